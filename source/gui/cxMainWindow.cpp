@@ -76,7 +76,7 @@ MainWindow::MainWindow() :
 	this->createActions();
 	this->createMenus();
 	this->createToolBars();
-	this->setStatusBar(new StatusBar(mServices->tracking(), mServices->view(), mServices->video()));
+	this->setStatusBar(new StatusBar(mServices->tracking(), mServices->view(), mServices->video(), mServices->patient()));
 
 	reporter()->setAudioSource(AudioPtr(new AudioImpl()));
 
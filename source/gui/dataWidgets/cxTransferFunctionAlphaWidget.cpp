@@ -14,7 +14,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <limits.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
-#include <vtkImageAccumulate.h>
 #include <QPainter>
 #include <QPen>
 #include <QColor>
@@ -22,6 +21,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QMouseEvent>
 #include "cxImageTF3D.h"
 #include "cxImageTFData.h"
+#include "cxImageStatistics.h"
 #include "cxLogger.h"
 #include "cxUtilHelpers.h"
 #include "cxTypeConversions.h"
@@ -263,20 +263,24 @@ void TransferFunctionAlphaWidget::paintHistogram(QPainter& painter)
 	// Draw histogram
 	// with log compression
 
-	vtkImageAccumulatePtr histogram = mImage->getHistogram();
-	int histogramSize = histogram->GetComponentExtent()[1] -
-						histogram->GetComponentExtent()[0];
+	ImageStatisticsPtr histogram = mImage->getStatistics();
+	int histogramSize = mImage->getRange();
+	int histogramMin = mImage->getMin();
+	int histogramMax = mImage->getMax();
 
 	painter.setPen(QColor(140, 140, 210));
 
-	double numElementsInBinWithMostElements = log(histogram->GetOutput()->GetPointData()->GetScalars()->GetRange()[1]+1);
+	// ignore zero: required for Sonowand CT volumes, where data are placed between 31K and 35K.
+	double numElementsInBinWithMostElements = log(double(histogram->getMaxCount(true))+1);
 	double barHeightMult = (this->height() - mBorder*2) / numElementsInBinWithMostElements;
 
 	double posMult = (this->width() - mBorder*2) / double(histogramSize);
-	for (int i = mImage->getMin(); i <= mImage->getMax(); i++)
+	for (int i = histogramMin; i <= histogramMax; i++)
 	{
-		int x = int(std::lround(((i- mImage->getMin()) * posMult))); //Offset with min value
-		int y = int(std::lround(log(double(static_cast<int*>(histogram->GetOutput()->GetScalarPointer(i - mImage->getMin(), 0, 0))[0]+1)) * barHeightMult));
+		if (i == 0)
+			continue;
+		int x = int(std::lround(((i- histogramMin) * posMult))); //Offset with min value
+		int y = int(std::lround(log(double(histogram->getCount(i))+1) * barHeightMult));
 	  if (y > 0)
 	  {
 		painter.drawLine(x + mBorder, height() - mBorder,
@@ -31,6 +31,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxTypeConversions.h"
 #include "cxActiveToolProxy.h"
 #include "cxViewService.h"
+#include "cxPatientModelService.h"
 
 #include "cxLogMessageFilter.h"
 #include "cxMessageListener.h"
@@ -39,7 +40,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 namespace cx
 {
-StatusBar::StatusBar(TrackingServicePtr trackingService, ViewServicePtr viewService, VideoServicePtr videoService) :
+StatusBar::StatusBar(TrackingServicePtr trackingService, ViewServicePtr viewService, VideoServicePtr videoService, PatientModelServicePtr patientModelService) :
 	mRenderingFpsLabel(new QLabel(this)),
 	mGrabbingInfoLabel(new QLabel(this)),
 	mRecordFullscreenLabel(new QLabel(this)),
@@ -64,6 +65,8 @@ StatusBar::StatusBar(TrackingServicePtr trackingService, ViewServicePtr viewServ
 
 	connect(vlc(), &VLCRecorder::stateChanged, this, &StatusBar::onRecordFullscreenChanged);
 
+	connect(patientModelService.get(), &PatientModelService::dataLoadProgress, this, &StatusBar::dataLoadProgressSlot);
+
 //	this->addPermanentWidget(mMessageLevelLabel);
 	this->addPermanentWidget(mRenderingFpsLabel);
 }
@@ -233,4 +236,16 @@ void StatusBar::showMessageSlot(Message message)
 	this->showMessage(text, message.getTimeout());
 }
 
+void StatusBar::dataLoadProgressSlot(int loaded, int total)
+{
+	if (loaded >= total)
+	{
+		this->clearMessage();
+		return;
+	}
+
+	this->showMessage(QString("Loading data %1 of %2...").arg(loaded+1).arg(total));
+	this->repaint(); // the patient is loaded in the main thread: paint now instead of waiting for the event loop
+}
+
 }//namespace cx
@@ -72,7 +72,7 @@ class cxGui_EXPORT StatusBar: public QStatusBar
   Q_OBJECT
 
 public:
-  StatusBar(TrackingServicePtr trackingService, ViewServicePtr viewService, VideoServicePtr videoService); ///< connects signals and slots
+  StatusBar(TrackingServicePtr trackingService, ViewServicePtr viewService, VideoServicePtr videoService, PatientModelServicePtr patientModelService); ///< connects signals and slots
   virtual ~StatusBar(); ///< empty
 
 private slots:
@@ -83,6 +83,7 @@ private slots:
   void grabberConnectedSlot(bool connected);
   void tpsSlot(int numTps); ///< Show transforms per seconds
   void showMessageSlot(Message message); ///< prints the incomming message to the statusbar
+  void dataLoadProgressSlot(int loaded, int total); ///< Show progress while loading patient data
   void updateToolButtons();
   void resetToolManagerConnection();
   void onRecordFullscreenChanged();
@@ -378,6 +378,7 @@ VideoTab::VideoTab(QWidget *parent) :
 	m24bitRadioButton = NULL;
 	m8bitRadioButton = NULL;
 	mCompressCheckBox = NULL;
+	mSingleFileCheckBox = NULL;
 
 }
 
@@ -405,10 +406,15 @@ void VideoTab::init()
 	mCompressCheckBox->setChecked(settings()->value("Ultrasound/CompressAcquisition", true).toBool());
 	mCompressCheckBox->setToolTip("Store the US Acquisition data as compressed MHD");
 
+	mSingleFileCheckBox = new QCheckBox("Save acquisition as single file");
+	mSingleFileCheckBox->setChecked(settings()->value("Ultrasound/SingleFileAcquisition", false).toBool());
+	mSingleFileCheckBox->setToolTip("Store each US Acquisition stream in one .cxus file instead of one file per frame");
+
 	toplayout->addSpacing(5);
 	toplayout->addWidget(m24bitRadioButton);
 	toplayout->addWidget(m8bitRadioButton);
 	toplayout->addWidget(mCompressCheckBox);
+	toplayout->addWidget(mSingleFileCheckBox);
 
 	mTopLayout->addLayout(toplayout);
 
@@ -419,6 +425,7 @@ void VideoTab::saveParametersSlot()
 	settings()->setValue("Ultrasound/acquisitionName", mAcquisitionNameLineEdit->text());
 	settings()->setValue("Ultrasound/8bitAcquisitionData", m8bitRadioButton->isChecked());
 	settings()->setValue("Ultrasound/CompressAcquisition", mCompressCheckBox->isChecked());
+	settings()->setValue("Ultrasound/SingleFileAcquisition", mSingleFileCheckBox->isChecked());
 }
 
 //==============================================================================
@@ -158,6 +158,7 @@ protected:
   QRadioButton* m24bitRadioButton;
   QRadioButton* m8bitRadioButton;
   QCheckBox* mCompressCheckBox;
+  QCheckBox* mSingleFileCheckBox;
 };
 
 /**
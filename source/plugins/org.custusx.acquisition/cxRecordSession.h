@@ -33,7 +33,6 @@ namespace cx
  */
 
 typedef boost::shared_ptr<class RecordSession> RecordSessionPtr;
-typedef std::map<double, Transform3D> TimedTransformMap;
 
 /**
  * RecordSession
@@ -155,6 +155,7 @@ void USAcquisition::recordStarted()
 
 	ToolPtr tool = this->getServices()->tracking()->getFirstProbe();
 	mCore->setWriteColor(this->getWriteColor());
+	mCore->setWriteSingleFile(settings()->value("Ultrasound/SingleFileAcquisition", false).toBool());
 	mCore->startRecord(mBase->getLatestSession(),
 										 tool,
 										 this->getServices()->tracking()->getReferenceTool(),
@@ -67,6 +67,10 @@ public:
 	void cancelRecord();
 
 	void setWriteColor(bool on);
+	/**
+	  * Store each stream in a single .cxus file instead of one file per frame.
+	  */
+	void setWriteSingleFile(bool on);
 	void set_rMpr(Transform3D rMpr);
 	/**
 	  * Retrieve an in-memory data set for the given stream uid.
@@ -98,6 +102,7 @@ private:
 	ToolPtr mRecordingTool;
 	ToolPtr mReference;
 	bool mDoWriteColor;
+	bool mWriteSingleFile;
 	Transform3D m_rMpr;
 };
 typedef boost::shared_ptr<USSavingRecorder> USSavingRecorderPtr;
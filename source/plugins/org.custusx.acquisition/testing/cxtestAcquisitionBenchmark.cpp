@@ -0,0 +1,56 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include "cxtestAcquisitionBenchmarkFixture.h"
+
+namespace cxtest
+{
+
+namespace
+{
+void runAcquisitionBenchmark(int frameInterval, int trackingInterval, bool writeSingleFile)
+{
+	AcquisitionBenchmarkFixture fixture;
+	fixture.setFrameInterval(frameInterval);
+	fixture.setTrackingInterval(trackingInterval);
+	fixture.setWriteSingleFile(writeSingleFile);
+	fixture.run();
+
+	CHECK(fixture.getStreamedFrames() > 0);
+	CHECK(fixture.getRecordedFrames() > 0);
+	CHECK(fixture.getRecordedPositions() > 0);
+	CHECK(fixture.getSavedData().size() == 1);
+	CHECK(fixture.getSavedBytes() > 0);
+}
+} // namespace
+
+TEST_CASE("Speed: US acquisition at 25 fps, tracking at 33 Hz", "[speed][integration][modules][Acquisition]")
+{
+	runAcquisitionBenchmark(40, 30, false);
+}
+
+TEST_CASE("Speed: US acquisition at 25 fps, tracking at 33 Hz, single file", "[speed][integration][modules][Acquisition]")
+{
+	runAcquisitionBenchmark(40, 30, true);
+}
+
+TEST_CASE("Speed: US acquisition at 100 fps, tracking at 100 Hz", "[speed][integration][modules][Acquisition]")
+{
+	runAcquisitionBenchmark(10, 10, false);
+}
+
+TEST_CASE("Speed: US acquisition at 100 fps, tracking at 100 Hz, single file", "[speed][integration][modules][Acquisition]")
+{
+	runAcquisitionBenchmark(10, 10, true);
+}
+
+} // namespace cxtest
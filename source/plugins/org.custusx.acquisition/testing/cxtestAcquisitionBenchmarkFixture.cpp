@@ -0,0 +1,245 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxtestAcquisitionBenchmarkFixture.h"
+
+#include <algorithm>
+#include <QApplication>
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTime>
+#include "catch.hpp"
+
+#include "cxMHDImageStreamer.h"
+#include "cxDirectlyLinkedSender.h"
+#include "cxBasicVideoSource.h"
+#include "cxDummyTool.h"
+#include "cxTrackingSystemDummyService.h"
+#include "cxRecordSession.h"
+#include "cxUSReconstructInputData.h"
+#include "cxDataLocations.h"
+#include "cxFileHelpers.h"
+#include "cxLogicManager.h"
+#include "cxReporter.h"
+#include "cxLogger.h"
+#include "cxFileManagerServiceProxy.h"
+#include "cxtestJenkinsMeasurement.h"
+
+#ifdef CX_WINDOWS
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace cxtest
+{
+
+AcquisitionBenchmarkFixture::AcquisitionBenchmarkFixture(QObject* parent) :
+	QObject(parent),
+	mFrameInterval(40),
+	mTrackingInterval(30),
+	mRecordDuration(3000),
+	mWriteSingleFile(false),
+	mCompressImages(true),
+	mStreamedFrames(0),
+	mRecordedStreamedFrames(0),
+	mRecordedFrames(0),
+	mRecordedPositions(0),
+	mRecordMs(0),
+	mSaveMs(0),
+	mSavedBytes(0)
+{
+	this->setUp();
+}
+
+AcquisitionBenchmarkFixture::~AcquisitionBenchmarkFixture()
+{
+	this->tearDown();
+}
+
+void AcquisitionBenchmarkFixture::setUp()
+{
+	cx::LogicManager::initialize();
+	cx::removeNonemptyDirRecursively(this->getDataPath());
+	cx::Reporter::initialize();
+}
+
+void AcquisitionBenchmarkFixture::tearDown()
+{
+	mRecorder.reset();
+	cx::Reporter::shutdown();
+	cx::removeNonemptyDirRecursively(this->getDataPath());
+	cx::LogicManager::shutdown();
+}
+
+QString AcquisitionBenchmarkFixture::getDataPath()
+{
+	return cx::DataLocations::getTestDataPath() + "/temp/AcquisitionBenchmark/";
+}
+
+QString AcquisitionBenchmarkFixture::getMeasurementPrefix() const
+{
+	return QString("USAcquisition_%1msFrames_%2msTracking_%3")
+			.arg(mFrameInterval)
+			.arg(mTrackingInterval)
+			.arg(mWriteSingleFile ? "SingleFile" : "FilePerFrame");
+}
+
+int AcquisitionBenchmarkFixture::getDroppedFrames() const
+{
+	return std::max(0, mRecordedStreamedFrames - mRecordedFrames);
+}
+
+void AcquisitionBenchmarkFixture::run()
+{
+	this->startStreaming();
+	this->wait(500); // let streaming and tracking settle before recording
+	this->record();
+	this->stopStreaming();
+	this->save();
+	this->printMeasurements();
+}
+
+void AcquisitionBenchmarkFixture::startStreaming()
+{
+	QString filename = cx::DataLocations::getTestDataPath() + "/testing/default_volume/Default.mhd";
+	REQUIRE(QFile::exists(filename));
+
+	mVideo.reset(new cx::BasicVideoSource("benchmarkVideo"));
+	mVideo->start();
+
+	mSender.reset(new cx::DirectlyLinkedSender());
+	connect(mSender.get(), SIGNAL(newImage()), this, SLOT(newImage()));
+
+	mStreamer.reset(new cx::DummyImageStreamer());
+	mStreamer->setSendInterval(mFrameInterval);
+	mStreamer->initialize(filename, false);
+	mStreamer->startStreaming(mSender);
+	REQUIRE(mStreamer->isStreaming());
+
+	mTool.reset(new cx::DummyTool());
+	mTool->setProbeSector(cx::DummyToolTestUtilities::createProbeDefinitionLinear());
+	mTracking.reset(new cx::TrackingSystemDummyService(mTool));
+	mTracking->setTrackingInterval(mTrackingInterval);
+	mTracking->setState(cx::Tool::tsTRACKING);
+}
+
+void AcquisitionBenchmarkFixture::stopStreaming()
+{
+	mTracking->setState(cx::Tool::tsNONE);
+	mStreamer->stopStreaming();
+	disconnect(mSender.get(), SIGNAL(newImage()), this, SLOT(newImage()));
+	mVideo->stop();
+}
+
+void AcquisitionBenchmarkFixture::newImage()
+{
+	cx::ImagePtr image = mSender->popImage();
+	if (!image)
+		return;
+	++mStreamedFrames;
+	mVideo->setInput(image);
+}
+
+void AcquisitionBenchmarkFixture::record()
+{
+	mRecorder.reset(new cx::USSavingRecorder());
+	mRecorder->setWriteColor(true);
+	mRecorder->setWriteSingleFile(mWriteSingleFile);
+	mRecorder->set_rMpr(cx::Transform3D::Identity());
+	connect(mRecorder.get(), SIGNAL(saveDataCompleted(QString)), this, SLOT(dataSaved(QString)));
+
+	std::vector<cx::VideoSourcePtr> video;
+	video.push_back(mVideo);
+	cx::FileManagerServicePtr filemanager = cx::FileManagerServiceProxy::create(cx::logicManager()->getPluginContext());
+
+	cx::RecordSessionPtr session(new cx::RecordSession(0, "benchmark"));
+	session->startNewInterval();
+	mRecorder->startRecord(session, mTool, cx::ToolPtr(), video, filemanager);
+	int streamedAtStart = mStreamedFrames;
+	QTime clock;
+	clock.start();
+
+	this->wait(mRecordDuration);
+
+	session->stopLastInterval();
+	mRecorder->stopRecord();
+	mRecordMs = clock.elapsed();
+	mRecordedStreamedFrames = mStreamedFrames - streamedAtStart;
+
+	cx::USReconstructInputData data = mRecorder->getDataForStream(mVideo->getUid());
+	mRecordedFrames = data.mFrames.size();
+	mRecordedPositions = data.mPositions.size();
+}
+
+void AcquisitionBenchmarkFixture::save()
+{
+	QTime clock;
+	clock.start();
+	mRecorder->startSaveData(this->getDataPath(), mCompressImages);
+
+	while (mRecorder->getNumberOfSavingThreads() > 0)
+	{
+		qApp->processEvents();
+#ifndef CX_WINDOWS
+		usleep(1000);
+#else
+		Sleep(1);
+#endif
+	}
+	mSaveMs = clock.elapsed();
+	mSavedBytes = this->getFolderSize(this->getDataPath());
+}
+
+void AcquisitionBenchmarkFixture::dataSaved(QString filename)
+{
+	mSavedData << filename;
+}
+
+void AcquisitionBenchmarkFixture::wait(int time)
+{
+	qint64 stop = QDateTime::currentMSecsSinceEpoch() + time;
+
+	while (QDateTime::currentMSecsSinceEpoch() < stop)
+		qApp->processEvents();
+}
+
+qint64 AcquisitionBenchmarkFixture::getFolderSize(QString path)
+{
+	qint64 retval = 0;
+	QDirIterator iter(path, QDir::Files, QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		iter.next();
+		retval += iter.fileInfo().size();
+	}
+	return retval;
+}
+
+void AcquisitionBenchmarkFixture::printMeasurements()
+{
+	double recordSeconds = std::max(this->getRecordSeconds(), 0.001);
+	double saveSeconds = std::max(this->getSaveSeconds(), 0.001);
+	double megaBytes = double(mSavedBytes)/1024/1024;
+
+	QString prefix = this->getMeasurementPrefix();
+	JenkinsMeasurement jenkins;
+	jenkins.createOutput(prefix+"_StreamedFPS", QString::number(mRecordedStreamedFrames/recordSeconds));
+	jenkins.createOutput(prefix+"_RecordedFPS", QString::number(mRecordedFrames/recordSeconds));
+	jenkins.createOutput(prefix+"_DroppedFrames", QString::number(this->getDroppedFrames()));
+	jenkins.createOutput(prefix+"_TrackingHz", QString::number(mRecordedPositions/recordSeconds));
+	jenkins.createOutput(prefix+"_WriteMBps", QString::number(megaBytes/saveSeconds));
+	jenkins.createOutput(prefix+"_WriteSeconds", QString::number(saveSeconds));
+}
+
+} // namespace cxtest
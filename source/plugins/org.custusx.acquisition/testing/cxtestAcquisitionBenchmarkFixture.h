@@ -0,0 +1,112 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXTESTACQUISITIONBENCHMARKFIXTURE_H
+#define CXTESTACQUISITIONBENCHMARKFIXTURE_H
+
+#include "cxtest_org_custusx_acquisition_export.h"
+
+#include <QObject>
+#include "cxForwardDeclarations.h"
+#include "cxUSSavingRecorder.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class DummyImageStreamer> DummyImageStreamerPtr;
+typedef boost::shared_ptr<class DirectlyLinkedSender> DirectlyLinkedSenderPtr;
+typedef boost::shared_ptr<class BasicVideoSource> BasicVideoSourcePtr;
+typedef boost::shared_ptr<class TrackingSystemDummyService> TrackingSystemDummyServicePtr;
+}
+
+namespace cxtest
+{
+
+/** Measure throughput of the US acquisition path.
+ *
+ * Frames are streamed from a DummyImageStreamer into a video source,
+ * and positions from a dummy tool run by TrackingSystemDummyService.
+ * Both are recorded with USSavingRecorder, then saved to disk.
+ *
+ * run() prints the measurements as Jenkins measurements,
+ * named with getMeasurementPrefix().
+ *
+ * \ingroup cxTest
+ * \date 2026-10-18
+ */
+class CXTEST_ORG_CUSTUSX_ACQUISITION_EXPORT AcquisitionBenchmarkFixture : public QObject
+{
+	Q_OBJECT
+
+public:
+	AcquisitionBenchmarkFixture(QObject* parent=NULL);
+	~AcquisitionBenchmarkFixture();
+
+	void setFrameInterval(int ms) { mFrameInterval = ms; }
+	void setTrackingInterval(int ms) { mTrackingInterval = ms; }
+	void setRecordDuration(int ms) { mRecordDuration = ms; }
+	void setWriteSingleFile(bool on) { mWriteSingleFile = on; }
+	void setCompressImages(bool on) { mCompressImages = on; }
+
+	void run(); ///< stream, record and save, then print measurements
+
+	int getStreamedFrames() const { return mRecordedStreamedFrames; } ///< frames sent by the streamer while recording
+	int getRecordedFrames() const { return mRecordedFrames; }
+	int getRecordedPositions() const { return mRecordedPositions; }
+	int getDroppedFrames() const;
+	double getRecordSeconds() const { return mRecordMs/1000.0; }
+	double getSaveSeconds() const { return mSaveMs/1000.0; }
+	qint64 getSavedBytes() const { return mSavedBytes; }
+	QStringList getSavedData() const { return mSavedData; }
+	QString getMeasurementPrefix() const;
+
+	static QString getDataPath();
+
+private slots:
+	void newImage();
+	void dataSaved(QString filename);
+
+private:
+	void setUp();
+	void tearDown();
+	void startStreaming();
+	void stopStreaming();
+	void record();
+	void save();
+	void printMeasurements();
+	void wait(int time);
+	static qint64 getFolderSize(QString path);
+
+	int mFrameInterval;
+	int mTrackingInterval;
+	int mRecordDuration;
+	bool mWriteSingleFile;
+	bool mCompressImages;
+
+	cx::DummyImageStreamerPtr mStreamer;
+	cx::DirectlyLinkedSenderPtr mSender;
+	cx::BasicVideoSourcePtr mVideo;
+	cx::DummyToolPtr mTool;
+	cx::TrackingSystemDummyServicePtr mTracking;
+	cx::USSavingRecorderPtr mRecorder;
+
+	int mStreamedFrames;
+	int mRecordedStreamedFrames;
+	int mRecordedFrames;
+	int mRecordedPositions;
+	int mRecordMs;
+	int mSaveMs;
+	qint64 mSavedBytes;
+	QStringList mSavedData;
+};
+
+} // namespace cxtest
+
+#endif // CXTESTACQUISITIONBENCHMARKFIXTURE_H
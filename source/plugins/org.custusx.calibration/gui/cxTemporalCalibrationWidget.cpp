@@ -77,7 +77,7 @@ TemporalCalibrationWidget::TemporalCalibrationWidget(VisServicesPtr services, Ac
 
   mFileSelectWidget = new FileSelectWidget(this);
   connect(mFileSelectWidget, SIGNAL(fileSelected(QString)), this, SLOT(selectData(QString)));
-  mFileSelectWidget->setNameFilter(QStringList() << "*.fts");
+  mFileSelectWidget->setNameFilter(QStringList() << "*.fts" << "*.cxus");
   topLayout->addWidget(mFileSelectWidget);
 
   mVerbose = new QCheckBox("Save data to temporal_calib.txt");
@@ -0,0 +1,156 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxSignalCorrelation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <unsupported/Eigen/FFT>
+
+namespace cx
+{
+
+namespace
+{
+/** Return sum_i x[i]*y[i+k] for k in [-(nx-1), ny-1], stored at index k+nx-1.
+ */
+std::vector<double> crossCorrelationSums(const std::vector<double>& x, const std::vector<double>& y)
+{
+	int nx = x.size();
+	int ny = y.size();
+	if (!nx || !ny)
+		return std::vector<double>();
+
+	// pad to avoid wrap-around in the circular correlation
+	int size = nx+ny-1;
+	int M = 1;
+	while (M < size)
+		M *= 2;
+
+	std::vector<double> xp(M, 0);
+	std::vector<double> yp(M, 0);
+	std::copy(x.begin(), x.end(), xp.begin());
+	std::copy(y.begin(), y.end(), yp.begin());
+
+	Eigen::FFT<double> fft;
+	std::vector<std::complex<double> > X;
+	std::vector<std::complex<double> > Y;
+	fft.fwd(X, xp);
+	fft.fwd(Y, yp);
+	for (int k=0; k<M; ++k)
+		X[k] = std::conj(X[k]) * Y[k];
+	std::vector<double> r;
+	fft.inv(r, X);
+
+	std::vector<double> retval(size);
+	for (int k=-(nx-1); k<ny; ++k)
+		retval[k+nx-1] = r[(k+M)%M];
+	return retval;
+}
+
+std::vector<double> squaredPrefixSums(const std::vector<double>& x)
+{
+	std::vector<double> retval(x.size()+1, 0);
+	for (unsigned i=0; i<x.size(); ++i)
+		retval[i+1] = retval[i] + x[i]*x[i];
+	return retval;
+}
+} // namespace
+
+std::vector<double> correlateFFT(const std::vector<double>& x, const std::vector<double>& y, int maxDelay)
+{
+	std::vector<double> retval(2*maxDelay, 0);
+	int n = std::min(x.size(), y.size());
+	if (!n)
+		return retval;
+
+	double mx = 0;
+	double my = 0;
+	for (int i=0; i<n; ++i)
+	{
+		mx += x[i];
+		my += y[i];
+	}
+	mx /= n;
+	my /= n;
+
+	std::vector<double> dx(n);
+	std::vector<double> dy(n);
+	double sx = 0;
+	double sy = 0;
+	for (int i=0; i<n; ++i)
+	{
+		dx[i] = x[i] - mx;
+		dy[i] = y[i] - my;
+		sx += dx[i]*dx[i];
+		sy += dy[i]*dy[i];
+	}
+	double denom = sqrt(sx*sy);
+	if (denom==0)
+		return retval;
+
+	std::vector<double> sums = crossCorrelationSums(dx, dy);
+	for (int delay=-maxDelay; delay<maxDelay; ++delay)
+	{
+		if (std::abs(delay) >= n)
+			continue; // no overlap
+		retval[delay+maxDelay] = sums[delay+n-1] / denom;
+	}
+	return retval;
+}
+
+std::vector<double> leastSquaresFFT(const std::vector<double>& x, const std::vector<double>& y, int maxShift)
+{
+	std::vector<double> retval(2*maxShift, std::numeric_limits<double>::max());
+	int nx = x.size();
+	int ny = y.size();
+	if (!nx || !ny)
+		return retval;
+
+	// expand sum (x-y)^2 = sum x^2 + sum y^2 - 2 sum xy, each over the overlap
+	std::vector<double> sums = crossCorrelationSums(x, y);
+	std::vector<double> xx = squaredPrefixSums(x);
+	std::vector<double> yy = squaredPrefixSums(y);
+
+	for (int shift=-maxShift; shift<maxShift; ++shift)
+	{
+		int r0 = std::max(0, -shift);
+		int r1 = std::min(nx, ny-shift);
+		if (r1 <= r0)
+			continue;
+
+		double sxx = xx[r1] - xx[r0];
+		double syy = yy[r1+shift] - yy[r0+shift];
+		double sxy = sums[shift+nx-1];
+		double value = (sxx + syy - 2*sxy) / (r1-r0);
+		retval[shift+maxShift] = sqrt(std::max(0.0, value));
+	}
+	return retval;
+}
+
+double interpolatePeak(const std::vector<double>& values, int index)
+{
+	if (index <= 0 || index+1 >= int(values.size()))
+		return index;
+
+	double y0 = values[index-1];
+	double y1 = values[index];
+	double y2 = values[index+1];
+	double denom = y0 - 2*y1 + y2;
+	if (denom==0)
+		return index;
+
+	return index + 0.5*(y0-y2)/denom;
+}
+
+}
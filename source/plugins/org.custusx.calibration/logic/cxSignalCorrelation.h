@@ -0,0 +1,54 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXSIGNALCORRELATION_H_
+#define CXSIGNALCORRELATION_H_
+
+#include "org_custusx_calibration_Export.h"
+
+#include <vector>
+
+namespace cx
+{
+/**
+ * \file
+ * \addtogroup org_custusx_calibration
+ * @{
+ */
+
+/** Normalized correlation between x and y for all delays in [-maxDelay, maxDelay):
+ *
+ *   corr[delay+maxDelay] = sum_i (x[i]-mean(x))*(y[i+delay]-mean(y)) / sqrt(sx*sy)
+ *
+ * summed over the overlap, sx and sy are the sums of squared deviations.
+ * Computed by FFT in O(n log n). x and y must have equal size.
+ */
+org_custusx_calibration_EXPORT std::vector<double> correlateFFT(const std::vector<double>& x, const std::vector<double>& y, int maxDelay);
+
+/** RMS of x[i]-y[i+shift] over the overlap, for all shifts in [-maxShift, maxShift):
+ *
+ *   rms[shift+maxShift] = sqrt(sum_i (x[i]-y[i+shift])^2 / overlap)
+ *
+ * Computed by FFT in O(n log n). Shifts without overlap are set to the max double.
+ */
+org_custusx_calibration_EXPORT std::vector<double> leastSquaresFFT(const std::vector<double>& x, const std::vector<double>& y, int maxShift);
+
+/** Refine the extremum at index by fitting a parabola to its neighbours.
+ *  Returns the fractional index, index if at the border.
+ */
+org_custusx_calibration_EXPORT double interpolatePeak(const std::vector<double>& values, int index);
+
+/**
+ * @}
+ */
+}
+
+#endif /* CXSIGNALCORRELATION_H_ */
@@ -29,10 +29,10 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxUsReconstructionFileReader.h"
 #include "cxLogger.h"
 #include "cxTime.h"
-#include <vtkImageMask.h>
 #include "cxFileManagerServiceProxy.h"
+#include "cxSignalCorrelation.h"
+#include <QtConcurrent>
 
-typedef vtkSmartPointer<vtkImageMask> vtkImageMaskPtr;
 typedef vtkSmartPointer<vtkImageCorrelation> vtkImageCorrelationPtr;
 
 namespace cx
@@ -42,63 +42,6 @@ typedef unsigned char uchar; // for removing eclipse warnings
 
 
 
-/**
- * Found this on
- * http://paulbourke.net/miscellaneous/correlate/
- * Slightly modified.
- *
- * x: first input series, size n
- * y: second input series, size n
- * corr: correlation result, size maxdelay*2 (zero shif is found at corr[maxdelay]
- */
-void correlate(double* x, double* y, double* corr, int maxdelay, int n)
-{
-  int i, j;
-  double mx, my, sx, sy, sxy, denom, r;
-  int delay;
-
-  /* Calculate the mean of the two series x[], y[] */
-  mx = 0;
-  my = 0;
-  for (i = 0; i < n; i++)
-  {
-    mx += x[i];
-    my += y[i];
-  }
-  mx /= n;
-  my /= n;
-
-  /* Calculate the denominator */
-  sx = 0;
-  sy = 0;
-  for (i = 0; i < n; i++)
-  {
-    sx += (x[i] - mx) * (x[i] - mx);
-    sy += (y[i] - my) * (y[i] - my);
-  }
-  denom = sqrt(sx * sy);
-
-  /* Calculate the correlation series */
-  for (delay = -maxdelay; delay < maxdelay; delay++)
-  {
-    sxy = 0;
-    for (i = 0; i < n; i++)
-    {
-      j = i + delay;
-      if (j < 0 || j >= n)
-        continue;
-      else
-        sxy += (x[i] - mx) * (y[j] - my);
-    }
-    r = sxy / denom;
-    corr[delay+maxdelay] = r;//(sxy/denom+1) * 128;
-
-    /* r is the correlation coefficient at "delay" */
-
-  }
-
-}
-
 TemporalCalibration::TemporalCalibration()
 {
 	mAddRawToDebug = false;
@@ -241,29 +184,6 @@ bool TemporalCalibration::checkFrameMovementQuality(std::vector<double> pos)
 	return error < 0.2;
 }
 
-/** shift tracking data with the input shift, then compute RMS value of function
- *
- */
-double TemporalCalibration::findLeastSquares(std::vector<double> frames, std::vector<double> tracking, int shift) const
-{
-	size_t r0 = 0;
-	size_t r1 = frames.size();
-
-	r0 = std::max<int>(r0, - shift);
-	r1 = std::min<int>(r1, tracking.size() - shift);
-
-	double value = 0;
-
-	for (int i=r0; i<r1; ++i)
-	{
-		double core = pow(frames[i] - tracking[i+shift], 2.0);
-		value += core;
-	}
-	value /= (r1-r0);
-	value = sqrt(value);
-	return value;
-}
-
 /** Find the correlation shift between the regularly spaces series frames and tracking,
  *  with a spacing of resolution.
  *
@@ -274,17 +194,14 @@ double TemporalCalibration::findLSShift(std::vector<double> frames, std::vector<
 	double maxShift = 1000;
 	size_t N = std::min(tracking.size(), frames.size());
   N = std::min<int>(N, 2*maxShift/resolution); // constrain search to 1 second in each direction
-  std::vector<double> result(N, 0);
   int W = N/2;
 
-  for (int i=-W; i<W; ++i)
-  {
-  	double rms = this->findLeastSquares(frames, tracking, i);
-  	result[i+W] = rms;
-  }
+  // rms of frames[i]-tracking[i+shift] for all shifts in [-W,W>
+  std::vector<double> result = leastSquaresFFT(frames, tracking, W);
 
   int top = std::distance(result.begin(), std::min_element(result.begin(), result.end()));
-  double shift = (W-top) * resolution; // convert to shift in ms.
+  double subTop = interpolatePeak(result, top); // refine below the resolution
+  double shift = (W-subTop) * resolution; // convert to shift in ms.
 
   mDebugStream << "=======================================" << std::endl;
   mDebugStream << "tracking vs frames fit using least squares:" << std::endl;
@@ -296,7 +213,7 @@ double TemporalCalibration::findLSShift(std::vector<double> frames, std::vector<
 	for (size_t x = 0; x < std::min<int>(tracking.size(), frames.size()); ++x)
   {
     mDebugStream << frames[x] << "\t" << tracking[x];
-    if (x<N)
+    if (x<result.size())
     	mDebugStream << "\t" << result[x];
   	mDebugStream << std::endl;
   }
@@ -316,9 +233,7 @@ double TemporalCalibration::findLSShift(std::vector<double> frames, std::vector<
 double TemporalCalibration::findCorrelationShift(std::vector<double> frames, std::vector<double> tracking, double resolution) const
 {
 	size_t N = std::min(tracking.size(), frames.size());
-  std::vector<double> result(N, 0);
-
-  correlate(&*frames.begin(), &*tracking.begin(), &*result.begin(), N / 2, N);
+  std::vector<double> result = correlateFFT(frames, tracking, N/2);
 
   int top = std::distance(result.begin(), std::max_element(result.begin(), result.end()));
   double shift = (N/2-top) * resolution; // convert to shift in ms.
@@ -331,7 +246,10 @@ double TemporalCalibration::findCorrelationShift(std::vector<double> frames, std
   mDebugStream << "Frame pos" << "\t" << "Track pos" << "\t" << "correlation" << std::endl;
   for (int x = 0; x < N; ++x)
   {
-    mDebugStream << frames[x] << "\t" << tracking[x] << "\t" << result[x] << std::endl;
+    mDebugStream << frames[x] << "\t" << tracking[x];
+    if (x<int(result.size()))
+    	mDebugStream << "\t" << result[x];
+    mDebugStream << std::endl;
   }
 
   mDebugStream << std::endl;
@@ -429,18 +347,34 @@ std::vector<double> TemporalCalibration::computeTrackingMovement()
  */
 std::vector<double> TemporalCalibration::computeProbeMovement()
 {
-  int N_frames = mFileData.mUsRaw->getDimensions()[2];
+  int N_frames = mProcessedFrames.size();
 
   std::vector<double> retval;
+  if (!N_frames)
+    return retval;
 
   double maxSingleStep = 5; // assume max 5mm movement per frame
 //	double currentMaxShift;
   double lastVal = 0;
 
 	mMask = mFileData.getMask();
+	int line_index_x = mFileData.mProbeDefinition.mData.getOrigin_p()[0];
+	// read the dimensions once: mUsRaw->getDimensions() loads a frame under the container lock.
+	int* dims = mProcessedFrames[0]->GetDimensions();
+	int dimX = dims[0];
+	int dimY = dims[1];
+	std::vector<double> reference = this->extractLine_y(line_index_x, 0, dimX, dimY);
+
+	// correlating each frame with the first is independent of the other frames:
+	// do it in parallel, then search for the hits in sequence, each seeded by the last.
+	std::vector<FrameCorrelation> correlations(N_frames);
+	for (int i=0; i<N_frames; ++i)
+		correlations[i].frame = i;
+	QtConcurrent::blockingMap(correlations, boost::bind(&TemporalCalibration::correlateWithReference, this, boost::cref(reference), line_index_x, dimX, _1));
+
   for (int i=0; i<N_frames; ++i)
   {
-    double val = this->findCorrelation(mFileData.mUsRaw, 0, i, maxSingleStep, lastVal);
+    double val = this->findCorrelation(correlations[i].values, maxSingleStep, lastVal);
 //    currentMaxShift =  fabs(val) + maxSingleStep;
     lastVal = val;
     retval.push_back(val);
@@ -463,25 +397,19 @@ std::vector<double> TemporalCalibration::computeProbeMovement()
   return retval;
 }
 
-double TemporalCalibration::findCorrelation(USFrameDataPtr data, int frame_a, int frame_b, double maxShift, double lastVal)
+void TemporalCalibration::correlateWithReference(const std::vector<double>& reference, int line_index_x, int dimX, FrameCorrelation& target) const
+{
+	int dimY = reference.size();
+	std::vector<double> line = this->extractLine_y(line_index_x, target.frame, dimX, dimY);
+	target.values = correlateFFT(reference, line, dimY); // allocate space on both sides of zero
+}
+
+double TemporalCalibration::findCorrelation(const std::vector<double>& correlation, double maxShift, double lastVal) const
 {
 	int maxShift_pix = maxShift / mFileData.mUsRaw->getSpacing()[1];
 	int lastVal_pix = lastVal / mFileData.mUsRaw->getSpacing()[1];
 
-	int line_index_x = mFileData.mProbeDefinition.mData.getOrigin_p()[0];
-
-  int dimY = mFileData.mUsRaw->getDimensions()[1];
-
-	vtkImageDataPtr line1 = this->extractLine_y(mFileData.mUsRaw, line_index_x, frame_a);
-	vtkImageDataPtr line2 = this->extractLine_y(mFileData.mUsRaw, line_index_x, frame_b);
-
-  int N = 2*dimY; //result vector allocate space on both sides of zero
-  std::vector<double> result(N, 0);
-  double* line_a = static_cast<double*>(line1->GetScalarPointer());
-  double* line_b = static_cast<double*>(line2->GetScalarPointer());
-  double* line_c = &*result.begin();
-
-  correlate(line_a, line_b, line_c, N/2, dimY);
+  int N = correlation.size();
 
   // use the last found hit as a seed for looking for a local maximum
   int lastTop = N/2 - lastVal_pix;
@@ -490,49 +418,36 @@ double TemporalCalibration::findCorrelation(USFrameDataPtr data, int frame_a, in
   range.second = std::min(N, range.second);
 
   // look for a max in the vicinity of the last hit
-  int top = std::distance(result.begin(), std::max_element(result.begin()+range.first, result.begin()+range.second));
+  int top = std::distance(correlation.begin(), std::max_element(correlation.begin()+range.first, correlation.begin()+range.second));
 
   double hit = (N/2-top) * mFileData.mUsRaw->getSpacing()[1]; // convert to downwards movement in mm.
 
   return hit;
 }
 
-/**extract the y-line with x-index line_index_x from frame ( data[line_index_x, y_varying, frame] )
+/**extract the y-line with x-index line_index_x from frame ( data[line_index_x, y_varying, frame] ),
+ * with values outside mMask set to zero.
  *
+ * Reads the frame and mask directly, thus safe to call from several threads.
+ * dimX and dimY are the frame dimensions, equal for all frames.
  */
-vtkImageDataPtr TemporalCalibration::extractLine_y(USFrameDataPtr data, int line_index_x, int frame)
+std::vector<double> TemporalCalibration::extractLine_y(int line_index_x, int frame, int dimX, int dimY) const
 {
-  int dimX = data->getDimensions()[0];
-  int dimY = data->getDimensions()[1];
-
-  vtkImageDataPtr retval = generateVtkImageDataDouble(Eigen::Array3i(dimY, 1, 1), Vector3D(1,1,1), 1);
-
-  vtkImageDataPtr base = mProcessedFrames[frame];
-
-  // run the base frame through the mask. Result is source.
-  vtkImageMaskPtr maskFilter = vtkImageMaskPtr::New();
-	maskFilter->SetMaskInputData(mMask);
-  maskFilter->SetImageInputData(base);
-  maskFilter->SetMaskedOutputValue(0.0);
-  maskFilter->Update();
-  uchar* source = static_cast<uchar*>(maskFilter->GetOutput()->GetScalarPointer());
+  std::vector<double> retval(dimY, 0);
 
-  double* dest = static_cast<double*>(retval->GetScalarPointer());
+  uchar* source = static_cast<uchar*>(mProcessedFrames[frame]->GetScalarPointer());
+  uchar* mask = mMask ? static_cast<uchar*>(mMask->GetScalarPointer()) : NULL;
 
   for (int y=0; y<dimY; ++y)
   {
-    dest[y] = source[y*dimX + line_index_x];
+    int index = y*dimX + line_index_x;
+    if (!mask || mask[index])
+      retval[y] = source[index];
   }
 
   return retval;
 }
 
-
-
-
-
-
-
 }//namespace cx
 
 
@@ -39,6 +39,10 @@ typedef std::map<double,double> TimeSeriesType;
  * The shift sign is given from:
  *   frames = tracking + shift
  *
+ * The frames are correlated with the first frame in parallel,
+ * and the shift is found from a FFT based least squares fit,
+ * interpolated to below the resampling resolution.
+ *
  */
 class org_custusx_calibration_EXPORT TemporalCalibration
 {
@@ -49,13 +53,19 @@ public:
   double calibrate(bool* success);
 
 private:
-	vtkImageDataPtr extractLine_y(USFrameDataPtr data, int line_index_x, int frame);
-  double findCorrelation(USFrameDataPtr data, int frame_a, int frame_b, double maxShift, double lastVal);
+	struct FrameCorrelation
+	{
+		int frame;
+		std::vector<double> values; ///< correlation with the reference line, zero shift at values.size()/2
+	};
+
+	std::vector<double> extractLine_y(int line_index_x, int frame, int dimX, int dimY) const;
+	void correlateWithReference(const std::vector<double>& reference, int line_index_x, int dimX, FrameCorrelation& target) const;
+  double findCorrelation(const std::vector<double>& correlation, double maxShift, double lastVal) const;
   std::vector<double> computeProbeMovement();
   std::vector<double> resample(std::vector<double> shift, std::vector<TimedPosition> time, double resolution);
   std::vector<double> computeTrackingMovement();
   double findCorrelationShift(std::vector<double> frames, std::vector<double> tracking, double resolution) const;
-  double findLeastSquares(std::vector<double> frames, std::vector<double> tracking, int shift) const;
   double findLSShift(std::vector<double> frames, std::vector<double> tracking, double resolution) const;
   bool checkFrameMovementQuality(std::vector<double> pos);
   void writePositions(QString title, std::vector<double> pos, std::vector<TimedPosition> time, double shift);
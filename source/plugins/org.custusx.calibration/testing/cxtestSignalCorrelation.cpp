@@ -0,0 +1,70 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include "cxSignalCorrelation.h"
+
+namespace
+{
+std::vector<double> createSignal(int size, double offset)
+{
+	std::vector<double> retval(size);
+	for (int i=0; i<size; ++i)
+		retval[i] = sin(0.05*(i+offset)) + 0.3*cos(0.17*(i+offset));
+	return retval;
+}
+
+double bruteForceRMS(const std::vector<double>& x, const std::vector<double>& y, int shift)
+{
+	int r0 = std::max(0, -shift);
+	int r1 = std::min<int>(x.size(), y.size()-shift);
+	double value = 0;
+	for (int i=r0; i<r1; ++i)
+		value += pow(x[i]-y[i+shift], 2.0);
+	return sqrt(value/(r1-r0));
+}
+} // namespace
+
+TEST_CASE("SignalCorrelation: FFT least squares equals the direct sum", "[unit][modules][calibration]")
+{
+	std::vector<double> x = createSignal(200, 0);
+	std::vector<double> y = createSignal(180, 7);
+	int W = 50;
+
+	std::vector<double> rms = cx::leastSquaresFFT(x, y, W);
+	REQUIRE(rms.size() == 2*W);
+	for (int shift=-W; shift<W; ++shift)
+	{
+		INFO("shift " << shift);
+		CHECK(rms[shift+W] == Approx(bruteForceRMS(x, y, shift)));
+	}
+}
+
+TEST_CASE("SignalCorrelation: Shift is found with sub-sample precision", "[unit][modules][calibration]")
+{
+	double trueShift = 12.3; // y[i] = x[i+trueShift]
+	std::vector<double> x = createSignal(400, trueShift);
+	std::vector<double> y = createSignal(400, 0);
+	int W = 50;
+
+	std::vector<double> rms = cx::leastSquaresFFT(x, y, W);
+	int top = std::distance(rms.begin(), std::min_element(rms.begin(), rms.end()));
+	CHECK(top == W+12);
+	CHECK(fabs(cx::interpolatePeak(rms, top)-W - trueShift) < 0.2);
+
+	std::vector<double> corr = cx::correlateFFT(x, y, W);
+	top = std::distance(corr.begin(), std::max_element(corr.begin(), corr.end()));
+	CHECK(top == W+12);
+	CHECK(corr[top] <= 1.0);
+}
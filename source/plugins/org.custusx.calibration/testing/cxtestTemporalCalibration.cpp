@@ -28,9 +28,10 @@ TEST_CASE("TemporalCalibration reproduces old results on a test data set", "[uni
   double shift = calibrator.calibrate(&success);
 
   double testValue = 115; // shift found on data set during first tests.
+  double tolerance = 2.5; // shift is now interpolated below the 5ms resampling resolution
 
   CHECK( success );
-  CHECK( cx::similar(shift, testValue, 1));
+  CHECK( cx::similar(shift, testValue, tolerance));
 	cx::LogicManager::shutdown();
 }
 
@@ -41,7 +41,7 @@ void OpenIGTLinkPluginActivator::start(ctkPluginContext* context)
 
 	igtlioLogicPointer logic = igtlioLogicPointer::New();
 	mNetworkHandler.reset(new NetworkHandler(logic));
-	OpenIGTLink3GuiExtenderService* gui = new OpenIGTLink3GuiExtenderService(context, logic);
+	OpenIGTLink3GuiExtenderService* gui = new OpenIGTLink3GuiExtenderService(context, mNetworkHandler);
 
 	OpenIGTLinkTrackingSystemService* tracking = new OpenIGTLinkTrackingSystemService(mNetworkHandler);
 	OpenIGTLinkStreamerService *streamer = new OpenIGTLinkStreamerService(mNetworkHandler, trackingService);
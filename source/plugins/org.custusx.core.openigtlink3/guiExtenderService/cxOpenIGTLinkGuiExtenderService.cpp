@@ -11,17 +11,76 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 
 #include "cxOpenIGTLinkGuiExtenderService.h"
+#include <QEvent>
 #include "qIGTLIOClientWidget.h"
-#include "qIGTLIOLogicController.h"
 #include "cxPlusConnectWidget.h"
 #include "cxVisServices.h"
 
 namespace cx
 {
-OpenIGTLink3GuiExtenderService::OpenIGTLink3GuiExtenderService(ctkPluginContext *context, igtlioLogicPointer logic)
+
+namespace
+{
+/** Give the igtlio client widget the logic only while it is shown.
+ *
+ * The widget uses the logic from the main thread without locking, thus the
+ * NetworkHandler processes the logic in the main thread while it is shown.
+ */
+class ClientWidgetLogicAttacher : public QObject
+{
+public:
+	ClientWidgetLogicAttacher(qIGTLIOClientWidget* widget, NetworkHandlerPtr networkHandler) :
+		QObject(widget),
+		mWidget(widget),
+		mNetworkHandler(networkHandler),
+		mAttached(false)
+	{
+		mWidget->installEventFilter(this);
+	}
+	virtual ~ClientWidgetLogicAttacher()
+	{
+		if (mAttached)
+			mNetworkHandler->setMainThreadProcessing(false);
+	}
+
+protected:
+	virtual bool eventFilter(QObject* watched, QEvent* event)
+	{
+		if (event->type()==QEvent::Show)
+			this->attach();
+		if (event->type()==QEvent::Hide)
+			this->detach();
+		return QObject::eventFilter(watched, event);
+	}
+
+private:
+	void attach()
+	{
+		if (mAttached)
+			return;
+		mAttached = true;
+		mNetworkHandler->setMainThreadProcessing(true);
+		mWidget->setLogic(mNetworkHandler->getLogic());
+	}
+	void detach()
+	{
+		if (!mAttached)
+			return;
+		mAttached = false;
+		mWidget->setLogic(igtlioLogicPointer());
+		mNetworkHandler->setMainThreadProcessing(false);
+	}
+
+	qIGTLIOClientWidget* mWidget;
+	NetworkHandlerPtr mNetworkHandler;
+	bool mAttached;
+};
+} // namespace
+
+OpenIGTLink3GuiExtenderService::OpenIGTLink3GuiExtenderService(ctkPluginContext *context, NetworkHandlerPtr networkHandler)
 {
 	mContext = context;
-	mLogic = logic;
+	mNetworkHandler = networkHandler;
 
 }
 
@@ -31,13 +90,11 @@ OpenIGTLink3GuiExtenderService::~OpenIGTLink3GuiExtenderService()
 
 std::vector<GUIExtenderService::CategorizedWidget> OpenIGTLink3GuiExtenderService::createWidgets() const
 {
-	qIGTLIOLogicController* logicController = new qIGTLIOLogicController();
-	logicController->setLogic(mLogic);
-
+	// No qIGTLIOLogicController: its timer would process the logic concurrently with the NetworkHandler.
 	qIGTLIOClientWidget* widget = new qIGTLIOClientWidget();
 	widget->setWindowTitle("OpenIGTLink3");
 	widget->setObjectName("Object_OpenIGTLink_3");
-	widget->setLogic(mLogic);
+	new ClientWidgetLogicAttacher(widget, mNetworkHandler);
 
 	std::vector<CategorizedWidget> retval;
 	retval.push_back(GUIExtenderService::CategorizedWidget( widget, "OpenIGTLink"));
@@ -17,7 +17,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxGUIExtenderService.h"
 class ctkPluginContext;
 
-#include "igtlioLogic.h"
+#include "cxNetworkHandler.h"
 
 namespace cx
 {
@@ -31,7 +31,7 @@ class NetworkConnection;
 class org_custusx_core_openigtlink3_EXPORT OpenIGTLink3GuiExtenderService : public GUIExtenderService
 {
 public:
-	OpenIGTLink3GuiExtenderService(ctkPluginContext* context, igtlioLogicPointer logic);
+	OpenIGTLink3GuiExtenderService(ctkPluginContext* context, NetworkHandlerPtr networkHandler);
     virtual ~OpenIGTLink3GuiExtenderService();
 
     std::vector<CategorizedWidget> createWidgets() const;
@@ -41,7 +41,7 @@ private:
 //	NetworkConnectionHandlePtr mClient;
 	ctkPluginContext* mContext;
     //NetworkDataTransferPtr mDataTransfer;
-	igtlioLogicPointer mLogic;
+	NetworkHandlerPtr mNetworkHandler;
 };
 typedef boost::shared_ptr<OpenIGTLink3GuiExtenderService> OpenIGTLink3GuiExtenderServicePtr;
 
@@ -11,57 +11,63 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxNetworkHandler.h"
 
+#include <algorithm>
+#include <QMutexLocker>
 #include <QTimer>
 
 #include "igtlioLogic.h"
-#include "igtlioImageDevice.h"
-#include "igtlioTransformDevice.h"
-#include "igtlioStatusDevice.h"
-#include "igtlioStringDevice.h"
-
 #include "igtlioConnector.h"
 
-#include "igtlioImageConverter.h"
-#include "igtlioTransformConverter.h"
-#include "igtlioCommandConverter.h"
-#include "igtlioStatusConverter.h"
-#include "igtlioStringConverter.h"
-#include "igtlioUsSectorDefinitions.h"
-
+#include "cxNetworkReceiveThread.h"
 #include "cxLogger.h"
 
 namespace cx
 {
 
+void NetworkDeviceStatistics::add(double latency, double decodeTime)
+{
+	++count;
+	totalLatency += latency;
+	maxLatency = std::max(maxLatency, latency);
+	totalDecodeTime += decodeTime;
+}
+
 NetworkHandler::NetworkHandler(igtlioLogicPointer logic) :
 	mTimer(new QTimer(this)),
-	mProbeDefinitionFromStringMessages(ProbeDefinitionFromStringMessagesPtr(new ProbeDefinitionFromStringMessages))
+	mMainThreadProcessing(0)
 {
 	qRegisterMetaType<Transform3D>("Transform3D");
 	qRegisterMetaType<ImagePtr>("ImagePtr");
+	qRegisterMetaType<ProbeDefinitionPtr>("ProbeDefinitionPtr");
 
 	mLogic = logic;
 
 	this->connectToConnectionEvents();
-	this->connectToDeviceEvents();
+
+	mReceiveThread.reset(new NetworkReceiveThread(mLogic));
+	connect(mReceiveThread.get(), &NetworkReceiveThread::received, this, &NetworkHandler::onReceived, Qt::QueuedConnection);
+	connect(mReceiveThread.get(), &NetworkReceiveThread::string_message, this, &NetworkHandler::string_message, Qt::QueuedConnection);
+	mReceiveThread->start();
 
 	connect(mTimer, SIGNAL(timeout()), this, SLOT(periodicProcess()));
-	mTimer->start(5);
 }
 
 NetworkHandler::~NetworkHandler()
 {
-	mTimer->stop();
+	mReceiveThread->stop();
 }
 
 igtlioSessionPointer NetworkHandler::requestConnectToServer(std::string serverHost, int serverPort, IGTLIO_SYNCHRONIZATION_TYPE sync, double timeout_s)
 {
+	QMutexLocker sentry(mReceiveThread->getLogicMutex());
 	mSession = mLogic->ConnectToServer(serverHost, serverPort, sync, timeout_s);
+	mReceiveThread->wakeUp();
 	return mSession;
 }
 
 void NetworkHandler::disconnectFromServer()
 {
+	QMutexLocker sentry(mReceiveThread->getLogicMutex());
 	if (mSession->GetConnector() && mSession->GetConnector()->GetState()!=igtlioConnector::STATE_OFF)
 	{
 		CX_LOG_DEBUG() << "NetworkHandler: Disconnecting from server" << mSession->GetConnector()->GetName();
@@ -69,147 +75,93 @@ void NetworkHandler::disconnectFromServer()
 		connector->Stop();
 		mLogic->RemoveConnector(connector);
 	}
-	mProbeDefinitionFromStringMessages->reset();
+	mReceiveThread->resetProbeDefinition();
+	sentry.unlock();
+
+	this->reportStatistics();
+	mStatistics.clear();
 }
 
-void NetworkHandler::onDeviceReceived(vtkObject* caller_device, void* unknown, unsigned long event , void*)
+QMutex* NetworkHandler::getLogicMutex()
 {
-	Q_UNUSED(unknown);
-	Q_UNUSED(event);
-	vtkSmartPointer<igtlioDevice> receivedDevice(reinterpret_cast<igtlioDevice*>(caller_device));
-
-	igtlioBaseConverter::HeaderData header = receivedDevice->GetHeader();
-	std::string device_type = receivedDevice->GetDeviceType();
-
-//	CX_LOG_DEBUG() << "Device is modified, device type: " << device_type << " on device: " << receivedDevice->GetDeviceName() << " equipmentId: " << header.equipmentId;
-
-	// Currently the only id available is the Device name defined in Plus xml. Looking like this: Probe_sToReference_s
-	// Use this for all message types for now, instead of equipmentId.
-	// Anser integration may send equipmentId, so this is checked for when we get a transform.
-	QString deviceName(receivedDevice->GetDeviceName().c_str());
+	return mReceiveThread->getLogicMutex();
+}
 
-	if(device_type == igtlioImageConverter::GetIGTLTypeName())
+void NetworkHandler::setMainThreadProcessing(bool on)
+{
+	if (on)
 	{
-		igtlioImageDevicePointer imageDevice = igtlioImageDevice::SafeDownCast(receivedDevice);
-
-		igtlioImageConverter::ContentData content = imageDevice->GetContent();
-
-//		QString deviceName(header.deviceName.c_str());
-//		QString deviceName(header.equipmentId.c_str());//Use equipmentId
-		ImagePtr cximage = ImagePtr(new Image(deviceName, content.image));
-		// get timestamp from igtl second-format:;
-		double timestampMS = header.timestamp * 1000;
-		cximage->setAcquisitionTime( QDateTime::fromMSecsSinceEpoch(qint64(timestampMS)));
-		//this->decode_rMd(msg, retval);
-
-
-		//Use the igtlio meta data from the image message
-		std::string metaLabel;
-		std::string metaDataValue;
-		QStringList igtlioLabels;
-
-		igtlioLabels << IGTLIO_KEY_PROBE_TYPE;
-		igtlioLabels << IGTLIO_KEY_ORIGIN;
-		igtlioLabels << IGTLIO_KEY_ANGLES;
-		igtlioLabels << IGTLIO_KEY_BOUNDING_BOX;
-		igtlioLabels << IGTLIO_KEY_DEPTHS;
-		igtlioLabels << IGTLIO_KEY_LINEAR_WIDTH;
-		igtlioLabels << IGTLIO_KEY_SPACING_X;
-		igtlioLabels << IGTLIO_KEY_SPACING_Y;
-		//TODO: Use deciveNameLong when this is defined in IGTLIO and sent with Plus
-
-
-		for (int i = 0; i < igtlioLabels.size(); ++i)
+		if (!mMainThreadProcessing++)
 		{
-			metaLabel = igtlioLabels[i].toStdString();
-			bool gotMetaData = receivedDevice->GetMetaDataElement(metaLabel, metaDataValue);
-			if(!gotMetaData)
-				CX_LOG_WARNING() << "Cannot get needed igtlio meta information: " << metaLabel;
-			else
-				mProbeDefinitionFromStringMessages->parseValue(metaLabel.c_str(), metaDataValue.c_str());
+			mReceiveThread->pause();
+			mTimer->start(5);
 		}
-
-
-		mProbeDefinitionFromStringMessages->setImage(cximage);
-
-		if (mProbeDefinitionFromStringMessages->haveValidValues() && mProbeDefinitionFromStringMessages->haveChanged())
-		{
-			//TODO: Use deciveNameLong
-			emit probedefinition(deviceName, mProbeDefinitionFromStringMessages->createProbeDefintion(deviceName));
-		}
-
-		emit image(cximage);
-
-		// CX-366: Currenly we don't use the transform from the image message, because there is no specification of what this transform should be.
-		// Only the transforms from the transform messages are used.
-//		double timestamp = header.timestamp;
-//		Transform3D cxtransform = Transform3D::fromVtkMatrix(content.transform);
-//		emit transform(deviceName, cxtransform, timestamp);
 	}
-	else if(device_type == igtlioTransformConverter::GetIGTLTypeName())
+	else if (mMainThreadProcessing && !--mMainThreadProcessing)
 	{
-		igtlioTransformDevicePointer transformDevice = igtlioTransformDevice::SafeDownCast(receivedDevice);
-		igtlioTransformConverter::ContentData content = transformDevice->GetContent();
-
-//		QString deviceName(content.deviceName.c_str());
-//		QString deviceName(header.equipmentId.c_str());//Use equipmentId
-		//QString streamIdTo(content.streamIdTo.c_str());
-		//QString streamIdFrom(content.streamIdFrom.c_str());
-		Transform3D cxtransform = Transform3D::fromVtkMatrix(content.transform);
+		mTimer->stop();
+		mReceiveThread->resume();
+	}
+}
 
-//		CX_LOG_DEBUG() << "TRANSFORM: "	<< " equipmentId: " << header.equipmentId
-//										<< " streamIdTo: " << content.streamIdTo
-//										<< " streamIdFrom: " << content.streamIdFrom
-//										<< " deviceName: " << deviceName
-//										<< " transform: " << cxtransform;
+void NetworkHandler::periodicProcess()
+{
+	mReceiveThread->process();
+}
 
-		double timestamp = header.timestamp;
-//		emit transform(deviceName, header.equipmentType, cxtransform, timestamp);
-		//test: Set all messages as type TRACKED_US_PROBE for now
-//		emit transform(deviceName, igtlioBaseConverter::TRACKED_US_PROBE, cxtransform, timestamp);
+quint64 NetworkHandler::getDroppedCount() const
+{
+	return mReceiveThread->getDroppedImageCount();
+}
 
-		// Try to use equipmentId from OpenIGTLink meta data. If not presnet use deviceName.
-		// Having equipmentId in OpenIGTLink meta data is something we would like to have a part of the OpenIGTLinkIO standard,
-		// and added to the messages from Plus.
-		std::string openigtlinktransformid;
-		bool gotTransformId = receivedDevice->GetMetaDataElement("equipmentId", openigtlinktransformid);
+void NetworkHandler::onReceived()
+{
+	// rearm before emptying the queues: items added during this call will signal again.
+	mReceiveThread->clearReceivedPending();
 
-		if (gotTransformId)
-			emit transform(qstring_cast(openigtlinktransformid), cxtransform, timestamp);
-		else
-			emit transform(deviceName, cxtransform, timestamp);
-	}
-	else if(device_type == igtlioStatusConverter::GetIGTLTypeName())
+	// transforms first: they are cheap, and tracking is the most latency sensitive.
+	ReceivedTransform transformMessage;
+	while (mReceiveThread->popTransform(&transformMessage))
 	{
-		igtlioStatusDevicePointer status = igtlioStatusDevice::SafeDownCast(receivedDevice);
-
-		igtlioStatusConverter::ContentData content = status->GetContent();
-
-		CX_LOG_DEBUG() << "STATUS: "	<< " code: " << content.code
-										<< " subcode: " << content.subcode
-										<< " errorname: " << content.errorname
-										<< " statusstring: " << content.statusstring;
-
+		double latency = double(mReceiveThread->getTime() - transformMessage.receiveTime) / 1.0E6;
+		mStatistics[transformMessage.deviceName].add(latency, transformMessage.decodeTime);
+		emit transform(transformMessage.deviceName, transformMessage.transform, transformMessage.timestamp);
 	}
-	else if(device_type == igtlioStringConverter::GetIGTLTypeName())
-	{
-		igtlioStringDevicePointer string = igtlioStringDevice::SafeDownCast(receivedDevice);
 
-		igtlioStringConverter::ContentData content = string->GetContent();
+	ReceivedImage imageMessage;
+	while (mReceiveThread->popImage(&imageMessage))
+	{
+		this->emitProbeDefinitions();
+		double latency = double(mReceiveThread->getTime() - imageMessage.receiveTime) / 1.0E6;
+		mStatistics[imageMessage.deviceName].add(latency, imageMessage.decodeTime);
+		emit image(imageMessage.image);
+	}
+	this->emitProbeDefinitions(); // in case the image was dropped
+}
 
-//		CX_LOG_DEBUG() << "STRING: "	<< " equipmentId: " << header.equipmentId
-//										<< " encoding: " << content.encoding
-//										<< " string: " << content.string_msg;
+void NetworkHandler::emitProbeDefinitions()
+{
+	std::map<QString, ProbeDefinitionPtr> definitions = mReceiveThread->takeProbeDefinitions();
+	std::map<QString, ProbeDefinitionPtr>::iterator iter;
+	for (iter = definitions.begin(); iter != definitions.end(); ++iter)
+		emit probedefinition(iter->first, iter->second);
+}
 
-		QString message(content.string_msg.c_str());
-//		mProbeDefinitionFromStringMessages->parseStringMessage(header, message);//Turning this off because we want to use meta info instead
-		emit string_message(message);
-	}
-	else
+void NetworkHandler::reportStatistics()
+{
+	std::map<QString, NetworkDeviceStatistics>::iterator iter;
+	for (iter = mStatistics.begin(); iter != mStatistics.end(); ++iter)
 	{
-		CX_LOG_WARNING() << "Found unhandled devicetype: " << device_type;
+		NetworkDeviceStatistics stats = iter->second;
+		CX_LOG_DEBUG() << QString("NetworkHandler: [%1] received %2, latency mean=%3ms max=%4ms, decode mean=%5ms")
+						  .arg(iter->first)
+						  .arg(stats.count)
+						  .arg(stats.getMeanLatency(), 0, 'f', 2)
+						  .arg(stats.maxLatency, 0, 'f', 2)
+						  .arg(stats.getMeanDecodeTime(), 0, 'f', 2);
 	}
-
+	if (this->getDroppedCount())
+		CX_LOG_WARNING() << "NetworkHandler: dropped " << this->getDroppedCount() << " images";
 }
 
 void NetworkHandler::onConnectionEvent(vtkObject* caller, void* connector, unsigned long event , void*)
@@ -226,30 +178,6 @@ void NetworkHandler::onConnectionEvent(vtkObject* caller, void* connector, unsig
 	}
 }
 
-void NetworkHandler::onDeviceAddedOrRemoved(vtkObject* caller, void* void_device, unsigned long event, void* callData)
-{
-	Q_UNUSED(caller);
-	Q_UNUSED(callData);
-	if (event==igtlioLogic::NewDeviceEvent)
-	{
-		igtlioDevicePointer device(reinterpret_cast<igtlioDevice*>(void_device));
-		if(device)
-		{
-			CX_LOG_DEBUG() << " NetworkHandler is listening to " << device->GetDeviceName();
-			qvtkReconnect(NULL, device, igtlioDevice::ReceiveEvent, this, SLOT(onDeviceReceived(vtkObject*, void*, unsigned long, void*)));
-		}
-	}
-	if (event==igtlioLogic::RemovedDeviceEvent)
-	{
-		CX_LOG_WARNING() << "TODO: on remove device event, not implemented";
-	}
-}
-
-void NetworkHandler::periodicProcess()
-{
-	mLogic->PeriodicProcess();
-}
-
 void NetworkHandler::connectToConnectionEvents()
 {
 	foreach(int eventId, QList<int>()
@@ -262,16 +190,4 @@ void NetworkHandler::connectToConnectionEvents()
 	}
 }
 
-void NetworkHandler::connectToDeviceEvents()
-{
-	foreach(int eventId, QList<int>()
-			<< igtlioLogic::NewDeviceEvent
-			<< igtlioLogic::RemovedDeviceEvent
-			)
-	{
-		qvtkReconnect(NULL, mLogic, eventId,
-					this, SLOT(onDeviceAddedOrRemoved(vtkObject*, void*, unsigned long, void*)));
-	}
-}
-
 } // namespace cx
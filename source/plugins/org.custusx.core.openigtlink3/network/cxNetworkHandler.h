@@ -20,14 +20,43 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxImage.h"
 #include "cxMesh.h"
 #include "cxProbeDefinitionFromStringMessages.h"
+#include <map>
 
 #include "ctkVTKObject.h"
 
+class QTimer;
+class QMutex;
+
 namespace cx
 {
 
 typedef boost::shared_ptr<class NetworkHandler> NetworkHandlerPtr;
+typedef boost::shared_ptr<class NetworkReceiveThread> NetworkReceiveThreadPtr;
+
+/** Statistics for the messages from one OpenIGTLink device. */
+struct NetworkDeviceStatistics
+{
+	NetworkDeviceStatistics() : count(0), totalLatency(0), maxLatency(0), totalDecodeTime(0) {}
+	void add(double latency, double decodeTime);
+	double getMeanLatency() const { return count ? totalLatency/count : 0; }
+	double getMeanDecodeTime() const { return count ? totalDecodeTime/count : 0; }
+
+	unsigned count; ///< messages emitted in the main thread
+	double totalLatency; ///< ms from queued in the receive thread to emitted in the main thread
+	double maxLatency;
+	double totalDecodeTime; ///< ms spent converting in the receive thread
+};
 
+/** \brief Connection to an OpenIGTLink server.
+ *
+ * Messages are received and decoded in a NetworkReceiveThread, and emitted
+ * from the main thread. Per device statistics are kept for received
+ * images and transforms, and reported on disconnect.
+ *
+ * Other users of the logic must hold getLogicMutex(), or call
+ * setMainThreadProcessing(true) if they use it from the main thread
+ * without locking, such as the igtlio GUI widgets.
+ */
 class org_custusx_core_openigtlink3_EXPORT NetworkHandler : public QObject
 {
 	Q_OBJECT
@@ -40,6 +69,16 @@ public:
 	igtlioSessionPointer requestConnectToServer(std::string serverHost, int serverPort=-1, IGTLIO_SYNCHRONIZATION_TYPE sync=IGTLIO_BLOCKING, double timeout_s=5);
 	void disconnectFromServer();
 
+	igtlioLogicPointer getLogic() { return mLogic; }
+	QMutex* getLogicMutex();
+	/** Process the logic in the main thread instead of the receive thread,
+	 *  until called with false the same number of times.
+	 */
+	void setMainThreadProcessing(bool on);
+
+	std::map<QString, NetworkDeviceStatistics> getStatistics() const { return mStatistics; }
+	quint64 getDroppedCount() const; ///< images dropped because the main thread lags behind. Transforms are never dropped.
+
 signals:
 	void connected();
 	void disconnected();
@@ -54,18 +93,20 @@ signals:
 
 private slots:
 	void onConnectionEvent(vtkObject* caller, void* connector, unsigned long event, void*);
-	void onDeviceAddedOrRemoved(vtkObject* caller, void* connector, unsigned long event, void*callData);
-	void onDeviceReceived(vtkObject * caller_device, void * unknown, unsigned long event, void *);
+	void onReceived();
 	void periodicProcess();
 
 private:
 	void connectToConnectionEvents();
-	void connectToDeviceEvents();
+	void emitProbeDefinitions();
+	void reportStatistics();
 
 	igtlioLogicPointer mLogic;
 	igtlioSessionPointer mSession;
-	QTimer *mTimer;
-	ProbeDefinitionFromStringMessagesPtr mProbeDefinitionFromStringMessages;
+	NetworkReceiveThreadPtr mReceiveThread;
+	QTimer* mTimer; ///< processes the logic during main thread processing
+	int mMainThreadProcessing;
+	std::map<QString, NetworkDeviceStatistics> mStatistics;
 };
 
 } // namespace cx
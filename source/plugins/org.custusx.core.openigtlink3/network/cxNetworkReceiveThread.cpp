@@ -0,0 +1,380 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxNetworkReceiveThread.h"
+
+#include <algorithm>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <vtkImageData.h>
+
+#include "igtlioConnector.h"
+#include "igtlioImageDevice.h"
+#include "igtlioTransformDevice.h"
+#include "igtlioStatusDevice.h"
+#include "igtlioStringDevice.h"
+
+#include "igtlioImageConverter.h"
+#include "igtlioTransformConverter.h"
+#include "igtlioStatusConverter.h"
+#include "igtlioStringConverter.h"
+#include "igtlioUsSectorDefinitions.h"
+
+#include "cxLogger.h"
+#include "cxTypeConversions.h"
+
+namespace cx
+{
+
+NetworkReceiveThread::NetworkReceiveThread(igtlioLogicPointer logic, QObject* parent) :
+	QThread(parent),
+	mLogic(logic),
+	mLogicMutex(QMutex::Recursive), // connection signals are emitted while locked
+	mStop(false),
+	mActive(false),
+	mPaused(0),
+	mReceivedInPass(0),
+	mProbeDefinitionFromStringMessages(ProbeDefinitionFromStringMessagesPtr(new ProbeDefinitionFromStringMessages)),
+	mImageQueue(8),
+	mReceivedPending(0)
+{
+	this->setObjectName("org.custusx.core.openigtlink3.receive"); // becomes the thread name
+	mClock.start();
+	this->connectToDeviceEvents();
+}
+
+NetworkReceiveThread::~NetworkReceiveThread()
+{
+	this->stop();
+}
+
+void NetworkReceiveThread::stop()
+{
+	{
+		QMutexLocker sentry(&mStateMutex);
+		mStop = true;
+		mWakeUp.wakeAll();
+	}
+	this->wait();
+}
+
+void NetworkReceiveThread::wakeUp()
+{
+	QMutexLocker sentry(&mStateMutex);
+	mActive = true;
+	mWakeUp.wakeAll();
+}
+
+void NetworkReceiveThread::pause()
+{
+	{
+		QMutexLocker sentry(&mStateMutex);
+		++mPaused;
+	}
+	// wait for the current pass: the thread checks the state before each pass.
+	QMutexLocker sentry(&mLogicMutex);
+}
+
+void NetworkReceiveThread::resume()
+{
+	{
+		QMutexLocker sentry(&mStateMutex);
+		mPaused = std::max(mPaused-1, 0);
+	}
+	this->wakeUp();
+}
+
+int NetworkReceiveThread::process()
+{
+	QMutexLocker sentry(&mLogicMutex);
+	mReceivedInPass = 0;
+	mLogic->PeriodicProcess();
+	return mReceivedInPass;
+}
+
+void NetworkReceiveThread::run()
+{
+	const qint64 idleTimeout = qint64(1000)*1000*1000; // ns without messages before backing off
+	qint64 lastReceived = this->getTime();
+	while (this->waitUntilActive())
+	{
+		QMutexLocker sentry(&mLogicMutex);
+		if (!this->isRunnable())
+			continue; // paused while waiting for the lock
+
+		// one more pass after the last connector closed, to emit its pending events.
+		bool open = this->hasOpenConnector();
+		int received = this->process();
+		if (!open)
+		{
+			QMutexLocker stateSentry(&mStateMutex);
+			mActive = false;
+		}
+		sentry.unlock();
+
+		// igtlio reads the sockets in its own threads and gives no notification
+		// when data are available: Process again at once while data arrive,
+		// and poll less often when the connection has been idle for a while.
+		if (received)
+			lastReceived = this->getTime();
+		else if (this->getTime() - lastReceived < idleTimeout)
+			QThread::msleep(1);
+		else
+			QThread::msleep(10);
+	}
+}
+
+bool NetworkReceiveThread::waitUntilActive()
+{
+	QMutexLocker sentry(&mStateMutex);
+	while (!mStop && (!mActive || mPaused))
+		mWakeUp.wait(&mStateMutex);
+	return !mStop;
+}
+
+bool NetworkReceiveThread::isRunnable()
+{
+	QMutexLocker sentry(&mStateMutex);
+	return !mStop && mActive && !mPaused;
+}
+
+bool NetworkReceiveThread::hasOpenConnector() const
+{
+	for (unsigned i=0; i<mLogic->GetNumberOfConnectors(); ++i)
+		if (mLogic->GetConnector(i)->GetState() != igtlioConnector::STATE_OFF)
+			return true;
+	return false;
+}
+
+void NetworkReceiveThread::resetProbeDefinition()
+{
+	mProbeDefinitionFromStringMessages->reset();
+}
+
+bool NetworkReceiveThread::popImage(ReceivedImage* value)
+{
+	return mImageQueue.pop(value);
+}
+
+bool NetworkReceiveThread::popTransform(ReceivedTransform* value)
+{
+	QMutexLocker sentry(&mTransformMutex);
+	if (mTransformQueue.empty())
+		return false;
+	*value = mTransformQueue.front();
+	mTransformQueue.pop_front();
+	return true;
+}
+
+std::map<QString, ProbeDefinitionPtr> NetworkReceiveThread::takeProbeDefinitions()
+{
+	QMutexLocker sentry(&mProbeDefinitionMutex);
+	std::map<QString, ProbeDefinitionPtr> retval;
+	retval.swap(mChangedProbeDefinitions);
+	return retval;
+}
+
+void NetworkReceiveThread::clearReceivedPending()
+{
+	mReceivedPending.storeRelease(0);
+}
+
+quint64 NetworkReceiveThread::getDroppedImageCount() const
+{
+	return mImageQueue.getDroppedCount();
+}
+
+void NetworkReceiveThread::notifyReceived()
+{
+	// signal only if the consumer is not already notified: avoids flooding the event queue.
+	if (mReceivedPending.testAndSetOrdered(0, 1))
+		emit received();
+}
+
+double NetworkReceiveThread::getMilliSecondsSince(qint64 startTime) const
+{
+	return double(this->getTime() - startTime) / 1.0E6;
+}
+
+void NetworkReceiveThread::onDeviceReceived(vtkObject* caller_device, void* unknown, unsigned long event , void*)
+{
+	Q_UNUSED(unknown);
+	Q_UNUSED(event);
+	qint64 startTime = this->getTime();
+	++mReceivedInPass;
+	vtkSmartPointer<igtlioDevice> receivedDevice(reinterpret_cast<igtlioDevice*>(caller_device));
+
+	std::string device_type = receivedDevice->GetDeviceType();
+
+	// Currently the only id available is the Device name defined in Plus xml. Looking like this: Probe_sToReference_s
+	// Use this for all message types for now, instead of equipmentId.
+	// Anser integration may send equipmentId, so this is checked for when we get a transform.
+	QString deviceName(receivedDevice->GetDeviceName().c_str());
+
+	if(device_type == igtlioImageConverter::GetIGTLTypeName())
+	{
+		this->receiveImage(receivedDevice, deviceName, startTime);
+	}
+	else if(device_type == igtlioTransformConverter::GetIGTLTypeName())
+	{
+		this->receiveTransform(receivedDevice, deviceName, startTime);
+	}
+	else if(device_type == igtlioStatusConverter::GetIGTLTypeName())
+	{
+		igtlioStatusDevicePointer status = igtlioStatusDevice::SafeDownCast(receivedDevice);
+
+		igtlioStatusConverter::ContentData content = status->GetContent();
+
+		CX_LOG_DEBUG() << "STATUS: "	<< " code: " << content.code
+										<< " subcode: " << content.subcode
+										<< " errorname: " << content.errorname
+										<< " statusstring: " << content.statusstring;
+
+	}
+	else if(device_type == igtlioStringConverter::GetIGTLTypeName())
+	{
+		igtlioStringDevicePointer string = igtlioStringDevice::SafeDownCast(receivedDevice);
+
+		igtlioStringConverter::ContentData content = string->GetContent();
+
+		QString message(content.string_msg.c_str());
+//		mProbeDefinitionFromStringMessages->parseStringMessage(header, message);//Turning this off because we want to use meta info instead
+		emit string_message(message);
+	}
+	else
+	{
+		CX_LOG_WARNING() << "Found unhandled devicetype: " << device_type;
+	}
+}
+
+void NetworkReceiveThread::receiveImage(igtlioDevicePointer receivedDevice, QString deviceName, qint64 startTime)
+{
+	igtlioImageDevicePointer imageDevice = igtlioImageDevice::SafeDownCast(receivedDevice);
+	igtlioBaseConverter::HeaderData header = receivedDevice->GetHeader();
+	igtlioImageConverter::ContentData content = imageDevice->GetContent();
+
+	// igtlio decodes the next message into the same vtkImageData.
+	vtkImageDataPtr imageData = vtkImageDataPtr::New();
+	imageData->DeepCopy(content.image);
+
+	ImagePtr cximage = ImagePtr(new Image(deviceName, imageData));
+	// get timestamp from igtl second-format:;
+	double timestampMS = header.timestamp * 1000;
+	cximage->setAcquisitionTime( QDateTime::fromMSecsSinceEpoch(qint64(timestampMS)));
+	cximage->moveThisAndChildrenToThread(QCoreApplication::instance()->thread());
+
+	//Use the igtlio meta data from the image message
+	std::string metaLabel;
+	std::string metaDataValue;
+	QStringList igtlioLabels;
+
+	igtlioLabels << IGTLIO_KEY_PROBE_TYPE;
+	igtlioLabels << IGTLIO_KEY_ORIGIN;
+	igtlioLabels << IGTLIO_KEY_ANGLES;
+	igtlioLabels << IGTLIO_KEY_BOUNDING_BOX;
+	igtlioLabels << IGTLIO_KEY_DEPTHS;
+	igtlioLabels << IGTLIO_KEY_LINEAR_WIDTH;
+	igtlioLabels << IGTLIO_KEY_SPACING_X;
+	igtlioLabels << IGTLIO_KEY_SPACING_Y;
+	//TODO: Use deciveNameLong when this is defined in IGTLIO and sent with Plus
+
+	for (int i = 0; i < igtlioLabels.size(); ++i)
+	{
+		metaLabel = igtlioLabels[i].toStdString();
+		bool gotMetaData = receivedDevice->GetMetaDataElement(metaLabel, metaDataValue);
+		if(!gotMetaData)
+			CX_LOG_WARNING() << "Cannot get needed igtlio meta information: " << metaLabel;
+		else
+			mProbeDefinitionFromStringMessages->parseValue(metaLabel.c_str(), metaDataValue.c_str());
+	}
+
+	mProbeDefinitionFromStringMessages->setImage(cximage);
+
+	if (mProbeDefinitionFromStringMessages->haveValidValues() && mProbeDefinitionFromStringMessages->haveChanged())
+	{
+		//TODO: Use deciveNameLong
+		QMutexLocker sentry(&mProbeDefinitionMutex);
+		mChangedProbeDefinitions[deviceName] = mProbeDefinitionFromStringMessages->createProbeDefintion(deviceName);
+	}
+
+	ReceivedImage received;
+	received.deviceName = deviceName;
+	received.image = cximage;
+	received.decodeTime = this->getMilliSecondsSince(startTime);
+	received.receiveTime = this->getTime();
+
+	mImageQueue.push(received);
+	this->notifyReceived();
+
+	// CX-366: Currenly we don't use the transform from the image message, because there is no specification of what this transform should be.
+	// Only the transforms from the transform messages are used.
+}
+
+void NetworkReceiveThread::receiveTransform(igtlioDevicePointer receivedDevice, QString deviceName, qint64 startTime)
+{
+	igtlioTransformDevicePointer transformDevice = igtlioTransformDevice::SafeDownCast(receivedDevice);
+	igtlioBaseConverter::HeaderData header = receivedDevice->GetHeader();
+	igtlioTransformConverter::ContentData content = transformDevice->GetContent();
+
+	ReceivedTransform received;
+	received.transform = Transform3D::fromVtkMatrix(content.transform);
+	received.timestamp = header.timestamp;
+
+	// Try to use equipmentId from OpenIGTLink meta data. If not presnet use deviceName.
+	// Having equipmentId in OpenIGTLink meta data is something we would like to have a part of the OpenIGTLinkIO standard,
+	// and added to the messages from Plus.
+	std::string openigtlinktransformid;
+	bool gotTransformId = receivedDevice->GetMetaDataElement("equipmentId", openigtlinktransformid);
+	received.deviceName = gotTransformId ? qstring_cast(openigtlinktransformid) : deviceName;
+
+	received.decodeTime = this->getMilliSecondsSince(startTime);
+	received.receiveTime = this->getTime();
+
+	{
+		QMutexLocker sentry(&mTransformMutex);
+		mTransformQueue.push_back(received);
+	}
+	this->notifyReceived();
+}
+
+void NetworkReceiveThread::onDeviceAddedOrRemoved(vtkObject* caller, void* void_device, unsigned long event, void* callData)
+{
+	Q_UNUSED(caller);
+	Q_UNUSED(callData);
+	if (event==igtlioLogic::NewDeviceEvent)
+	{
+		igtlioDevicePointer device(reinterpret_cast<igtlioDevice*>(void_device));
+		if(device)
+		{
+			CX_LOG_DEBUG() << " NetworkHandler is listening to " << device->GetDeviceName();
+			// direct: decode in the thread calling PeriodicProcess()
+			qvtkReconnect(NULL, device, igtlioDevice::ReceiveEvent, this, SLOT(onDeviceReceived(vtkObject*, void*, unsigned long, void*)), 0.0, Qt::DirectConnection);
+		}
+	}
+	if (event==igtlioLogic::RemovedDeviceEvent)
+	{
+		CX_LOG_WARNING() << "TODO: on remove device event, not implemented";
+	}
+}
+
+void NetworkReceiveThread::connectToDeviceEvents()
+{
+	foreach(int eventId, QList<int>()
+			<< igtlioLogic::NewDeviceEvent
+			<< igtlioLogic::RemovedDeviceEvent
+			)
+	{
+		qvtkReconnect(NULL, mLogic, eventId,
+					this, SLOT(onDeviceAddedOrRemoved(vtkObject*, void*, unsigned long, void*)), 0.0, Qt::DirectConnection);
+	}
+}
+
+} // namespace cx
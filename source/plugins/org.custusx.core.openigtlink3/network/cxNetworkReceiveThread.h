@@ -0,0 +1,153 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CX_NETWORKRECEIVETHREAD_H_
+#define CX_NETWORKRECEIVETHREAD_H_
+
+#include "org_custusx_core_openigtlink3_Export.h"
+#include "igtlioLogic.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <map>
+#include <deque>
+
+#include "cxTransform3D.h"
+#include "cxImage.h"
+#include "cxBoundedFrameQueue.h"
+#include "cxProbeDefinitionFromStringMessages.h"
+
+#include "ctkVTKObject.h"
+
+namespace cx
+{
+
+/** An image decoded by NetworkReceiveThread. */
+struct ReceivedImage
+{
+	ReceivedImage() : decodeTime(0), receiveTime(0) {}
+	QString deviceName;
+	ImagePtr image;
+	double decodeTime; ///< ms spent converting the message
+	qint64 receiveTime; ///< NetworkReceiveThread::getTime() when queued
+};
+
+/** A transform decoded by NetworkReceiveThread. */
+struct ReceivedTransform
+{
+	ReceivedTransform() : timestamp(0), decodeTime(0), receiveTime(0) {}
+	QString deviceName;
+	Transform3D transform;
+	double timestamp;
+	double decodeTime;
+	qint64 receiveTime;
+};
+
+/** \brief Process an igtlioLogic in a separate thread.
+ *
+ * The thread calls igtlioLogic::PeriodicProcess() in a loop, thus messages
+ * from the igtlio socket threads are decoded and converted here instead of
+ * in the main thread. igtlio gives no notification when data arrive, thus
+ * the loop polls: It runs again at once as long as messages are received,
+ * and sleeps 1 ms when idle, i.e. up to 1000 wakeups/s while streaming.
+ * After one second without messages it sleeps 10 ms between passes.
+ *
+ * The thread does not touch the logic until wakeUp() is called, and goes
+ * back to sleep when no connector is open. pause() stops the processing
+ * until resume(): The owner can then call process() from another thread.
+ *
+ * Images and transforms are queued. received() is emitted once when a queue
+ * becomes non-empty: Call clearReceivedPending(), then pop until the queues
+ * are empty. The image queue is bounded and drops the oldest image when full.
+ * The transform queue is unbounded, as each transform is a tracking sample
+ * that must be recorded.
+ * Changed probe definitions are never dropped: They are stored before the
+ * image they came with is queued, thus call takeProbeDefinitions() after
+ * popping an image.
+ *
+ * The logic is not threadsafe: Other threads must hold getLogicMutex()
+ * while using it. The mutex is recursive.
+ *
+ * \ingroup org_custusx_core_openigtlink3
+ * \date 2026-10-18
+ */
+class org_custusx_core_openigtlink3_EXPORT NetworkReceiveThread : public QThread
+{
+	Q_OBJECT
+	QVTK_OBJECT
+
+public:
+	explicit NetworkReceiveThread(igtlioLogicPointer logic, QObject* parent = NULL);
+	virtual ~NetworkReceiveThread();
+
+	void stop();
+	void wakeUp(); ///< start processing, call when a connector is opened. threadsafe
+	void pause(); ///< stop processing, returns when the current pass is done. threadsafe
+	void resume(); ///< undo pause(). threadsafe
+	int process(); ///< process the logic once, return number of received messages. threadsafe
+	QMutex* getLogicMutex() { return &mLogicMutex; }
+	void resetProbeDefinition(); ///< hold getLogicMutex() when calling
+
+	bool popImage(ReceivedImage* value); // threadsafe
+	bool popTransform(ReceivedTransform* value); // threadsafe
+	std::map<QString, ProbeDefinitionPtr> takeProbeDefinitions(); // threadsafe
+	void clearReceivedPending(); // threadsafe
+	quint64 getDroppedImageCount() const; // threadsafe
+	qint64 getTime() const { return mClock.nsecsElapsed(); } ///< ns, threadsafe
+
+signals:
+	void received();
+	void string_message(QString message);
+
+protected:
+	virtual void run();
+
+private slots:
+	void onDeviceAddedOrRemoved(vtkObject* caller, void* connector, unsigned long event, void* callData);
+	void onDeviceReceived(vtkObject* caller_device, void* unknown, unsigned long event, void*);
+
+private:
+	typedef BoundedFrameQueue<ReceivedImage> ImageQueue;
+
+	void connectToDeviceEvents();
+	bool waitUntilActive(); ///< return false when stopped
+	bool isRunnable();
+	bool hasOpenConnector() const;
+	void receiveImage(igtlioDevicePointer receivedDevice, QString deviceName, qint64 startTime);
+	void receiveTransform(igtlioDevicePointer receivedDevice, QString deviceName, qint64 startTime);
+	void notifyReceived();
+	double getMilliSecondsSince(qint64 startTime) const;
+
+	igtlioLogicPointer mLogic;
+	QMutex mLogicMutex;
+	QMutex mStateMutex; ///< protects the members below, used with mWakeUp
+	QWaitCondition mWakeUp;
+	bool mStop;
+	bool mActive; ///< a connector might be open
+	int mPaused; ///< number of pause() calls not yet resumed
+	QElapsedTimer mClock;
+	int mReceivedInPass; ///< devices received during the current PeriodicProcess()
+	ProbeDefinitionFromStringMessagesPtr mProbeDefinitionFromStringMessages;
+	QMutex mProbeDefinitionMutex; ///< protects mChangedProbeDefinitions
+	std::map<QString, ProbeDefinitionPtr> mChangedProbeDefinitions;
+
+	ImageQueue mImageQueue;
+	QMutex mTransformMutex; ///< protects mTransformQueue
+	std::deque<ReceivedTransform> mTransformQueue;
+	QAtomicInt mReceivedPending; ///< 1 if received() is emitted but not yet handled
+};
+
+} // namespace cx
+
+#endif /* CX_NETWORKRECEIVETHREAD_H_ */
@@ -11,6 +11,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "catch.hpp"
 
 #include <QEventLoop>
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <vtkMatrix4x4.h>
 #include "vtkTimerLog.h"
 #include "igtlioConnector.h"
 #include "igtlioDevice.h"
@@ -61,11 +64,12 @@ void tryToReceiveEvents(igtlioLogicPointer logic, Receiver &receiver)
 	Q_UNUSED(receiver);
 	igtlioConnectorPointer connector = logic->GetConnector(0);
 
+	// the logic is processed by the NetworkHandler thread, receive the queued signals here.
 	double timeout = 1;
 	double starttime = vtkTimerLog::GetUniversalTime();
 	while (vtkTimerLog::GetUniversalTime() - starttime < timeout)
 	{
-		logic->PeriodicProcess();
+		qApp->processEvents();
 	}
 }
 
@@ -210,4 +214,37 @@ TEST_CASE("Connect/disconnect using NetworkHandler, use default network port", "
 	REQUIRE_FALSE(client->GetConnector()->IsConnected());
 }
 
+TEST_CASE("NetworkHandler emits transforms received in the receive thread", "[plugins][org.custusx.core.openigtlink3][integration]")
+{
+	igtlioLogicPointer logic = igtlioLogicPointer::New();
+	igtlioSessionPointer server = logic->StartServer();
+	cx::NetworkHandlerPtr networkHandler= cx::NetworkHandlerPtr(new cx::NetworkHandler(logic));
+
+	igtlioSessionPointer client = networkHandler->requestConnectToServer("localhost");
+	REQUIRE(client);
+	REQUIRE(client->GetConnector()->IsConnected());
+
+	vtkSmartPointer<vtkMatrix4x4> matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+	matrix->SetElement(0, 3, 10);
+
+	// the server might not have accepted the connection yet: retry until received.
+	bool received = false;
+	for (int i=0; (i<20) && !received; ++i)
+	{
+		{
+			QMutexLocker sentry(networkHandler->getLogicMutex());
+			server->SendTransform("test_tool", matrix);
+		}
+		received = waitForQueuedSignal(networkHandler.get(), SIGNAL(transform(QString, Transform3D, double)), 100, true);
+	}
+	REQUIRE(received);
+
+	std::map<QString, cx::NetworkDeviceStatistics> statistics = networkHandler->getStatistics();
+	REQUIRE(statistics.count("test_tool"));
+	CHECK(statistics["test_tool"].count > 0);
+	CHECK(statistics["test_tool"].maxLatency >= statistics["test_tool"].getMeanLatency());
+
+	networkHandler->disconnectFromServer();
+}
+
 } //namespace cxtest
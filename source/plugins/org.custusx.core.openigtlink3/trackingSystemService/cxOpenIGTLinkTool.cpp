@@ -164,6 +164,7 @@ void OpenIGTLinkTool::toolTransformAndTimestampSlot(Transform3D prMs, double tim
 
     (*mPositionHistory)[mTimestamp] = prMt; // store original in history
     m_prMt = prMt_filtered;
+    this->incrementChangeCount();
     emit toolTransformAndTimestamp(m_prMt, mTimestamp);
 }
 
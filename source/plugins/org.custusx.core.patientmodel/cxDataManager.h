@@ -114,6 +114,7 @@ signals:
 	void clinicalApplicationChanged();
 	void streamLoaded();
 	void rMprChanged(); ///< emitted when the transformation between patient reference and (data) reference is set
+	void dataLoadProgress(int loaded, int total); ///< emitted for each data file read while loading a patient
 
 protected:
 	DataManager();
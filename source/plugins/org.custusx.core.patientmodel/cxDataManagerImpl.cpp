@@ -18,6 +18,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QFile>
 #include <QTextStream>
 #include <QDir>
+#include <QtConcurrentRun>
+#include <QFutureSynchronizer>
+#include <boost/bind.hpp>
 
 #include "cxTransform3D.h"
 #include "cxRegistrationTransform.h"
@@ -40,6 +43,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxActiveData.h"
 #include "cxFileManagerService.h"
 #include "cxEnumConversion.h"
+#include "cxTimeKeeper.h"
 
 
 namespace cx
@@ -362,19 +366,31 @@ void DataManagerImpl::parseXml(QDomNode& dataManagerNode, QString rootPath)
 	mPatientLandmarks->parseXml(patientLandmarksNode);
 
 	// All images must be created from the DataManager, so the image nodes are parsed here
-	std::map<DataPtr, QDomNode> datanodes;
-
+	std::vector<DataLoadJob> jobs;
+	std::map<QString, DataPtr> created;
 	QDomNode child = dataManagerNode.firstChild();
 	for (; !child.isNull(); child = child.nextSibling())
 	{
 		if (child.nodeName() == "data")
 		{
-			DataPtr data = this->loadData(child.toElement(), rootPath);
-			if (data)
-				datanodes[data] = child.toElement();
+			DataLoadJob job = this->createLoadJob(child.toElement(), rootPath, created);
+			if (!job.data)
+				continue;
+			created[job.data->getUid()] = job.data;
+			jobs.push_back(job);
 		}
 	}
 
+	this->readDataFiles(jobs);
+
+	std::map<DataPtr, QDomNode> datanodes;
+	for (unsigned i = 0; i < jobs.size(); ++i)
+	{
+		DataPtr data = this->completeLoad(jobs[i], rootPath);
+		if (data)
+			datanodes[data] = jobs[i].node;
+	}
+
 	// parse xml data separately: we want to first load all data
 	// because there might be interdependencies (cx::DistanceMetric)
 	for (std::map<DataPtr, QDomNode>::iterator iter = datanodes.begin(); iter != datanodes.end(); ++iter)
@@ -411,43 +427,140 @@ void DataManagerImpl::parseXml(QDomNode& dataManagerNode, QString rootPath)
 	}
 }
 
-DataPtr DataManagerImpl::loadData(QDomElement node, QString rootPath)
+/** Create the data object for a <data> node, without reading the file.
+ */
+DataManagerImpl::DataLoadJob DataManagerImpl::createLoadJob(QDomElement node, QString rootPath, const std::map<QString, DataPtr>& created)
 {
-	QString uid = node.toElement().attribute("uid");
-	QString name = node.toElement().attribute("name");
-	QString type = node.toElement().attribute("type");
+	DataLoadJob job;
+	job.node = node;
 
-	QDir relativePath = this->findRelativePath(node, rootPath);
-	QString absolutePath = this->findAbsolutePath(relativePath, rootPath);
+	QString uid = node.attribute("uid");
+	job.name = node.attribute("name");
+	QString type = node.attribute("type");
 
-	if (mData.count(uid)) // dont load same image twice
-		return mData[uid];
+	job.relativePath = this->findRelativePath(node, rootPath);
+	job.absolutePath = this->findAbsolutePath(job.relativePath, rootPath);
 
-	DataPtr data = mDataFactory->create(type, uid, name);
-	if (!data)
+	// dont load same image twice
+	if (mData.count(uid))
 	{
-		reportWarning(QString("Unknown type: %1 for file %2").arg(type).arg(absolutePath));
-		return DataPtr();
+		job.data = mData[uid];
+		return job;
+	}
+	std::map<QString, DataPtr>::const_iterator iter = created.find(uid);
+	if (iter != created.end())
+	{
+		job.data = iter->second;
+		return job;
 	}
-	bool loaded = data->load(absolutePath, mFileManagerService);
 
-	if (!loaded)
+	job.data = mDataFactory->create(type, uid, job.name);
+	if (!job.data)
 	{
-		reportWarning("Unknown file: " + absolutePath);
+		reportWarning(QString("Unknown type: %1 for file %2").arg(type).arg(job.absolutePath));
+		return job;
+	}
+	job.readFile = true;
+	return job;
+}
+
+/** Read the file into the data object. Called from a worker thread for images.
+ */
+void DataManagerImpl::readDataFile(DataLoadJob* job)
+{
+	job->loaded = job->data->load(job->absolutePath, mFileManagerService);
+
+	// compute range and histogram in the worker, not when the image is first shown
+	ImagePtr image = boost::dynamic_pointer_cast<Image>(job->data);
+	if (image && job->loaded)
+		image->getStatistics();
+
+	// objects created during load belong to the worker thread
+	if (image && (QThread::currentThread() != QCoreApplication::instance()->thread()))
+		image->moveThisAndChildrenToThread(QCoreApplication::instance()->thread());
+}
+
+void DataManagerImpl::readDataFileInWorker(DataLoadJob* job, QSemaphore* finished)
+{
+	this->readDataFile(job);
+	finished->release();
+}
+
+/** Read the files of all jobs.
+ *  Images are read and decoded concurrently in the global thread pool,
+ *  while the other data are read in this thread.
+ *
+ *  The patient is loaded synchronously in the main thread, thus QFutureWatcher
+ *  signals would require a nested event loop. Instead, each worker releases
+ *  a semaphore when done, and this thread blocks on it between progress reports.
+ */
+void DataManagerImpl::readDataFiles(std::vector<DataLoadJob>& jobs)
+{
+	TimeKeeper timer;
+	QSemaphore imagesFinished;
+	QFutureSynchronizer<void> images;
+	int total = 0;
+	for (unsigned i = 0; i < jobs.size(); ++i)
+	{
+		if (!jobs[i].readFile)
+			continue;
+		++total;
+		if (boost::dynamic_pointer_cast<Image>(jobs[i].data))
+			images.addFuture(QtConcurrent::run(boost::bind(&DataManagerImpl::readDataFileInWorker, this, &jobs[i], &imagesFinished)));
+	}
+
+	int loaded = 0;
+	emit dataLoadProgress(loaded, total);
+
+	for (unsigned i = 0; i < jobs.size(); ++i)
+	{
+		if (jobs[i].readFile && !boost::dynamic_pointer_cast<Image>(jobs[i].data))
+		{
+			this->readDataFile(&jobs[i]);
+			emit dataLoadProgress(++loaded, total);
+		}
+	}
+
+	// the images finish in any order: report each one as soon as it is done.
+	while (loaded < total)
+	{
+		imagesFinished.acquire();
+		emit dataLoadProgress(++loaded, total);
+	}
+	images.waitForFinished();
+
+	if (!images.futures().empty())
+		report(QString("Loaded %1 data, %2 images in parallel, in %3s")
+			   .arg(jobs.size())
+			   .arg(images.futures().size())
+			   .arg(timer.getElapsedSecondsAsString()));
+}
+
+/** Add the loaded data to the manager, in the order given in the xml.
+ */
+DataPtr DataManagerImpl::completeLoad(const DataLoadJob& job, QString rootPath)
+{
+	DataPtr data = job.data;
+	if (!job.readFile)
+		return data;
+
+	if (!job.loaded)
+	{
+		reportWarning("Unknown file: " + job.absolutePath);
 		return DataPtr();
 	}
 
-	if (!name.isEmpty())
-		data->setName(name);
-	data->setFilename(relativePath.path());
+	if (!job.name.isEmpty())
+		data->setName(job.name);
+	data->setFilename(job.relativePath.path());
 
 	this->loadData(data);
 
 	// conversion for change in format 2013-10-29
 	QString newPath = rootPath+"/"+data->getFilename();
-	if (QDir::cleanPath(absolutePath) != QDir::cleanPath(newPath))
+	if (QDir::cleanPath(job.absolutePath) != QDir::cleanPath(newPath))
 	{
-		reportWarning(QString("Detected old data format, converting from %1 to %2").arg(absolutePath).arg(newPath));
+		reportWarning(QString("Detected old data format, converting from %1 to %2").arg(job.absolutePath).arg(newPath));
 		data->save(rootPath, mFileManagerService);
 	}
 
@@ -20,6 +20,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <set>
 #include <string>
 #include <QMutex>
+#include <QSemaphore>
 #include <vector>
 #include "cxImage.h"
 #include "cxMesh.h"
@@ -112,7 +113,24 @@ protected:
 	CLINICAL_VIEW mClinicalApplication;
 	void deleteFiles(DataPtr data, QString basePath);
 
-	DataPtr loadData(QDomElement node, QString rootPath);
+	/** State for loading one <data> node, see parseXml().
+	 */
+	struct DataLoadJob
+	{
+		DataLoadJob() : readFile(false), loaded(false) {}
+		QDomElement node;
+		DataPtr data;
+		QDir relativePath;
+		QString absolutePath;
+		QString name;
+		bool readFile; ///< false if data already exists
+		bool loaded;
+	};
+	DataLoadJob createLoadJob(QDomElement node, QString rootPath, const std::map<QString, DataPtr>& created);
+	void readDataFile(DataLoadJob* job);
+	void readDataFileInWorker(DataLoadJob* job, QSemaphore* finished);
+	void readDataFiles(std::vector<DataLoadJob>& jobs);
+	DataPtr completeLoad(const DataLoadJob& job, QString rootPath);
 	int findUniqueUidNumber(QString uidBase) const;
 
 	void readClinicalView();
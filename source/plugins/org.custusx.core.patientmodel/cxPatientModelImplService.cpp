@@ -43,6 +43,7 @@ PatientModelImplService::PatientModelImplService(ctkPluginContext *context) :
 	connect(this->dataService().get(), &DataManager::rMprChanged, this, &PatientModelService::rMprChanged);
 	connect(this->dataService().get(), &DataManager::streamLoaded, this, &PatientModelService::streamLoaded);
 	connect(this->dataService().get(), &DataManager::clinicalApplicationChanged, this, &PatientModelService::clinicalApplicationChanged);
+	connect(this->dataService().get(), &DataManager::dataLoadProgress, this, &PatientModelService::dataLoadProgress);
 
 	connect(this->dataService().get(), &DataManager::centerChanged, this, &PatientModelService::centerChanged);
     connect(this->dataService().get(), &DataManager::operatingTableChanged, this, &PatientModelService::operatingTableChanged);
@@ -104,6 +105,7 @@ PatientModelImplService::~PatientModelImplService()
 		disconnect(this->dataService().get(), &DataManager::rMprChanged, this, &PatientModelService::rMprChanged);
 		disconnect(this->dataService().get(), &DataManager::streamLoaded, this, &PatientModelService::streamLoaded);
 		disconnect(this->dataService().get(), &DataManager::clinicalApplicationChanged, this, &PatientModelService::clinicalApplicationChanged);
+		disconnect(this->dataService().get(), &DataManager::dataLoadProgress, this, &PatientModelService::dataLoadProgress);
 
 		disconnect(this->patientData().get(), &PatientData::patientChanged, this, &PatientModelService::patientChanged);
 	}
@@ -117,6 +117,7 @@ Transform3D ToolUsingIGSTK::getCalibration_sMt() const
 void ToolUsingIGSTK::setCalibration_sMt(Transform3D calibration)
 {
 	mTool->updateCalibration(calibration);
+	this->incrementChangeCount();
 }
 
 QString ToolUsingIGSTK::getCalibrationFileName() const
@@ -179,6 +180,7 @@ void ToolUsingIGSTK::toolTransformAndTimestampSlot(Transform3D matrix, double ti
 	if (this->getVisible())
 		(*mPositionHistory)[timestamp] = matrix;
 	m_prMt = prMt_filtered;
+	this->incrementChangeCount();
 	emit toolTransformAndTimestamp(m_prMt, timestamp);
 
 //	ToolImpl::set_prMt(matrix, timestamp);
@@ -197,7 +199,7 @@ void ToolUsingIGSTK::calculateTpsSlot()
 
 	TimedTransformMap::reverse_iterator it = mPositionHistory->rbegin();
 	double lastTransform = it->first;
-	for (size_t i = 0; i < numberOfTransformsToCheck; ++i)
+	for (size_t i = 0; i < numberOfTransformsToCheck-1; ++i)
 		++it;
 	double firstTransform = it->first;
 	double secondsPassed = (lastTransform - firstTransform) / 1000;
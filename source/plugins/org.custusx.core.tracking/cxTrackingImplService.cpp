@@ -22,11 +22,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QFileInfo>
 #include <vtkDoubleArray.h>
 #include <QCoreApplication>
+#include <limits>
 
 #include "cxRegistrationTransform.h"
 #include "cxLogger.h"
 #include "cxTypeConversions.h"
 #include "cxPositionStorageFile.h"
+#include "cxPositionJournalWriter.h"
 #include "cxTime.h"
 #include "cxDummyTool.h"
 #include "cxToolImpl.h"
@@ -65,6 +67,11 @@ TrackingImplService::TrackingImplService(ctkPluginContext *context) :
 
 	connect(settings(), SIGNAL(valueChangedFor(QString)), this, SLOT(globalConfigurationFileChangedSlot(QString)));
 
+	// continously append new positions to file, writing is done in the journal thread.
+	mJournalTimer = new QTimer(this);
+	connect(mJournalTimer, SIGNAL(timeout()), this, SLOT(journalPositionsSlot()));
+	mJournalTimer->start(1000);
+
     this->listenForTrackingSystemServices(context);
 }
 
@@ -72,6 +79,7 @@ TrackingImplService::~TrackingImplService()
 {
 	while (!mTrackingSystems.empty())
 		this->unInstallTrackingSystem(mTrackingSystems.back());
+	mJournal.reset(); // writes remaining positions
 }
 
 
@@ -350,28 +358,68 @@ ToolPtr TrackingImplService::getReferenceTool() const
 	return mReferenceTool;
 }
 
-void TrackingImplService::savePositionHistory()
+QString TrackingImplService::getPositionHistoryFilename()
 {
-	QString filename = this->getLoggingFolder() + "/toolpositions.snwpos";
+	QString folder = this->getLoggingFolder();
+	if (folder.isEmpty())
+		return "";
+	return folder + "/toolpositions.snwpos";
+}
+
+PositionJournalWriterPtr TrackingImplService::getJournal()
+{
+	QString filename = this->getPositionHistoryFilename();
+	if (filename.isEmpty())
+		return PositionJournalWriterPtr();
+
+	if (!mJournal || (mJournal->getFilename() != filename))
+	{
+		mJournal.reset(); // complete writing to the previous file
+		mJournal.reset(new PositionJournalWriter(filename));
+	}
+	return mJournal;
+}
 
-	PositionStorageWriter writer(filename);
+/** Send all positions not yet journaled to the journal thread.
+ */
+void TrackingImplService::appendNewPositionsToJournal()
+{
+	PositionJournalWriterPtr journal = this->getJournal();
+	if (!journal)
+		return;
 
+	std::vector<PositionStorageEntry> entries;
 	ToolMap::iterator it = mTools.begin();
 	for (; it != mTools.end(); ++it)
 	{
 		ToolPtr current = it->second;
 		TimedTransformMapPtr data = current->getPositionHistory();
-
-		if (!data)
+		if (!data || data->empty())
 			continue;
 
-		// save only data acquired after mLastLoadPositionHistory:
-		TimedTransformMap::iterator iter = data->lower_bound(mLastLoadPositionHistory);
+		TimedTransformMap::iterator iter = data->begin();
+		std::map<QString, double>::iterator last = mJournaledUntil.find(current->getUid());
+		if (last != mJournaledUntil.end())
+			iter = data->upper_bound(last->second);
+
 		for (; iter != data->end(); ++iter)
-			writer.write(iter->second, (iter->first), current->getUid());
+			entries.push_back(PositionStorageEntry(current->getUid(), iter->first, iter->second));
+		mJournaledUntil[current->getUid()] = data->rbegin()->first;
 	}
 
-	mLastLoadPositionHistory = getMilliSecondsSinceEpoch();
+	journal->append(entries);
+}
+
+void TrackingImplService::journalPositionsSlot()
+{
+	this->appendNewPositionsToJournal();
+}
+
+void TrackingImplService::savePositionHistory()
+{
+	this->appendNewPositionsToJournal();
+	if (mJournal)
+		mJournal->flush();
 }
 
 void TrackingImplService::loadPositionHistory()
@@ -381,10 +429,17 @@ void TrackingImplService::loadPositionHistory()
 	// save all position data acquired so far, in case of multiple calls.
 	this->savePositionHistory();
 
-	QString filename = this->getLoggingFolder()+ "/toolpositions.snwpos";
+	QString filename = this->getPositionHistoryFilename();
+	if (filename.isEmpty())
+		return;
 
 	PositionStorageReader reader(filename);
 
+	// If the same tools already have loaded this file, all later blocks
+	// were journaled from memory: Read only the blocks after the last load.
+	if ((filename == mLastLoadPositionHistoryFile) && (mTools == mLastLoadPositionHistoryTools))
+		reader.setTimeWindow(mLastLoadPositionHistory, std::numeric_limits<double>::max());
+
 	Transform3D matrix = Transform3D::Identity();
 	double timestamp;
 	QString toolUid;
@@ -417,7 +472,17 @@ void TrackingImplService::loadPositionHistory()
 							  "\n  \t%1").arg(missingTools.join("\n  \t")));
 	}
 
+	// loaded positions are already in the file
+	for (ToolMap::iterator it = mTools.begin(); it != mTools.end(); ++it)
+	{
+		TimedTransformMapPtr data = it->second->getPositionHistory();
+		if (data && !data->empty())
+			mJournaledUntil[it->first] = data->rbegin()->first;
+	}
+
 	mLastLoadPositionHistory = getMilliSecondsSinceEpoch();
+	mLastLoadPositionHistoryFile = filename;
+	mLastLoadPositionHistoryTools = mTools;
 }
 
 //void TrackingImplService::setLoggingFolder(QString loggingFolder)
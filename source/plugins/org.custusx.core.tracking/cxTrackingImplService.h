@@ -36,6 +36,7 @@ typedef boost::shared_ptr<class PlaybackTime> PlaybackTimePtr;
 typedef boost::shared_ptr<class TrackingSystemService> TrackingSystemServicePtr;
 typedef boost::shared_ptr<class TrackingSystemPlaybackService> TrackingSystemPlaybackServicePtr;
 typedef boost::shared_ptr<class SessionStorageService> SessionStorageServicePtr;
+typedef boost::shared_ptr<class PositionJournalWriter> PositionJournalWriterPtr;
 
 /**
  * \brief Interface towards the navigation system.
@@ -112,6 +113,7 @@ private slots:
 	void onSessionCleared();
 	void onSessionLoad(QDomElement& node);
 	void onSessionSave(QDomElement& node);
+	void journalPositionsSlot();
 
 private:
     void listenForTrackingSystemServices(ctkPluginContext *context);
@@ -134,8 +136,11 @@ private:
 	void parseXml(QDomNode& dataNode); ///< read internal state from node
 	virtual void savePositionHistory();
 	virtual void loadPositionHistory();
+	void appendNewPositionsToJournal();
+	PositionJournalWriterPtr getJournal();
 
 	QString getLoggingFolder();
+	QString getPositionHistoryFilename();
 
 	ToolMap mTools; ///< all tools
 	ToolPtr mActiveTool; ///< the tool with highest priority
@@ -143,6 +148,11 @@ private:
 	ManualToolAdapterPtr mManualTool; ///< a mouse-controllable virtual tool that is available even when not tracking.
 
 	double mLastLoadPositionHistory;
+	QString mLastLoadPositionHistoryFile;
+	ToolMap mLastLoadPositionHistoryTools;
+	PositionJournalWriterPtr mJournal; ///< appends tool positions to the logging folder
+	QTimer* mJournalTimer;
+	std::map<QString, double> mJournaledUntil; ///< <tool uid, last timestamp sent to journal>
 
 	std::vector<TrackingSystemServicePtr> mTrackingSystems;
 	TrackingSystemPlaybackServicePtr mPlaybackSystem;
@@ -17,7 +17,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
-TrackingSystemDummyService::TrackingSystemDummyService(DummyToolPtr tool)
+TrackingSystemDummyService::TrackingSystemDummyService(DummyToolPtr tool) :
+	mTrackingInterval(30)
 {
 	mState = Tool::tsINITIALIZED;
 
@@ -56,7 +57,7 @@ void TrackingSystemDummyService::setState(const Tool::State val)
 		for (unsigned i=0; i<mTools.size(); ++i)
 		{
 			mTools[i]->setVisible(true);
-			mTools[i]->startTracking(30);
+			mTools[i]->startTracking(mTrackingInterval);
 		}
 	}
 	else
@@ -71,6 +72,11 @@ void TrackingSystemDummyService::setState(const Tool::State val)
 	emit stateChanged();
 }
 
+void TrackingSystemDummyService::setTrackingInterval(int interval)
+{
+	mTrackingInterval = interval;
+}
+
 void TrackingSystemDummyService::setLoggingFolder(QString loggingFolder)
 {
 
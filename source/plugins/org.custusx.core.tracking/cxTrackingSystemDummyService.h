@@ -42,9 +42,13 @@ public:
 	virtual void setLoggingFolder(QString loggingFolder); ///<\param loggingFolder path to the folder where logs should be saved
 	virtual TrackerConfigurationPtr getConfiguration();
 
+	void setTrackingInterval(int interval); ///< ms between tool positions, used when tracking starts
+	int getTrackingInterval() const { return mTrackingInterval; }
+
 private:
 	std::vector<DummyToolPtr> mTools; ///< all tools
 	Tool::State mState;
+	int mTrackingInterval;
 };
 
 
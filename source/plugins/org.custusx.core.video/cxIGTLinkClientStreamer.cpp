@@ -38,6 +38,7 @@ IGTLinkClientStreamer::IGTLinkClientStreamer() :
 	mAddress(""),
 	mPort(0)
 {
+	mImageMessagePool.reset(new IGTLinkImageMessagePool());
 }
 
 IGTLinkClientStreamer::~IGTLinkClientStreamer()
@@ -323,7 +324,7 @@ void IGTLinkClientStreamer::addToQueue(IGTLinkUSStatusMessage::Pointer msg)
 void IGTLinkClientStreamer::addToQueue(igtl::ImageMessage::Pointer msg)
 {
 	IGTLinkConversion converter;
-	IGTLinkConversionImage imageconverter;
+	IGTLinkConversionImage imageconverter(mImageMessagePool);
     IGTLinkConversionSonixCXLegacy cxconverter;
 
     PackagePtr package(new Package());
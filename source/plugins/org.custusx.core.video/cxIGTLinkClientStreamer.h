@@ -16,6 +16,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QAbstractSocket>
 #include "cxIGTLinkImageMessage.h"
 #include "cxIGTLinkUSStatusMessage.h"
+#include "cxIGTLinkImageMessagePool.h"
 #include "cxStreamedTimestampSynchronizer.h"
 
 class QTcpSocket;
@@ -75,6 +76,7 @@ private:
     boost::shared_ptr<QTcpSocket> mSocket;
 	igtl::MessageHeader::Pointer mHeaderMsg;
 	IGTLinkUSStatusMessage::Pointer mUnsentUSStatusMessage; ///< received message, will be added to queue when next image arrives
+	IGTLinkImageMessagePoolPtr mImageMessagePool; ///< keeps received messages alive while images refer to them
 
 
 };
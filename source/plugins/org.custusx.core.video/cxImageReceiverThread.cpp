@@ -18,15 +18,49 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxDirectlyLinkedSender.h"
 #include "cxLogger.h"
 #include "cxProfile.h"
+#include "cxSettings.h"
+#include <algorithm>
 
 namespace cx
 {
 
 ImageReceiverThread::ImageReceiverThread(StreamerServicePtr streamerInterface, QObject* parent) :
 		QObject(parent),
+		mImageReceivedPending(0),
+		mLastReportedDropCount(0),
 		mStreamerInterface(streamerInterface)
 {
 	this->setObjectName("imagereceiver worker");
+
+	int queueSize = settings()->value("Video/ImageQueueSize", 32).toInt();
+	mImageQueue.reset(new ImageQueue(std::max(queueSize, 1)));
+	QString policy = settings()->value("Video/ImageQueuePolicy", "dropOldest").toString();
+	if (policy == "latest")
+		this->setImageQueuePolicy(ImageQueue::pLATEST_ONLY);
+	else if (policy == "block")
+		this->setImageQueuePolicy(ImageQueue::pBLOCK);
+	else
+		this->setImageQueuePolicy(ImageQueue::pDROP_OLDEST);
+}
+
+void ImageReceiverThread::setImageQueuePolicy(ImageQueue::POLICY policy)
+{
+	mImageQueue->setPolicy(policy);
+}
+
+quint64 ImageReceiverThread::getEnqueuedImageCount() const
+{
+	return mImageQueue->getEnqueuedCount();
+}
+
+quint64 ImageReceiverThread::getDroppedImageCount() const
+{
+	return mImageQueue->getDroppedCount();
+}
+
+unsigned ImageReceiverThread::getImageQueueDepth() const
+{
+	return mImageQueue->getDepth();
 }
 
 void ImageReceiverThread::initialize()
@@ -101,11 +135,11 @@ void ImageReceiverThread::addImageToQueue(ImagePtr imgMsg)
 //	if (needToCalibrateMsgTimeStamp)
 //        mStreamSynchronizer.syncToCurrentTime(imgMsg);
 
-	QMutexLocker sentry(&mImageMutex);
-	mMutexedImageMessageQueue.push_back(imgMsg);
-	sentry.unlock();
+	mImageQueue->push(imgMsg);
 
-	emit imageReceived(); // emit signal outside lock, catch possibly in another thread
+	// signal only if the consumer is not already notified: avoids flooding the event queue.
+	if (mImageReceivedPending.testAndSetOrdered(0, 1))
+		emit imageReceived(); // catch possibly in another thread
 }
 
 void ImageReceiverThread::addSonixStatusToQueue(ProbeDefinitionPtr msg)
@@ -118,12 +152,14 @@ void ImageReceiverThread::addSonixStatusToQueue(ProbeDefinitionPtr msg)
 
 ImagePtr ImageReceiverThread::getLastImageMessage()
 {
-	QMutexLocker sentry(&mImageMutex);
-	if (mMutexedImageMessageQueue.empty())
-		return ImagePtr();
-	ImagePtr retval = mMutexedImageMessageQueue.front();
-	mMutexedImageMessageQueue.pop_front();
-
+	ImagePtr retval;
+	if (mImageQueue->pop(&retval))
+		return retval;
+
+	// Queue is empty: rearm the signal, then check again in order to
+	// catch images added in between.
+	mImageReceivedPending.storeRelease(0);
+	mImageQueue->pop(&retval);
 	return retval;
 }
 
@@ -153,7 +189,26 @@ void ImageReceiverThread::reportFPS(QString streamUid)
 	{
 		emit fps(streamUid, logger->getFPS());
 		logger->reset(timeout);
+		this->reportDroppedImages(streamUid);
+	}
+}
+
+void ImageReceiverThread::reportDroppedImages(QString streamUid)
+{
+	quint64 dropped = mImageQueue->getDroppedCount();
+	if (dropped == mLastReportedDropCount)
+		return;
+	// dropping is the purpose of the latest-only policy
+	if (mImageQueue->getPolicy() != ImageQueue::pLATEST_ONLY)
+	{
+		reportWarning(QString("Video [%1]: dropped %2 of %3 images, queue depth %4/%5")
+					  .arg(streamUid)
+					  .arg(dropped - mLastReportedDropCount)
+					  .arg(mImageQueue->getEnqueuedCount())
+					  .arg(mImageQueue->getDepth())
+					  .arg(mImageQueue->getCapacity()));
 	}
+	mLastReportedDropCount = dropped;
 }
 
 //bool ImageReceiverThread::imageComesFromSonix(ImagePtr imgMsg)
@@ -23,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QMutex>
 #include <QDateTime>
 #include "cxForwardDeclarations.h"
+#include "cxBoundedFrameQueue.h"
 
 namespace cx
 {
@@ -43,6 +44,14 @@ typedef boost::shared_ptr<class ImageReceiverThread> ImageReceiverThreadPtr;
 /** \brief Base class for receiving images from a video stream.
  *
  * Subclass to implement for a specific protocol.
+ *
+ * Received images are put in a bounded queue, see BoundedFrameQueue.
+ * The queue size and policy are read from the settings
+ * Video/ImageQueueSize and Video/ImageQueuePolicy (latest, dropOldest or block).
+ * The queue is shared by all streams, thus latest keeps only one image in total.
+ * imageReceived() is emitted once when the queue becomes non-empty:
+ * Call getLastImageMessage() until it returns zero to empty the queue.
+ *
  * Supported messages:
  *  - Image : contains vtkImageData, timestamp, uid, all else is discarded.
  *  - ProbeDefinition : contains sector and image definition, temporal cal is discarded.
@@ -57,10 +66,16 @@ Q_OBJECT
 public:
 	ImageReceiverThread(StreamerServicePtr streamerInterface, QObject* parent = NULL);
 	virtual ~ImageReceiverThread() {}
-	virtual ImagePtr getLastImageMessage(); // threadsafe, Threadsafe retrieval of last image message.
+	virtual ImagePtr getLastImageMessage(); // threadsafe, Threadsafe retrieval of oldest queued image message, zero if empty.
 	virtual ProbeDefinitionPtr getLastSonixStatusMessage(); // threadsafe,Threadsafe retrieval of last status message.
 	virtual QString hostDescription() const; // threadsafe
 
+	typedef BoundedFrameQueue<ImagePtr> ImageQueue;
+	void setImageQueuePolicy(ImageQueue::POLICY policy); // threadsafe
+	quint64 getEnqueuedImageCount() const; // threadsafe
+	quint64 getDroppedImageCount() const; // threadsafe
+	unsigned getImageQueueDepth() const; // threadsafe
+
 public slots:
 	void initialize(); // not threadsafe, call via postevent
 	void shutdown(); // not threadsafe, call via postevent
@@ -88,13 +103,15 @@ private slots:
 
 private:
 	void reportFPS(QString streamUid);
+	void reportDroppedImages(QString streamUid);
 //	bool imageComesFromSonix(ImagePtr imgMsg);
 	bool attemptInitialize();
 
 	std::map<QString, cx::CyclicActionLoggerPtr> mFPSTimer;
-	QMutex mImageMutex;
 	QMutex mSonixStatusMutex;
-	std::list<ImagePtr> mMutexedImageMessageQueue;
+	boost::shared_ptr<ImageQueue> mImageQueue;
+	QAtomicInt mImageReceivedPending; ///< 1 if imageReceived() is emitted but the queue not yet emptied
+	quint64 mLastReportedDropCount;
 	std::list<ProbeDefinitionPtr> mMutexedSonixStatusMessageQueue;
 
 //    StreamedTimestampSynchronizer mStreamSynchronizer;
@@ -129,9 +129,14 @@ void VideoConnection::runDirectLinkClient(StreamerServicePtr service)
 
 void VideoConnection::imageReceivedSlot()
 {
-	if (!mClient)
-		return;
-	this->updateImage(mClient->getLastImageMessage());
+	// the client signals once for all queued images: empty the queue.
+	while (mClient)
+	{
+		ImagePtr image = mClient->getLastImageMessage();
+		if (!image)
+			break;
+		this->updateImage(image);
+	}
 }
 
 void VideoConnection::statusReceivedSlot()
@@ -151,6 +151,7 @@ VideoSourcePtr VideoImplService::getGuessForActiveVideoSource(VideoSourcePtr old
 
     QStringList nameFilters;
     nameFilters << "TissueAngio.fts" << "TissueFlow.fts" << "ScanConverted.fts";
+    nameFilters << "TissueAngio.cxus" << "TissueFlow.cxus" << "ScanConverted.cxus";
     // ask for playback stream:
     foreach(USAcquisitionVideoPlaybackPtr uSAcquisitionVideoPlayback,mUSAcquisitionVideoPlaybacks)
     {
@@ -202,7 +203,7 @@ VideoSourcePtr VideoImplService::getActiveVideoSource()
 void VideoImplService::setPlaybackMode(PlaybackTimePtr controller)
 {
 
-    QStringList res = getAbsolutePathToFiles( mBackend->getDataManager()->getActivePatientFolder() + "/US_Acq/",QStringList("*.fts"), true);
+    QStringList res = getAbsolutePathToFiles( mBackend->getDataManager()->getActivePatientFolder() + "/US_Acq/",QStringList() << "*.fts" << "*.cxus", true);
     QSet<QString> types;
     foreach (const QString &acq, res)
     {
@@ -15,9 +15,10 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxTime.h"
 #include "vtkImageData.h"
 #include "cxRegistrationTransform.h"
-#include <vtkImageAppend.h>
-#include <vtkImageCast.h>
 #include "cxReporter.h"
+#include "cxVolumeHelpers.h"
+#include <QtConcurrent>
+#include "boost/bind.hpp"
 
 #include "cxLogger.h"
 #include "ctkDICOMItem.h"
@@ -29,8 +30,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxDicomImageReader.h"
 #include "cxCustomMetaImage.h"
 
-typedef vtkSmartPointer<vtkImageAppend> vtkImageAppendPtr;
-
 namespace cx
 {
 
@@ -78,39 +77,60 @@ QString DicomConverter::generateName(DicomImageReaderPtr reader)
     return name;
 }
 
-ImagePtr DicomConverter::createCxImageFromDicomFile(QString filename, bool ignoreLocalizerImages)
+void DicomConverter::readSliceHeader(bool ignoreLocalizerImages, DicomSlice& slice) const
 {
-	DicomImageReaderPtr reader = DicomImageReader::createFromFile(filename);
+	DicomImageReaderPtr reader = DicomImageReader::createFromFile(slice.filename);
 	if (!reader)
 	{
-		reportWarning(QString("File not found: %1").arg(filename));
-		return ImagePtr();
+		reportWarning(QString("File not found: %1").arg(slice.filename));
+		return;
 	}
 
 	if(ignoreLocalizerImages && reader->isLocalizerImage())
 	{
-		reportWarning(QString("Localizer image removed from series: %1").arg(filename));
-		return ImagePtr();
+		reportWarning(QString("Localizer image removed from series: %1").arg(slice.filename));
+		return;
 	}
 
 	if (reader->getNumberOfFrames()==0)
 	{
-		reportWarning(QString("Found no images in %1, skipping.").arg(filename));
-		return ImagePtr();
+		reportWarning(QString("Found no images in %1, skipping.").arg(slice.filename));
+		return;
 	}
 
+	slice.rMd = reader->getImageTransformPatient();
+	slice.dim = reader->getDimensions();
+	slice.zOffset = 0;
+	slice.reader = reader;
+}
+
+/** Read the headers of all files in parallel. The pixel data is left on disk.
+ *  Files that cannot be used are removed.
+ */
+std::vector<DicomConverter::DicomSlice> DicomConverter::readSliceHeaders(QStringList files) const
+{
+	std::vector<DicomSlice> slices(files.size());
+	for (int i=0; i<files.size(); ++i)
+		slices[i].filename = files[i];
+
+	bool ignoreSpesialImages = true;
+	QtConcurrent::blockingMap(slices, boost::bind(&DicomConverter::readSliceHeader, this, ignoreSpesialImages, _1));
+
+	std::vector<DicomSlice> retval;
+	for (unsigned i=0; i<slices.size(); ++i)
+		if (slices[i].reader)
+			retval.push_back(slices[i]);
+	return retval;
+}
+
+/** Create an image with the meta data from reader, without image data.
+ */
+ImagePtr DicomConverter::createCxImage(DicomImageReaderPtr reader)
+{
 	QString uid = this->generateUid(reader);
 	QString name = this->generateName(reader);
 	cx::ImagePtr image = cx::Image::create(uid, name);
 
-	vtkImageDataPtr imageData = reader->createVtkImageData();
-	if (!imageData)
-	{
-		reportWarning(QString("Failed to create image for %1.").arg(filename));
-		return ImagePtr();
-	}
-	image->setVtkImageData(imageData);
-
 	QString modalityString = reader->item()->GetElementAsString(DCM_Modality);
 	image->setModality(convertToModality(modalityString));
 
@@ -122,45 +142,45 @@ ImagePtr DicomConverter::createCxImageFromDicomFile(QString filename, bool ignor
 	Transform3D M = reader->getImageTransformPatient();
 	image->get_rMd_History()->setRegistration(M);
 
-	reportDebug(QString("Image created from %1").arg(filename));
 	return image;
 }
 
-std::vector<ImagePtr> DicomConverter::createImages(QStringList files)
+ImagePtr DicomConverter::createCxImageFromSlice(DicomSlice slice)
 {
-	std::vector<ImagePtr> retval;
-	for (int i=0; i<files.size(); ++i)
+	vtkImageDataPtr imageData = slice.reader->createVtkImageData();
+	if (!imageData)
 	{
-		bool ignoreSpesialImages = true;
-		ImagePtr image = this->createCxImageFromDicomFile(files[i], ignoreSpesialImages);
-		if (image)
-			retval.push_back(image);
+		reportWarning(QString("Failed to create image for %1.").arg(slice.filename));
+		return ImagePtr();
 	}
-	return retval;
+
+	cx::ImagePtr image = this->createCxImage(slice.reader);
+	image->setVtkImageData(imageData);
+
+	reportDebug(QString("Image created from %1").arg(slice.filename));
+	return image;
 }
 
-std::map<double, ImagePtr> DicomConverter::sortImagesAlongDirection(std::vector<ImagePtr> images, Vector3D  e_sort)
+std::map<double, DicomConverter::DicomSlice> DicomConverter::sortSlicesAlongDirection(std::vector<DicomSlice> slices, Vector3D  e_sort) const
 {
-	std::map<double, ImagePtr> sorted;
-	for (unsigned i=0; i<images.size(); ++i)
+	std::map<double, DicomSlice> sorted;
+	for (unsigned i=0; i<slices.size(); ++i)
 	{
-		Vector3D pos = images[i]->get_rMd().coord(Vector3D(0,0,0));
+		Vector3D pos = slices[i].rMd.coord(Vector3D(0,0,0));
 		double dist = dot(pos, e_sort);
 
-		sorted[dist] = images[i];
+		sorted[dist] = slices[i];
 	}
 	return sorted;
 }
 
-bool DicomConverter::slicesFormRegularGrid(std::map<double, ImagePtr> sorted, Vector3D e_sort) const
+bool DicomConverter::slicesFormRegularGrid(std::map<double, DicomSlice> sorted, Vector3D e_sort) const
 {
 	std::vector<Vector3D> positions;
 	std::vector<double> distances;
-	for (std::map<double, ImagePtr>::iterator iter=sorted.begin(); iter!=sorted.end(); ++iter)
+	for (std::map<double, DicomSlice>::iterator iter=sorted.begin(); iter!=sorted.end(); ++iter)
 	{
-		ImagePtr current = iter->second;
-
-		Vector3D pos = current->get_rMd().coord(Vector3D(0,0,0));
+		Vector3D pos = iter->second.rMd.coord(Vector3D(0,0,0));
 		positions.push_back(pos);
 
 		if (positions.size()>=2)
@@ -195,15 +215,15 @@ bool DicomConverter::slicesFormRegularGrid(std::map<double, ImagePtr> sorted, Ve
 	return true;
 }
 
-double DicomConverter::getMeanSliceDistance(std::map<double, ImagePtr> sorted) const
+double DicomConverter::getMeanSliceDistance(std::map<double, DicomSlice> sorted) const
 {
 	if (sorted.size()==0)
 		return 0;
 
 	// check for multislice image
-	vtkImageDataPtr first = sorted.begin()->second->getBaseVtkImageData();
-	if (first->GetDimensions()[2]>1)
-		return first->GetSpacing()[2];
+	DicomSlice first = sorted.begin()->second;
+	if (first.dim[2]>1)
+		return first.reader->getSpacing()[2];
 
 	if (sorted.size()<2)
 		return 0;
@@ -215,38 +235,48 @@ double DicomConverter::getMeanSliceDistance(std::map<double, ImagePtr> sorted) c
 	return (zValueLastImage-zValueFirstImage)/numHolesBetweenImages;
 }
 
-ImagePtr DicomConverter::mergeSlices(std::map<double, ImagePtr> sorted) const
+void DicomConverter::decodeSlice(vtkImageData* target, const DicomSlice& slice) const
 {
-	vtkImageAppendPtr appender = vtkImageAppendPtr::New();
-	appender->SetAppendAxis(2);
-
-	ImagePtr retval = sorted.begin()->second;
-
-	int i = 0;
+	if (!slice.reader->decodeInto(target, slice.zOffset))
+		reportWarning(QString("Failed to decode %1, slice left empty.").arg(slice.filename));
+}
 
-	for (std::map<double, ImagePtr>::iterator iter=sorted.begin(); iter!=sorted.end(); ++iter)
+ImagePtr DicomConverter::mergeSlices(std::map<double, DicomSlice> sorted)
+{
+	// find the position of each file in the volume
+	std::vector<DicomSlice> slices;
+	DicomSlice first = sorted.begin()->second;
+	int dimZ = 0;
+	for (std::map<double, DicomSlice>::iterator iter=sorted.begin(); iter!=sorted.end(); ++iter)
 	{
-		ImagePtr current = iter->second;
-
-		// Set window width and level to the values of the middle frame
-		if (i == sorted.size() / 2)
-			retval->setInitialWindowLevel(current->getInitialWindowWidth(), current->getInitialWindowLevel());
-		++i;
-
-		//Convert all slices to same format
-		vtkImageCastPtr imageCast = vtkImageCastPtr::New();
-		imageCast->SetInputData(current->getBaseVtkImageData());
-		imageCast->SetOutputScalarTypeToShort();
-		imageCast->Update();
-
-		appender->AddInputData(imageCast->GetOutput());
+		DicomSlice current = iter->second;
+		if ((current.dim[0]!=first.dim[0]) || (current.dim[1]!=first.dim[1]))
+		{
+			reportError(QString("Dicom convert: found slices with different dimensions, cannot create image."));
+			return ImagePtr();
+		}
+		current.zOffset = dimZ;
+		dimZ += current.dim[2];
+		slices.push_back(current);
 	}
-	appender->Update();
 
-	vtkImageDataPtr wholeImage = appender->GetOutput();
-	Eigen::Array3d spacing(wholeImage->GetSpacing());
+	Eigen::Array3d spacing = first.reader->getSpacing();
 	spacing[2] = this->getMeanSliceDistance(sorted);
+
+	vtkImageDataPtr wholeImage = vtkImageDataPtr::New();
 	wholeImage->SetSpacing(spacing.data());
+	wholeImage->SetExtent(0, first.dim[0]-1, 0, first.dim[1]-1, 0, dimZ-1);
+	//Convert all slices to same format while decoding
+	wholeImage->AllocateScalars(VTK_SHORT, first.reader->getSamplesPerPixel());
+
+	QtConcurrent::blockingMap(slices, boost::bind(&DicomConverter::decodeSlice, this, wholeImage.GetPointer(), _1));
+	setDeepModified(wholeImage);
+
+	ImagePtr retval = this->createCxImage(first.reader);
+
+	// Set window width and level to the values of the middle frame
+	DicomImageReader::WindowLevel windowLevel = slices[slices.size()/2].reader->getWindowLevel();
+	retval->setInitialWindowLevel(windowLevel.width, windowLevel.center);
 
 	retval->setVtkImageData(wholeImage);
 
@@ -257,19 +287,19 @@ ImagePtr DicomConverter::convertToImage(QString series)
 {
 	QStringList files = mDatabase->filesForSeries(series);
 
-	std::vector<ImagePtr> images = this->createImages(files);
+	std::vector<DicomSlice> slices = this->readSliceHeaders(files);
 
-	if (images.empty())
+	if (slices.empty())
 		return ImagePtr();
 
-	if (images.size()==1)
+	if (slices.size()==1)
 	{
-		return images.front();
+		return this->createCxImageFromSlice(slices.front());
 	}
 
-	Vector3D e_sort = images.front()->get_rMd().vector(Vector3D(0,0,1));
+	Vector3D e_sort = slices.front().rMd.vector(Vector3D(0,0,1));
 
-	std::map<double, ImagePtr> sorted = this->sortImagesAlongDirection(images, e_sort);
+	std::map<double, DicomSlice> sorted = this->sortSlicesAlongDirection(slices, e_sort);
 
 	if (!this->slicesFormRegularGrid(sorted, e_sort))
 		return ImagePtr();
@@ -23,6 +23,10 @@ typedef boost::shared_ptr<class DicomImageReader> DicomImageReaderPtr;
 /**
  * Import dicom series into cx Image.
  *
+ * The headers of all files are read first, then the
+ * volume is allocated and the slices decoded directly
+ * into it, in parallel.
+ *
  * \ingroup org_custusx_dicom
  *
  * \date 2014-04-04
@@ -38,15 +42,29 @@ public:
 	ImagePtr convertToImage(QString seriesUid);
 
 private:
+	/** A file in the series, with the header info needed to place it in the volume.
+	 */
+	struct DicomSlice
+	{
+		QString filename;
+		DicomImageReaderPtr reader;
+		Transform3D rMd;
+		Eigen::Array3i dim;
+		int zOffset; ///< position of the first frame in the merged volume
+	};
+
 	QString generateUid(DicomImageReaderPtr reader);
 	QString generateName(DicomImageReaderPtr reader);
-	std::map<double, ImagePtr> sortImagesAlongDirection(std::vector<ImagePtr> images, Vector3D  e_sort);
-	ImagePtr mergeSlices(std::map<double, ImagePtr> sorted) const;
-	double getMeanSliceDistance(std::map<double, ImagePtr> sorted) const;
-	bool slicesFormRegularGrid(std::map<double, ImagePtr> sorted, Vector3D e_sort) const;
+	std::map<double, DicomSlice> sortSlicesAlongDirection(std::vector<DicomSlice> slices, Vector3D  e_sort) const;
+	ImagePtr mergeSlices(std::map<double, DicomSlice> sorted);
+	double getMeanSliceDistance(std::map<double, DicomSlice> sorted) const;
+	bool slicesFormRegularGrid(std::map<double, DicomSlice> sorted, Vector3D e_sort) const;
 	// ignoreLocalizerImages is a tag to ignore special images. For now only localizer images are ignored
-	ImagePtr createCxImageFromDicomFile(QString filename, bool ignoreLocalizerImages);
-	std::vector<ImagePtr> createImages(QStringList files);
+	void readSliceHeader(bool ignoreLocalizerImages, DicomSlice& slice) const;
+	std::vector<DicomSlice> readSliceHeaders(QStringList files) const;
+	void decodeSlice(vtkImageData* target, const DicomSlice& slice) const;
+	ImagePtr createCxImage(DicomImageReaderPtr reader);
+	ImagePtr createCxImageFromSlice(DicomSlice slice);
 	QString convertToValidName(QString text) const;
 
 	ctkDICOMDatabase* mDatabase;
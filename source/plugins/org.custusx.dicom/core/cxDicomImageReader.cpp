@@ -18,6 +18,44 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
+namespace
+{
+template<class TSource, class TTarget>
+void castPixels(const TSource* source, TTarget* target, unsigned long count)
+{
+	for (unsigned long i=0; i<count; ++i)
+		target[i] = static_cast<TTarget>(source[i]);
+}
+
+template<class TTarget>
+bool castPixelsFrom(const DiPixel* pixels, TTarget* target, unsigned long count)
+{
+	const void* source = pixels->getData();
+	switch (pixels->getRepresentation())
+	{
+	case EPR_Uint8:
+		castPixels(static_cast<const Uint8*>(source), target, count);
+		return true;
+	case EPR_Uint16:
+		castPixels(static_cast<const Uint16*>(source), target, count);
+		return true;
+	case EPR_Uint32:
+		castPixels(static_cast<const Uint32*>(source), target, count);
+		return true;
+	case EPR_Sint8:
+		castPixels(static_cast<const Sint8*>(source), target, count);
+		return true;
+	case EPR_Sint16:
+		castPixels(static_cast<const Sint16*>(source), target, count);
+		return true;
+	case EPR_Sint32:
+		castPixels(static_cast<const Sint32*>(source), target, count);
+		return true;
+	}
+	return false;
+}
+} // namespace
+
 DicomImageReaderPtr DicomImageReader::createFromFile(QString filename)
 {
 	DicomImageReaderPtr retval(new DicomImageReader);
@@ -119,6 +157,22 @@ bool DicomImageReader::isLocalizerImage() const
 	return retval;
 }
 
+Eigen::Array3i DicomImageReader::getDimensions() const
+{
+	unsigned short rows = 0;
+	unsigned short columns = 0;
+	mDataset->findAndGetUint16(DCM_Rows, rows, 0, OFTrue);
+	mDataset->findAndGetUint16(DCM_Columns, columns, 0, OFTrue);
+	return Eigen::Array3i(columns, rows, this->getNumberOfFrames());
+}
+
+int DicomImageReader::getSamplesPerPixel() const
+{
+	unsigned short samplesPerPixel = 1;
+	mDataset->findAndGetUint16(DCM_SamplesPerPixel, samplesPerPixel, 0, OFTrue);
+	return std::max<int>(samplesPerPixel, 1);
+}
+
 int DicomImageReader::getNumberOfFrames() const
 {
 	int numberOfFrames = this->item()->GetElementAsInteger(DCM_NumberOfFrames);
@@ -176,7 +230,8 @@ vtkImageDataPtr DicomImageReader::createVtkImageData()
 {
 	//TODO: Use DicomImage::createMonochromeImage() to get a monochrome copy for convenience
 
-	DicomImage dicomImage(mFilename.toLatin1().data()); //, CIF_MayDetachPixelData );
+	// decode from the already loaded file instead of reading it again
+	DicomImage dicomImage(&mFileFormat, mDataset->getOriginalXfer());
 	const DiPixel *pixels = dicomImage.getInterData();
 	if (!pixels)
 	{
@@ -193,45 +248,84 @@ vtkImageDataPtr DicomImageReader::createVtkImageData()
 
 	int samplesPerPixel = pixels->getPlanes();
 	int scalarSize = dim.prod() * samplesPerPixel;
-	int pixelDepth = dicomImage.getDepth();
 
 	switch (pixels->getRepresentation())
 	{
 	case EPR_Uint8:
-//		std::cout << "  VTK_UNSIGNED_CHAR" << std::endl;
 		data->AllocateScalars(VTK_UNSIGNED_CHAR, samplesPerPixel);
 		break;
 	case EPR_Uint16:
-//		std::cout << "  VTK_UNSIGNED_SHORT" << std::endl;
 		data->AllocateScalars(VTK_UNSIGNED_SHORT, samplesPerPixel);
 		break;
 	case EPR_Uint32:
-//		std::cout << "  VTK_UNSIGNED_INT" << std::endl;
 		data->AllocateScalars(VTK_UNSIGNED_INT, samplesPerPixel);
 		break;
 	case EPR_Sint8:
-//		std::cout << "  VTK_CHAR" << std::endl;
 		data->AllocateScalars(VTK_CHAR, samplesPerPixel);
 		break;
 	case EPR_Sint16:
-//		std::cout << "  VTK_SHORT" << std::endl;
 		data->AllocateScalars(VTK_SHORT, samplesPerPixel);
 		break;
 	case EPR_Sint32:
-//		std::cout << "  VTK_INT" << std::endl;
 		data->AllocateScalars(VTK_INT, samplesPerPixel);
 		break;
 	}
 
-	int bytesPerPixel = data->GetScalarSize() * samplesPerPixel;
-
-	memcpy(data->GetScalarPointer(), pixels->getData(), pixels->getCount()*bytesPerPixel);
 	if (pixels->getCount()!=scalarSize)
 		this->error("Mismatch in pixel counts");
+	if (!this->copyPixels(pixels, data, 0))
+		return vtkImageDataPtr();
 	setDeepModified(data);
 	return data;
 }
 
+bool DicomImageReader::decodeInto(vtkImageData* target, int zOffset)
+{
+	DicomImage dicomImage(&mFileFormat, mDataset->getOriginalXfer(), CIF_MayDetachPixelData);
+	const DiPixel *pixels = dicomImage.getInterData();
+	if (!pixels)
+	{
+		this->error("Found no pixel data");
+		return false;
+	}
+
+	Eigen::Array3i dim = this->getDim(dicomImage);
+	int* targetDim = target->GetDimensions();
+	if ((dim[0]!=targetDim[0]) || (dim[1]!=targetDim[1]) || (zOffset+dim[2]>targetDim[2]))
+	{
+		this->error(QString("Slice dimensions %1x%2x%3 at z=%4 does not fit in volume")
+					.arg(dim[0]).arg(dim[1]).arg(dim[2]).arg(zOffset));
+		return false;
+	}
+
+	return this->copyPixels(pixels, target, zOffset);
+}
+
+/** Copy the pixels into target at slice zOffset, converted to the scalar type of target.
+ *  Writes only to the given slices, thus different slices can be filled concurrently.
+ */
+bool DicomImageReader::copyPixels(const DiPixel* pixels, vtkImageData* target, int zOffset) const
+{
+	unsigned long count = pixels->getCount() * pixels->getPlanes();
+	int* dim = target->GetDimensions();
+	unsigned long available = (unsigned long)(dim[0]) * dim[1] * (dim[2]-zOffset) * target->GetNumberOfScalarComponents();
+	if (count > available)
+	{
+		this->error("Pixel data does not fit in target image");
+		return false;
+	}
+
+	void* dest = target->GetScalarPointer(0, 0, zOffset);
+	bool success = false;
+	switch (target->GetScalarType())
+	{
+		vtkTemplateMacro(success = castPixelsFrom(pixels, static_cast<VTK_TT*>(dest), count));
+	}
+	if (!success)
+		this->error("Unsupported pixel representation");
+	return success;
+}
+
 Eigen::Array3d DicomImageReader::getSpacing() const
 {
 	Eigen::Array3d spacing;
@@ -54,6 +54,14 @@ public:
 	static DicomImageReaderPtr createFromFile(QString filename);
 	Transform3D getImageTransformPatient() const;
 	vtkImageDataPtr createVtkImageData();
+	/** Decode the pixel data into target, starting at slice zOffset.
+	 *  The pixels are converted to the scalar type of target while copied.
+	 *  Pixel data is released from the file after decoding.
+	 */
+	bool decodeInto(vtkImageData* target, int zOffset);
+	Eigen::Array3i getDimensions() const; ///< dimensions as given by the header, without decoding
+	int getSamplesPerPixel() const;
+	Eigen::Array3d getSpacing() const;
 	ctkDICOMItemPtr item() const;
 	WindowLevel getWindowLevel() const;
 	int getNumberOfFrames() const;
@@ -67,8 +75,8 @@ private:
 
 	DicomImageReader();
 	bool loadFile(QString filename);
-	Eigen::Array3d getSpacing() const;
 	Eigen::Array3i getDim(const DicomImage& dicomImage) const;
+	bool copyPixels(const DiPixel* pixels, vtkImageData* target, int zOffset) const;
 	void error(QString message) const;
 	double getDouble(const DcmTagKey& tag, const unsigned long pos=0, const OFBool searchIntoSub = OFFalse) const;
 //	double getDouble(DcmObject *dcmObject, const DcmTagKey &tag, const unsigned long pos, const bool searchIntoSub) const;
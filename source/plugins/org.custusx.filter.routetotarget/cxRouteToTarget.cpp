@@ -69,27 +69,10 @@ void RouteToTarget::processCenterline(vtkPolyDataPtr centerline_r)
 
 void RouteToTarget::findClosestPointInBranches(Vector3D targetCoordinate_r)
 {
-	double minDistance = 100000;
-	int minDistancePositionIndex;
-	BranchPtr minDistanceBranch;
-	std::vector<BranchPtr> branches = mBranchListPtr->getBranches();
-	for (int i = 0; i < branches.size(); i++)
-	{
-		Eigen::MatrixXd positions = branches[i]->getPositions();
-		for (int j = 0; j < positions.cols(); j++)
-		{
-            double D = findDistance(positions.col(j), targetCoordinate_r);
-			if (D < minDistance)
-			{
-				minDistance = D;
-				minDistanceBranch = branches[i];
-				minDistancePositionIndex = j;
-			}
-		}
-	}
+	std::pair<BranchPtr, int> closest = mBranchListPtr->findClosestPosition(targetCoordinate_r);
 
-		mProjectedBranchPtr = minDistanceBranch;
-		mProjectedIndex = minDistancePositionIndex;
+	mProjectedBranchPtr = closest.first;
+	mProjectedIndex = closest.second;
 }
 
 
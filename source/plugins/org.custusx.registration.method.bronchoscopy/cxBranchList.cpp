@@ -36,6 +36,7 @@ BranchList::~BranchList()
 void BranchList::addBranch(BranchPtr b)
 {
 	mBranches.push_back(b);
+	this->invalidateSpatialIndex();
 }
 
 void BranchList::deleteBranch(BranchPtr b)
@@ -45,6 +46,7 @@ void BranchList::deleteBranch(BranchPtr b)
 		if (b == mBranches[i])
 		{
 			mBranches.erase(mBranches.begin() + i);
+			this->invalidateSpatialIndex();
 			return;
 		}
 	}
@@ -53,6 +55,7 @@ void BranchList::deleteBranch(BranchPtr b)
 void BranchList::deleteAllBranches()
 {
 	mBranches.clear();
+	this->invalidateSpatialIndex();
 }
 
 std::vector<BranchPtr> BranchList::getBranches()
@@ -114,6 +117,7 @@ void BranchList::smoothOrientations()
 }
 
 void BranchList::interpolateBranchPositions(int interpolationFactor){
+	this->invalidateSpatialIndex();
 
 	for (int i = 0; i < mBranches.size(); i++)
 	{
@@ -159,6 +163,7 @@ void BranchList::interpolateBranchPositions(int interpolationFactor){
 
 void BranchList::smoothBranchPositions(int controlPointDistance)
 {
+	this->invalidateSpatialIndex();
 	for (int i = 0; i < mBranches.size(); i++)
 	{
 		Eigen::MatrixXd positions = mBranches[i]->getPositions();
@@ -202,6 +207,7 @@ void BranchList::smoothBranchPositions(int controlPointDistance)
 
 void BranchList::findBranchesInCenterline(Eigen::MatrixXd positions_r)
 {
+	this->invalidateSpatialIndex();
 	positions_r = sortMatrix(2,positions_r);
 	Eigen::MatrixXd positionsNotUsed_r = positions_r;
 
@@ -328,6 +334,7 @@ BranchListPtr BranchList::removePositionsForLocalRegistration(Eigen::MatrixXd tr
 }
 
 void BranchList::excludeClosePositionsInCTCenterline(double minPointDistance){
+	this->invalidateSpatialIndex();
 
 	std::vector<BranchPtr> branchVector = this->getBranches();
 	for (int i = 0; i < branchVector.size(); i++)
@@ -437,6 +444,45 @@ vtkPolyDataPtr BranchList::createVtkPolyDataFromBranches(bool fullyConnected, bo
 	return retval;
 }
 
+/**
+ * Find the branch position closest to position.
+ * @return the branch and the index of the position in it,
+ * or a NULL branch if there are no positions.
+ */
+std::pair<BranchPtr, int> BranchList::findClosestPosition(Vector3D position)
+{
+	this->updateSpatialIndex();
+	int index = mSpatialIndex->findClosestPoint(position);
+	if (index < 0)
+		return std::make_pair(BranchPtr(), -1);
+	std::pair<int, int> found = mSpatialIndexPositions[index];
+	return std::make_pair(mBranches[found.first], found.second);
+}
+
+void BranchList::invalidateSpatialIndex()
+{
+	mSpatialIndex.reset();
+	mSpatialIndexPositions.clear();
+}
+
+void BranchList::updateSpatialIndex()
+{
+	if (mSpatialIndex)
+		return;
+
+	std::vector<Vector3D> points;
+	for (int i = 0; i < mBranches.size(); i++)
+	{
+		Eigen::MatrixXd positions = mBranches[i]->getPositions();
+		for (int j = 0; j < positions.cols(); j++)
+		{
+			points.push_back(positions.col(j));
+			mSpatialIndexPositions.push_back(std::make_pair(i, j));
+		}
+	}
+	mSpatialIndex.reset(new PointKdTree(points));
+}
+
 Eigen::MatrixXd sortMatrix(int rowNumber, Eigen::MatrixXd matrix)
 {
 	for (int i = 0; i < matrix.cols() - 1; i++)  {
@@ -483,6 +529,16 @@ std::pair<std::vector<Eigen::MatrixXd::Index>, Eigen::VectorXd > dsearchn(Eigen:
 	return std::make_pair(indexVector , D);
 }
 
+/** Create a spatial index of the columns in positions (3xN).
+ */
+PointKdTreePtr createPositionIndex(const Eigen::MatrixXd& positions)
+{
+	std::vector<Vector3D> points(positions.cols());
+	for (int i = 0; i < positions.cols(); i++)
+		points[i] = positions.col(i);
+	return PointKdTreePtr(new PointKdTree(points));
+}
+
 std::pair<Eigen::MatrixXd,Eigen::MatrixXd > findConnectedPointsInCT(int startIndex , Eigen::MatrixXd positionsNotUsed)
 {
 	//Eigen::MatrixXd branchPositions(positionsNotUsed.rows(), positionsNotUsed.cols());
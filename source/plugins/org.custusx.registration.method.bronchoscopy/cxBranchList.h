@@ -14,6 +14,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxBranch.h"
 #include "cxMesh.h"
 #include "cxVector3D.h"
+#include "cxPointKdTree.h"
 #include "org_custusx_registration_method_bronchoscopy_Export.h"
 
 
@@ -23,9 +24,17 @@ namespace cx
 typedef std::vector< Eigen::Matrix4d > M4Vector;
 typedef boost::shared_ptr<class BranchList> BranchListPtr;
 
+/** A list of centerline branches.
+ *
+ * findClosestPosition() uses a spatial index of all branch positions. It is
+ * built on demand, and reset by the methods changing the branches. Call
+ * invalidateSpatialIndex() after changing the branches directly.
+ */
 class org_custusx_registration_method_bronchoscopy_EXPORT BranchList
 {
 	std::vector<BranchPtr> mBranches;
+	PointKdTreePtr mSpatialIndex;
+	std::vector<std::pair<int, int> > mSpatialIndexPositions; ///< (branch, position) for each point in mSpatialIndex
 public:
 	BranchList();
 	virtual ~BranchList();
@@ -42,6 +51,10 @@ public:
 	void excludeClosePositionsInCTCenterline(double minPointDistance);
 	BranchListPtr removePositionsForLocalRegistration(Eigen::MatrixXd trackingPositions, double maxDistance);
 	vtkPolyDataPtr createVtkPolyDataFromBranches(bool fullyConnected = false, bool straightBranches = false) const;
+	std::pair<BranchPtr, int> findClosestPosition(Vector3D position);
+	void invalidateSpatialIndex();
+private:
+	void updateSpatialIndex();
 };
 
 std::pair<Eigen::MatrixXd,Eigen::MatrixXd > findConnectedPointsInCT(int startIndex , Eigen::MatrixXd positionsNotUsed);
@@ -49,6 +62,7 @@ Eigen::MatrixXd sortMatrix(int rowNumber, Eigen::MatrixXd matrix);
 Eigen::MatrixXd eraseCol(int removeIndex, Eigen::MatrixXd positions);
 std::pair<Eigen::MatrixXd::Index, double> dsearch(Eigen::Vector3d p, Eigen::MatrixXd positions);
 std::pair<std::vector<Eigen::MatrixXd::Index>, Eigen::VectorXd > dsearchn(Eigen::MatrixXd p1, Eigen::MatrixXd p2);
+PointKdTreePtr createPositionIndex(const Eigen::MatrixXd& positions);
 
 }//namespace cx
 
@@ -171,50 +171,87 @@ Eigen::Matrix4d performLandmarkRegistration(vtkPointsPtr source, vtkPointsPtr ta
 
 
 
-std::vector<Eigen::MatrixXd::Index> dsearch2n(Eigen::MatrixXd pos1, Eigen::MatrixXd pos2, Eigen::MatrixXd ori1, Eigen::MatrixXd ori2)
+namespace
+{
+/** Position and orientation distance between column i in pos1/ori1 and column j in pos2/ori2.
+ */
+void findPositionAndOrientationDistance(const Eigen::MatrixXd& pos1, const Eigen::MatrixXd& pos2, const Eigen::MatrixXd& ori1, const Eigen::MatrixXd& ori2,
+										int i, int j, double* P, double* O)
+{
+	double p0 = ( pos2(0,j) - pos1(0,i) );
+	double p1 = ( pos2(1,j) - pos1(1,i) );
+	double p2 = ( pos2(2,j) - pos1(2,i) );
+	double o0 = fmod( ori2(0,j) - ori1(0,i) , 2 );
+	double o1 = fmod( ori2(1,j) - ori1(1,i) , 2 );
+	double o2 = fmod( ori2(2,j) - ori1(2,i) , 2 );
+
+	*P = sqrt( p0*p0 + p1*p1 + p2*p2 );
+	*O = sqrt( o0*o0 + o1*o1 + o2*o2 );
+
+	if (boost::math::isnan( *O ))
+		*O = 4;
+}
+} // namespace
+
+/**
+ * For each column in pos1/ori1, find the column in pos2/ori2 with the
+ * smallest combined distance D = P + alpha*O, where P is the position
+ * distance, O the orientation distance and alpha^2 the mean of P/O.
+ *
+ * alpha is estimated from at most maxAlphaSamples evenly spaced columns in pos2.
+ * The closest position in pos2Index bounds D, thus only the positions within
+ * that distance are compared.
+ */
+std::vector<Eigen::MatrixXd::Index> dsearch2n(const PointKdTree& pos2Index, Eigen::MatrixXd pos1, Eigen::MatrixXd pos2, Eigen::MatrixXd ori1, Eigen::MatrixXd ori2, int maxAlphaSamples)
 {
-	Eigen::MatrixXd::Index index;
 	std::vector<Eigen::MatrixXd::Index> indexVector;
+	if (pos2.cols() == 0)
+		return indexVector;
+	int alphaStep = std::max<int>(1, (pos2.cols() + maxAlphaSamples - 1) / maxAlphaSamples);
 
 	for (int i = 0; i < pos1.cols(); i++)
 	{
-		Eigen::VectorXd D(pos2.cols());
-		Eigen::VectorXd P(pos2.cols());
-		Eigen::VectorXd O(pos2.cols());
-		Eigen::VectorXd R(pos2.cols());
-
-		for (int j = 0; j < pos2.cols(); j++)
+		double P, O;
+		double sumR = 0;
+		int numR = 0;
+		for (int j = 0; j < pos2.cols(); j += alphaStep)
 		{
-			float p0 = ( pos2(0,j) - pos1(0,i) );
-			float p1 = ( pos2(1,j) - pos1(1,i) );
-			float p2 = ( pos2(2,j) - pos1(2,i) );
-			float o0 = fmod( ori2(0,j) - ori1(0,i) , 2 );
-			float o1 = fmod( ori2(1,j) - ori1(1,i) , 2 );
-			float o2 = fmod( ori2(2,j) - ori1(2,i) , 2 );
-
-			P(j) = sqrt( p0*p0 + p1*p1 + p2*p2 );
-			O(j) = sqrt( o0*o0 + o1*o1 + o2*o2 );
-
-			if (boost::math::isnan( O(j) ))
-				O(j) = 4;
-
-			if ( (o0>2) || (o1>2) || (o2>2) )
-				std::cout << "Warning in bronchoscopyRegistration.cpp: Error on oriantation calculation in dsearch2n. Orientation > 2." << std::endl;
-
-			R(j) = P(j) / O(j);
-
+			findPositionAndOrientationDistance(pos1, pos2, ori1, ori2, i, j, &P, &O);
+			sumR += P / O;
+			++numR;
 		}
-		float alpha = sqrt( R.mean() );
-		if (boost::math::isnan( alpha ))
+		double alpha = sqrt( sumR / numR );
+		if (!boost::math::isfinite( alpha ))
 			alpha = 0;
 
-		D = P + alpha * O;
-		D.minCoeff(&index);
+		// D >= P: only positions closer than the D of the closest position can have a smaller D.
+		int index = pos2Index.findClosestPoint(pos1.col(i));
+		findPositionAndOrientationDistance(pos1, pos2, ori1, ori2, i, index, &P, &O);
+		double minD = P + alpha * O;
+
+		std::vector<int> candidates = pos2Index.findPointsWithinRadius(pos1.col(i), minD);
+		for (unsigned k = 0; k < candidates.size(); k++)
+		{
+			int j = candidates[k];
+			findPositionAndOrientationDistance(pos1, pos2, ori1, ori2, i, j, &P, &O);
+			double D = P + alpha * O;
+			if ((D < minD) || (D == minD && j < index))
+			{
+				minD = D;
+				index = j;
+			}
+		}
 		indexVector.push_back(index);
 	}
 	return indexVector;
 }
 
+std::vector<Eigen::MatrixXd::Index> dsearch2n(Eigen::MatrixXd pos1, Eigen::MatrixXd pos2, Eigen::MatrixXd ori1, Eigen::MatrixXd ori2)
+{
+	PointKdTreePtr pos2Index = createPositionIndex(pos2);
+	return dsearch2n(*pos2Index, pos1, pos2, ori1, ori2);
+}
+
 std::pair<Eigen::MatrixXd , Eigen::MatrixXd> RemoveInvalidData(Eigen::MatrixXd positionData, Eigen::MatrixXd orientationData)
 {
 	std::vector<int> indicesToBeDeleted;
@@ -335,6 +372,8 @@ Eigen::Matrix4d registrationAlgorithm(BranchListPtr branches, M4Vector Tnavigati
 		Tnavigation[i] = registrationMatrix * Tnavigation[i];
 	}
 
+	PointKdTreePtr CTPositionIndex = createPositionIndex(CTPositions);
+
 	int iterationNumber = 0;
 	int maxIterations = 50;
 	while ( translation.array().abs().sum() > 1 && iterationNumber < maxIterations)
@@ -347,7 +386,7 @@ Eigen::Matrix4d registrationAlgorithm(BranchListPtr branches, M4Vector Tnavigati
 
 
 		iterationNumber++;
-		std::vector<Eigen::MatrixXd::Index> indexVector = dsearch2n( trackingPositions, CTPositions, trackingOrientations, CTOrientations );
+		std::vector<Eigen::MatrixXd::Index> indexVector = dsearch2n( *CTPositionIndex, trackingPositions, CTPositions, trackingOrientations, CTOrientations );
 		Eigen::MatrixXd nearestCTPositions(3,indexVector.size());
 		Eigen::MatrixXd nearestCTOrientations(3,indexVector.size());
 		Eigen::VectorXd DAngle(indexVector.size());
@@ -452,13 +491,15 @@ Eigen::Matrix4d registrationAlgorithmImage2Image(BranchListPtr branchesFixed, Br
 		CTPositionsMoving.col(i) = CTPositionsMoving.col(i) + translation;
 	}
 
+	PointKdTreePtr CTPositionFixedIndex = createPositionIndex(CTPositionsFixed);
+
 	int iterationNumber = 0;
 	int maxIterations = 200;
 	while ( translation.array().abs().sum() > 0.5 && iterationNumber < maxIterations)
 	{
 
 		iterationNumber++;
-		std::vector<Eigen::MatrixXd::Index> indexVector = dsearch2n( CTPositionsMoving, CTPositionsFixed, CTOrientationsMoving, CTOrientationsFixed );
+		std::vector<Eigen::MatrixXd::Index> indexVector = dsearch2n( *CTPositionFixedIndex, CTPositionsMoving, CTPositionsFixed, CTOrientationsMoving, CTOrientationsFixed );
 		Eigen::MatrixXd nearestCTPositions(3,indexVector.size());
 		Eigen::MatrixXd nearestCTOrientations(3,indexVector.size());
 		Eigen::VectorXd DAngle(indexVector.size());
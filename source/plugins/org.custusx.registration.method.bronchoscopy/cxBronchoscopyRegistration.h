@@ -15,6 +15,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxBranchList.h"
 #include <vector>
 #include "vtkForwardDeclarations.h"
+#include "cxTimedTransformMap.h"
 
 typedef std::vector< Eigen::Matrix4d > M4Vector;
 
@@ -22,7 +23,6 @@ typedef std::vector< Eigen::Matrix4d > M4Vector;
 namespace cx
 {
 
-typedef std::map<double, Transform3D> TimedTransformMap;
 typedef boost::shared_ptr<class BranchList> BranchListPtr;
 
 class org_custusx_registration_method_bronchoscopy_EXPORT BronchoscopyRegistration
@@ -44,6 +44,7 @@ M4Vector excludeClosePositions();
 Eigen::Matrix4d registrationAlgorithm(BranchListPtr branches, M4Vector Tnavigation);
 Eigen::Matrix4d registrationAlgorithmImage2Image(BranchListPtr branchesFixed, BranchListPtr branchesMoving);
 std::vector<Eigen::MatrixXd::Index> dsearch2n(Eigen::MatrixXd pos1, Eigen::MatrixXd pos2, Eigen::MatrixXd ori1, Eigen::MatrixXd ori2);
+std::vector<Eigen::MatrixXd::Index> dsearch2n(const PointKdTree& pos2Index, Eigen::MatrixXd pos1, Eigen::MatrixXd pos2, Eigen::MatrixXd ori1, Eigen::MatrixXd ori2, int maxAlphaSamples = 1000);
 vtkPointsPtr convertTovtkPoints(Eigen::MatrixXd positions);
 Eigen::Matrix4d performLandmarkRegistration(vtkPointsPtr source, vtkPointsPtr target, bool* ok);
 std::pair<Eigen::MatrixXd , Eigen::MatrixXd> RemoveInvalidData(Eigen::MatrixXd positionData, Eigen::MatrixXd orientationData);
@@ -109,4 +109,66 @@ TEST_CASE("Test the findParentIndex method", "[unit][bronchoscopy]")
 
 }
 
+TEST_CASE("Test the findClosestPosition method", "[unit][bronchoscopy]")
+{
+	vtkPolyDataPtr linesPolyData = makeDummyCenterLine();
+	Eigen::MatrixXd CLpoints = cx::makeTransformedMatrix(linesPolyData);
+	cx::BranchListPtr bl = cx::BranchListPtr(new cx::BranchList());
+	bl->findBranchesInCenterline(CLpoints);
+
+	cx::Vector3D target(3, -4, 25);
+	std::pair<cx::BranchPtr, int> closest = bl->findClosestPosition(target);
+	REQUIRE(closest.first);
+
+	double minDistance = 1.0E10;
+	std::vector<cx::BranchPtr> branches = bl->getBranches();
+	for (int i = 0; i < branches.size(); i++)
+		for (int j = 0; j < branches[i]->getPositions().cols(); j++)
+			minDistance = std::min(minDistance, (cx::Vector3D(branches[i]->getPositions().col(j)) - target).norm());
+	cx::Vector3D found = closest.first->getPositions().col(closest.second);
+	CHECK((found - target).norm() == Approx(minDistance));
+
+	bl->deleteAllBranches();
+	CHECK_FALSE(bl->findClosestPosition(target).first);
+}
+
+TEST_CASE("Test that dsearch2n with a spatial index finds the minimal combined distance", "[unit][bronchoscopy]")
+{
+	int n = 300;
+	Eigen::MatrixXd positions(3, n);
+	Eigen::MatrixXd orientations(3, n);
+	for (int j = 0; j < n; j++)
+	{
+		double t = j * 0.1;
+		positions.col(j) = Eigen::Vector3d(10 * cos(t), 10 * sin(t), j * 0.2);
+		orientations.col(j) = Eigen::Vector3d(-sin(t), cos(t), 0.02).normalized();
+	}
+	Eigen::MatrixXd trackingPositions = positions.leftCols(50).array() + 0.7;
+	Eigen::MatrixXd trackingOrientations(3, 50);
+	for (int i = 0; i < 50; i++)
+		trackingOrientations.col(i) = (orientations.col(i) + Eigen::Vector3d(0.1, 0, 0.1)).normalized();
+
+	std::vector<Eigen::MatrixXd::Index> indices = cx::dsearch2n(trackingPositions, positions, trackingOrientations, orientations);
+	REQUIRE(indices.size() == 50);
+
+	for (int i = 0; i < trackingPositions.cols(); i++)
+	{
+		// brute force: minimize P + alpha*O over all positions
+		Eigen::VectorXd P(n), O(n);
+		for (int j = 0; j < n; j++)
+		{
+			P(j) = (positions.col(j) - trackingPositions.col(i)).norm();
+			Eigen::Vector3d o;
+			for (int k = 0; k < 3; k++)
+				o(k) = fmod(orientations(k,j) - trackingOrientations(k,i), 2);
+			O(j) = o.norm();
+		}
+		double alpha = sqrt((P.array() / O.array()).mean());
+		Eigen::VectorXd D = P + alpha * O;
+		Eigen::MatrixXd::Index expected;
+		D.minCoeff(&expected);
+		CHECK(D(indices[i]) == Approx(D(expected)));
+	}
+}
+
 } //namespace cxtest
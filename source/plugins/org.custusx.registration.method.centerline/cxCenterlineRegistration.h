@@ -16,6 +16,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxTransform3D.h"
 #include "org_custusx_registration_method_centerline_Export.h"
 #include "vtkForwardDeclarations.h"
+#include "cxTimedTransformMap.h"
 #include <map>
 #include "cxTransform3D.h"
 #include <vtkSmartPointer.h>
@@ -36,7 +37,6 @@ typedef std::vector< Eigen::Matrix4d > M4Vector;
 namespace cx
 {
 
-typedef std::map<double, Transform3D> TimedTransformMap;
 typedef vtkSmartPointer<vtkDoubleArray>             vtkDoubleArrayPtr;
 typedef vtkSmartPointer<vtkPoints>                  vtkPointsPtr;
 typedef vtkSmartPointer<vtkPolyData>                vtkPolyDataPtr;
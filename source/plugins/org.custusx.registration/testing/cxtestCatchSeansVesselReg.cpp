@@ -15,6 +15,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkPolyData.h>
 #include <vtkPolyDataWriter.h>
 #include <vtkCellArray.h>
+#include <vtkPoints.h>
 #include "cxMesh.h"
 #include "cxVector3D.h"
 #include "cxDataLocations.h"
@@ -25,6 +26,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QDir>
 #include "cxFileManagerServiceProxy.h"
 #include "cxLogicManager.h"
+#include "vtkCellLocator.h"
 
 
 TEST_CASE_METHOD(cxtest::SeansVesselRegFixture, "SeansVesselReg: V2V syntectic data", "[integration][modules][registration][not_win32]")
@@ -164,3 +166,76 @@ TEST_CASE_METHOD(cxtest::SeansVesselRegFixture, "SeansVesselReg: V2V registratio
 
 	cx::LogicManager::shutdown();
 }
+
+namespace
+{
+/** Copy of context searching the target with a vtkCellLocator instead of the k-d tree.
+ */
+cx::SeansVesselReg::ContextPtr createCellLocatorContext(cx::SeansVesselReg::ContextPtr context)
+{
+	cx::SeansVesselReg::ContextPtr retval(new cx::SeansVesselReg::Context(*context));
+	retval->mTargetKdTree.reset();
+	retval->mTargetPointLocator = vtkCellLocatorPtr::New();
+	retval->mTargetPointLocator->SetDataSet(retval->mTargetPoints);
+	retval->mTargetPointLocator->SetNumberOfCellsPerBucket(1);
+	retval->mTargetPointLocator->BuildLocator();
+	return retval;
+}
+
+double getMaxDistance(vtkPointsPtr a, vtkPointsPtr b)
+{
+	double retval = 0;
+	for (vtkIdType i = 0; i < a->GetNumberOfPoints(); ++i)
+		retval = std::max(retval, (cx::Vector3D(a->GetPoint(i)) - cx::Vector3D(b->GetPoint(i))).length());
+	return retval;
+}
+} // namespace
+
+TEST_CASE_METHOD(cxtest::SeansVesselRegFixture, "SeansVesselReg: k-d tree gives same distances as vtkCellLocator", "[unit][modules][registration]")
+{
+	std::vector<cx::Vector3D> pts;
+	cx::Vector3D a = this->append_pt(&pts, cx::Vector3D(0, 0, 0));
+	a = this->append_line(&pts, a, cx::Vector3D(0, 0, 10), 0.1);
+	this->append_line(&pts, a, cx::Vector3D(-3, 0, 15), 0.1);
+	this->append_line(&pts, a, cx::Vector3D(3, 0, 15), 0.1);
+	cx::MeshPtr target(new cx::Mesh("target", "target", this->generatePolyData(pts)));
+
+	// a sparser, displaced copy of the target
+	std::vector<cx::Vector3D> sourcePts;
+	cx::Transform3D perturbation = cx::createTransformTranslate(cx::Vector3D(0.3, -0.2, 0.1)) * cx::createTransformRotateX(3 / 180.0 * M_PI);
+	for (unsigned i = 0; i < pts.size(); i += 3)
+		sourcePts.push_back(perturbation.coord(pts[i]));
+	cx::MeshPtr source(new cx::Mesh("source", "source", this->generatePolyData(sourcePts)));
+
+	cx::SeansVesselReg vesselReg;
+	cx::SeansVesselReg::ContextPtr kdTreeContext = vesselReg.createContext(source, target);
+	REQUIRE(kdTreeContext);
+	REQUIRE(kdTreeContext->mTargetKdTree); // vertex-only target
+	cx::SeansVesselReg::ContextPtr locatorContext = createCellLocatorContext(kdTreeContext);
+
+	vesselReg.computeDistances(kdTreeContext);
+	vesselReg.computeDistances(locatorContext);
+
+	double tol = 1.0E-9;
+	CHECK(kdTreeContext->mMetric == Approx(locatorContext->mMetric).epsilon(tol));
+
+	// the LTS subset is unordered, and equidistant points may be swapped:
+	// compare each source point to its own closest target point.
+	vtkPointsPtr kdSource = kdTreeContext->mSortedSourcePoints;
+	vtkPointsPtr kdTarget = kdTreeContext->mSortedTargetPoints;
+	REQUIRE(kdSource->GetNumberOfPoints() == locatorContext->mSortedSourcePoints->GetNumberOfPoints());
+	for (vtkIdType i = 0; i < kdSource->GetNumberOfPoints(); ++i)
+	{
+		double closest[3];
+		vtkIdType cell_id;
+		int sub_id;
+		double distanceSquared = 0;
+		locatorContext->mTargetPointLocator->FindClosestPoint(kdSource->GetPoint(i), closest, cell_id, sub_id, distanceSquared);
+		double kdDistance = (cx::Vector3D(kdSource->GetPoint(i)) - cx::Vector3D(kdTarget->GetPoint(i))).length();
+		INFO("Point " << i);
+		CHECK(kdDistance == Approx(sqrt(distanceSquared)).epsilon(tol));
+	}
+
+	// the same subset is selected, apart from ties
+	CHECK(getMaxDistance(kdSource, kdTarget) == Approx(getMaxDistance(locatorContext->mSortedSourcePoints, locatorContext->mSortedTargetPoints)).epsilon(tol));
+}
@@ -12,6 +12,11 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxPNNReconstructionMethodService.h"
 
 #include <QFileInfo>
+#include <QThread>
+#include <QElapsedTimer>
+#include <cmath>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
 #include "cxLogger.h"
 #include "cxTypeConversions.h"
 #include "cxVolumeHelpers.h"
@@ -20,9 +25,52 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkImageData.h>
 #include "cxImage.h"
 #include "cxDoubleProperty.h"
+#include "cxBoolProperty.h"
 
 namespace cx
 {
+
+/** A range [zBegin, zEnd> of output slices processed by one worker,
+ *  along with the statistics gathered by that worker.
+ *
+ * Each worker writes only to voxels inside its own slab, thus
+ * the slabs can be processed concurrently without locking.
+ */
+struct PNNReconstructionMethodService::Slab
+{
+	Slab(int begin, int end) : zBegin(begin), zEnd(end), removed(0), ignored(0), elapsedms(0) {}
+	int zBegin;
+	int zEnd;
+	int removed;
+	int ignored;
+	int elapsedms;
+};
+
+/** Shared read-only input for the frame scatter step.
+ */
+struct PNNReconstructionMethodService::ScatterInput
+{
+	std::vector<unsigned char*> frames;
+	std::vector<boost::array<double, 16> > transforms;
+	unsigned char* mask;
+	Eigen::Array3i inputDims;
+	Vector3D inputSpacing;
+	unsigned char* output;
+	Eigen::Array3i outputDims;
+	Vector3D outputSpacing;
+};
+
+/** Shared read-only input for the hole filling step.
+ */
+struct PNNReconstructionMethodService::FillInput
+{
+	unsigned char* input;
+	unsigned char* output;
+	unsigned char* mask;
+	Eigen::Array3i dims;
+	int interpolationSteps;
+};
+
 PNNReconstructionMethodService::PNNReconstructionMethodService(ctkPluginContext* context)
 {
 }
@@ -39,6 +87,15 @@ std::vector<PropertyPtr> PNNReconstructionMethodService::getSettings(QDomElement
 {
 	std::vector<PropertyPtr> retval;
 	retval.push_back(this->getInterpolationStepsOption(root));
+	retval.push_back(this->getParallelOption(root));
+	return retval;
+}
+
+BoolPropertyPtr PNNReconstructionMethodService::getParallelOption(QDomElement root)
+{
+	BoolPropertyPtr retval;
+	retval = BoolProperty::initialize("parallel", "Parallel",
+		"Split the output volume into slabs and reconstruct them concurrently", true, root);
 	return retval;
 }
 
@@ -93,50 +150,132 @@ bool PNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input,
 	Vector3D inputSpacing(input->getSpacing());
 	Vector3D outputSpacing(tempOutput->GetSpacing());
 
-	//Get raw data pointers
-	unsigned char *outputPointer = static_cast<unsigned char*> (tempOutput->GetScalarPointer());
-	unsigned char* maskPointer = static_cast<unsigned char*> (input->getMask()->GetScalarPointer());
-
-	// Traverse all input pixels
+	ScatterInput scatter;
+	scatter.mask = static_cast<unsigned char*> (input->getMask()->GetScalarPointer());
+	scatter.inputDims = inputDims;
+	scatter.inputSpacing = inputSpacing;
+	scatter.output = static_cast<unsigned char*> (tempOutput->GetScalarPointer());
+	scatter.outputDims = Eigen::Array3i(outputDims);
+	scatter.outputSpacing = outputSpacing;
+	// Fetch all frame pointers up front: the workers should not touch VTK objects.
 	for (int record = 0; record < inputDims[2]; record++)
 	{
-		unsigned char *inputPointer = input->getFrame(record);
-		boost::array<double, 16> recordTransform = frameInfo[record].mPos.flatten();
+		scatter.frames.push_back(input->getFrame(record));
+		scatter.transforms.push_back(frameInfo[record].mPos.flatten());
+	}
+
+	// Traverse all input pixels, each slab picks the pixels hitting its own part of the output
+	bool parallel = this->getParallelOption(settings)->getValue();
+	std::vector<Slab> slabs = this->createSlabs(outputDims[2], parallel);
+	TimeKeeper timer;
+	QtConcurrent::blockingMap(slabs, boost::bind(&PNNReconstructionMethodService::scatterSlab, this, boost::cref(scatter), _1));
+	QString scatterTiming = QString("Scatter [threads=%1, %2s, speedup=%3]")
+			.arg(parallel ? QThread::idealThreadCount() : 1)
+			.arg(timer.getElapsedSecondsAsString())
+			.arg(this->computeSpeedup(slabs, timer.getElapsedms()), 0, 'f', 1);
+
+	// Fill holes
+	this->interpolate(tempOutputData, outputData, settings, scatterTiming);
+
+	setDeepModified(outputData);
+	return true;
+}
+
+/**Split the z range of the output volume into slabs.
+ * Use several slabs per thread in order to balance the load,
+ * as the sweep usually covers the volume unevenly.
+ */
+std::vector<PNNReconstructionMethodService::Slab> PNNReconstructionMethodService::createSlabs(int zDim, bool parallel) const
+{
+	int count = 1;
+	if (parallel)
+		count = std::max(1, std::min(zDim, 4*QThread::idealThreadCount()));
+
+	std::vector<Slab> retval;
+	for (int i = 0; i < count; ++i)
+		retval.push_back(Slab(i*zDim/count, (i+1)*zDim/count));
+	return retval;
+}
+
+/**Return the accumulated time spent by all workers divided by the wall time,
+ * i.e. the speedup gained compared to running the same work on one thread.
+ */
+double PNNReconstructionMethodService::computeSpeedup(const std::vector<Slab>& slabs, int wallms) const
+{
+	double work = 0;
+	for (unsigned i = 0; i < slabs.size(); ++i)
+		work += slabs[i].elapsedms;
+	return work / std::max(wallms, 1);
+}
+
+/**Scatter all input pixels that hit the given slab into the output volume.
+ *
+ * The output z coordinate is linear along each beam, thus the range of
+ * samples hitting the slab can be found directly, and each pixel is
+ * transformed by only one worker.
+ */
+void PNNReconstructionMethodService::scatterSlab(const ScatterInput& input, Slab& slab)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	const Eigen::Array3i& inputDims = input.inputDims;
+	const Vector3D& inputSpacing = input.inputSpacing;
+	const Vector3D& outputSpacing = input.outputSpacing;
+	const int* outputDims = input.outputDims.data();
+	unsigned char* outputPointer = input.output;
+
+	for (unsigned record = 0; record < input.frames.size(); record++)
+	{
+		unsigned char *inputPointer = input.frames[record];
+		const double* t = input.transforms[record].begin();
+
+		// z in voxel units along a beam: zv(sample) = zStart + sample*zStep
+		double zStep = t[9] * inputSpacing[1] / outputSpacing[2];
 
 		for (int beam = 0; beam < inputDims[0]; beam++)
 		{
-			for (int sample = 0; sample < inputDims[1]; sample++)
+			double zStart = (t[8] * beam * inputSpacing[0] + t[11]) / outputSpacing[2];
+
+			// conservative sample range, the exact test is done per pixel below
+			int sampleBegin = 0;
+			int sampleEnd = inputDims[1];
+			if (std::fabs(zStep) > 1.0E-9)
 			{
-				if (!validPixel(beam, sample, inputDims, maskPointer))
+				double s0 = (slab.zBegin - 1.5 - zStart) / zStep;
+				double s1 = (slab.zEnd + 0.5 - zStart) / zStep;
+				sampleBegin = static_cast<int>(std::max<double>(sampleBegin, std::floor(std::min(s0, s1))));
+				sampleEnd = static_cast<int>(std::min<double>(sampleEnd, std::ceil(std::max(s0, s1)) + 1));
+			}
+
+			for (int sample = sampleBegin; sample < sampleEnd; sample++)
+			{
+				if (!validPixel(beam, sample, inputDims, input.mask))
 					continue;
-				Vector3D inputPoint(beam * inputSpacing[0], sample * inputSpacing[1], 0.0);
-				Vector3D outputPoint = inputPoint;
-				optimizedCoordTransform(&outputPoint, recordTransform);
+				Vector3D outputPoint(beam * inputSpacing[0], sample * inputSpacing[1], 0.0);
+				optimizedCoordTransform(&outputPoint, input.transforms[record]);
 				int outputVoxelX = static_cast<int> ((outputPoint[0] / outputSpacing[0]) + 0.5);
 				int outputVoxelY = static_cast<int> ((outputPoint[1] / outputSpacing[1]) + 0.5);
 				int outputVoxelZ = static_cast<int> ((outputPoint[2] / outputSpacing[2]) + 0.5);
 
-				if (validVoxel(outputVoxelX, outputVoxelY, outputVoxelZ, outputDims))
-				{
-					int outputIndex = outputVoxelX + outputVoxelY * outputDims[0] + outputVoxelZ * outputDims[0]
-						* outputDims[1];
-					int inputIndex = beam + sample * inputDims[0];
+				if ((outputVoxelZ < slab.zBegin) || (outputVoxelZ >= slab.zEnd))
+					continue;
+				if (!validVoxel(outputVoxelX, outputVoxelY, outputVoxelZ, outputDims))
+					continue;
 
-					// assign the max value found from all frames hitting this voxel. This removes black areas where (some of) multiple sweeps contains shadows.
-					outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], outputPointer[outputIndex]);
-					// set minimum intensity value to 1. This separates "zero intensity" from "no intensity".
-					outputPointer[outputIndex] = std::max<unsigned char>(inputPointer[inputIndex], 1); //
-				}//validVoxel
+				int outputIndex = outputVoxelX + outputVoxelY * outputDims[0] + outputVoxelZ * outputDims[0]
+					* outputDims[1];
+				int inputIndex = beam + sample * inputDims[0];
 
+				// assign the max value found from all frames hitting this voxel. This removes black areas where (some of) multiple sweeps contains shadows.
+				// set minimum intensity value to 1. This separates "zero intensity" from "no intensity".
+				unsigned char value = std::max<unsigned char>(inputPointer[inputIndex], 1);
+				outputPointer[outputIndex] = std::max<unsigned char>(value, outputPointer[outputIndex]);
 			}//sample
 		}//beam
 	}//record
 
-	// Fill holes
-	this->interpolate(tempOutputData, outputData, settings);
-
-	setDeepModified(outputData);
-	return true;
+	slab.elapsedms = timer.elapsed();
 }
 
 namespace
@@ -227,11 +366,12 @@ vtkImageDataPtr PNNReconstructionMethodService::createMask(vtkImageDataPtr input
 	return mask;
 }
 
-void PNNReconstructionMethodService::interpolate(ImagePtr inputData, vtkImageDataPtr outputData, QDomElement settings)
+void PNNReconstructionMethodService::interpolate(ImagePtr inputData, vtkImageDataPtr outputData, QDomElement settings, QString scatterTiming)
 {
 	TimeKeeper timer;
 	DoublePropertyPtr interpolationStepsOption = this->getInterpolationStepsOption(settings);
 	int interpolationSteps = static_cast<int> (interpolationStepsOption->getValue());
+	bool parallel = this->getParallelOption(settings)->getValue();
 
 	vtkImageDataPtr input = inputData->getBaseVtkImageData();
 	vtkImageDataPtr output = outputData;
@@ -241,58 +381,84 @@ void PNNReconstructionMethodService::interpolate(ImagePtr inputData, vtkImageDat
 
 	Eigen::Array3i inputDims(input->GetDimensions());
 
-	unsigned char *inputPointer = static_cast<unsigned char*> (input->GetScalarPointer());
-	unsigned char *outputPointer = static_cast<unsigned char*> (output->GetScalarPointer());
-	unsigned char *maskPointer = static_cast<unsigned char*> (mask->GetScalarPointer());
+	FillInput fill;
+	fill.input = static_cast<unsigned char*> (input->GetScalarPointer());
+	fill.output = static_cast<unsigned char*> (output->GetScalarPointer());
+	fill.mask = static_cast<unsigned char*> (mask->GetScalarPointer());
+	fill.dims = outputDims;
+	fill.interpolationSteps = interpolationSteps;
 
 	if ((outputDims[0] != inputDims[0]) || (outputDims[1] != inputDims[1]) || (outputDims[2] != inputDims[2]))
 		reportWarning("outputDims != inputDims. output: " + qstring_cast(outputDims[0]) + " "
 			+ qstring_cast(outputDims[1]) + " " + qstring_cast(outputDims[2]) + " input: " + qstring_cast(inputDims[0])
 			+ " " + qstring_cast(inputDims[1]) + " " + qstring_cast(inputDims[2]));
 
+	// Traverse all voxels, one slab per worker
+	std::vector<Slab> slabs = this->createSlabs(outputDims[2], parallel);
+	QtConcurrent::blockingMap(slabs, boost::bind(&PNNReconstructionMethodService::interpolateSlab, this, boost::cref(fill), _1));
+
 	int total = outputDims[0] * outputDims[1] * outputDims[2];
 	int removed = 0;
 	int ignored = 0;
-	// Traverse all voxels
-	for (int x = 0; x < outputDims[0]; x++)
+	for (unsigned i = 0; i < slabs.size(); ++i)
+	{
+		removed += slabs[i].removed;
+		ignored += slabs[i].ignored;
+	}
+
+	int valid = 100*double(ignored)/double(total);
+	int outside = 100*double(removed)/double(total);
+	int holes = 100*double(total-ignored-removed)/double(total);
+	reportDebug(
+				QString("PNN: Size: %1Mb, Valid voxels: %2\%, Outside mask: %3\%  Filled holes [steps=%4, %5s, speedup=%7]: %6\%, %8")
+				.arg(total/1024/1024)
+				.arg(valid)
+				.arg(outside)
+				.arg(interpolationSteps)
+				.arg(timer.getElapsedSecondsAsString())
+				.arg(holes)
+				.arg(this->computeSpeedup(slabs, timer.getElapsedms()), 0, 'f', 1)
+				.arg(scatterTiming));
+}
+
+/**Copy or hole fill all voxels in the slab.
+ * Voxels are traversed in memory order (x innermost).
+ */
+void PNNReconstructionMethodService::interpolateSlab(const FillInput& input, Slab& slab)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	const Eigen::Array3i& dims = input.dims;
+
+	for (int z = slab.zBegin; z < slab.zEnd; z++)
 	{
-		for (int y = 0; y < outputDims[1]; y++)
+		for (int y = 0; y < dims[1]; y++)
 		{
-			for (int z = 0; z < outputDims[2]; z++)
+			int outputIndex = y * dims[0] + z * dims[0] * dims[1];
+			for (int x = 0; x < dims[0]; x++, outputIndex++)
 			{
-				int outputIndex = x + y * outputDims[0] + z * outputDims[0] * outputDims[1];
-
 				// ignore if outside volume of interest
-				if (maskPointer[outputIndex]==0)
+				if (input.mask[outputIndex]==0)
 				{
-					removed++;
+					slab.removed++;
 				}
 				// copy if value already exists
-				else if (inputPointer[outputIndex]>0)
+				else if (input.input[outputIndex]>0)
 				{
-					outputPointer[outputIndex] = inputPointer[outputIndex];
-					ignored++;
+					input.output[outputIndex] = input.input[outputIndex];
+					slab.ignored++;
 				}
 				// fill hole otherwise (empty space within the volume)
 				else
 				{
-					this->fillHole(inputPointer, outputPointer, x, y, z, outputDims, interpolationSteps);
+					this->fillHole(input.input, input.output, x, y, z, dims, input.interpolationSteps);
 				}
-			}//z
+			}//x
 		}//y
-	}//x
+	}//z
 
-	int valid = 100*double(ignored)/double(total);
-	int outside = 100*double(removed)/double(total);
-	int holes = 100*double(total-ignored-removed)/double(total);
-	reportDebug(
-				QString("PNN: Size: %1Mb, Valid voxels: %2\%, Outside mask: %3\%  Filled holes [steps=%4, %5s]: %6\%")
-				.arg(total/1024/1024)
-				.arg(valid)
-				.arg(outside)
-				.arg(interpolationSteps)
-				.arg(timer.getElapsedSecondsAsString())
-				.arg(holes));
+	slab.elapsedms = timer.elapsed();
 }
 
 /**Fill the empty voxel (x,y,z) with the average value of the surrounding box.
@@ -43,6 +43,7 @@ public:
 	virtual std::vector<PropertyPtr> getSettings(QDomElement root);
 	virtual bool reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, QDomElement settings);
 
+	BoolPropertyPtr getParallelOption(QDomElement root);
 
 private:
 	DoublePropertyPtr getInterpolationStepsOption(QDomElement root);
@@ -56,7 +57,15 @@ private:
 		return (x >= 0) && (x < dims[0]) && (y >= 0) && (y < dims[1]) && (z >= 0) && (z < dims[2]);
 	}
 
-	void interpolate(ImagePtr inputData, vtkImageDataPtr outputData, QDomElement settings);
+	struct Slab;
+	struct ScatterInput;
+	struct FillInput;
+	std::vector<Slab> createSlabs(int zDim, bool parallel) const;
+	double computeSpeedup(const std::vector<Slab>& slabs, int wallms) const;
+
+	void scatterSlab(const ScatterInput& input, Slab& slab);
+	void interpolate(ImagePtr inputData, vtkImageDataPtr outputData, QDomElement settings, QString scatterTiming);
+	void interpolateSlab(const FillInput& input, Slab& slab);
 	vtkImageDataPtr createMask(vtkImageDataPtr inputData);
 	void fillHole(unsigned char *inputPointer, unsigned char *outputPointer, int x, int y, int z, const Eigen::Array3i& dim, int interpolationSteps);
 
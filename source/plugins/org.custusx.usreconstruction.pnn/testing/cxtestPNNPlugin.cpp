@@ -18,6 +18,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxtestUtilities.h"
 #include "cxLogicManager.h"
 #include "cxFileManagerServiceProxy.h"
+#include "cxBoolProperty.h"
+#include "cxImage.h"
+#include <vtkImageData.h>
 
 namespace cxtest
 {
@@ -86,6 +89,87 @@ TEST_CASE("ReconstructAlgorithm: PNN on sphere, tilt","[unit][usreconstruction][
 	cx::LogicManager::shutdown();
 }
 
+TEST_CASE("ReconstructAlgorithm: PNN on sphere, serial","[unit][usreconstruction][synthetic][pnn]")
+{
+	cx::LogicManager::initialize();
+	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
+
+	ReconstructionAlgorithmFixture fixture;
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement("pnn");
+
+	fixture.setOverallBoundsAndSpacing(100, 5);
+	fixture.getInputGenerator()->setSpherePhantom();
+
+	cx::PNNReconstructionMethodService* algorithm = new cx::PNNReconstructionMethodService(pluginContext);
+	algorithm->getParallelOption(settings)->setValue(false);
+	fixture.setAlgorithm(algorithm);
+	fixture.reconstruct(settings);
+
+	fixture.checkRMSBelow(20.0);
+	fixture.checkCentroidDifferenceBelow(1);
+	fixture.checkMassDifferenceBelow(0.01);
+
+	cx::LogicManager::shutdown();
+}
+
+namespace
+{
+vtkImageDataPtr reconstructSphereWithPNN(ctkPluginContext* pluginContext, bool parallel)
+{
+	ReconstructionAlgorithmFixture fixture;
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement("pnn");
+
+	SyntheticReconstructInputPtr generator = fixture.getInputGenerator();
+	generator->defineProbeMovementSteps(40);
+	generator->defineProbeMovementNormalizedTranslationRange(0.8);
+	generator->defineProbeMovementAngleRange(M_PI/6);
+	generator->defineProbe(cx::DummyToolTestUtilities::createProbeDefinitionLinear(100, 100, Eigen::Array2i(150,150)));
+	generator->setSpherePhantom();
+	fixture.defineOutputVolume(100, 2);
+
+	cx::PNNReconstructionMethodService* algorithm = new cx::PNNReconstructionMethodService(pluginContext);
+	algorithm->getParallelOption(settings)->setValue(parallel);
+	fixture.setAlgorithm(algorithm);
+	fixture.reconstruct(settings);
+
+	return fixture.getOutput()->getBaseVtkImageData();
+}
+} // namespace
+
+TEST_CASE("ReconstructAlgorithm: PNN parallel and serial give identical output","[unit][usreconstruction][synthetic][pnn]")
+{
+	cx::LogicManager::initialize();
+	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
+
+	// the tilted sweep leaves holes, thus both scatter and hole filling are compared
+	vtkImageDataPtr serial = reconstructSphereWithPNN(pluginContext, false);
+	vtkImageDataPtr parallel = reconstructSphereWithPNN(pluginContext, true);
+
+	REQUIRE(serial);
+	REQUIRE(parallel);
+	REQUIRE(Eigen::Array3i(serial->GetDimensions()).isApprox(Eigen::Array3i(parallel->GetDimensions())));
+
+	unsigned char* serialPtr = static_cast<unsigned char*>(serial->GetScalarPointer());
+	unsigned char* parallelPtr = static_cast<unsigned char*>(parallel->GetScalarPointer());
+	vtkIdType size = serial->GetNumberOfPoints();
+	vtkIdType differing = 0;
+	vtkIdType nonzero = 0;
+	for (vtkIdType i = 0; i < size; ++i)
+	{
+		if (serialPtr[i] != parallelPtr[i])
+			++differing;
+		if (serialPtr[i])
+			++nonzero;
+	}
+
+	CHECK(nonzero > 0);
+	CHECK(differing == 0);
+
+	cx::LogicManager::shutdown();
+}
+
 } // namespace cxtest
 
 
@@ -0,0 +1,734 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxVNNAlgorithm.h"
+
+#include <cmath>
+#include <limits>
+#include <QElapsedTimer>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include "cxLogger.h"
+#include "cxVolumeHelpers.h"
+#include "cxUSFramePlaneIndex.h"
+
+namespace cx
+{
+
+namespace
+{
+/** Side length of the voxel cubes processed as a unit. Same as in kernels.cl.h. */
+const int CUBE_SIZE = 4;
+
+/** Same as close_plane_t in kernels.cl.h */
+struct ClosePlane
+{
+	float dist;
+	int planeId;
+	unsigned char intensity;
+};
+
+/** Per-task scratch memory, corresponding to the __local memory of the kernel. */
+struct Scratch
+{
+	std::vector<float> absDists;
+	std::vector<ClosePlane> closePlanes;
+	std::vector<int> guesses;
+	std::vector<float> guessDists; ///< |dist| to each of the guesses
+	std::vector<int> candidates; ///< sorted ids of the planes that can contribute to the current cube
+};
+} // namespace
+
+/** Input shared by all workers. Read only during reconstruction,
+ *  except for the output volume, where each worker writes its own cubes.
+ */
+struct VNNAlgorithm::Context
+{
+	Settings settings;
+	int maxStarts;
+	bool doTermDistance;
+
+	int nPlanes;
+	int inDims[2];
+	float inSpacing[2];
+	std::vector<const unsigned char*> frames;
+	const unsigned char* mask;
+
+	int outDims[3];
+	float outSpacing[3];
+	unsigned char* output;
+
+	USFramePlaneIndexPtr planeIndex; ///< zero if not available: all planes are candidates
+
+	// Plane equations n*v+w, structure of arrays.
+	std::vector<float> nx, ny, nz, nw;
+	// In-plane axes and origin of each plane, for projection into image coordinates.
+	std::vector<float> ux, uy, uz, vx, vy, vz, tx, ty, tz;
+
+	float dist(const float* voxel, int plane) const
+	{
+		return nx[plane]*voxel[0] + ny[plane]*voxel[1] + nz[plane]*voxel[2] + nw[plane];
+	}
+};
+
+namespace
+{
+typedef VNNAlgorithm::Context Context;
+
+/** Compute |dist| from voxel to all planes. Plain loop over contiguous arrays, vectorizable. */
+void computeAbsDistances(const Context& ctx, const float* voxel, float* absDists)
+{
+	const float* nx = &ctx.nx[0];
+	const float* ny = &ctx.ny[0];
+	const float* nz = &ctx.nz[0];
+	const float* nw = &ctx.nw[0];
+	const float x = voxel[0];
+	const float y = voxel[1];
+	const float z = voxel[2];
+	for (int i = 0; i < ctx.nPlanes; ++i)
+		absDists[i] = std::fabs(nx[i]*x + ny[i]*y + nz[i]*z + nw[i]);
+}
+
+/** Project voxel dist along the normal of plane, return floating point image coordinates. */
+void toImgCoord_float(const Context& ctx, const float* voxel, int plane, float dist, float* p)
+{
+	float x = voxel[0] - dist*ctx.nx[plane] - ctx.tx[plane];
+	float y = voxel[1] - dist*ctx.ny[plane] - ctx.ty[plane];
+	float z = voxel[2] - dist*ctx.nz[plane] - ctx.tz[plane];
+	p[0] = (ctx.ux[plane]*x + ctx.uy[plane]*y + ctx.uz[plane]*z) / ctx.inSpacing[0];
+	p[1] = (ctx.vx[plane]*x + ctx.vy[plane]*y + ctx.vz[plane]*z) / ctx.inSpacing[1];
+}
+
+void round_int(const float* p, int* retval)
+{
+	retval[0] = static_cast<int>(p[0] + 0.5f);
+	retval[1] = static_cast<int>(p[1] + 0.5f);
+}
+
+bool isValidPixel(const Context& ctx, const int* p)
+{
+	return (p[0] >= 0) && (p[0] < ctx.inDims[0])
+			&& (p[1] >= 0) && (p[1] < ctx.inDims[1])
+			&& (ctx.mask[p[0] + p[1]*ctx.inDims[0]] > 0);
+}
+
+bool isValidProjection(const Context& ctx, const float* voxel, int plane, float dist)
+{
+	float p[2];
+	int ip[2];
+	toImgCoord_float(ctx, voxel, plane, dist, p);
+	round_int(p, ip);
+	return isValidPixel(ctx, ip);
+}
+
+/** Bilinear interpolation in image. Unlike the kernel, the upper neighbours
+ *  are clamped to the image in order to avoid reading outside the frame.
+ */
+float bilinearInterpolation(const Context& ctx, float x, float y, const unsigned char* image)
+{
+	int x0 = static_cast<int>(x);
+	int y0 = static_cast<int>(y);
+	float dx = x - x0;
+	float dy = y - y0;
+	int x1 = std::min(x0+1, ctx.inDims[0]-1);
+	int y1 = std::min(y0+1, ctx.inDims[1]-1);
+	int w = ctx.inDims[0];
+
+	return image[x0 + y0*w] * (1.0f-dx)*(1.0f-dy)
+			+ image[x1 + y0*w] * dx*(1.0f-dy)
+			+ image[x1 + y1*w] * dx*dy
+			+ image[x0 + y1*w] * (1.0f-dx)*dy;
+}
+
+int findHighestIdx(const ClosePlane* planes, int n)
+{
+	int maxidx = 0;
+	float maxval = -1.0f;
+	for (int i = 0; i < n; i++)
+	{
+		float abs = std::fabs(planes[i].dist);
+		if (abs > maxval)
+		{
+			maxidx = i;
+			maxval = abs;
+		}
+	}
+	return maxidx;
+}
+
+/** Port of findLocalMinimas() in kernels.cl: find start guesses for the plane search.
+ *
+ *  With a plane index, only the candidate planes are searched. The planes
+ *  skipped between two candidates pass outside the cube, and are treated
+ *  as a high between the minima.
+ */
+int findLocalMinimas(const Context& ctx, const float* voxel, Scratch& scratch)
+{
+	const bool useCandidates = (ctx.planeIndex.get() != NULL);
+	const int nSearch = useCandidates ? int(scratch.candidates.size()) : ctx.nPlanes;
+	const int* candidates = useCandidates ? &scratch.candidates[0] : NULL;
+	int* guesses = &scratch.guesses[0];
+	float* guessDists = &scratch.guessDists[0];
+	float* absDists = &scratch.absDists[0];
+	if (useCandidates)
+	{
+		for (int k = 0; k < nSearch; k++)
+			absDists[k] = std::fabs(ctx.dist(voxel, candidates[k]));
+	}
+	else
+	{
+		computeAbsDistances(ctx, voxel, absDists);
+	}
+
+	float cx = ctx.outSpacing[0]*CUBE_SIZE;
+	float cy = ctx.outSpacing[1]*CUBE_SIZE;
+	float cz = ctx.outSpacing[2]*CUBE_SIZE;
+	float max_dist = std::sqrt(cx*cx + cy*cy + cz*cz) + ctx.settings.radius;
+
+	int nMinima = 1;
+	int prev_pos = 0;
+	guesses[0] = 0;
+	guessDists[0] = std::fabs(ctx.dist(voxel, 0));
+	bool hasHighSinceLastTaken = true;
+	for (int k = 0; k < nSearch; k++)
+	{
+		int i = useCandidates ? candidates[k] : k;
+		float dist = absDists[k];
+		if (useCandidates && (k > 0) && (i != candidates[k-1]+1))
+			hasHighSinceLastTaken = true;
+		if (dist >= max_dist)
+		{
+			hasHighSinceLastTaken = true;
+			continue;
+		}
+
+		if (!hasHighSinceLastTaken)
+		{
+			// previous minima is too close, replace it if this one is better
+			if (dist < guessDists[prev_pos])
+			{
+				guesses[prev_pos] = i;
+				guessDists[prev_pos] = dist;
+			}
+		}
+		else if (nMinima < ctx.maxStarts)
+		{
+			guesses[nMinima] = i;
+			guessDists[nMinima] = dist;
+			prev_pos = nMinima;
+			hasHighSinceLastTaken = false;
+			nMinima++;
+		}
+		else
+		{
+			// replace the worst minima
+			float biggest = -std::numeric_limits<float>::infinity();
+			int biggest_idx = 0;
+			hasHighSinceLastTaken = false;
+			for (int j = 0; j < nMinima; j++)
+			{
+				if (guessDists[j] > biggest)
+				{
+					biggest_idx = j;
+					biggest = guessDists[j];
+				}
+			}
+			if (biggest > dist)
+			{
+				guesses[biggest_idx] = i;
+				guessDists[biggest_idx] = dist;
+				prev_pos = biggest_idx;
+			}
+		}
+	}
+	return nMinima;
+}
+
+/** Port of findClosestPlanes_heuristic() in kernels.cl.
+ *  Search both ways from guess, insert planes within radius into closePlanes.
+ *  Return number of planes found, smallestIdx is set to the closest plane.
+ */
+int findClosestPlanes_heuristic(const Context& ctx, const float* voxel, int guess, ClosePlane* closePlanes, int* smallestIdx)
+{
+	const int maxPlanes = ctx.settings.maxPlanes;
+	const float radius = ctx.settings.radius;
+	const int nPlanes = ctx.nPlanes;
+
+	int found = 0;
+	bool doneUp = false;
+	bool doneDown = false;
+	*smallestIdx = guess;
+
+	float term_condition = std::min(std::max(std::fabs(ctx.dist(voxel, guess)), radius), 3*radius);
+	float smallest_dist = 99999.9f;
+
+	int max_idx = findHighestIdx(closePlanes, maxPlanes);
+	float max_dist = std::min(std::fabs(closePlanes[max_idx].dist), radius);
+
+	// plane -1 does not exist, assume plane 1 is close enough
+	if (guess == 0)
+		guess = 1;
+
+	for (int i = 0; !doneUp || !doneDown; i++)
+	{
+		int idx[2] = { std::min(guess + i, nPlanes-1), std::max(guess - i - 1, 0) };
+		bool* done[2] = { &doneUp, &doneDown };
+
+		for (int d = 0; d < 2; ++d)
+		{
+			float dist = ctx.dist(voxel, idx[d]);
+			float abs_dist = std::fabs(dist);
+
+			if (!*done[d] && abs_dist < max_dist && isValidProjection(ctx, voxel, idx[d], dist))
+			{
+				// swap out the plane with the longest distance
+				closePlanes[max_idx].dist = dist;
+				closePlanes[max_idx].planeId = idx[d];
+				closePlanes[max_idx].intensity = 0;
+				found++;
+
+				max_idx = findHighestIdx(closePlanes, maxPlanes);
+				max_dist = std::min(std::fabs(closePlanes[max_idx].dist), radius);
+
+				if (smallest_dist > abs_dist)
+				{
+					smallest_dist = abs_dist;
+					*smallestIdx = idx[d];
+				}
+			}
+
+			if (ctx.doTermDistance && abs_dist > term_condition)
+				*done[d] = true;
+		}
+
+		if (idx[0] == nPlanes-1)
+			doneUp = true;
+		if (idx[1] == 0)
+			doneDown = true;
+	}
+
+	return std::min(found, maxPlanes);
+}
+
+void resetClosePlanes(const Context& ctx, ClosePlane* closePlanes)
+{
+	for (int i = 0; i < ctx.settings.maxPlanes; i++)
+	{
+		closePlanes[i].dist = std::numeric_limits<float>::infinity();
+		closePlanes[i].planeId = -1;
+		closePlanes[i].intensity = 0;
+	}
+}
+
+/** Port of findClosestPlanes_multistart() in kernels.cl.
+ *  Updates the guesses to the closest planes found, for use in the next voxel.
+ */
+int findClosestPlanes_multistart(const Context& ctx, const float* voxel, int nGuesses, Scratch& scratch)
+{
+	ClosePlane* closePlanes = &scratch.closePlanes[0];
+	resetClosePlanes(ctx, closePlanes);
+
+	int found = 0;
+	for (int i = 0; i < nGuesses; i++)
+	{
+		int smallestIdx = 0;
+		int foundHere = findClosestPlanes_heuristic(ctx, voxel, scratch.guesses[i], closePlanes, &smallestIdx);
+		if (foundHere > 0)
+			scratch.guesses[i] = smallestIdx;
+		found += foundHere;
+	}
+
+	return std::min(found, ctx.settings.maxPlanes);
+}
+
+/** Exhaustive search through the candidate planes from the plane index.
+ *  Gives the same result as the Closest plane method, without visiting all planes.
+ */
+int findClosestPlanes_candidates(const Context& ctx, const float* voxel, Scratch& scratch)
+{
+	ClosePlane* closePlanes = &scratch.closePlanes[0];
+	resetClosePlanes(ctx, closePlanes);
+
+	const int maxPlanes = ctx.settings.maxPlanes;
+	const float radius = ctx.settings.radius;
+	int max_idx = 0;
+	float max_dist = radius;
+	int found = 0;
+
+	for (unsigned k = 0; k < scratch.candidates.size(); ++k)
+	{
+		int plane = scratch.candidates[k];
+		float dist = ctx.dist(voxel, plane);
+		if (std::fabs(dist) < max_dist && isValidProjection(ctx, voxel, plane, dist))
+		{
+			closePlanes[max_idx].dist = dist;
+			closePlanes[max_idx].planeId = plane;
+			closePlanes[max_idx].intensity = 0;
+			found++;
+
+			max_idx = findHighestIdx(closePlanes, maxPlanes);
+			max_dist = std::min(std::fabs(closePlanes[max_idx].dist), radius);
+		}
+	}
+
+	return std::min(found, maxPlanes);
+}
+
+unsigned char performInterpolation_vnn(const Context& ctx, const float* voxel, const ClosePlane* closePlanes, int nClosePlanes)
+{
+	if (nClosePlanes == 0)
+		return 1;
+
+	int plane_id = 0;
+	float lowest_dist = 10.0f;
+	int close_plane_id = 0;
+	for (int i = 0; i < nClosePlanes; i++)
+	{
+		float fabs_dist = std::fabs(closePlanes[i].dist);
+		if (fabs_dist < lowest_dist)
+		{
+			lowest_dist = fabs_dist;
+			plane_id = closePlanes[i].planeId;
+			close_plane_id = i;
+		}
+	}
+
+	float p[2];
+	int ip[2];
+	toImgCoord_float(ctx, voxel, plane_id, closePlanes[close_plane_id].dist, p);
+	round_int(p, ip);
+	if (!isValidPixel(ctx, ip))
+		return 1;
+
+	return std::max<unsigned char>(1, ctx.frames[plane_id][ip[1]*ctx.inDims[0] + ip[0]]);
+}
+
+/** VNN2 and DW: distance weighted sum of the closest or bilinearly interpolated pixel in each plane.
+ */
+unsigned char performInterpolation_weighted(const Context& ctx, const float* voxel, const ClosePlane* closePlanes, int nClosePlanes, bool bilinear)
+{
+	if (nClosePlanes == 0)
+		return 1;
+
+	float scale = 0.0f;
+	float val = 0;
+	for (int i = 0; i < nClosePlanes; i++)
+	{
+		int plane_id = closePlanes[i].planeId;
+		const unsigned char* image = ctx.frames[plane_id];
+
+		float p[2];
+		int ip[2];
+		toImgCoord_float(ctx, voxel, plane_id, closePlanes[i].dist, p);
+		round_int(p, ip);
+		if (!isValidPixel(ctx, ip))
+			continue;
+
+		float value;
+		if (bilinear)
+			value = bilinearInterpolation(ctx, p[0], p[1], image);
+		else
+			value = image[ip[1]*ctx.inDims[0] + ip[0]];
+
+		float dist = std::max(std::fabs(closePlanes[i].dist), 0.001f);
+		float weight = 1.0f/dist;
+		scale += weight;
+		val += value * weight;
+	}
+
+	if (scale == 0.0f)
+		return 1;
+	return std::max<unsigned char>(1, static_cast<unsigned char>(val / scale));
+}
+
+float weightGauss(float x, float sigma)
+{
+	const float sqrt_2pi = 2.506628275f;
+	return (1.0f/(sigma*sqrt_2pi)) * std::exp(-(x*x)/(2*sigma*sigma));
+}
+
+unsigned char anisotropicFilter(const Context& ctx, const ClosePlane* pixels, int n_planes)
+{
+	float mean_value = 0.0f;
+	int sum_ids = 0;
+	for (int i = 0; i < n_planes; i++)
+	{
+		mean_value += pixels[i].intensity;
+		sum_ids += pixels[i].planeId;
+	}
+	float mean_id = float(sum_ids) / n_planes;
+	mean_value = mean_value / n_planes;
+
+	float variance = 0.0f;
+	for (int i = 0; i < n_planes; i++)
+	{
+		float tmp = pixels[i].intensity - mean_value;
+		variance += tmp*tmp;
+	}
+
+	// We want high variance regions to have a sharp weight function
+	// and small variance regions to have a smooth weight function.
+	variance = (n_planes > 1) ? variance/(n_planes-1) : 10000000.0f;
+	variance = std::min(std::max(variance, 1.0f), 10000000.0f);
+	float gauss_sigma = 32.0f/std::sqrt(variance);
+
+	float sum_weights = 0.0f;
+	float sum = 0.0f;
+	for (int i = 0; i < n_planes; i++)
+	{
+		float weight = weightGauss(pixels[i].dist, gauss_sigma);
+		if (pixels[i].planeId >= mean_id)
+			weight += ctx.settings.newnessWeight;
+		if (pixels[i].intensity >= mean_value)
+			weight += ctx.settings.brightnessWeight;
+		sum += pixels[i].intensity * weight;
+		sum_weights += weight;
+	}
+	return static_cast<unsigned char>(sum / sum_weights);
+}
+
+unsigned char performInterpolation_anisotropic(const Context& ctx, const float* voxel, ClosePlane* closePlanes, int nClosePlanes)
+{
+	if (nClosePlanes == 0)
+		return 1;
+
+	for (int i = 0; i < nClosePlanes; i++)
+	{
+		int plane_id = closePlanes[i].planeId;
+		float p[2];
+		int ip[2];
+		toImgCoord_float(ctx, voxel, plane_id, closePlanes[i].dist, p);
+		round_int(p, ip);
+		if (!isValidPixel(ctx, ip))
+			continue;
+		closePlanes[i].intensity = static_cast<unsigned char>(bilinearInterpolation(ctx, p[0], p[1], ctx.frames[plane_id]));
+	}
+
+	return std::max<unsigned char>(1, anisotropicFilter(ctx, closePlanes, nClosePlanes));
+}
+
+unsigned char performInterpolation(const Context& ctx, const float* voxel, Scratch& scratch, int nClosePlanes)
+{
+	ClosePlane* closePlanes = &scratch.closePlanes[0];
+	switch (ctx.settings.method)
+	{
+	case VNNAlgorithm::mVNN:
+		return performInterpolation_vnn(ctx, voxel, closePlanes, nClosePlanes);
+	case VNNAlgorithm::mVNN2:
+		return performInterpolation_weighted(ctx, voxel, closePlanes, nClosePlanes, false);
+	case VNNAlgorithm::mDW:
+		return performInterpolation_weighted(ctx, voxel, closePlanes, nClosePlanes, true);
+	case VNNAlgorithm::mANISOTROPIC:
+		return performInterpolation_anisotropic(ctx, voxel, closePlanes, nClosePlanes);
+	default:
+		return 1;
+	}
+}
+
+/** Port of the body of voxel_methods() in kernels.cl, for one cube.
+ *  Iterate such that the next voxel is always a neighbour of the previous voxel.
+ */
+void processCube(const Context& ctx, const int* origin, Scratch& scratch)
+{
+	float voxel[3] = { origin[0]*ctx.outSpacing[0], origin[1]*ctx.outSpacing[1], origin[2]*ctx.outSpacing[2] };
+
+	bool noPlanes = false;
+	bool exhaustive = false;
+	if (ctx.planeIndex)
+	{
+		// only planes passing within radius of the cube can contribute,
+		// add one input pixel to account for rounding of the projections.
+		Vector3D lo(voxel[0], voxel[1], voxel[2]);
+		Vector3D hi = lo + (CUBE_SIZE-1)*Vector3D(ctx.outSpacing[0], ctx.outSpacing[1], ctx.outSpacing[2]);
+		Vector3D margin = Vector3D::Ones()*(ctx.settings.radius + std::max(ctx.inSpacing[0], ctx.inSpacing[1]));
+		ctx.planeIndex->getFramesIntersecting(DoubleBoundingBox3D(lo - margin, hi + margin), &scratch.candidates);
+		noPlanes = scratch.candidates.empty();
+		exhaustive = (ctx.settings.planeMethod == VNNAlgorithm::pmCLOSEST);
+	}
+	int nGuesses = (noPlanes || exhaustive) ? 0 : findLocalMinimas(ctx, voxel, scratch);
+
+	for (int xoffset = 0; xoffset < CUBE_SIZE; xoffset++)
+	{
+		int x = origin[0] + xoffset;
+		if (x >= ctx.outDims[0])
+			break;
+
+		bool yreverse = xoffset % 2;
+		for (int yi = 0; yi < CUBE_SIZE; yi++)
+		{
+			int yoffset = yreverse ? CUBE_SIZE-1-yi : yi;
+			int y = origin[1] + yoffset;
+			if (y >= ctx.outDims[1])
+				continue;
+
+			bool zreverse = (yoffset % 2) && (xoffset % 2);
+			for (int zi = 0; zi < CUBE_SIZE; zi++)
+			{
+				int zoffset = zreverse ? CUBE_SIZE-1-zi : zi;
+				int z = origin[2] + zoffset;
+				if (z >= ctx.outDims[2])
+					continue;
+
+				voxel[0] = x*ctx.outSpacing[0];
+				voxel[1] = y*ctx.outSpacing[1];
+				voxel[2] = z*ctx.outSpacing[2];
+
+				int nClosePlanes = 0;
+				if (exhaustive)
+					nClosePlanes = findClosestPlanes_candidates(ctx, voxel, scratch);
+				else if (!noPlanes)
+					nClosePlanes = findClosestPlanes_multistart(ctx, voxel, nGuesses, scratch);
+				size_t index = x + size_t(y)*ctx.outDims[0] + size_t(z)*ctx.outDims[0]*ctx.outDims[1];
+				ctx.output[index] = performInterpolation(ctx, voxel, scratch, nClosePlanes);
+			}
+		}
+	}
+}
+
+/** Process all cubes in one z-layer of cubes.
+ */
+void processCubeLayer(const Context& ctx, int cubeZ)
+{
+	Scratch scratch;
+	scratch.absDists.resize(ctx.nPlanes);
+	scratch.closePlanes.resize(ctx.settings.maxPlanes);
+	scratch.guesses.resize(ctx.maxStarts);
+	scratch.guessDists.resize(ctx.maxStarts);
+
+	int xcubes = (ctx.outDims[0] + CUBE_SIZE - 1) / CUBE_SIZE;
+	int ycubes = (ctx.outDims[1] + CUBE_SIZE - 1) / CUBE_SIZE;
+	for (int cy = 0; cy < ycubes; ++cy)
+	{
+		for (int cx = 0; cx < xcubes; ++cx)
+		{
+			int origin[3] = { cx*CUBE_SIZE, cy*CUBE_SIZE, cubeZ*CUBE_SIZE };
+			processCube(ctx, origin, scratch);
+		}
+	}
+}
+
+} // namespace
+
+VNNAlgorithm::VNNAlgorithm() :
+	mExecutionTime(0)
+{
+}
+
+VNNAlgorithm::~VNNAlgorithm()
+{
+}
+
+double VNNAlgorithm::getExecutionTime() const
+{
+	return mExecutionTime;
+}
+
+bool VNNAlgorithm::initializeContext(Context* ctx, ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, const Settings& settings)
+{
+	std::vector<TimedPosition> frameInfo = input->getFrames();
+	Eigen::Array3i inDims = input->getDimensions();
+
+	if (inDims[2] != static_cast<int>(frameInfo.size()))
+	{
+		reportError(QString("Number of frames %1 != %2 dimension 2 of US input").arg(inDims[2]).arg(frameInfo.size()));
+		return false;
+	}
+	if (inDims[2] < 2)
+	{
+		reportError(QString("VNN reconstruction needs at least 2 frames, got %1").arg(inDims[2]));
+		return false;
+	}
+	if (outputData->GetScalarType() != VTK_UNSIGNED_CHAR)
+	{
+		reportError("VNN reconstruction requires an unsigned char output volume");
+		return false;
+	}
+
+	ctx->settings = settings;
+	ctx->settings.maxPlanes = std::max(1, settings.maxPlanes);
+	ctx->settings.nStarts = std::max(1, settings.nStarts);
+	// as in kernels.cl.h: Closest means one exhaustive search from the best start.
+	ctx->maxStarts = (settings.planeMethod == pmCLOSEST) ? 1 : ctx->settings.nStarts;
+	ctx->doTermDistance = (settings.planeMethod != pmCLOSEST);
+
+	ctx->nPlanes = inDims[2];
+	ctx->inDims[0] = inDims[0];
+	ctx->inDims[1] = inDims[1];
+	ctx->inSpacing[0] = input->getSpacing()[0];
+	ctx->inSpacing[1] = input->getSpacing()[1];
+	ctx->mask = static_cast<unsigned char*>(input->getMask()->GetScalarPointer());
+
+	int* outDims = outputData->GetDimensions();
+	double* outSpacing = outputData->GetSpacing();
+	for (int i = 0; i < 3; ++i)
+	{
+		ctx->outDims[i] = outDims[i];
+		ctx->outSpacing[i] = outSpacing[i];
+	}
+	ctx->output = static_cast<unsigned char*>(outputData->GetScalarPointer());
+	ctx->planeIndex = input->getPlaneIndex();
+	if (ctx->planeIndex && (ctx->planeIndex->getNumberOfFrames() != ctx->nPlanes))
+	{
+		reportWarning("VNN reconstruction: plane index does not match input, ignoring it");
+		ctx->planeIndex.reset();
+	}
+
+	for (int i = 0; i < ctx->nPlanes; ++i)
+	{
+		ctx->frames.push_back(input->getFrame(i));
+
+		Transform3D M = frameInfo[i].mPos;
+		Vector3D n = M.matrix().block<3,1>(0,2);
+		Vector3D u = M.matrix().block<3,1>(0,0);
+		Vector3D v = M.matrix().block<3,1>(0,1);
+		Vector3D t = M.matrix().block<3,1>(0,3);
+		ctx->nx.push_back(n[0]);
+		ctx->ny.push_back(n[1]);
+		ctx->nz.push_back(n[2]);
+		ctx->nw.push_back(-n.dot(t));
+		ctx->ux.push_back(u[0]);
+		ctx->uy.push_back(u[1]);
+		ctx->uz.push_back(u[2]);
+		ctx->vx.push_back(v[0]);
+		ctx->vy.push_back(v[1]);
+		ctx->vz.push_back(v[2]);
+		ctx->tx.push_back(t[0]);
+		ctx->ty.push_back(t[1]);
+		ctx->tz.push_back(t[2]);
+	}
+
+	return true;
+}
+
+bool VNNAlgorithm::reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, const Settings& settings)
+{
+	input->validate();
+
+	Context ctx;
+	if (!this->initializeContext(&ctx, input, outputData, settings))
+		return false;
+
+	std::vector<int> layers;
+	int zcubes = (ctx.outDims[2] + CUBE_SIZE - 1) / CUBE_SIZE;
+	for (int i = 0; i < zcubes; ++i)
+		layers.push_back(i);
+
+	QElapsedTimer timer;
+	timer.start();
+	QtConcurrent::blockingMap(layers, boost::bind(&processCubeLayer, boost::cref(ctx), _1));
+	mExecutionTime = timer.elapsed();
+
+	setDeepModified(outputData);
+	return true;
+}
+
+} /* namespace cx */
@@ -0,0 +1,93 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXVNNALGORITHM_H_
+#define CXVNNALGORITHM_H_
+
+#include "org_custusx_usreconstruction_vnn_Export.h"
+
+#include "cxUSFrameData.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class VNNAlgorithm> VNNAlgorithmPtr;
+
+/**
+ * CPU implementation of the voxel based reconstruction methods in
+ * org.custusx.usreconstruction.vnncl (kernels.cl).
+ *
+ * The output volume is split into cubes of CUBE_SIZE^3 voxels, the same
+ * way as the OpenCL kernel does it. The cubes are processed on the global
+ * thread pool, one z-layer of cubes per task. The plane equations are stored
+ * as separate arrays of floats, in order to let the compiler vectorize the
+ * distance calculations.
+ *
+ * Method and plane method IDs are the same as in kernels.cl.h.
+ *
+ * \ingroup org_custusx_usreconstruction_vnn
+ * \date 2026-10-18
+ */
+class org_custusx_usreconstruction_vnn_EXPORT VNNAlgorithm
+{
+public:
+	enum METHOD
+	{
+		mVNN = 0,
+		mVNN2 = 1,
+		mDW = 2,
+		mANISOTROPIC = 3
+	};
+	enum PLANE_METHOD
+	{
+		pmHEURISTIC = 0,
+		pmCLOSEST = 1
+	};
+
+	struct Settings
+	{
+		Settings() :
+			method(mDW), planeMethod(pmHEURISTIC), maxPlanes(10), nStarts(16),
+			radius(3), newnessWeight(0), brightnessWeight(1) {}
+		int method; ///< see METHOD
+		int planeMethod; ///< see PLANE_METHOD
+		int maxPlanes; ///< max number of planes to include for each voxel (MAX_PLANES)
+		int nStarts; ///< number of starts for multistart search (MAX_MULTISTART_STARTS)
+		float radius; ///< max distance from voxel to included planes, mm
+		float newnessWeight; ///< extra weight for pixels newer than mean (anisotropic only)
+		float brightnessWeight; ///< extra weight for pixels brighter than mean (anisotropic only)
+	};
+
+	VNNAlgorithm();
+	~VNNAlgorithm();
+
+	/**
+	 * Reconstruct input into outputData.
+	 * @param input The processed input US data
+	 * @param outputData Preallocated unsigned char output volume
+	 * @param settings Method parameters
+	 * @return True on success
+	 */
+	bool reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, const Settings& settings);
+
+	/**
+	 * Wall time in ms spent on the voxel loop during the last reconstruct().
+	 */
+	double getExecutionTime() const;
+
+	struct Context;
+private:
+	bool initializeContext(Context* context, ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, const Settings& settings);
+	double mExecutionTime;
+};
+
+} /* namespace cx */
+
+#endif /* CXVNNALGORITHM_H_ */
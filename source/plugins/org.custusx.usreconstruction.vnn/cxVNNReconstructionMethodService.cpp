@@ -0,0 +1,141 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxVNNReconstructionMethodService.h"
+#include <QThread>
+#include "cxLogger.h"
+
+namespace cx
+{
+
+VNNReconstructionMethodService::VNNReconstructionMethodService(ctkPluginContext* context) :
+	ReconstructionMethodService()
+{
+	mAlgorithm = VNNAlgorithmPtr(new VNNAlgorithm);
+
+	mMethods.push_back("VNN");
+	mMethods.push_back("VNN2");
+	mMethods.push_back("DW");
+	mMethods.push_back("Anisotropic");
+	mPlaneMethods.push_back("Heuristic");
+	mPlaneMethods.push_back("Closest");
+}
+
+VNNReconstructionMethodService::~VNNReconstructionMethodService()
+{
+}
+
+QString VNNReconstructionMethodService::getName() const
+{
+	return "vnn_cpu";
+}
+
+double VNNReconstructionMethodService::getExecutionTime()
+{
+	return mAlgorithm->getExecutionTime();
+}
+
+std::vector<PropertyPtr> VNNReconstructionMethodService::getSettings(QDomElement root)
+{
+	std::vector<PropertyPtr> retval;
+
+	retval.push_back(this->getMethodOption(root));
+	retval.push_back(this->getRadiusOption(root));
+	retval.push_back(this->getPlaneMethodOption(root));
+	retval.push_back(this->getMaxPlanesOption(root));
+	retval.push_back(this->getNStartsOption(root));
+	retval.push_back(this->getNewnessWeightOption(root));
+	retval.push_back(this->getBrightnessWeightOption(root));
+	return retval;
+}
+
+bool VNNReconstructionMethodService::reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, QDomElement settings)
+{
+	VNNAlgorithm::Settings params;
+	params.method = this->getMethodID(settings);
+	params.planeMethod = this->getPlaneMethodID(settings);
+	params.maxPlanes = this->getMaxPlanesOption(settings)->getValue();
+	params.nStarts = this->getNStartsOption(settings)->getValue();
+	params.radius = this->getRadiusOption(settings)->getValue();
+	params.newnessWeight = this->getNewnessWeightOption(settings)->getValue();
+	params.brightnessWeight = this->getBrightnessWeightOption(settings)->getValue();
+
+	report(QString("Method: %1, radius: %2, planeMethod: %3, nClosePlanes: %4, nPlanes: %5, nStarts: %6, threads: %7")
+		   .arg(params.method).arg(params.radius).arg(params.planeMethod).arg(params.maxPlanes)
+		   .arg(input->getDimensions()[2]).arg(params.nStarts).arg(QThread::idealThreadCount()));
+
+	bool ret = mAlgorithm->reconstruct(input, outputData, params);
+
+	if (ret)
+		reportDebug(QString("VNN CPU reconstruction done [%1s]").arg(mAlgorithm->getExecutionTime()/1000.0, 0, 'f', 3));
+	return ret;
+}
+
+StringPropertyPtr VNNReconstructionMethodService::getMethodOption(QDomElement root)
+{
+	QStringList methods;
+	for (std::vector<QString>::iterator it = mMethods.begin(); it != mMethods.end(); ++it)
+		methods << *it;
+	return StringProperty::initialize("Method", "", "Which algorithm to use for reconstruction", methods[2],
+			methods, root);
+}
+
+DoublePropertyPtr VNNReconstructionMethodService::getNewnessWeightOption(QDomElement root)
+{
+	return DoubleProperty::initialize("Newness weight", "", "Newness weight", 0, DoubleRange(0.0, 10, 0.1), 1,
+			root);
+}
+
+DoublePropertyPtr VNNReconstructionMethodService::getBrightnessWeightOption(QDomElement root)
+{
+	return DoubleProperty::initialize("Brightness weight", "", "Brightness weight", 1, DoubleRange(0.0, 10, 0.1),
+			1, root);
+}
+
+StringPropertyPtr VNNReconstructionMethodService::getPlaneMethodOption(QDomElement root)
+{
+	QStringList methods;
+	for (std::vector<QString>::iterator it = mPlaneMethods.begin(); it != mPlaneMethods.end(); ++it)
+		methods << *it;
+	return StringProperty::initialize("Plane method", "", "Which method to use for finding close planes",
+			methods[0], methods, root);
+}
+
+DoublePropertyPtr VNNReconstructionMethodService::getRadiusOption(QDomElement root)
+{
+	return DoubleProperty::initialize("Radius (mm)", "", "Radius of kernel. mm.", 3, DoubleRange(0.1, 10, 0.1), 1,
+			root);
+}
+
+DoublePropertyPtr VNNReconstructionMethodService::getMaxPlanesOption(QDomElement root)
+{
+	return DoubleProperty::initialize("nPlanes", "", "Number of planes to include in closest planes", 10,
+			DoubleRange(1, 200, 1), 0, root);
+}
+
+DoublePropertyPtr VNNReconstructionMethodService::getNStartsOption(QDomElement root)
+{
+	return DoubleProperty::initialize("nStarts", "", "Number of starts for multistart searchs", 16,
+			DoubleRange(1, 16, 1), 0, root);
+}
+
+int VNNReconstructionMethodService::getMethodID(QDomElement root)
+{
+	return find(mMethods.begin(), mMethods.end(), this->getMethodOption(root)->getValue()) - mMethods.begin();
+}
+
+int VNNReconstructionMethodService::getPlaneMethodID(QDomElement root)
+{
+	return find(mPlaneMethods.begin(), mPlaneMethods.end(), this->getPlaneMethodOption(root)->getValue())
+			- mPlaneMethods.begin();
+}
+
+} /* namespace cx */
@@ -0,0 +1,73 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXVNNRECONSTRUCTIONMETHODSERVICE_H_
+#define CXVNNRECONSTRUCTIONMETHODSERVICE_H_
+
+#include "org_custusx_usreconstruction_vnn_Export.h"
+
+#include "cxReconstructionMethodService.h"
+#include "cxStringProperty.h"
+#include "cxDoubleProperty.h"
+#include "cxVNNAlgorithm.h"
+class ctkPluginContext;
+
+namespace cx
+{
+
+/**
+ * CPU implementation of the VNN, VNN2, DW and Anisotropic reconstruction methods.
+ *
+ * Uses the same settings as the vnn_cl method, and produces the same
+ * output within tolerance, but does not require an OpenCL device.
+ *
+ * \ingroup org_custusx_usreconstruction_vnn
+ *
+ * \date 2026-10-18
+ */
+class org_custusx_usreconstruction_vnn_EXPORT VNNReconstructionMethodService : public ReconstructionMethodService
+{
+	Q_INTERFACES(cx::ReconstructionMethodService)
+public:
+	VNNReconstructionMethodService(ctkPluginContext* context);
+	virtual ~VNNReconstructionMethodService();
+
+	virtual QString getName() const;
+	virtual std::vector<PropertyPtr> getSettings(QDomElement root);
+	virtual bool reconstruct(ProcessedUSInputDataPtr input, vtkImageDataPtr outputData, QDomElement settings);
+
+	/**
+	 * Wall time in ms spent in the voxel loop in the last reconstruction.
+	 */
+	double getExecutionTime();
+
+	StringPropertyPtr getMethodOption(QDomElement root);
+	DoublePropertyPtr getRadiusOption(QDomElement root);
+	StringPropertyPtr getPlaneMethodOption(QDomElement root);
+	DoublePropertyPtr getMaxPlanesOption(QDomElement root);
+	DoublePropertyPtr getNStartsOption(QDomElement root);
+	DoublePropertyPtr getBrightnessWeightOption(QDomElement root);
+	DoublePropertyPtr getNewnessWeightOption(QDomElement root);
+
+private:
+	int getMethodID(QDomElement root);
+	int getPlaneMethodID(QDomElement root);
+
+	// Method names. Indices into this array corresponds to VNNAlgorithm::METHOD.
+	std::vector<QString> mMethods;
+	std::vector<QString> mPlaneMethods;
+
+	VNNAlgorithmPtr mAlgorithm;
+};
+
+} /* namespace cx */
+
+#endif /* CXVNNRECONSTRUCTIONMETHODSERVICE_H_ */
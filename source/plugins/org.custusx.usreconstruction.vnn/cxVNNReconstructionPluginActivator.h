@@ -0,0 +1,57 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXVNNRECONSTRUCTIONPLUGINACTIVATOR_H_
+#define CXVNNRECONSTRUCTIONPLUGINACTIVATOR_H_
+
+#include <ctkPluginActivator.h>
+#include "boost/shared_ptr.hpp"
+
+namespace cx
+{
+/**
+ * \defgroup org_custusx_usreconstruction_vnn
+ * \ingroup cx_plugins
+ *
+ * \see cx::VNNReconstructionMethodService
+ *
+ */
+
+typedef boost::shared_ptr<class RegisteredService> RegisteredServicePtr;
+
+/**
+ * Activator for the CPU VNN reconstruction plugin
+ *
+ * \ingroup org_custusx_usreconstruction_vnn
+ *
+ * \date 2026-10-18
+ */
+class VNNReconstructionPluginActivator :  public QObject, public ctkPluginActivator
+{
+  Q_OBJECT
+  Q_INTERFACES(ctkPluginActivator)
+  Q_PLUGIN_METADATA(IID "org_custusx_usreconstruction_vnn")
+
+public:
+
+  VNNReconstructionPluginActivator();
+  ~VNNReconstructionPluginActivator();
+
+  void start(ctkPluginContext* context);
+  void stop(ctkPluginContext* context);
+
+private:
+	RegisteredServicePtr mRegistration;
+};
+
+} // namespace cx
+
+#endif /* CXVNNRECONSTRUCTIONPLUGINACTIVATOR_H_ */
@@ -0,0 +1,7 @@
+#include "cxtestUtilities.h"
+#include "cxtest_org_custusx_usreconstruction_vnn_export.h"
+
+namespace
+{
+EXPORT_DUMMY_CLASS_FOR_LINKING_ON_WINDOWS_IN_LIB_WITHOUT_EXPORTED_CLASS(CXTEST_ORG_CUSTUSX_USRECONSTRUCTION_VNN_EXPORT)
+}
@@ -0,0 +1,264 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <QDomElement>
+#include "cxVNNReconstructionMethodService.h"
+
+#include "cxtestReconstructionAlgorithmFixture.h"
+#include "cxLogicManager.h"
+#include "cxImage.h"
+#include "cxUSFrameData.h"
+#include "cxUSFramePlaneIndex.h"
+#include <vtkImageData.h>
+
+#ifdef CX_USE_OPENCL_UTILITY
+#include "cxVNNclReconstructionMethodService.h"
+#include "cxtestUtilities.h"
+#endif // CX_USE_OPENCL_UTILITY
+
+namespace cxtest
+{
+
+namespace
+{
+void reconstructSphereAndVerify(QString method, QString planeMethod)
+{
+	cx::LogicManager::initialize();
+	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
+
+	ReconstructionAlgorithmFixture fixture;
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement("vnn_cpu");
+
+	fixture.setOverallBoundsAndSpacing(100, 5);
+	fixture.getInputGenerator()->setSpherePhantom();
+
+	cx::VNNReconstructionMethodService* algorithm = new cx::VNNReconstructionMethodService(pluginContext);
+	algorithm->getMethodOption(settings)->setValue(method);
+	algorithm->getPlaneMethodOption(settings)->setValue(planeMethod);
+	algorithm->getRadiusOption(settings)->setValue(10);
+	algorithm->getMaxPlanesOption(settings)->setValue(8);
+	algorithm->getNStartsOption(settings)->setValue(1);
+
+	fixture.setAlgorithm(algorithm);
+	fixture.reconstruct(settings);
+
+	fixture.checkRMSBelow(20.0);
+	fixture.checkCentroidDifferenceBelow(1);
+	fixture.checkMassDifferenceBelow(0.01);
+
+	delete algorithm;
+	cx::LogicManager::shutdown();
+}
+} // namespace
+
+namespace
+{
+/** Index over the full frames of input, as built by ReconstructPreprocessor.
+ */
+cx::USFramePlaneIndexPtr createPlaneIndex(cx::ProcessedUSInputDataPtr input, double outputSpacing)
+{
+	Eigen::Array3i dims = input->getDimensions();
+	cx::Vector3D spacing = input->getSpacing();
+	double width = (dims[0]-1)*spacing[0];
+	double height = (dims[1]-1)*spacing[1];
+	std::vector<cx::Vector3D> frameRect;
+	frameRect.push_back(cx::Vector3D(0, 0, 0));
+	frameRect.push_back(cx::Vector3D(width, 0, 0));
+	frameRect.push_back(cx::Vector3D(0, height, 0));
+	frameRect.push_back(cx::Vector3D(width, height, 0));
+
+	std::vector<cx::TimedPosition> frames = input->getFrames();
+	std::vector<cx::Transform3D> dMu(frames.size());
+	for (unsigned i = 0; i < frames.size(); ++i)
+		dMu[i] = frames[i].mPos;
+
+	return cx::USFramePlaneIndexPtr(new cx::USFramePlaneIndex(frameRect, dMu, 4*outputSpacing));
+}
+
+/** Reconstruct the sphere without and with the plane index,
+ *  return the number of voxels that differ by more than 2 and the mean difference.
+ */
+void reconstructSphereWithAndWithoutIndex(QString planeMethod, vtkIdType* outliers, double* meanDifference)
+{
+	cx::LogicManager::initialize();
+	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
+
+	ReconstructionAlgorithmFixture fixture;
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement("vnn_cpu");
+
+	double spacing = 5;
+	fixture.setOverallBoundsAndSpacing(100, spacing);
+	fixture.getInputGenerator()->setSpherePhantom();
+
+	cx::VNNReconstructionMethodService* algorithm = new cx::VNNReconstructionMethodService(pluginContext);
+	algorithm->getMethodOption(settings)->setValue("VNN");
+	algorithm->getPlaneMethodOption(settings)->setValue(planeMethod);
+	algorithm->getRadiusOption(settings)->setValue(10);
+	algorithm->getMaxPlanesOption(settings)->setValue(8);
+	algorithm->getNStartsOption(settings)->setValue(3);
+	fixture.setAlgorithm(algorithm);
+
+	fixture.reconstruct(settings);
+	REQUIRE(!fixture.getInput()->getPlaneIndex());
+	vtkImageDataPtr withoutIndex = vtkImageDataPtr::New();
+	withoutIndex->DeepCopy(fixture.getOutput()->getBaseVtkImageData());
+
+	fixture.getInput()->setPlaneIndex(createPlaneIndex(fixture.getInput(), spacing));
+	fixture.reconstruct(settings);
+	vtkImageDataPtr withIndex = fixture.getOutput()->getBaseVtkImageData();
+
+	unsigned char* ptr0 = static_cast<unsigned char*>(withoutIndex->GetScalarPointer());
+	unsigned char* ptr1 = static_cast<unsigned char*>(withIndex->GetScalarPointer());
+	vtkIdType size = withIndex->GetNumberOfPoints();
+	REQUIRE(size == withoutIndex->GetNumberOfPoints());
+	double sumDifference = 0;
+	*outliers = 0;
+	for (vtkIdType i = 0; i < size; ++i)
+	{
+		int difference = std::abs(int(ptr0[i]) - int(ptr1[i]));
+		sumDifference += difference;
+		if (difference > 2)
+			++*outliers;
+	}
+	*meanDifference = sumDifference/size;
+	INFO(planeMethod << ": mean difference " << *meanDifference << ", " << *outliers << " of " << size << " voxels differ by more than 2");
+	CHECK(*meanDifference < 1.0);
+	CHECK(double(*outliers)/size < 0.01);
+
+	delete algorithm;
+	cx::LogicManager::shutdown();
+}
+} // namespace
+
+TEST_CASE("VNN CPU: Closest gives identical output with plane index", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	vtkIdType outliers = 0;
+	double meanDifference = 0;
+	reconstructSphereWithAndWithoutIndex("Closest", &outliers, &meanDifference);
+	CHECK(outliers == 0);
+	CHECK(meanDifference == 0);
+}
+
+TEST_CASE("VNN CPU: Heuristic gives equal output with plane index", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	// the start guesses are selected among the candidate planes, thus equal within the tolerance in the plugin doc.
+	vtkIdType outliers = 0;
+	double meanDifference = 0;
+	reconstructSphereWithAndWithoutIndex("Heuristic", &outliers, &meanDifference);
+}
+
+TEST_CASE("VNN CPU: VNN on sphere", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	reconstructSphereAndVerify("VNN", "Heuristic");
+}
+
+TEST_CASE("VNN CPU: VNN2 on sphere", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	reconstructSphereAndVerify("VNN2", "Heuristic");
+}
+
+TEST_CASE("VNN CPU: DW on sphere", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	reconstructSphereAndVerify("DW", "Heuristic");
+}
+
+TEST_CASE("VNN CPU: VNN Closest on sphere", "[unit][usreconstruction][synthetic][vnn_cpu]")
+{
+	reconstructSphereAndVerify("VNN", "Closest");
+}
+
+#ifdef CX_USE_OPENCL_UTILITY
+
+namespace
+{
+template<class SERVICE>
+vtkImageDataPtr reconstructSphere(SERVICE* algorithm, QString method)
+{
+	ReconstructionAlgorithmFixture fixture;
+	QDomDocument domdoc;
+	QDomElement settings = domdoc.createElement("vnn");
+
+	fixture.setOverallBoundsAndSpacing(100, 5);
+	fixture.getInputGenerator()->setSpherePhantom();
+
+	algorithm->getMethodOption(settings)->setValue(method);
+	algorithm->getPlaneMethodOption(settings)->setValue("Heuristic");
+	algorithm->getRadiusOption(settings)->setValue(10);
+	algorithm->getMaxPlanesOption(settings)->setValue(8);
+	algorithm->getNStartsOption(settings)->setValue(1);
+
+	fixture.setAlgorithm(algorithm);
+	fixture.reconstruct(settings);
+	return fixture.getOutput()->getBaseVtkImageData();
+}
+
+void compareCPUWithOpenCL(QString method)
+{
+	cx::LogicManager::initialize();
+	ctkPluginContext* pluginContext = cx::logicManager()->getPluginContext();
+
+	cx::VNNReconstructionMethodService* cpu = new cx::VNNReconstructionMethodService(pluginContext);
+	cx::VNNclReconstructionMethodService* cl = new cx::VNNclReconstructionMethodService(pluginContext);
+	vtkImageDataPtr cpuOutput = reconstructSphere(cpu, method);
+	vtkImageDataPtr clOutput = reconstructSphere(cl, method);
+
+	REQUIRE(cpuOutput);
+	REQUIRE(clOutput);
+	REQUIRE(Eigen::Array3i(cpuOutput->GetDimensions()).isApprox(Eigen::Array3i(clOutput->GetDimensions())));
+
+	// The tolerance stated in the plugin doc: equal apart from bilinear
+	// interpolation at the frame edges, where the kernel reads past the frame.
+	unsigned char* cpuPtr = static_cast<unsigned char*>(cpuOutput->GetScalarPointer());
+	unsigned char* clPtr = static_cast<unsigned char*>(clOutput->GetScalarPointer());
+	vtkIdType size = cpuOutput->GetNumberOfPoints();
+	double sumDifference = 0;
+	vtkIdType outliers = 0;
+	for (vtkIdType i = 0; i < size; ++i)
+	{
+		int difference = std::abs(int(cpuPtr[i]) - int(clPtr[i]));
+		sumDifference += difference;
+		if (difference > 2)
+			++outliers;
+	}
+
+	INFO(method << ": mean difference " << sumDifference/size << ", " << outliers << " of " << size << " voxels differ by more than 2");
+	CHECK(sumDifference/size < 1.0);
+	CHECK(double(outliers)/size < 0.01);
+
+	delete cpu;
+	delete cl;
+	//need to be sure opencl thread is finished before shutting down
+	Utilities::sleep_sec(1);
+	cx::LogicManager::shutdown();
+}
+} // namespace
+
+TEST_CASE("VNN CPU: VNN equals VNNcl on sphere", "[unit][usreconstruction][synthetic][vnn_cpu][VNNcl][not_apple]")
+{
+	compareCPUWithOpenCL("VNN");
+}
+
+TEST_CASE("VNN CPU: VNN2 equals VNNcl on sphere", "[unit][usreconstruction][synthetic][vnn_cpu][VNNcl][not_apple]")
+{
+	compareCPUWithOpenCL("VNN2");
+}
+
+TEST_CASE("VNN CPU: DW equals VNNcl on sphere", "[unit][usreconstruction][synthetic][vnn_cpu][VNNcl][not_apple]")
+{
+	compareCPUWithOpenCL("DW");
+}
+
+#endif // CX_USE_OPENCL_UTILITY
+
+} // namespace cxtest
@@ -23,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxTransferFunctions3DPresets.h"
 #include "cxTimeKeeper.h"
 #include "cxUSFrameData.h"
+#include "cxUSFramePlaneIndex.h"
 
 #include "cxUSReconstructInputDataAlgoritms.h"
 #include "cxPatientModelService.h"
@@ -53,6 +54,7 @@ std::vector<ProcessedUSInputDataPtr> ReconstructPreprocessor::createProcessedInp
 	std::vector<std::vector<vtkImageDataPtr> > frames = mFileData.mUsRaw->initializeFrames(angio);
 
 	std::vector<ProcessedUSInputDataPtr> retval;
+	USFramePlaneIndexPtr planeIndex = this->createPlaneIndex();
 
 	for (unsigned i=0; i<angio.size(); ++i)
 	{
@@ -63,11 +65,29 @@ std::vector<ProcessedUSInputDataPtr> ReconstructPreprocessor::createProcessedInp
 											 mFileData.mFilename,
 											 QFileInfo(mFileData.mFilename).completeBaseName() ));
 		CX_ASSERT(Eigen::Array3i(frames[i][0]->GetDimensions()).isApprox(Eigen::Array3i(mFileData.getMask()->GetDimensions())));
+		input->setPlaneIndex(planeIndex);
 		retval.push_back(input);
 	}
 	return retval;
 }
 
+/**
+ * Build a spatial index of the frames in output space, shared by all
+ * processed inputs. The whole mask is indexed, i.e. mMaskReduce is ignored.
+ */
+USFramePlaneIndexPtr ReconstructPreprocessor::createPlaneIndex()
+{
+	if (mFileData.mFrames.empty() || !mFileData.getMask())
+		return USFramePlaneIndexPtr();
+
+	std::vector<Transform3D> dMu(mFileData.mFrames.size());
+	for (unsigned i = 0; i < mFileData.mFrames.size(); ++i)
+		dMu[i] = mFileData.mFrames[i].mPos;
+
+	double cellSize = 4 * mOutputVolumeParams.getSpacing();
+	return USFramePlaneIndexPtr(new USFramePlaneIndex(this->generateInputRectangle(0), dMu, cellSize));
+}
+
 namespace
 {
 bool within(int x, int min, int max)
@@ -318,8 +338,9 @@ double ReconstructPreprocessor::timeToPosition(unsigned i_frame, unsigned i_pos)
 
 /**
  * Generate a rectangle (2D) defining ROI in input image space
+ * \param maskReduce Percentage to shrink the mask bounding box by on each side.
  */
-std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle()
+std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle(double maskReduce)
 {
 	std::vector<Vector3D> retval(4);
 	vtkImageDataPtr mask = mFileData.getMask();
@@ -359,7 +380,7 @@ std::vector<Vector3D> ReconstructPreprocessor::generateInputRectangle()
 
 	//Test: reduce the output volume by reducing the mask when determining
 	//      output volume size
-	double red = mInput.mMaskReduce;
+	double red = maskReduce;
 	int reduceX = (xmax - xmin) * (red / 100);
 	int reduceY = (ymax - ymin) * (red / 100);
 
@@ -429,7 +450,7 @@ void ReconstructPreprocessor::findExtentAndOutputTransform()
 	//mFrames[i].mPos = d'Mu, d' = only rotation
 
 	// Find extent of all frames as a point cloud
-	std::vector<Vector3D> inputRect = this->generateInputRectangle();
+	std::vector<Vector3D> inputRect = this->generateInputRectangle(mInput.mMaskReduce);
 	std::vector<Vector3D> outputRect;
 	for (unsigned slice = 0; slice < mFileData.mFrames.size(); slice++)
 	{
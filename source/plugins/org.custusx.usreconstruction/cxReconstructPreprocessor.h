@@ -22,6 +22,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 typedef boost::shared_ptr<class ReconstructPreprocessor> ReconstructPreprocessorPtr;
+typedef boost::shared_ptr<class USFramePlaneIndex> USFramePlaneIndexPtr;
 
 /** \brief Algorithm part of reconstruction -
  * no dependencies on parameter classes.
@@ -49,7 +50,8 @@ private:
     void updateFromOriginalFileData();
     void findExtentAndOutputTransform();
     Transform3D applyOutputOrientation();
-	std::vector<Vector3D> generateInputRectangle();
+	std::vector<Vector3D> generateInputRectangle(double maskReduce);
+	USFramePlaneIndexPtr createPlaneIndex();
 	void interpolatePositions();
 	double timeToPosition(unsigned i_frame, unsigned i_pos);
     void filterPositions(); // Noise-supressing position filter, averaging filter, configurable length
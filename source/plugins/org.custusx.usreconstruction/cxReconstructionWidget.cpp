@@ -43,7 +43,7 @@ ReconstructionWidget::ReconstructionWidget(QWidget* parent, UsReconstructionServ
 	QVBoxLayout* topLayout = new QVBoxLayout(this);
 
 	connect(mFileSelectWidget, &FileSelectWidget::fileSelected, this, &ReconstructionWidget::selectData);
-	mFileSelectWidget->setNameFilter(QStringList() << "*.fts");
+	mFileSelectWidget->setNameFilter(QStringList() << "*.fts" << "*.cxus");
 	connect(mReconstructer.get(), &UsReconstructionService::newInputDataAvailable, mFileSelectWidget, &FileSelectWidget::refresh);
 	connect(mReconstructer.get(), &UsReconstructionService::newInputDataPath, this, &ReconstructionWidget::updateFileSelectorPath);
 
@@ -69,6 +69,14 @@ public:
 	{
 		return mInputGenerator;
 	}
+	cx::ImagePtr getOutput()
+	{
+		return mOutputData;
+	}
+	cx::ProcessedUSInputDataPtr getInput()
+	{
+		return mInputData;
+	}
 
 private:
 	void generateInput();
@@ -0,0 +1,83 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <QTime>
+#include <vtkImageData.h>
+#include "cxtestReconstructionManagerFixture.h"
+#include "cxtestSyntheticReconstructInput.h"
+#include "cxtestJenkinsMeasurement.h"
+#include "cxStringPropertyBase.h"
+#include "cxImage.h"
+#include "cxLogger.h"
+
+namespace cxtest
+{
+
+namespace
+{
+void reconstructAndMeasure(ReconstructionManagerTestFixture& fixture, QString algorithm, int numberOfFrames)
+{
+	cx::UsReconstructionServicePtr reconstructer = fixture.getManager();
+	reconstructer->getParam("Algorithm")->setValueFromVariant(algorithm);
+
+	QTime clock;
+	clock.start();
+	fixture.reconstruct();
+	double seconds = std::max(clock.elapsed()/1000.0, 0.001);
+
+	std::vector<cx::ImagePtr> output = fixture.getOutput();
+	CHECK(output.size()==1);
+	if (output.empty())
+	{
+		CX_LOG_WARNING() << "Reconstruction benchmark: " << algorithm << " gave no output";
+		return;
+	}
+	double voxels = output[0]->getBaseVtkImageData()->GetNumberOfPoints();
+
+	QString prefix = QString("USReconstruction_%1").arg(algorithm);
+	JenkinsMeasurement jenkins;
+	jenkins.createOutput(prefix+"_VoxelsPerSecond", QString::number(voxels/seconds));
+	jenkins.createOutput(prefix+"_InputFramesPerSecond", QString::number(numberOfFrames/seconds));
+	jenkins.createOutput(prefix+"_Seconds", QString::number(seconds));
+}
+} // namespace
+
+TEST_CASE("Speed: US reconstruction of synthetic sphere with each algorithm", "[speed][integration][usreconstruction][synthetic][not_win32]")
+{
+	ReconstructionManagerTestFixture fixture;
+
+	SyntheticReconstructInputPtr input(new SyntheticReconstructInput);
+	input->setOverallBoundsAndSpacing(100, 1);
+	input->setSpherePhantom();
+	cx::USReconstructInputData inputData = input->generateSynthetic_USReconstructInputData();
+
+	cx::UsReconstructionServicePtr reconstructer = fixture.getManager();
+	reconstructer->selectData(inputData);
+	reconstructer->getParam("Dual Angio")->setValueFromVariant(false);
+	reconstructer->getParam("Position Filter Strength")->setValueFromVariant("0");
+
+	// one ReconstructionMethodService is registered for each entry
+	cx::StringPropertyBasePtr algorithms = boost::dynamic_pointer_cast<cx::StringPropertyBase>(reconstructer->getParam("Algorithm"));
+	REQUIRE(algorithms);
+	QStringList names = algorithms->getValueRange();
+	REQUIRE(!names.empty());
+
+	for (int i=0; i<names.size(); ++i)
+	{
+		INFO("Algorithm: " + names[i].toStdString());
+		reconstructAndMeasure(fixture, names[i], inputData.mFrames.size());
+	}
+}
+
+} // namespace cxtest
@@ -26,6 +26,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxPatientModelService.h"
 #include "cxRemoteAPI.h"
+#include "cxLayoutVideoSource.h"
+#include "cxMJPEGStreamer.h"
+#include <QUrlQuery>
 #include <QPixmap>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -74,6 +77,8 @@ void HttpRequestHandler::handle_complete_request(QHttpRequest *req, QHttpRespons
 	   GET    /layout/display                                  : get image of layout
 	   DELETE /layout/display                                  : delete display
 
+	   GET    /layout/display/mjpeg?budget=50&quality=75     : stream layout display as motion jpeg
+
 	   PUT    /layout/display/stream?port=8086                 : start streamer on port
 	   DELETE /layout/display/stream                           : stop streamer on port
 	*/
@@ -112,6 +117,10 @@ void HttpRequestHandler::handle_layout(QHttpRequest *req, QHttpResponse *resp)
     {
         this->process_stream(req, resp);
     }
+    else if (req->path()=="/layout/display/mjpeg")
+    {
+        this->process_mjpeg(req, resp);
+    }
     else if (req->path() == "/layout/display")
     {
         this->process_display(req, resp);
@@ -154,6 +163,20 @@ void HttpRequestHandler::process_stream(QHttpRequest *req, QHttpResponse *resp)
     }
 }
 
+void HttpRequestHandler::process_mjpeg(QHttpRequest *req, QHttpResponse *resp)
+{
+    CX_ASSERT(req->path()=="/layout/display/mjpeg");
+
+    if (req->method()==QHttpRequest::HTTP_GET)
+    {
+        this->create_mjpeg_stream(req, resp);
+    }
+    else
+    {
+        this->reply_method_not_allowed(resp);
+    }
+}
+
 void HttpRequestHandler::process_display(QHttpRequest *req, QHttpResponse *resp)
 {
     CX_ASSERT(req->path()=="/layout/display");
@@ -236,6 +259,46 @@ void HttpRequestHandler::delete_display(QHttpResponse *resp)
     mApi->closeLayoutWidget();
 }
 
+void HttpRequestHandler::create_mjpeg_stream(QHttpRequest *req, QHttpResponse *resp)
+{
+    // example test line:
+    // curl "http://localhost:8085/layout/display/mjpeg?budget=50&quality=75" > stream.mjpeg
+    QUrlQuery query(req->url());
+    int frameBudget = 50; // ms
+    int quality = 75;
+    if (!this->readIntQueryItem(query, "budget", &frameBudget) || !this->readIntQueryItem(query, "quality", &quality))
+    {
+        this->reply_bad_request(resp);
+        return;
+    }
+    frameBudget = std::max(frameBudget, 1);
+    quality = qBound(0, quality, 100);
+
+    LayoutVideoSourcePtr source = mApi->startStreaming();
+    if (!source)
+    {
+        this->reply_notfound(resp); // create display first
+        return;
+    }
+
+    // deletes itself when the client disconnects
+    new MJPEGStreamer(source, resp, frameBudget, quality, this);
+}
+
+/** Read item from the query into value, if present.
+ *  Return false if the item is present but not an integer.
+ */
+bool HttpRequestHandler::readIntQueryItem(const QUrlQuery& query, QString item, int* value)
+{
+    if (!query.hasQueryItem(item))
+        return true;
+    bool ok = false;
+    int retval = query.queryItemValue(item).toInt(&ok);
+    if (ok)
+        *value = retval;
+    return ok;
+}
+
 QByteArray HttpRequestHandler::generatePNGEncoding(QImage image)
 {
     QByteArray ba;
@@ -290,6 +353,11 @@ void HttpRequestHandler::reply_mainpage(QHttpResponse *resp)
                  "</tr>"
                  "<tr><td>GET</td><td>/layout/display</td><td>get image of layout</td><td>png image</td></tr>"
                  "<tr><td>DELETE</td><td>/layout/display</td><td>delete display</td></tr>"
+                 "<tr>"
+                 "<td>GET</td><td>/layout/display/mjpeg</td>"
+                 "<td>stream display as motion jpeg, only changed frames are sent.</td>"
+                 "<td>budget=(ms per frame)&amp;quality=(0-100)</td>"
+                 "</tr>"
                  ""
 				 "%2"
                  ""
@@ -329,6 +397,12 @@ void HttpRequestHandler::reply_notfound(QHttpResponse *resp)
     resp->end(QByteArray("Not found"));
 }
 
+void HttpRequestHandler::reply_bad_request(QHttpResponse *resp)
+{
+    resp->writeHead(400);
+    resp->end(QByteArray("Bad Request"));
+}
+
 void HttpRequestHandler::reply_method_not_allowed(QHttpResponse *resp)
 {
     resp->writeHead(405);
@@ -18,6 +18,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 class QHttpRequest;
 class QHttpResponse;
+class QUrlQuery;
 
 namespace cx
 {
@@ -44,16 +45,20 @@ protected:
     void handle_layout(QHttpRequest *req, QHttpResponse *resp);
     void process_display(QHttpRequest *req, QHttpResponse *resp);
     void process_stream(QHttpRequest *req, QHttpResponse *resp);
+    void process_mjpeg(QHttpRequest *req, QHttpResponse *resp);
     void process_layout(QHttpRequest *req, QHttpResponse *resp);
 
     void reply_mainpage(QHttpResponse *resp);
     void reply_screenshot(QHttpResponse *resp);
     void reply_notfound(QHttpResponse *resp);
     void reply_method_not_allowed(QHttpResponse *resp);
+    void reply_bad_request(QHttpResponse *resp);
     void reply_layout_list(QHttpResponse *resp);
     void get_display_image(QHttpResponse *resp);
     void create_display(QHttpRequest *req, QHttpResponse *resp);
     void delete_display(QHttpResponse *resp);
+    void create_mjpeg_stream(QHttpRequest *req, QHttpResponse *resp);
+    bool readIntQueryItem(const QUrlQuery& query, QString item, int* value);
     virtual void create_stream(QHttpRequest *req, QHttpResponse *resp);
     virtual void delete_stream(QHttpResponse *resp);
 
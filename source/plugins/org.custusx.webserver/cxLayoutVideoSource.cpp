@@ -9,7 +9,7 @@ CustusX is released under a BSD 3-Clause license.
 See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
 =========================================================================*/
 #include "cxLayoutVideoSource.h"
-#include "cxViewCollectionImageWriter.h"
+#include "cxAsyncViewCollectionImageWriter.h"
 #include "cxViewCollectionWidget.h"
 #include "vtkImageData.h"
 #include "cxLogger.h"
@@ -22,7 +22,10 @@ LayoutVideoSource::LayoutVideoSource(ViewCollectionWidget* widget) :
     mStreaming(false)
 {
 	CX_ASSERT(widget);
+    mWriter = new AsyncViewCollectionImageWriter(widget);
+    mWriter->setParent(this);
     connect(mWidget.data(), &ViewCollectionWidget::rendered, this, &LayoutVideoSource::onRendered);
+    connect(mWriter, &AsyncViewCollectionImageWriter::imageReady, this, &LayoutVideoSource::onImageReady);
 }
 
 QString LayoutVideoSource::getUid()
@@ -51,6 +54,7 @@ void LayoutVideoSource::start()
         return;
 
     mStreaming = true;
+    mWriter->requestGrab(); // deliver the current contents, even if no render follows
     emit streaming(mStreaming);
 }
 
@@ -84,8 +88,16 @@ void LayoutVideoSource::onRendered()
     if (!mStreaming)
         return;
 
-    mGrabbed = vtkImageDataPtr();
-    mTimestamp = QDateTime::currentDateTime();
+    mWriter->requestGrab();
+}
+
+void LayoutVideoSource::onImageReady()
+{
+    if (!mStreaming)
+        return;
+
+    mGrabbed = mWriter->getImage();
+    mTimestamp = mWriter->getImageTime();
     emit newFrame();
 }
 
@@ -94,11 +106,6 @@ vtkImageDataPtr LayoutVideoSource::getVtkImageData()
     if (!mStreaming)
         return vtkImageDataPtr();
 
-    if (!mGrabbed)
-    {
-        ViewCollectionImageWriter grabber(mWidget);
-        mGrabbed = grabber.grab();
-    }
     return mGrabbed;
 }
 
@@ -18,9 +18,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 class ViewCollectionWidget;
+class AsyncViewCollectionImageWriter;
 
 /**
  * Stream images rendered to the input ViewCollectionWidget.
+ *
+ * Each render is read back asynchronously, newFrame() is
+ * emitted when the image is available.
  */
 class org_custusx_webserver_EXPORT LayoutVideoSource : public VideoSource
 {
@@ -47,7 +51,9 @@ public:
 
 private:
     QPointer<ViewCollectionWidget> mWidget;
+    AsyncViewCollectionImageWriter* mWriter;
     void onRendered();
+    void onImageReady();
     vtkImageDataPtr mGrabbed;
     QDateTime mTimestamp;
     bool mStreaming;
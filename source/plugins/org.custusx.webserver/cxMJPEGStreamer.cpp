@@ -0,0 +1,194 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxMJPEGStreamer.h"
+
+#include <cstring>
+#include <algorithm>
+#include <QtConcurrent>
+#include <QTimer>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <qhttpresponse.h>
+#include "cxVideoSource.h"
+#include "cxViewCollectionImageWriter.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+const char* const gBoundary = "cxframe";
+}
+
+QRect findChangedRegion(const QImage& previous, const QImage& current, int tileSize)
+{
+	if ((previous.size()!=current.size()) || (previous.format()!=current.format()))
+		return current.rect();
+
+	int bytesPerPixel = current.depth()/8;
+	QRect retval;
+	for (int y0=0; y0<current.height(); y0+=tileSize)
+	{
+		int y1 = std::min(y0+tileSize, current.height());
+		for (int x0=0; x0<current.width(); x0+=tileSize)
+		{
+			int x1 = std::min(x0+tileSize, current.width());
+			for (int y=y0; y<y1; ++y)
+			{
+				const uchar* a = previous.constScanLine(y) + x0*bytesPerPixel;
+				const uchar* b = current.constScanLine(y) + x0*bytesPerPixel;
+				if (memcmp(a, b, (x1-x0)*bytesPerPixel))
+				{
+					retval |= QRect(x0, y0, x1-x0, y1-y0);
+					break;
+				}
+			}
+		}
+	}
+	return retval;
+}
+
+MJPEGStreamer::MJPEGStreamer(VideoSourcePtr source, QHttpResponse* response, int frameBudget, int quality, QObject* parent) :
+	QObject(parent),
+	mSource(source),
+	mResponse(response),
+	mQuality(qBound(0, quality, 100)),
+	mNewFrameAvailable(true),
+	mWriting(false),
+	mEncodedFrames(0),
+	mSentFrames(0),
+	mTotalEncodeTime(0)
+{
+	connect(&mWatcher, SIGNAL(finished()), this, SLOT(onEncoded()));
+	connect(mSource.get(), SIGNAL(newFrame()), this, SLOT(onNewFrame()));
+	connect(mResponse.data(), SIGNAL(allBytesWritten()), this, SLOT(onAllBytesWritten()));
+	connect(mResponse.data(), SIGNAL(done()), this, SLOT(onResponseDone()));
+
+	mResponse->setHeader("Content-Type", QString("multipart/x-mixed-replace; boundary=%1").arg(gBoundary));
+	mResponse->setHeader("Cache-Control", "no-cache");
+	mResponse->writeHead(200); // everything is OK
+
+	mSource->start();
+
+	mTimer = new QTimer(this);
+	connect(mTimer, SIGNAL(timeout()), this, SLOT(onTimeout()));
+	mTimer->start(frameBudget);
+}
+
+MJPEGStreamer::~MJPEGStreamer()
+{
+	mWatcher.waitForFinished();
+	mSource->stop();
+}
+
+double MJPEGStreamer::getAverageEncodeTime() const
+{
+	if (!mEncodedFrames)
+		return 0;
+	return mTotalEncodeTime/mEncodedFrames;
+}
+
+void MJPEGStreamer::onNewFrame()
+{
+	mNewFrameAvailable = true;
+}
+
+void MJPEGStreamer::onTimeout()
+{
+	if (!mResponse)
+		return;
+	// drop frames until the previous one is encoded and sent
+	if (!mNewFrameAvailable || mWatcher.isRunning() || mWriting)
+		return;
+
+	vtkImageDataPtr grabbed = mSource->getVtkImageData();
+	if (!grabbed)
+		return;
+	mNewFrameAvailable = false;
+
+	mWatcher.setFuture(QtConcurrent::run(&MJPEGStreamer::encode, grabbed, mPrevious, mQuality));
+}
+
+MJPEGStreamer::EncodedFrame MJPEGStreamer::encode(vtkImageDataPtr grabbed, QImage previous, int quality)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	EncodedFrame retval;
+	retval.image = ViewCollectionImageWriter::vtkImageData2QImage(grabbed);
+	int tileSize = 32;
+	retval.changed = findChangedRegion(previous, retval.image, tileSize);
+
+	if (!retval.changed.isEmpty())
+	{
+		QBuffer buffer(&retval.jpeg);
+		buffer.open(QIODevice::WriteOnly);
+		retval.image.save(&buffer, "JPG", quality);
+	}
+
+	retval.encodeTime = timer.nsecsElapsed()/1.0E6;
+	return retval;
+}
+
+void MJPEGStreamer::onEncoded()
+{
+	EncodedFrame frame = mWatcher.result();
+	mPrevious = frame.image;
+	mEncodedFrames++;
+	mTotalEncodeTime += frame.encodeTime;
+
+	if (frame.jpeg.isEmpty())
+		return; // unchanged since last frame
+	this->writeFrame(frame);
+}
+
+void MJPEGStreamer::writeFrame(const EncodedFrame& frame)
+{
+	if (!mResponse)
+		return;
+
+	QRect r = frame.changed;
+	QString header = QString("--%1\r\n"
+							 "Content-Type: image/jpeg\r\n"
+							 "Content-Length: %2\r\n"
+							 "X-Encode-Time: %3\r\n"
+							 "X-Changed-Region: %4,%5,%6,%7\r\n"
+							 "\r\n")
+			.arg(gBoundary)
+			.arg(frame.jpeg.size())
+			.arg(frame.encodeTime, 0, 'f', 1)
+			.arg(r.x()).arg(r.y()).arg(r.width()).arg(r.height());
+
+	mWriting = true;
+	mResponse->write(header.toLatin1());
+	mResponse->write(frame.jpeg);
+	mResponse->write(QByteArray("\r\n"));
+	mSentFrames++;
+}
+
+void MJPEGStreamer::onAllBytesWritten()
+{
+	mWriting = false;
+}
+
+void MJPEGStreamer::onResponseDone()
+{
+	mTimer->stop();
+	mResponse = NULL;
+	CX_LOG_DEBUG() << QString("MJPEG stream closed: sent %1 of %2 encoded frames, mean encode time %3 ms")
+					  .arg(mSentFrames)
+					  .arg(mEncodedFrames)
+					  .arg(this->getAverageEncodeTime(), 0, 'f', 1);
+	this->deleteLater();
+}
+
+} // namespace cx
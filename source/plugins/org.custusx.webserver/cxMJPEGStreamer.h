@@ -0,0 +1,97 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXMJPEGSTREAMER_H
+#define CXMJPEGSTREAMER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QImage>
+#include <QFutureWatcher>
+#include "cxForwardDeclarations.h"
+
+#include "org_custusx_webserver_Export.h"
+
+class QHttpResponse;
+class QTimer;
+
+namespace cx
+{
+
+/**
+ * Return the bounding box of all tiles of size tileSize
+ * that differ between previous and current.
+ * The entire image is returned if the images are incompatible.
+ */
+org_custusx_webserver_EXPORT QRect findChangedRegion(const QImage& previous, const QImage& current, int tileSize);
+
+/**
+ * Stream images from a VideoSource as motion jpeg over
+ * a persistent http response (multipart/x-mixed-replace).
+ *
+ * A new image is grabbed at most once per frame budget, and only if
+ * the source has rendered since the last grab and the previous frame
+ * has been encoded and sent. Encoding is done on a worker thread.
+ * Images unchanged since the last frame are not sent.
+ *
+ * Each part contains the encoding time and the changed region in the
+ * headers X-Encode-Time (ms) and X-Changed-Region (x,y,width,height).
+ *
+ * Deletes itself when the connection is closed.
+ *
+ * \ingroup org_custusx_webserver
+ * \date 2026-10-18
+ */
+class org_custusx_webserver_EXPORT MJPEGStreamer : public QObject
+{
+	Q_OBJECT
+public:
+	struct EncodedFrame
+	{
+		EncodedFrame() : encodeTime(0) {}
+		QImage image; ///< the grabbed image, compared against the next grab
+		QByteArray jpeg; ///< empty if nothing changed
+		QRect changed; ///< region changed since the previous frame
+		double encodeTime; ///< ms
+	};
+
+	MJPEGStreamer(VideoSourcePtr source, QHttpResponse* response, int frameBudget, int quality, QObject* parent=NULL);  ///< frameBudget in ms, jpeg quality clamped to 0-100
+	virtual ~MJPEGStreamer();
+
+	double getAverageEncodeTime() const;
+
+private slots:
+	void onNewFrame();
+	void onTimeout();
+	void onEncoded();
+	void onAllBytesWritten();
+	void onResponseDone();
+
+private:
+	static EncodedFrame encode(vtkImageDataPtr grabbed, QImage previous, int quality);
+	void writeFrame(const EncodedFrame& frame);
+
+	VideoSourcePtr mSource;
+	QPointer<QHttpResponse> mResponse;
+	QTimer* mTimer;
+	QFutureWatcher<EncodedFrame> mWatcher;
+	QImage mPrevious;
+	int mQuality;
+	bool mNewFrameAvailable;
+	bool mWriting;
+
+	int mEncodedFrames;
+	int mSentFrames;
+	double mTotalEncodeTime;
+};
+
+} // namespace cx
+
+#endif // CXMJPEGSTREAMER_H
@@ -46,6 +46,8 @@ void RemoteAPI::closeLayoutWidget()
 LayoutVideoSourcePtr RemoteAPI::startStreaming()
 {
 	ViewCollectionWidget* vcw = mScreenVideo->getSecondaryLayoutWidget();
+	if (!vcw)
+		return LayoutVideoSourcePtr();
 	LayoutVideoSourcePtr source(new LayoutVideoSource(vcw));
     return source;
 }
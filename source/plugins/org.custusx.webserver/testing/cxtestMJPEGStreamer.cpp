@@ -0,0 +1,46 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "catch.hpp"
+
+#include <QImage>
+#include "cxMJPEGStreamer.h"
+
+TEST_CASE("MJPEGStreamer: Unchanged image has no changed region", "[unit][plugins][org.custusx.webserver]")
+{
+	QImage image(100, 80, QImage::Format_RGB888);
+	image.fill(Qt::gray);
+
+	CHECK(cx::findChangedRegion(image, image.copy(), 32).isEmpty());
+}
+
+TEST_CASE("MJPEGStreamer: Changed pixel gives the enclosing tile", "[unit][plugins][org.custusx.webserver]")
+{
+	QImage previous(100, 80, QImage::Format_RGB888);
+	previous.fill(Qt::gray);
+	QImage current = previous.copy();
+	current.setPixel(40, 70, qRgb(255, 0, 0));
+
+	QRect changed = cx::findChangedRegion(previous, current, 32);
+	CHECK(changed == QRect(32, 64, 32, 16)); // last tile row is cut by the image border
+
+	current.setPixel(99, 0, qRgb(255, 0, 0));
+	changed = cx::findChangedRegion(previous, current, 32);
+	CHECK(changed == QRect(32, 0, 68, 80));
+}
+
+TEST_CASE("MJPEGStreamer: Incompatible images are entirely changed", "[unit][plugins][org.custusx.webserver]")
+{
+	QImage current(100, 80, QImage::Format_RGB888);
+	current.fill(Qt::gray);
+
+	CHECK(cx::findChangedRegion(QImage(), current, 32) == current.rect());
+	CHECK(cx::findChangedRegion(current.scaled(50, 40), current, 32) == current.rect());
+}
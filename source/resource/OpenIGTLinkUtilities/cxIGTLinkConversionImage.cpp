@@ -24,6 +24,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 ==========================================================================*/
 #include "cxIGTLinkConversionImage.h"
 #include "vtkImageData.h"
+#include "vtkDataArray.h"
 
 #include <igtl_util.h>
 #include "cxLogger.h"
@@ -34,6 +35,15 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
+IGTLinkConversionImage::IGTLinkConversionImage()
+{
+}
+
+IGTLinkConversionImage::IGTLinkConversionImage(IGTLinkImageMessagePoolPtr pool) :
+	mPool(pool)
+{
+}
+
 igtl::ImageMessage::Pointer IGTLinkConversionImage::encode(ImagePtr image, PATIENT_COORDINATE_SYSTEM externalSpace)
 {
 	igtl::ImageMessage::Pointer retval = igtl::ImageMessage::New();
@@ -48,7 +58,9 @@ igtl::ImageMessage::Pointer IGTLinkConversionImage::encode(ImagePtr image, PATIE
 
 ImagePtr IGTLinkConversionImage::decode(igtl::ImageMessage *msg)
 {
-	vtkImageDataPtr vtkImage = this->decode_vtkImageData(msg);
+	vtkImageDataPtr vtkImage = this->decode_vtkImageDataWithoutCopy(msg);
+	if (!vtkImage)
+		vtkImage = this->decode_vtkImageData(msg);
 	QDateTime timestamp = IGTLinkConversionBase().decode_timestamp(msg);
 	QString deviceName = msg->GetDeviceName();
 
@@ -103,6 +115,31 @@ int swapCopy64(igtlUint64 * dst, igtlUint64 * src, int n)
 }
 } // unnamed namespace
 
+bool IGTLinkConversionImage::needsByteSwap(igtl::ImageMessage *msg) const
+{
+	int endian = msg->GetEndian();
+	return (msg->GetScalarSize() > 1 &&
+			((igtl_is_little_endian() && endian == igtl::ImageMessage::ENDIAN_BIG) ||
+			 (!igtl_is_little_endian() && endian == igtl::ImageMessage::ENDIAN_LITTLE)));
+}
+
+vtkImageDataPtr IGTLinkConversionImage::decode_vtkImageDataWithoutCopy(igtl::ImageMessage *imgMsg)
+{
+	if (!mPool)
+		return vtkImageDataPtr();
+	if (this->needsByteSwap(imgMsg))
+		return vtkImageDataPtr();
+	if (imgMsg->GetImageSize() != imgMsg->GetSubVolumeImageSize())
+		return vtkImageDataPtr();
+
+	// the vtk type must have the same memory layout as the igtl type
+	int scalarType = IGTLToVTKScalarType(imgMsg->GetScalarType());
+	if (scalarType == VTK_VOID || vtkDataArray::GetDataTypeSize(scalarType) != imgMsg->GetScalarSize())
+		return vtkImageDataPtr();
+
+	return mPool->wrap(igtl::ImageMessage::Pointer(imgMsg), scalarType);
+}
+
 vtkImageDataPtr IGTLinkConversionImage::decode_vtkImageData(igtl::ImageMessage *imgMsg)
 {
 	// NOTE: This method is mostly a copy-paste from Slicer.
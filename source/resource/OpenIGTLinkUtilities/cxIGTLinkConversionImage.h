@@ -28,6 +28,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "igtlImageMessage.h"
 #include "cxImage.h"
 #include "cxOpenIGTLinkUtilitiesExport.h"
+#include "cxIGTLinkImageMessagePool.h"
 
 
 namespace cx
@@ -43,15 +44,24 @@ namespace cx
  *
  * decode methods assume Unpack() has been called.
  * encode methods assume Pack() will be called.
+ *
+ * If a IGTLinkImageMessagePool is given, decode will wrap the message
+ * buffer instead of copying it whenever possible, i.e. when no byte swap
+ * is needed and the message contains the full volume. The pool keeps the
+ * message alive as long as the image refers to it.
  */
 class cxOpenIGTLinkUtilities_EXPORT IGTLinkConversionImage
 {
 public:
+	IGTLinkConversionImage();
+	explicit IGTLinkConversionImage(IGTLinkImageMessagePoolPtr pool);
+
 	igtl::ImageMessage::Pointer encode(ImagePtr in, PATIENT_COORDINATE_SYSTEM externalSpace);
 	ImagePtr decode(igtl::ImageMessage *in);
 
 private:
 	vtkImageDataPtr decode_vtkImageData(igtl::ImageMessage* in);
+	vtkImageDataPtr decode_vtkImageDataWithoutCopy(igtl::ImageMessage* in);
 	void decode_rMd(igtl::ImageMessage* msg, ImagePtr out);
 //	void encode_Transform3D(Transform3D rMd, igtl::ImageMessage *outmsg);
 	void encode_rMd(ImagePtr image, igtl::ImageMessage *outmsg, PATIENT_COORDINATE_SYSTEM externalSpace);
@@ -63,6 +73,9 @@ private:
 	void setMatrix(igtl::ImageMessage *msg, Transform3D matrix);
 	int getIgtlCoordinateSystem(PATIENT_COORDINATE_SYSTEM space) const;
 	PATIENT_COORDINATE_SYSTEM getPatientCoordinateSystem(int igtlSpace) const;
+	bool needsByteSwap(igtl::ImageMessage *msg) const;
+
+	IGTLinkImageMessagePoolPtr mPool;
 };
 
 } //namespace cx
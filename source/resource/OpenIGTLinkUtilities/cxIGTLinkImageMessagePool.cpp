@@ -0,0 +1,77 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxIGTLinkImageMessagePool.h"
+
+#include <vtkImageData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+
+namespace cx
+{
+
+IGTLinkImageMessagePool::IGTLinkImageMessagePool(unsigned maxRetained) :
+	mMaxRetained(maxRetained),
+	mWrapped(0),
+	mRejected(0)
+{
+}
+
+void IGTLinkImageMessagePool::reap()
+{
+	std::list<Entry>::iterator iter = mRetained.begin();
+	while (iter != mRetained.end())
+	{
+		// the pool holds the only reference: no image uses the buffer.
+		if (iter->mScalars->GetReferenceCount() == 1)
+			iter = mRetained.erase(iter);
+		else
+			++iter;
+	}
+}
+
+vtkImageDataPtr IGTLinkImageMessagePool::wrap(igtl::ImageMessage::Pointer msg, int vtkScalarType)
+{
+	this->reap();
+	if (mRetained.size() >= mMaxRetained)
+	{
+		++mRejected;
+		return vtkImageDataPtr();
+	}
+
+	int size[3];
+	float spacing[3];
+	msg->GetDimensions(size);
+	msg->GetSpacing(spacing);
+	int numComponents = msg->GetNumComponents();
+	vtkIdType numValues = vtkIdType(size[0])*size[1]*size[2]*numComponents;
+
+	vtkDataArrayPtr scalars = vtkDataArrayPtr::Take(vtkDataArray::CreateDataArray(vtkScalarType));
+	if (!scalars)
+		return vtkImageDataPtr();
+	scalars->SetNumberOfComponents(numComponents);
+	scalars->SetVoidArray(msg->GetScalarPointer(), numValues, 1); // save=1: the message owns the buffer
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetExtent(0, size[0]-1, 0, size[1]-1, 0, size[2]-1);
+	retval->SetOrigin(0.0, 0.0, 0.0);
+	retval->SetSpacing(spacing[0], spacing[1], spacing[2]);
+	retval->GetPointData()->SetScalars(scalars);
+
+	Entry entry;
+	entry.mMessage = msg;
+	entry.mScalars = scalars;
+	mRetained.push_back(entry);
+	++mWrapped;
+
+	return retval;
+}
+
+} // namespace cx
@@ -0,0 +1,75 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXIGTLINKIMAGEMESSAGEPOOL_H
+#define CXIGTLINKIMAGEMESSAGEPOOL_H
+
+#include "cxOpenIGTLinkUtilitiesExport.h"
+
+#include <list>
+#include <boost/shared_ptr.hpp>
+#include "igtlImageMessage.h"
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+
+/** Keeps received image messages alive while decoded images refer to their buffers.
+ *
+ * Used by IGTLinkConversionImage to decode without copying the pixel data:
+ * The decoded vtkImageData wraps the scalar buffer of the message, and the pool
+ * holds on to the message until nobody refers to the scalar array any more.
+ * Released messages are reaped on the next call to wrap().
+ *
+ * The number of retained messages is limited. When the limit is reached,
+ * e.g. when the consumer holds on to many frames, wrap() returns NULL and
+ * the caller must fall back to copying.
+ *
+ * Create one pool per stream, and use it from the decoding thread only.
+ *
+ * \ingroup cx_resource_OpenIGTLinkUtilities
+ * \date 2026-10-18
+ */
+class cxOpenIGTLinkUtilities_EXPORT IGTLinkImageMessagePool
+{
+public:
+	explicit IGTLinkImageMessagePool(unsigned maxRetained = 16);
+
+	/** Create a vtkImageData using the scalar buffer in msg directly.
+	 *  Return NULL if the pool is full.
+	 */
+	vtkImageDataPtr wrap(igtl::ImageMessage::Pointer msg, int vtkScalarType);
+
+	/** Release messages that are no longer referenced by any image. */
+	void reap();
+
+	unsigned getRetainedCount() const { return mRetained.size(); }
+	unsigned getMaxRetained() const { return mMaxRetained; }
+	/** Number of images created by wrap() */
+	unsigned long getWrappedCount() const { return mWrapped; }
+	/** Number of calls to wrap() rejected because the pool was full */
+	unsigned long getRejectedCount() const { return mRejected; }
+
+private:
+	struct Entry
+	{
+		igtl::ImageMessage::Pointer mMessage;
+		vtkDataArrayPtr mScalars;
+	};
+	std::list<Entry> mRetained;
+	unsigned mMaxRetained;
+	unsigned long mWrapped;
+	unsigned long mRejected;
+};
+typedef boost::shared_ptr<IGTLinkImageMessagePool> IGTLinkImageMessagePoolPtr;
+
+} // namespace cx
+
+#endif // CXIGTLINKIMAGEMESSAGEPOOL_H
@@ -151,3 +151,55 @@ TEST_CASE_METHOD(IGTLinkConversionFixture, "IGTLinkConversion: Decode/encode Pro
 	//not supported CHECK(input->getTemporalCalibration() == output->getTemporalCalibration());
 }
 
+
+TEST_CASE_METHOD(IGTLinkConversionFixture, "IGTLinkConversion: Decode image without copy", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	vtkImageDataPtr rawImage = cx::generateVtkImageData(Eigen::Array3i(40, 30, 1), cx::Vector3D(0.5, 0.6, 1), 0);
+	this->setValue(rawImage, 10, 20, 0, 7);
+	cx::ImagePtr input(new cx::Image("my_uid", rawImage));
+
+	cx::IGTLinkImageMessagePoolPtr pool(new cx::IGTLinkImageMessagePool(2));
+	cx::IGTLinkConversionImage converter(pool);
+	igtl::ImageMessage::Pointer msg = converter.encode(input, pcsLPS);
+	cx::ImagePtr output = converter.decode(msg);
+
+	REQUIRE(output);
+	CHECK(output->getBaseVtkImageData()->GetScalarPointer() == msg->GetScalarPointer());
+	CHECK(this->getValue(output, 10, 20, 0) == 7);
+	CHECK(cx::similar(cx::Vector3D(output->getBaseVtkImageData()->GetSpacing()), cx::Vector3D(0.5, 0.6, 1)));
+	CHECK(pool->getWrappedCount() == 1);
+	CHECK(pool->getRetainedCount() == 1);
+
+	// the message stays alive as long as the image uses it
+	msg = igtl::ImageMessage::Pointer();
+	CHECK(this->getValue(output, 10, 20, 0) == 7);
+
+	output.reset();
+	pool->reap();
+	CHECK(pool->getRetainedCount() == 0);
+}
+
+TEST_CASE_METHOD(IGTLinkConversionFixture, "IGTLinkConversion: Decode copies when message pool is full", "[unit][resource][OpenIGTLinkUtilities]")
+{
+	vtkImageDataPtr rawImage = cx::generateVtkImageData(Eigen::Array3i(40, 30, 1), cx::Vector3D(1, 1, 1), 0);
+	this->setValue(rawImage, 1, 2, 0, 5);
+	cx::ImagePtr input(new cx::Image("my_uid", rawImage));
+
+	cx::IGTLinkImageMessagePoolPtr pool(new cx::IGTLinkImageMessagePool(2));
+	cx::IGTLinkConversionImage converter(pool);
+
+	std::vector<igtl::ImageMessage::Pointer> messages;
+	std::vector<cx::ImagePtr> outputs;
+	for (unsigned i=0; i<3; ++i)
+	{
+		messages.push_back(converter.encode(input, pcsLPS));
+		outputs.push_back(converter.decode(messages.back()));
+	}
+
+	CHECK(pool->getWrappedCount() == 2);
+	CHECK(pool->getRejectedCount() == 1);
+	CHECK(outputs[1]->getBaseVtkImageData()->GetScalarPointer() == messages[1]->GetScalarPointer());
+	CHECK(outputs[2]->getBaseVtkImageData()->GetScalarPointer() != messages[2]->GetScalarPointer());
+	for (unsigned i=0; i<outputs.size(); ++i)
+		CHECK(this->getValue(outputs[i], 1, 2, 0) == 5);
+}
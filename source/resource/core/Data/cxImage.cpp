@@ -14,16 +14,14 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <QDomDocument>
 #include <QDir>
-#include <vtkImageAccumulate.h>
+#include <QMutexLocker>
 #include <vtkImageReslice.h>
 #include <vtkImageData.h>
 #include <vtkMatrix4x4.h>
 #include <vtkPlane.h>
 #include <vtkPlanes.h>
-#include <vtkImageResample.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageClip.h>
-#include <vtkImageIterator.h>
 #include <vtkPiecewiseFunction.h>
 #include <vtkColorTransferFunction.h>
 #include "cxImageTF3D.h"
@@ -37,6 +35,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxUtilHelpers.h"
 #include "cxVolumeHelpers.h"
 #include "cxImageDefaultTFGenerator.h"
+#include "cxImageStatistics.h"
+#include "cxImagePyramid.h"
 #include "cxNullDeleter.h"
 #include "cxSettings.h"
 #include "cxUnsignedDerivedImage.h"
@@ -104,7 +104,7 @@ Image::~Image()
 }
 
 Image::Image(const QString& uid, const vtkImageDataPtr& data, const QString& name) :
-	Data(uid, name), mBaseImageData(data), mMaxRGBIntensity(-1), mThresholdPreview(false)
+	Data(uid, name), mBaseImageData(data), mThresholdPreview(false)
 {
 	mInitialWindowWidth = -1;
 	mInitialWindowLevel = -1;
@@ -134,7 +134,6 @@ ImagePtr Image::copy()
 	retval->mUnsigned = mUnsigned;
 	retval->mModality = mModality;
 	retval->mImageType = mImageType;
-	retval->mMaxRGBIntensity = mMaxRGBIntensity;
 	retval->mInterpolationType = mInterpolationType;
 	retval->mImageLookupTable2D = mImageLookupTable2D;
 	retval->mImageTransferFunctions3D = mImageTransferFunctions3D;
@@ -195,7 +194,6 @@ void Image::resetTransferFunctions(bool _2D, bool _3D)
 	}
 
 	mBaseImageData->GetScalarRange(); // this line updates some internal vtk value, and (on fedora) removes 4.5s in the second render().
-	mMaxRGBIntensity = -1;
 
 	ImageDefaultTFGenerator tfGenerator(ImagePtr(this, null_deleter()));
 	if (_3D)
@@ -267,9 +265,13 @@ void Image::moveThisAndChildrenToThread(QThread* thread)
 
 void Image::setVtkImageData(const vtkImageDataPtr& data, bool resetTransferFunctions)
 {
-	mBaseImageData = data;
+	{
+		QMutexLocker sentry(&mStatisticsMutex);
+		mBaseImageData = data;
+		mStatistics.reset();
+	}
 	mBaseGrayScaleImageData = NULL;
-	mHistogramPtr = NULL;
+	mPyramid.reset();
 
 	if (resetTransferFunctions)
 		this->resetTransferFunctions();
@@ -349,90 +351,34 @@ Eigen::Array3d Image::getSpacing() const
 	return Eigen::Array3d(mBaseImageData->GetSpacing());
 }
 
-vtkImageAccumulatePtr Image::getHistogram()
+ImageStatisticsPtr Image::getStatistics()
 {
-	if (mHistogramPtr.GetPointer() == NULL)
+	vtkImageDataPtr image;
 	{
-		mHistogramPtr = vtkImageAccumulatePtr::New();
-		mHistogramPtr->SetInputData(this->getGrayScaleVtkImageData());
-		mHistogramPtr->IgnoreZeroOn(); // required for Sonowand CT volumes, where data are placed between 31K and 35K.
-		// Set up only a 1D histogram for now, so y and z values are set to 0
-		mHistogramPtr->SetComponentExtent(0, this->getRange(), 0, 0, 0, 0);
-		mHistogramPtr->SetComponentOrigin(this->getMin(), 0, 0);
-		mHistogramPtr->SetComponentSpacing(1, 0, 0);
+		QMutexLocker sentry(&mStatisticsMutex);
+		if (mStatistics && mStatistics->isValidFor(mBaseImageData))
+			return mStatistics;
+		image = mBaseImageData;
 	}
-	mHistogramPtr->Update();
-	return mHistogramPtr;
-}
 
-template<typename scalartype> static int getRGBMax(vtkImageDataPtr image)
-{
-	int max = 0;
-	vtkImageIterator<scalartype> iter(image, image->GetExtent());
-	while (!iter.IsAtEnd())
-	{
-		typename vtkImageIterator<scalartype>::SpanIterator siter = iter.BeginSpan();
-		while (siter != iter.EndSpan())
-		{
-			int value = *siter;
-			++siter;
-			value += *siter;
-			++siter;
-			value += *siter;
-			++siter;
-			if (value > max)
-			{
-				max = value;
-			}
-		}
-		iter.NextSpan();
-	}
-	return max/3;
-}
+	// Compute without holding the lock, thus other callers are not blocked by the
+	// parallel pass. Concurrent callers may compute the same statistics twice.
+	ImageStatisticsPtr statistics = ImageStatistics::create(image);
 
+	QMutexLocker sentry(&mStatisticsMutex);
+	if (statistics->isValidFor(mBaseImageData))
+		mStatistics = statistics;
+	return statistics;
+}
 
 int Image::getMax()
 {
-	// Alternatively create max from histogram
-	//IntIntMap::iterator iter = this->getHistogram()->end();
-	//iter--;
-	//return (*iter).first;
-	if (mBaseImageData->GetNumberOfScalarComponents() == 3)
-	{
-		if (mMaxRGBIntensity != -1)
-		{
-			return mMaxRGBIntensity;
-		}
-		double max = 0.0;
-		switch (mBaseImageData->GetScalarType())
-		{
-		case VTK_UNSIGNED_CHAR:
-			max = getRGBMax<unsigned char>(mBaseImageData);
-			break;
-		case VTK_UNSIGNED_SHORT:
-			max = getRGBMax<unsigned short>(mBaseImageData);
-			break;
-		default:
-			CX_LOG_ERROR() << "Unhandled RGB data type in image " << this->getUid();
-			break;
-		}
-		mMaxRGBIntensity = max;
-		return (int)mMaxRGBIntensity;
-	}
-	else
-	{
-//		return (int) this->getTransferFunctions3D()->getScalarMax();
-		return mBaseImageData->GetScalarRange()[1];
-	}
+	return this->getStatistics()->getMax();
 }
 
 int Image::getMin()
 {
-	// Alternatively create min from histogram
-	//IntIntMap::iterator iter = this->getHistogram()->begin();
-	//return (*iter).first;
-	return mBaseImageData->GetScalarRange()[0];
-//	return (int) this->getTransferFunctions3D()->getScalarMin();
+	return this->getStatistics()->getMin();
 }
 
 int Image::getRange()
@@ -447,7 +393,7 @@ int Image::getMaxAlphaValue()
 
 double Image::getVTKMinValue()
 {
-	int vtkScalarType = mBaseImageData->GetScalarType();
+	int vtkScalarType = this->getBaseVtkImageData()->GetScalarType();
 
 	if (vtkScalarType==VTK_CHAR)
 		return VTK_CHAR_MIN;
@@ -472,7 +418,7 @@ double Image::getVTKMinValue()
 
 double Image::getVTKMaxValue()
 {
-	int vtkScalarType = mBaseImageData->GetScalarType();
+	int vtkScalarType = this->getBaseVtkImageData()->GetScalarType();
 
 	if (vtkScalarType==VTK_CHAR)
 		return VTK_CHAR_MAX;
@@ -867,52 +813,22 @@ int Image::getInterpolationType() const
 	return mInterpolationType;
 }
 
+/** Return the image downsampled to no more than maxVoxels,
+ *  using the coarsest pyramid level needed. Blocks until the level is built.
+ */
 vtkImageDataPtr Image::resample(long maxVoxels)
 {
 	// also use grayscale as vtk is incapable of rendering 3component color.
-	vtkImageDataPtr retval = this->getGrayScaleVtkImageData();
-
-	double factor = computeResampleFactor(maxVoxels);
-
-	if (fabs(1.0-factor)>0.01) // resampling
-	{
-		vtkImageResamplePtr resampler = vtkImageResamplePtr::New();
-		resampler->SetInterpolationModeToLinear();
-		resampler->SetAxisMagnificationFactor(0, factor);
-		resampler->SetAxisMagnificationFactor(1, factor);
-		resampler->SetAxisMagnificationFactor(2, factor);
-		resampler->SetInputData(retval);
-//		resampler->GetOutput()->Update();
-		resampler->Update();
-		resampler->GetOutput()->GetScalarRange();
-		retval = resampler->GetOutput();
-
-//		long voxelsDown = retval->GetNumberOfPoints();
-//		long voxelsOrig = this->getBaseVtkImageData()->GetNumberOfPoints();
-//		report("Created downsampled volume in Image: "
-//									 + this->getName()
-//									 + " below " + qstring_cast(voxelsDown/1000/1000) + "M. "
-//									 + "Ratio: " + QString::number(factor, 'g', 2) + ", "
-//									 + "Original size: " + qstring_cast(voxelsOrig/1000/1000) + "M.");
-	}
-	return retval;
+	ImagePyramidPtr pyramid = this->getPyramid();
+	return pyramid->waitForLevel(pyramid->findLevel(maxVoxels));
 }
 
-double Image::computeResampleFactor(long maxVoxels)
+ImagePyramidPtr Image::getPyramid()
 {
-	if (maxVoxels==0)
-		return 1.0;
-
-	long voxels = this->getBaseVtkImageData()->GetNumberOfPoints();
-	double factor = (double)maxVoxels/(double)voxels;
-	factor = pow(factor, 1.0/3.0);
-	// cubic function leads to trouble for 138M-volume - must downsample to as low as 5-10 Mv in order to succeed on Mac.
-
-	if (factor<0.99)
-	{
-		return factor;
-	}
-	return 1.0;
+	vtkImageDataPtr base = this->getGrayScaleVtkImageData();
+	if (!mPyramid || !mPyramid->isValidFor(base))
+		mPyramid = ImagePyramid::create(base);
+	return mPyramid;
 }
 
 void Image::save(const QString& basePath, FileManagerServicePtr filemanager)
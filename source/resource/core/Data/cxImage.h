@@ -19,6 +19,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <map>
 #include <vector>
 #include <boost/shared_ptr.hpp>
+#include <QMutex>
 #include "cxBoundingBox3D.h"
 #include "vtkForwardDeclarations.h"
 #include "cxForwardDeclarations.h"
@@ -34,6 +35,8 @@ namespace cx
 {
 typedef std::map<int, int> IntIntMap;
 typedef std::map<int, QColor> ColorMap;
+typedef boost::shared_ptr<class ImageStatistics> ImageStatisticsPtr;
+typedef boost::shared_ptr<class ImagePyramid> ImagePyramidPtr;
 
 /** \brief A volumetric data set.
  *
@@ -98,7 +101,7 @@ public:
 
 	virtual DoubleBoundingBox3D boundingBox() const; ///< bounding box in image space
 	virtual Eigen::Array3d getSpacing() const;
-	virtual vtkImageAccumulatePtr getHistogram();///< \return The histogram for the image
+	virtual ImageStatisticsPtr getStatistics();///< \return Range and histogram for the image, computed once per image data. threadsafe
 	virtual int getMax();	///< \return Return highest used value in the image
 	virtual int getMin();	///< \return Return lowest used value in the image
 	virtual int getRange();///< For convenience: getMax() - getMin()
@@ -149,6 +152,7 @@ public:
 	int getInterpolationType() const;
 
 	vtkImageDataPtr resample(long maxVoxels);
+	ImagePyramidPtr getPyramid(); ///< downsampled versions of getGrayScaleVtkImageData(), built on demand
 
 	virtual void save(const QString &basePath, FileManagerServicePtr filemanager);
 
@@ -172,7 +176,9 @@ protected:
 //	vtkImageReslicePtr mOrientator; ///< converts imagedata to outputimagedata
 //	vtkMatrix4x4Ptr mOrientatorMatrix;
 //	vtkImageDataPtr mReferenceImageData; ///< imagedata after filtering through the orientatior, given in reference space
-	vtkImageAccumulatePtr mHistogramPtr;///< Histogram
+	ImageStatisticsPtr mStatistics;
+	QMutex mStatisticsMutex; ///< protects mStatistics, getStatistics() is called from worker threads
+	ImagePyramidPtr mPyramid;
 	ImagePtr mUnsigned; ///< version of this containing unsigned data.
 
 //	LandmarksPtr mLandmarks;
@@ -184,7 +190,6 @@ protected:
 
 	IMAGE_MODALITY mModality; ///< modality of the image, defined as DICOM tag (0008,0060), Section 3, C.7.3.1.1.1
 	IMAGE_SUBTYPE mImageType; ///< type of the image, defined as DICOM tag (0008,0008) (mainly value 3, but might be a merge of value 4), Section 3, C.7.6.1.1.2
-	double mMaxRGBIntensity;
 	int mInterpolationType; ///< mirror the interpolationType in vtkVolumeProperty
 
 
@@ -197,8 +202,6 @@ private:
 	DoubleBoundingBox3D getInitialBoundingBox() const;
 	double loadAttribute(QDomNode dataNode, QString name, double defVal);
 
-	double computeResampleFactor(long maxVoxels);
-
 	ColorMap createPreviewColorMap(const Eigen::Vector2d &threshold);
 	IntIntMap createPreviewOpacityMap(const Eigen::Vector2d &threshold);
 	void createThresholdPreviewTransferFunctions3D(const Eigen::Vector2d &threshold);
@@ -13,6 +13,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "vtkImageData.h"
 #include "cxImage.h"
+#include "cxImageStatistics.h"
 #include "cxImageLUT2D.h"
 #include "cxImageTF3D.h"
 #include "cxSettings.h"
@@ -144,9 +145,8 @@ double_pair ImageDefaultTFGenerator::ensureNonZeroRoundedRange(double_pair range
 
 double_pair ImageDefaultTFGenerator::getFullScalarRange() const
 {
-	double smin = mImage->getBaseVtkImageData()->GetScalarRange()[0];
-	double smax = mImage->getBaseVtkImageData()->GetScalarRange()[1];
-	return std::make_pair(smin, smax);
+	ImageStatisticsPtr statistics = mImage->getStatistics();
+	return std::make_pair(statistics->getScalarMin(), statistics->getScalarMax());
 }
 
 double_pair ImageDefaultTFGenerator::getInitialWindowRange() const
@@ -0,0 +1,187 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxImagePyramid.h"
+
+#include <algorithm>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include <vtkImageShrink3D.h>
+
+namespace cx
+{
+
+typedef vtkSmartPointer<vtkImageShrink3D> vtkImageShrink3DPtr;
+
+namespace
+{
+const int numberOfBaseLevels = 4; // full, 2x, 4x and 8x are shrunk from the base.
+}
+
+ImagePyramidPtr ImagePyramid::create(vtkImageDataPtr base)
+{
+	return ImagePyramidPtr(new ImagePyramid(base));
+}
+
+ImagePyramid::ImagePyramid(vtkImageDataPtr base) :
+	mBase(base),
+	mBaseMTime(base ? base->GetMTime() : 0),
+	mNumberOfLevels(1),
+	mBuildStarted(false)
+{
+	// add levels until the coarsest is a single voxel, thus any budget can be met.
+	if (mBase)
+	{
+		int* dim = mBase->GetDimensions();
+		int maxDim = std::max(dim[0], std::max(dim[1], dim[2]));
+		for (int factor = 1; maxDim/factor > 1; factor *= 2)
+			++mNumberOfLevels;
+	}
+	mLevels.resize(mNumberOfLevels);
+	mLevels[0] = mBase;
+	mFutures.resize(mNumberOfLevels);
+}
+
+ImagePyramid::~ImagePyramid()
+{
+	// workers refer to this
+	for (unsigned i = 0; i < mFutures.size(); ++i)
+		mFutures[i].waitForFinished();
+}
+
+bool ImagePyramid::isValidFor(vtkImageDataPtr base) const
+{
+	return base && (base == mBase) && (base->GetMTime() == mBaseMTime);
+}
+
+int ImagePyramid::getNumberOfLevels() const
+{
+	return mNumberOfLevels;
+}
+
+long ImagePyramid::getNumberOfVoxels(int level) const
+{
+	if (!mBase)
+		return 0;
+	int factor = 1 << level;
+	int* dim = mBase->GetDimensions();
+	long retval = 1;
+	for (int i = 0; i < 3; ++i)
+		retval *= std::max(1, dim[i]/factor);
+	return retval;
+}
+
+int ImagePyramid::findLevel(long maxVoxels) const
+{
+	if (maxVoxels <= 0)
+		return 0;
+	// the coarsest level is a single voxel, thus always within a positive budget.
+	for (int level = 0; level < mNumberOfLevels; ++level)
+		if (this->getNumberOfVoxels(level) <= maxVoxels)
+			return level;
+	return mNumberOfLevels-1;
+}
+
+void ImagePyramid::build()
+{
+	if (mBuildStarted || !mBase)
+		return;
+	mBuildStarted = true;
+
+	// The base levels are shrunk from the base, thus the coarse levels are not
+	// delayed by the fine. The levels below are small, and are shrunk from the
+	// previous level by the task building the coarsest base level.
+	// Each task reads its own shallow copy of the base, as the vtk pipeline
+	// modifies the input data object.
+	int coarsestBase = std::min(numberOfBaseLevels, mNumberOfLevels)-1;
+	for (int level = coarsestBase; level > 0; --level)
+	{
+		vtkImageDataPtr input = vtkImageDataPtr::New();
+		input->ShallowCopy(mBase);
+		int last = (level == coarsestBase) ? mNumberOfLevels-1 : level;
+		QFuture<void> future = QtConcurrent::run(boost::bind(&ImagePyramid::buildLevels, this, input, level, last));
+		for (int i = level; i <= last; ++i)
+			mFutures[i] = future;
+	}
+}
+
+bool ImagePyramid::isReady(int level) const
+{
+	return this->getLevel(level).GetPointer() != NULL;
+}
+
+vtkImageDataPtr ImagePyramid::getLevel(int level) const
+{
+	if ((level < 0) || (level >= mNumberOfLevels))
+		return vtkImageDataPtr();
+	QMutexLocker sentry(&mMutex);
+	return mLevels[level];
+}
+
+vtkImageDataPtr ImagePyramid::getLevelFor(long maxVoxels)
+{
+	int wanted = this->findLevel(maxVoxels);
+	if (wanted > 0)
+		this->build();
+
+	for (int level = wanted; level < mNumberOfLevels; ++level)
+	{
+		vtkImageDataPtr retval = this->getLevel(level);
+		if (retval)
+			return retval;
+	}
+	// show the full resolution rather than nothing until the first level is ready.
+	return mBase;
+}
+
+vtkImageDataPtr ImagePyramid::waitForLevel(int level)
+{
+	if (level <= 0)
+		return mBase;
+	level = std::min(level, mNumberOfLevels-1);
+
+	this->build();
+	mFutures[level].waitForFinished();
+	return this->getLevel(level);
+}
+
+void ImagePyramid::buildLevels(vtkImageDataPtr input, int first, int last)
+{
+	vtkImageDataPtr result = shrink(input, 1 << first);
+	for (int level = first; level <= last; ++level)
+	{
+		if (level > first)
+			result = shrink(result, 2);
+		{
+			QMutexLocker sentry(&mMutex);
+			mLevels[level] = result;
+		}
+		emit levelReady(level);
+	}
+}
+
+vtkImageDataPtr ImagePyramid::shrink(vtkImageDataPtr input, int factor)
+{
+	int* dim = input->GetDimensions();
+
+	vtkImageShrink3DPtr shrinker = vtkImageShrink3DPtr::New();
+	shrinker->SetInputData(input);
+	shrinker->SetShrinkFactors(std::min(factor, dim[0]), std::min(factor, dim[1]), std::min(factor, dim[2]));
+	shrinker->AveragingOn();
+	shrinker->Update();
+
+	vtkImageDataPtr retval = shrinker->GetOutput();
+	retval->GetScalarRange(); // precompute, otherwise done during the first render
+	return retval;
+}
+
+} // namespace cx
@@ -0,0 +1,79 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXIMAGEPYRAMID_H
+#define CXIMAGEPYRAMID_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <QObject>
+#include <QMutex>
+#include <QFuture>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class ImagePyramid> ImagePyramidPtr;
+
+/** \brief Downsampled versions of a volume, for display within a voxel budget.
+ *
+ * Level 0 is the input volume, level n is downsampled by 2^n along
+ * each axis by averaging. The coarsest level is a single voxel.
+ * The levels are built in parallel in the background when first
+ * requested, and levelReady() is emitted for each.
+ *
+ * Users with a voxel budget call getLevelFor(), which never blocks:
+ * It returns the level fitting the budget if ready, otherwise a coarser level,
+ * and the input volume if no level within the budget is ready yet.
+ * Call again on levelReady() to switch to the finer level.
+ *
+ * \ingroup cx_resource_core_data
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT ImagePyramid : public QObject
+{
+	Q_OBJECT
+public:
+	static ImagePyramidPtr create(vtkImageDataPtr base);
+	virtual ~ImagePyramid();
+
+	bool isValidFor(vtkImageDataPtr base) const; ///< true if built from base in its current state
+	int getNumberOfLevels() const;
+	long getNumberOfVoxels(int level) const; ///< size of level, also if not built
+	int findLevel(long maxVoxels) const; ///< finest level with no more than maxVoxels voxels. 0 or less means no limit.
+
+	void build(); ///< start building all levels in the background, if not already started.
+	bool isReady(int level) const;
+	vtkImageDataPtr getLevel(int level) const; ///< NULL if not ready
+	vtkImageDataPtr getLevelFor(long maxVoxels); ///< best ready level within maxVoxels, level 0 if none. Starts build.
+	vtkImageDataPtr waitForLevel(int level); ///< build if required and block until ready
+
+signals:
+	void levelReady(int level); ///< emitted from a worker thread
+
+private:
+	explicit ImagePyramid(vtkImageDataPtr base);
+	void buildLevels(vtkImageDataPtr input, int first, int last);
+	static vtkImageDataPtr shrink(vtkImageDataPtr input, int factor);
+
+	vtkImageDataPtr mBase;
+	unsigned long mBaseMTime;
+	int mNumberOfLevels;
+	bool mBuildStarted;
+	mutable QMutex mMutex; ///< protects mLevels
+	std::vector<vtkImageDataPtr> mLevels;
+	std::vector<QFuture<void> > mFutures; ///< the task building each level, indexed by level
+};
+
+} // namespace cx
+
+#endif // CXIMAGEPYRAMID_H
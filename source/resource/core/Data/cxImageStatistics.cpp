@@ -0,0 +1,299 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxImageStatistics.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include "cxLogger.h"
+
+namespace cx
+{
+
+namespace
+{
+/** Statistics for the voxels [begin, end), merged afterwards.
+ */
+struct Partial
+{
+	Partial(size_t b=0, size_t e=0) :
+		begin(b), end(e),
+		min(std::numeric_limits<double>::max()), max(-std::numeric_limits<double>::max()),
+		scalarMin(std::numeric_limits<double>::max()), scalarMax(-std::numeric_limits<double>::max())
+	{}
+	size_t begin;
+	size_t end;
+	double min;
+	double max;
+	double scalarMin;
+	double scalarMax;
+	std::vector<unsigned long> histogram;
+};
+
+struct Layout
+{
+	int components;
+	bool rgb;
+	int histogramMin;
+	size_t bins; ///< zero: compute range only
+};
+
+template<class T>
+void accumulate(const T* data, Layout layout, Partial& partial)
+{
+	const bool integer = std::numeric_limits<T>::is_integer;
+	partial.histogram.assign(layout.bins, 0);
+
+	double min = partial.min;
+	double max = partial.max;
+	double scalarMin = partial.scalarMin;
+	double scalarMax = partial.scalarMax;
+
+	const T* value = data + partial.begin*layout.components;
+	for (size_t i = partial.begin; i < partial.end; ++i, value += layout.components)
+	{
+		double scalar = value[0];
+		double intensity = scalar;
+		if (layout.rgb)
+		{
+			intensity = (double(value[0]) + double(value[1]) + double(value[2])) / 3.0;
+			if (integer)
+				intensity = std::floor(intensity);
+		}
+		if (!integer && (intensity != intensity)) // NaN
+			continue;
+
+		scalarMin = std::min(scalarMin, scalar);
+		scalarMax = std::max(scalarMax, scalar);
+		min = std::min(min, intensity);
+		max = std::max(max, intensity);
+
+		if (layout.bins)
+		{
+			int bin = (integer ? int(intensity) : int(std::floor(intensity))) - layout.histogramMin;
+			++partial.histogram[bin];
+		}
+	}
+
+	partial.min = min;
+	partial.max = max;
+	partial.scalarMin = scalarMin;
+	partial.scalarMax = scalarMax;
+}
+
+template<class T>
+void accumulateAll(const T* data, Layout layout, std::vector<Partial>& partials)
+{
+	QtConcurrent::blockingMap(partials, boost::bind(&accumulate<T>, data, layout, _1));
+}
+
+const double maxHistogramBins = 1 << 20;
+const size_t maxTotalPartialBins = 1 << 22; ///< limits the memory used by the histograms of all partials
+
+std::vector<Partial> createPartials(size_t numberOfVoxels, size_t bins)
+{
+	// one partial per thread: each needs its own histogram,
+	// thus fewer partials for large histograms.
+	size_t count = std::min<size_t>(numberOfVoxels/(1<<16), QThread::idealThreadCount());
+	if (bins)
+		count = std::min(count, maxTotalPartialBins/bins);
+	count = std::max<size_t>(1, count);
+
+	std::vector<Partial> retval;
+	for (size_t i = 0; i < count; ++i)
+		retval.push_back(Partial(i*numberOfVoxels/count, (i+1)*numberOfVoxels/count));
+	return retval;
+}
+
+void merge(const std::vector<Partial>& partials, Partial* result)
+{
+	result->histogram.clear();
+	for (unsigned i = 0; i < partials.size(); ++i)
+	{
+		const Partial& current = partials[i];
+		result->min = std::min(result->min, current.min);
+		result->max = std::max(result->max, current.max);
+		result->scalarMin = std::min(result->scalarMin, current.scalarMin);
+		result->scalarMax = std::max(result->scalarMax, current.scalarMax);
+
+		result->histogram.resize(current.histogram.size(), 0);
+		for (unsigned j = 0; j < current.histogram.size(); ++j)
+			result->histogram[j] += current.histogram[j];
+	}
+}
+
+/** Compute statistics for one scalar type.
+ *  8 and 16 bit integers are histogrammed over the full type range in
+ *  the same pass as the range, other types use a separate range pass first.
+ */
+template<class T>
+void computeTyped(const T* data, size_t numberOfVoxels, Layout layout, Partial* result, int* histogramMin)
+{
+	bool singlePass = std::numeric_limits<T>::is_integer && (sizeof(T) <= 2);
+
+	if (singlePass)
+	{
+		layout.histogramMin = std::numeric_limits<T>::min();
+		layout.bins = size_t(int(std::numeric_limits<T>::max()) - layout.histogramMin + 1);
+	}
+	else
+	{
+		layout.bins = 0;
+		std::vector<Partial> partials = createPartials(numberOfVoxels, layout.bins);
+		accumulateAll(data, layout, partials);
+		Partial range;
+		merge(partials, &range);
+		if (range.min > range.max) // empty or only NaN
+			return;
+
+		bool fitsInt = (range.min >= std::numeric_limits<int>::min()) && (range.max <= std::numeric_limits<int>::max());
+		if (!fitsInt || (std::floor(range.max) - std::floor(range.min) >= maxHistogramBins))
+		{
+			CX_LOG_WARNING() << "Image intensity range too large for histogram: [" << range.min << ", " << range.max << "]";
+			*result = range;
+			return;
+		}
+		layout.histogramMin = int(std::floor(range.min));
+		layout.bins = size_t(int(std::floor(range.max)) - layout.histogramMin + 1);
+	}
+
+	std::vector<Partial> partials = createPartials(numberOfVoxels, layout.bins);
+	accumulateAll(data, layout, partials);
+	merge(partials, result);
+	if (result->min > result->max)
+		return;
+
+	// keep only the bins in [min, max]
+	int first = int(std::floor(result->min)) - layout.histogramMin;
+	int last = int(std::floor(result->max)) - layout.histogramMin;
+	result->histogram.erase(result->histogram.begin() + last + 1, result->histogram.end());
+	result->histogram.erase(result->histogram.begin(), result->histogram.begin() + first);
+	*histogramMin = layout.histogramMin + first;
+}
+
+} // namespace
+
+ImageStatisticsPtr ImageStatistics::create(vtkImageDataPtr image)
+{
+	ImageStatisticsPtr retval(new ImageStatistics());
+	retval->compute(image);
+	return retval;
+}
+
+ImageStatistics::ImageStatistics() :
+	mImage(NULL),
+	mMTime(0),
+	mMin(0),
+	mMax(0),
+	mScalarMin(0),
+	mScalarMax(0),
+	mHistogramMin(0),
+	mNumberOfVoxels(0)
+{
+}
+
+bool ImageStatistics::isValidFor(vtkImageDataPtr image) const
+{
+	return image && (image.GetPointer() == mImage) && (image->GetMTime() == mMTime);
+}
+
+unsigned long ImageStatistics::getCount(int intensity) const
+{
+	int bin = intensity - mHistogramMin;
+	if ((bin < 0) || (bin >= int(mHistogram.size())))
+		return 0;
+	return mHistogram[bin];
+}
+
+unsigned long ImageStatistics::getMaxCount(bool ignoreZero) const
+{
+	unsigned long retval = 0;
+	for (unsigned i = 0; i < mHistogram.size(); ++i)
+	{
+		if (ignoreZero && (int(i) + mHistogramMin == 0))
+			continue;
+		retval = std::max(retval, mHistogram[i]);
+	}
+	return retval;
+}
+
+void ImageStatistics::compute(vtkImageDataPtr image)
+{
+	if (!image)
+		return;
+	mImage = image.GetPointer();
+	mMTime = image->GetMTime();
+
+	vtkDataArray* scalars = image->GetPointData()->GetScalars();
+	if (!scalars || !scalars->GetNumberOfTuples())
+		return;
+	mNumberOfVoxels = scalars->GetNumberOfTuples();
+
+	Layout layout;
+	layout.components = scalars->GetNumberOfComponents();
+	layout.rgb = (layout.components == 3);
+	layout.histogramMin = 0;
+	layout.bins = 0;
+
+	Partial result;
+	void* data = scalars->GetVoidPointer(0);
+
+	switch (scalars->GetDataType())
+	{
+	case VTK_CHAR:
+		computeTyped(static_cast<char*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_SIGNED_CHAR:
+		computeTyped(static_cast<signed char*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_UNSIGNED_CHAR:
+		computeTyped(static_cast<unsigned char*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_SHORT:
+		computeTyped(static_cast<short*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_UNSIGNED_SHORT:
+		computeTyped(static_cast<unsigned short*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_INT:
+		computeTyped(static_cast<int*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_UNSIGNED_INT:
+		computeTyped(static_cast<unsigned int*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_FLOAT:
+		computeTyped(static_cast<float*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	case VTK_DOUBLE:
+		computeTyped(static_cast<double*>(data), mNumberOfVoxels, layout, &result, &mHistogramMin);
+		break;
+	default:
+		CX_LOG_ERROR() << "Unhandled data type " << scalars->GetDataTypeAsString() << " in ImageStatistics";
+		return;
+	}
+
+	if (result.min > result.max) // no valid values
+		return;
+
+	mMin = result.min;
+	mMax = result.max;
+	mScalarMin = result.scalarMin;
+	mScalarMax = result.scalarMax;
+	mHistogram.swap(result.histogram);
+}
+
+} // namespace cx
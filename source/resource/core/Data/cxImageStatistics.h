@@ -0,0 +1,76 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXIMAGESTATISTICS_H
+#define CXIMAGESTATISTICS_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class ImageStatistics> ImageStatisticsPtr;
+
+/** \brief Scalar statistics for a vtkImageData: range and histogram.
+ *
+ * All values are found in one parallel pass over the volume.
+ * 8 and 16 bit types are histogrammed over the full type range directly,
+ * other types need an additional pass to find the range first.
+ *
+ * The intensity of a voxel is the first component, or for RGB images
+ * the average of the three color components.
+ * The histogram has one bin per integer intensity in [floor(min), floor(max)],
+ * and is empty if the range exceeds 2^20 bins.
+ *
+ * The object is immutable after creation and can be shared between threads.
+ * Use isValidFor() to check if the image has been modified since.
+ *
+ * \ingroup cx_resource_core_data
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT ImageStatistics
+{
+public:
+	static ImageStatisticsPtr create(vtkImageDataPtr image);
+
+	bool isValidFor(vtkImageDataPtr image) const; ///< true if computed from image in its current state
+
+	double getMin() const { return mMin; } ///< lowest intensity
+	double getMax() const { return mMax; } ///< highest intensity
+	double getScalarMin() const { return mScalarMin; } ///< lowest value in the first component, as vtkImageData::GetScalarRange()
+	double getScalarMax() const { return mScalarMax; } ///< highest value in the first component, as vtkImageData::GetScalarRange()
+
+	int getHistogramMin() const { return mHistogramMin; } ///< intensity of the first bin
+	int getHistogramMax() const { return mHistogramMin + int(mHistogram.size()) - 1; } ///< intensity of the last bin
+	unsigned long getCount(int intensity) const; ///< number of voxels with floor(intensity)
+	unsigned long getMaxCount(bool ignoreZero = true) const; ///< the largest bin, optionally ignoring intensity zero
+	unsigned long getNumberOfVoxels() const { return mNumberOfVoxels; }
+
+private:
+	ImageStatistics();
+	void compute(vtkImageDataPtr image);
+
+	vtkImageData* mImage; ///< identifies the source image together with mMTime, never dereferenced.
+	unsigned long mMTime;
+	double mMin;
+	double mMax;
+	double mScalarMin;
+	double mScalarMax;
+	int mHistogramMin;
+	std::vector<unsigned long> mHistogram;
+	unsigned long mNumberOfVoxels;
+};
+
+} // namespace cx
+
+#endif // CXIMAGESTATISTICS_H
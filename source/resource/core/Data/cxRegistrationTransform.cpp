@@ -206,6 +206,19 @@ bool operator==(const ParentSpace& lhs, const ParentSpace& rhs)
 //-------  RegistrationHistory    -------------------------
 //---------------------------------------------------------
 
+RegistrationHistory::RegistrationHistory() :
+	mVersion(0)
+{
+}
+
+/** Increase the version before emitting, thus listeners always see the new version.
+ */
+void RegistrationHistory::emitCurrentChanged()
+{
+	mVersion.ref();
+	emit currentChanged();
+}
+
 RegistrationHistoryPtr RegistrationHistory::getNullObject()
 {
 	if (!mNull)
@@ -325,7 +338,7 @@ void RegistrationHistory::setRegistration(const Transform3D& transform)
 	this->addRegistrationInternal(RegistrationTransform(transform));
 	if (changed)
 	{
-		emit currentChanged();
+		this->emitCurrentChanged();
 	}
 }
 
@@ -431,7 +444,7 @@ void RegistrationHistory::setCache(const RegistrationTransform& val, const Paren
 	mTransformCache = val;
 	mParentSpaceCache = parent;
 
-	emit currentChanged();
+	this->emitCurrentChanged();
 }
 
 /**set the active time. Use only registrations performed at or prior
@@ -21,6 +21,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <boost/shared_ptr.hpp>
 #include <QObject>
 #include <QDateTime>
+#include <QAtomicInt>
 
 #include "cxTransform3D.h"
 
@@ -97,6 +98,7 @@ class cxResource_EXPORT RegistrationHistory: public QObject
 {
 Q_OBJECT
 public:
+	RegistrationHistory();
 	virtual void addXml(QDomNode& parentNode) const; ///< write internal state to node
 	virtual void parseXml(QDomNode& dataNode);///< read internal state from node
 
@@ -121,6 +123,7 @@ public:
 		return false;
 	}
 	static RegistrationHistoryPtr getNullObject();
+	int getVersion() const { return mVersion.loadAcquire(); } ///< increased each time currentChanged() is emitted. threadsafe
 
 signals:
 	void currentChanged();
@@ -128,12 +131,14 @@ private:
 	virtual void addParentSpace(const ParentSpace& newParent);
 	virtual void addRegistrationInternal(const RegistrationTransform& transform);
 	void setCache(const RegistrationTransform& val, const ParentSpace& parent, const QDateTime& timestamp);
+	void emitCurrentChanged();
 	static RegistrationHistoryPtr mNull;
 	std::vector<RegistrationTransform> mData; ///< time-sorted list of all registration events.
 	std::vector<ParentSpace> mParentSpaces; ///< time-sorted list of all registration events.
 	QDateTime mCurrentTime; ///< disregard registrations later than this time. Invalid means use running time.
 	RegistrationTransform mTransformCache; ///< cache for the currently active transform
 	ParentSpace mParentSpaceCache; ///< cache for the currently active parent frame
+	QAtomicInt mVersion;
 };
 
 } // end namespace cx
@@ -21,7 +21,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include <vtkImageResample.h>
 #include <vtkImageClip.h>
-#include "vtkImageShiftScale.h"
+#include <vtkDataArray.h>
+#include <vtkTypeTraits.h>
+#include <algorithm>
 
 #include "cxImage.h"
 #include "cxUtilHelpers.h"
@@ -38,6 +40,37 @@ typedef vtkSmartPointer<vtkDoubleArray> vtkDoubleArrayPtr;
 namespace cx
 {
 
+namespace
+{
+template<class IT, class OT>
+void convertToUnsigned(const IT* input, OT* output, vtkIdType count, int shift)
+{
+	// clamp as vtkImageShiftScale::ClampOverflowOn()
+	double maxValue = vtkDataArray::GetDataTypeMax(vtkTypeTraits<OT>::VTKTypeID());
+	for (vtkIdType i = 0; i < count; ++i)
+	{
+		double value = double(input[i]) + shift;
+		output[i] = static_cast<OT>(std::min(std::max(value, 0.0), maxValue));
+	}
+}
+
+template<class IT>
+bool convertToUnsigned(const IT* input, void* output, int outputScalarType, vtkIdType count, int shift)
+{
+	switch (outputScalarType)
+	{
+	case VTK_UNSIGNED_SHORT:
+		convertToUnsigned(input, static_cast<unsigned short*>(output), count, shift);
+		return true;
+	case VTK_UNSIGNED_INT:
+		convertToUnsigned(input, static_cast<unsigned int*>(output), count, shift);
+		return true;
+	default:
+		return false;
+	}
+}
+} // namespace
+
 ImagePtr UnsignedDerivedImage::create(ImagePtr base)
 {
     boost::shared_ptr<UnsignedDerivedImage> retval;
@@ -45,7 +78,10 @@ ImagePtr UnsignedDerivedImage::create(ImagePtr base)
     return retval;
 }
 
-UnsignedDerivedImage::UnsignedDerivedImage(ImagePtr base) : Image(base->getUid()+"_u", vtkImageDataPtr(), base->getName())
+UnsignedDerivedImage::UnsignedDerivedImage(ImagePtr base) :
+	Image(base->getUid()+"_u", vtkImageDataPtr(), base->getName()),
+	mShift(0),
+	mScalarType(VTK_UNSIGNED_SHORT)
 {
     this->mBase = base;
 
@@ -61,7 +97,6 @@ UnsignedDerivedImage::UnsignedDerivedImage(ImagePtr base) : Image(base->getUid()
 
 	connect(this, SIGNAL(transferFunctionsChanged()), this, SLOT(testSlot()));
 	this->unsignedImageChangedSlot();
-    this->unsignedTransferFunctionsChangedSlot();
 }
 
 void UnsignedDerivedImage::testSlot()
@@ -89,7 +124,50 @@ void UnsignedDerivedImage::unsignedTransferFunctionsChangedSlot()
 
 void UnsignedDerivedImage::unsignedImageChangedSlot()
 {
-    this->setVtkImageData(this->convertImage());
+	mShift = this->findShift();
+	mScalarType = this->findScalarType();
+	// drop the converted volume, if any: getBaseVtkImageData() recreates it.
+	this->setVtkImageData(vtkImageDataPtr(), false);
+	this->unsignedTransferFunctionsChangedSlot();
+}
+
+vtkImageDataPtr UnsignedDerivedImage::getBaseVtkImageData()
+{
+	if (!mBaseImageData)
+		mBaseImageData = this->convertImage();
+	return mBaseImageData;
+}
+
+ImageStatisticsPtr UnsignedDerivedImage::getStatistics()
+{
+	this->getBaseVtkImageData(); // statistics need the converted volume
+	return Image::getStatistics();
+}
+
+/** Convert numberOfSlices slices from the base image, starting at firstSlice,
+ *  into output, which must hold numberOfSlices slices of getUnsignedScalarType().
+ */
+bool UnsignedDerivedImage::copyUnsignedSlices(int firstSlice, int numberOfSlices, void* output)
+{
+	ImagePtr base = mBase.lock();
+	if (!base)
+		return false;
+	vtkImageDataPtr input = base->getBaseVtkImageData();
+
+	int* dim = input->GetDimensions();
+	if (firstSlice < 0 || numberOfSlices < 0 || firstSlice + numberOfSlices > dim[2])
+		return false;
+
+	vtkIdType sliceSize = vtkIdType(dim[0]) * dim[1] * input->GetNumberOfScalarComponents();
+	vtkIdType count = sliceSize * numberOfSlices;
+	void* inputPtr = static_cast<char*>(input->GetScalarPointer()) + sliceSize * firstSlice * input->GetScalarSize();
+
+	switch (input->GetScalarType())
+	{
+		vtkTemplateMacro(return convertToUnsigned(static_cast<const VTK_TT*>(inputPtr), output, mScalarType, count, mShift));
+	default:
+		return false;
+	}
 }
 
 int UnsignedDerivedImage::findShift()
@@ -110,40 +188,43 @@ int UnsignedDerivedImage::findShift()
     return shift;
 }
 
-vtkImageDataPtr UnsignedDerivedImage::convertImage()
+/** The smallest unsigned type holding the intensity range of the base image.
+ */
+int UnsignedDerivedImage::findScalarType()
 {
-    vtkImageDataPtr retval;
-
     ImagePtr base = mBase.lock();
     if (!base)
-        return retval;
-
-    int shift = this->findShift();
+        return VTK_UNSIGNED_SHORT;
     vtkImageDataPtr input = base->getBaseVtkImageData();
 
-    vtkImageShiftScalePtr cast = vtkImageShiftScalePtr::New();
-	cast->SetInputData(input);
-    cast->ClampOverflowOn();
-
-    cast->SetShift(shift);
-
     // total intensity range of voxels:
     double range = input->GetScalarRange()[1] - input->GetScalarRange()[0];
 
     // to to fit within smallest type
     if (range <= VTK_UNSIGNED_SHORT_MAX-VTK_UNSIGNED_SHORT_MIN)
-        cast->SetOutputScalarType(VTK_UNSIGNED_SHORT);
-    else if (range <= VTK_UNSIGNED_INT_MAX-VTK_UNSIGNED_INT_MIN)
-        cast->SetOutputScalarType(VTK_UNSIGNED_INT);
+        return VTK_UNSIGNED_SHORT;
 //	else if (range <= VTK_UNSIGNED_LONG_MAX-VTK_UNSIGNED_LONG_MIN) // not supported by vtk - it seems (crash in rendering)
-//		cast->SetOutputScalarType(VTK_UNSIGNED_LONG);
-    else
-        cast->SetOutputScalarType(VTK_UNSIGNED_INT);
+//		return VTK_UNSIGNED_LONG;
+    return VTK_UNSIGNED_INT;
+}
+
+vtkImageDataPtr UnsignedDerivedImage::convertImage()
+{
+    vtkImageDataPtr retval;
+
+    ImagePtr base = mBase.lock();
+    if (!base)
+        return retval;
+
+    vtkImageDataPtr input = base->getBaseVtkImageData();
+
+    retval = vtkImageDataPtr::New();
+    retval->CopyStructure(input);
+    retval->AllocateScalars(mScalarType, input->GetNumberOfScalarComponents());
+    this->copyUnsignedSlices(0, input->GetDimensions()[2], retval->GetScalarPointer());
 
-    cast->Update();
 //		if (verbose)
-      report(QString("Converting image %1 from %2 to %3").arg(this->getName()).arg(input->GetScalarTypeAsString()).arg(cast->GetOutput()->GetScalarTypeAsString()));
-    retval = cast->GetOutput();
+      report(QString("Converting image %1 from %2 to %3").arg(this->getName()).arg(input->GetScalarTypeAsString()).arg(retval->GetScalarTypeAsString()));
     return retval;
 }
 
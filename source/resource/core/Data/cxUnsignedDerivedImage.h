@@ -36,6 +36,11 @@ struct CoordinateSystem;
  * Intended for structures that requires unsigned input, such
  * as TextureSlice3DProxy.
  *
+ * The unsigned voxels are computed on demand: copyUnsignedSlices() converts
+ * a range of slices from the base image into a buffer, thus consumers
+ * such as texture uploads can convert a slab at a time. The full unsigned
+ * volume is only created if getBaseVtkImageData() is called.
+ *
  * \ingroup cx_resource_core_data
  *   \date Feb 21, 2013
  *   \author christiana
@@ -46,6 +51,11 @@ class cxResource_EXPORT UnsignedDerivedImage : public Image
 public:
     static ImagePtr create(ImagePtr base);
 
+	virtual vtkImageDataPtr getBaseVtkImageData(); ///< converts the entire base image: prefer copyUnsignedSlices()
+	ImagePtr getBase() { return mBase.lock(); }
+	int getShift() const { return mShift; } ///< added to the base voxels
+	int getUnsignedScalarType() const { return mScalarType; }
+	bool copyUnsignedSlices(int firstSlice, int numberOfSlices, void* output);
 
     virtual RegistrationHistoryPtr get_rMd_History() { CALL_IN_WEAK_PTR(mBase, get_rMd_History, RegistrationHistoryPtr()); }
 //    virtual QString getUid() const                   { CALL_IN_WEAK_PTR(mBase, getUid, QString()); }
@@ -58,6 +68,8 @@ public:
     virtual QString getSpace()                       { CALL_IN_WEAK_PTR(mBase, getSpace, QString()); }
     virtual QString getParentSpace()                 { CALL_IN_WEAK_PTR(mBase, getParentSpace, QString()); }
     virtual DoubleBoundingBox3D boundingBox() const  { CALL_IN_WEAK_PTR(mBase, boundingBox, DoubleBoundingBox3D()); }
+    virtual Eigen::Array3d getSpacing() const        { CALL_IN_WEAK_PTR(mBase, getSpacing, Eigen::Array3d(1, 1, 1)); }
+    virtual ImageStatisticsPtr getStatistics();
 	virtual CoordinateSystem getCoordinateSystem();
 
 		virtual IMAGE_MODALITY getModality() const       { CALL_IN_WEAK_PTR(mBase, getModality, IMAGE_MODALITY()); }
@@ -71,11 +83,15 @@ private slots:
 private:
     UnsignedDerivedImage(ImagePtr base);
     int findShift();
+    int findScalarType();
     vtkImageDataPtr convertImage();
     void convertTransferFunctions();
 
     boost::weak_ptr<Image> mBase;
+    int mShift;
+    int mScalarType;
 };
+typedef boost::shared_ptr<UnsignedDerivedImage> UnsignedDerivedImagePtr;
 
 }
 #endif // CXUNSIGNEDDERIVEDIMAGE_H_
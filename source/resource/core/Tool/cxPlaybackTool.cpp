@@ -63,6 +63,7 @@ void PlaybackTool::timeChangedSlot()
 	{
 		m_rMpr = lastSample->second;
 		mTimestamp = lastSample->first;
+		this->incrementChangeCount();
 		emit toolTransformAndTimestamp(m_rMpr, mTimestamp);
 	}
 }
@@ -0,0 +1,191 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxTimedTransformMap.h"
+
+#include <algorithm>
+
+namespace cx
+{
+
+namespace
+{
+bool valueLessThanKey(const TimedTransformMap::value_type& value, double key)
+{
+	return value.first < key;
+}
+bool keyLessThanValue(double key, const TimedTransformMap::value_type& value)
+{
+	return key < value.first;
+}
+} // namespace
+
+TimedTransformMap::TimedTransformMap(size_t chunkSize) :
+	mChunkSize(std::max<size_t>(chunkSize, 2)),
+	mSize(0)
+{
+}
+
+void TimedTransformMap::clear()
+{
+	mChunks.clear();
+	mSize = 0;
+}
+
+void TimedTransformMap::findLowerBound(double key, size_t* chunk, size_t* index) const
+{
+	// first chunk containing a value >= key
+	size_t lo = 0;
+	size_t hi = mChunks.size();
+	while (lo < hi)
+	{
+		size_t mid = (lo+hi)/2;
+		if (mChunks[mid].back().first < key)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	*chunk = lo;
+	*index = 0;
+	if (lo < mChunks.size())
+	{
+		const Chunk& current = mChunks[lo];
+		*index = std::lower_bound(current.begin(), current.end(), key, valueLessThanKey) - current.begin();
+	}
+}
+
+void TimedTransformMap::findUpperBound(double key, size_t* chunk, size_t* index) const
+{
+	// first chunk containing a value > key
+	size_t lo = 0;
+	size_t hi = mChunks.size();
+	while (lo < hi)
+	{
+		size_t mid = (lo+hi)/2;
+		if (mChunks[mid].back().first <= key)
+			lo = mid+1;
+		else
+			hi = mid;
+	}
+	*chunk = lo;
+	*index = 0;
+	if (lo < mChunks.size())
+	{
+		const Chunk& current = mChunks[lo];
+		*index = std::upper_bound(current.begin(), current.end(), key, keyLessThanValue) - current.begin();
+	}
+}
+
+TimedTransformMap::iterator TimedTransformMap::lower_bound(double key)
+{
+	size_t chunk, index;
+	this->findLowerBound(key, &chunk, &index);
+	return iterator(this, chunk, index);
+}
+
+TimedTransformMap::const_iterator TimedTransformMap::lower_bound(double key) const
+{
+	size_t chunk, index;
+	this->findLowerBound(key, &chunk, &index);
+	return const_iterator(this, chunk, index);
+}
+
+TimedTransformMap::iterator TimedTransformMap::upper_bound(double key)
+{
+	size_t chunk, index;
+	this->findUpperBound(key, &chunk, &index);
+	return iterator(this, chunk, index);
+}
+
+TimedTransformMap::const_iterator TimedTransformMap::upper_bound(double key) const
+{
+	size_t chunk, index;
+	this->findUpperBound(key, &chunk, &index);
+	return const_iterator(this, chunk, index);
+}
+
+TimedTransformMap::iterator TimedTransformMap::find(double key)
+{
+	iterator iter = this->lower_bound(key);
+	if ((iter != this->end()) && (iter->first == key))
+		return iter;
+	return this->end();
+}
+
+TimedTransformMap::const_iterator TimedTransformMap::find(double key) const
+{
+	const_iterator iter = this->lower_bound(key);
+	if ((iter != this->end()) && (iter->first == key))
+		return iter;
+	return this->end();
+}
+
+TimedTransformMap::size_type TimedTransformMap::count(double key) const
+{
+	return (this->find(key) != this->end()) ? 1 : 0;
+}
+
+Transform3D& TimedTransformMap::operator[](double key)
+{
+	return this->insert(value_type(key, Transform3D::Identity())).first->second;
+}
+
+std::pair<TimedTransformMap::iterator, bool> TimedTransformMap::insert(const value_type& value)
+{
+	// fast path: newer than all stored values
+	if (mChunks.empty() || (mChunks.back().back().first < value.first))
+		return std::make_pair(this->append(value), true);
+
+	size_t chunk, index;
+	this->findLowerBound(value.first, &chunk, &index);
+	if (mChunks[chunk][index].first == value.first)
+		return std::make_pair(iterator(this, chunk, index), false);
+	return std::make_pair(this->insertBefore(chunk, index, value), true);
+}
+
+TimedTransformMap::iterator TimedTransformMap::append(const value_type& value)
+{
+	if (mChunks.empty() || (mChunks.back().size() >= mChunkSize))
+	{
+		mChunks.push_back(Chunk());
+		mChunks.back().reserve(mChunkSize);
+	}
+	mChunks.back().push_back(value);
+	++mSize;
+	return iterator(this, mChunks.size()-1, mChunks.back().size()-1);
+}
+
+TimedTransformMap::iterator TimedTransformMap::insertBefore(size_t chunk, size_t index, const value_type& value)
+{
+	if (mChunks[chunk].size() >= mChunkSize)
+	{
+		// split full chunk in two halves
+		size_t half = mChunks[chunk].size()/2;
+		Chunk upper;
+		upper.reserve(mChunkSize);
+		upper.insert(upper.end(), mChunks[chunk].begin()+half, mChunks[chunk].end());
+		mChunks[chunk].erase(mChunks[chunk].begin()+half, mChunks[chunk].end());
+		mChunks.insert(mChunks.begin()+chunk+1, Chunk());
+		mChunks[chunk+1].swap(upper);
+
+		if (index >= half)
+		{
+			++chunk;
+			index -= half;
+		}
+	}
+
+	Chunk& current = mChunks[chunk];
+	current.insert(current.begin()+index, value);
+	++mSize;
+	return iterator(this, chunk, index);
+}
+
+} // namespace cx
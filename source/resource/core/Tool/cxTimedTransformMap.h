@@ -0,0 +1,168 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXTIMEDTRANSFORMMAP_H
+#define CXTIMEDTRANSFORMMAP_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <iterator>
+#include <boost/shared_ptr.hpp>
+#include "cxTransform3D.h"
+
+namespace cx
+{
+
+/** \brief Time-sorted storage of transforms, e.g. the position history of a tool.
+ *
+ * Implements the subset of the std::map<double, Transform3D> interface
+ * used by the tools: iteration, lower/upper_bound, find and operator[].
+ *
+ * The values are stored in chunks of contiguous memory instead of one heap
+ * node per sample. Appending a sample newer than all others, which is
+ * the normal case for tracking data, is amortized O(1). Other inserts
+ * shift the values in one chunk, splitting it when full.
+ *
+ * Differences from std::map:
+ *  - Iterators are invalidated by insertion.
+ *  - The key of value_type is not const, but must not be modified.
+ *
+ * \ingroup cx_resource_core_tool
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT TimedTransformMap
+{
+public:
+	typedef double key_type;
+	typedef Transform3D mapped_type;
+	typedef std::pair<double, Transform3D> value_type;
+	typedef size_t size_type;
+
+private:
+	typedef std::vector<value_type, Eigen::aligned_allocator<value_type> > Chunk;
+	typedef std::vector<Chunk> ChunkVector;
+
+	template<class MAP, class VALUE>
+	class Iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef TimedTransformMap::value_type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef VALUE* pointer;
+		typedef VALUE& reference;
+
+		Iterator() : mMap(NULL), mChunk(0), mIndex(0) {}
+		Iterator(MAP* map, size_t chunk, size_t index) : mMap(map), mChunk(chunk), mIndex(index) {}
+		template<class OTHER_MAP, class OTHER_VALUE>
+		Iterator(const Iterator<OTHER_MAP, OTHER_VALUE>& other) : mMap(other.mMap), mChunk(other.mChunk), mIndex(other.mIndex) {}
+
+		reference operator*() const { return mMap->mChunks[mChunk][mIndex]; }
+		pointer operator->() const { return &mMap->mChunks[mChunk][mIndex]; }
+
+		Iterator& operator++()
+		{
+			if (++mIndex >= mMap->mChunks[mChunk].size())
+			{
+				++mChunk;
+				mIndex = 0;
+			}
+			return *this;
+		}
+		Iterator& operator--()
+		{
+			if (mIndex == 0)
+				mIndex = mMap->mChunks[--mChunk].size();
+			--mIndex;
+			return *this;
+		}
+		Iterator operator++(int) { Iterator retval(*this); ++(*this); return retval; }
+		Iterator operator--(int) { Iterator retval(*this); --(*this); return retval; }
+
+		template<class OTHER_MAP, class OTHER_VALUE>
+		bool operator==(const Iterator<OTHER_MAP, OTHER_VALUE>& other) const
+		{
+			return (mChunk == other.mChunk) && (mIndex == other.mIndex) && (mMap == other.mMap);
+		}
+		template<class OTHER_MAP, class OTHER_VALUE>
+		bool operator!=(const Iterator<OTHER_MAP, OTHER_VALUE>& other) const { return !(*this == other); }
+
+	private:
+		template<class OTHER_MAP, class OTHER_VALUE> friend class Iterator;
+		friend class TimedTransformMap;
+		MAP* mMap;
+		size_t mChunk; ///< index of chunk, == mChunks.size() for end()
+		size_t mIndex; ///< index in chunk
+	};
+
+public:
+	typedef Iterator<TimedTransformMap, value_type> iterator;
+	typedef Iterator<const TimedTransformMap, const value_type> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	explicit TimedTransformMap(size_t chunkSize = 1024);
+	template<class INPUT_ITERATOR>
+	TimedTransformMap(INPUT_ITERATOR first, INPUT_ITERATOR last) : mChunkSize(1024), mSize(0)
+	{
+		this->insert(first, last);
+	}
+
+	iterator begin() { return iterator(this, 0, 0); }
+	iterator end() { return iterator(this, mChunks.size(), 0); }
+	const_iterator begin() const { return const_iterator(this, 0, 0); }
+	const_iterator end() const { return const_iterator(this, mChunks.size(), 0); }
+	reverse_iterator rbegin() { return reverse_iterator(this->end()); }
+	reverse_iterator rend() { return reverse_iterator(this->begin()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(this->end()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(this->begin()); }
+
+	size_type size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+	void clear();
+
+	iterator lower_bound(double key);
+	iterator upper_bound(double key);
+	iterator find(double key);
+	const_iterator lower_bound(double key) const;
+	const_iterator upper_bound(double key) const;
+	const_iterator find(double key) const;
+	size_type count(double key) const;
+
+	Transform3D& operator[](double key);
+	/** Insert value if the key is not present.
+	 *  Return an iterator to the value with the key, and true if inserted.
+	 */
+	std::pair<iterator, bool> insert(const value_type& value);
+	template<class INPUT_ITERATOR>
+	void insert(INPUT_ITERATOR first, INPUT_ITERATOR last)
+	{
+		for (; first != last; ++first)
+			this->insert(value_type(first->first, first->second));
+	}
+
+	size_t getNumberOfChunks() const { return mChunks.size(); }
+
+private:
+	void findLowerBound(double key, size_t* chunk, size_t* index) const;
+	void findUpperBound(double key, size_t* chunk, size_t* index) const;
+	iterator insertBefore(size_t chunk, size_t index, const value_type& value);
+	iterator append(const value_type& value);
+
+	ChunkVector mChunks; ///< sorted, non-empty chunks
+	size_t mChunkSize;
+	size_t mSize;
+};
+typedef boost::shared_ptr<TimedTransformMap> TimedTransformMapPtr;
+
+} // namespace cx
+
+#endif // CXTIMEDTRANSFORMMAP_H
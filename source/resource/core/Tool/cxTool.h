@@ -23,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QDomNode>
 #include "vtkForwardDeclarations.h"
 #include "cxTransform3D.h"
+#include "cxTimedTransformMap.h"
 #include "cxIndent.h"
 #include "cxCoordinateSystemHelpers.h"
 #include "cxProbe.h"
@@ -32,8 +33,6 @@ namespace cx
 {
 typedef boost::shared_ptr<class Tool> ToolPtr;
 typedef std::map<QString, ToolPtr> ToolMap;
-typedef std::map<double, Transform3D> TimedTransformMap;
-typedef boost::shared_ptr<TimedTransformMap> TimedTransformMapPtr;
 typedef boost::shared_ptr<class TrackingPositionFilter> TrackingPositionFilterPtr;
 
 /**
@@ -114,6 +113,7 @@ public:
 
 	virtual ProbePtr getProbe() const { return ProbePtr(); } ///< additional information if the tool represents an US Probe. Extends getProbeSector()
 	virtual double getTimestamp() const = 0; ///< latest valid timestamp for the position matrix. 0 means indeterminate (for f.ex. manual tools)
+	virtual int getChangeCount() const { return -1; } ///< incremented each time the position, calibration or offset changes. -1 means not counted.
 	virtual void printSelf(std::ostream &os, Indent indent) { Q_UNUSED(os); Q_UNUSED(indent); } ///< dump internal debug data
 
 	virtual double getTooltipOffset() const { return 0; } ///< get a virtual offset extending from the tool tip.
@@ -72,9 +72,20 @@ void ToolImpl::setTooltipOffset(double val)
 	if (similar(val, mTooltipOffset))
 		return;
 	mTooltipOffset = val;
+	this->incrementChangeCount();
 	emit tooltipOffset(mTooltipOffset);
 }
 
+int ToolImpl::getChangeCount() const
+{
+	return mChangeCount.loadAcquire();
+}
+
+void ToolImpl::incrementChangeCount()
+{
+	mChangeCount.ref();
+}
+
 TimedTransformMapPtr ToolImpl::getPositionHistory()
 {
 	return mPositionHistory;
@@ -103,6 +114,7 @@ void ToolImpl::set_prMt(const Transform3D& prMt, double timestamp)
 	}
 
 	m_prMt = prMt;
+	this->incrementChangeCount();
 	// Store positions in history, but only if visible - the history has no concept of visibility
 	if (this->getVisible())
 		(*mPositionHistory)[timestamp] = m_prMt;
@@ -15,6 +15,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxTool.h"
 #include "cxToolFileParser.h"
+#include <QAtomicInt>
 
 namespace cx
 {
@@ -43,6 +44,7 @@ public:
 
 	virtual double getTooltipOffset() const;
 	virtual void setTooltipOffset(double val);
+	virtual int getChangeCount() const;
 
 	virtual void resetTrackingPositionFilter(TrackingPositionFilterPtr filter);
 	virtual bool isNull() { return false; }
@@ -55,6 +57,7 @@ public:
 protected:
 	virtual void set_prMt(const Transform3D& prMt, double timestamp);
 	void createToolGraphic();
+	void incrementChangeCount(); ///< call after changing m_prMt, calibration or offset
 
 	TimedTransformMapPtr mPositionHistory;
 	Transform3D m_prMt; ///< the transform from the tool to the patient reference
@@ -67,6 +70,7 @@ protected:
 	virtual ToolFileParser::ToolInternalStructurePtr getToolFileToolStructure() const { return ToolFileParser::ToolInternalStructurePtr(); }
 private:
 	double mTooltipOffset;
+	QAtomicInt mChangeCount;
 };
 typedef boost::shared_ptr<ToolImpl> cxToolPtr;
 
@@ -137,6 +137,11 @@ void ToolProxy::printSelf(std::ostream &os, Indent indent)
 	mTool->printSelf(os, indent);
 }
 
+int ToolProxy::getChangeCount() const
+{
+	return mTool->getChangeCount();
+}
+
 double ToolProxy::getTooltipOffset() const
 {
 	return mTool->getTooltipOffset();
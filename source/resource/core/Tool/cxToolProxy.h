@@ -50,6 +50,7 @@ public:
 
 	virtual ProbePtr getProbe() const;
 	virtual double getTimestamp() const;
+	virtual int getChangeCount() const;
 	virtual void printSelf(std::ostream &os, Indent indent);
 
 	virtual double getTooltipOffset() const;
@@ -26,7 +26,6 @@ class QDomNode;
 namespace cx
 {
 
-typedef std::map<double, Transform3D> TimedTransformMap;
 typedef boost::shared_ptr<class Tool> ToolPtr;
 typedef std::map<ToolPtr, TimedTransformMap> SessionToolHistoryMap;
 typedef boost::shared_ptr<class Landmarks> LandmarksPtr;
@@ -0,0 +1,137 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxVideoFramePool.h"
+
+#include <string.h>
+#include <QMutexLocker>
+#include <vtkImageData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+
+namespace cx
+{
+
+VideoFramePool::VideoFramePool(unsigned maxFrames) :
+	mMaxFrames(maxFrames),
+	mHits(0),
+	mMisses(0)
+{
+}
+
+bool VideoFramePool::isFree(vtkImageData* frame) const
+{
+	// only the pool refers to the frame and its scalars
+	vtkDataArray* scalars = frame->GetPointData()->GetScalars();
+	return (frame->GetReferenceCount() == 1) && scalars && (scalars->GetReferenceCount() == 1);
+}
+
+bool VideoFramePool::matches(vtkImageData* frame, Eigen::Array3i dim, int scalarType, int numComponents) const
+{
+	int* frameDim = frame->GetDimensions();
+	return (frameDim[0] == dim[0]) && (frameDim[1] == dim[1]) && (frameDim[2] == dim[2])
+			&& (frame->GetScalarType() == scalarType)
+			&& (frame->GetNumberOfScalarComponents() == numComponents);
+}
+
+vtkImageDataPtr VideoFramePool::allocate(Eigen::Array3i dim, int scalarType, int numComponents)
+{
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetExtent(0, dim[0]-1, 0, dim[1]-1, 0, dim[2]-1);
+	retval->AllocateScalars(scalarType, numComponents);
+	return retval;
+}
+
+vtkImageDataPtr VideoFramePool::get(Eigen::Array3i dim, int scalarType, int numComponents)
+{
+	QMutexLocker sentry(&mMutex);
+
+	int freeIndex = -1;
+	for (unsigned i = 0; i < mFrames.size(); ++i)
+	{
+		vtkImageData* frame = mFrames[i];
+		if (!this->isFree(frame))
+			continue;
+		if (this->matches(frame, dim, scalarType, numComponents))
+		{
+			++mHits;
+			frame->SetExtent(0, dim[0]-1, 0, dim[1]-1, 0, dim[2]-1);
+			frame->SetOrigin(0, 0, 0);
+			frame->SetSpacing(1, 1, 1);
+			frame->Modified();
+			return frame;
+		}
+		freeIndex = i;
+	}
+
+	++mMisses;
+	vtkImageDataPtr retval = this->allocate(dim, scalarType, numComponents);
+
+	// replace an unused frame with another layout if the pool is full
+	if (mFrames.size() < mMaxFrames)
+		mFrames.push_back(retval);
+	else if (freeIndex >= 0)
+		mFrames[freeIndex] = retval;
+
+	return retval;
+}
+
+vtkImageDataPtr VideoFramePool::copy(vtkImageDataPtr source)
+{
+	if (!source || !source->GetPointData()->GetScalars())
+		return vtkImageDataPtr();
+
+	Eigen::Array3i dim(source->GetDimensions());
+	vtkImageDataPtr retval = this->get(dim, source->GetScalarType(), source->GetNumberOfScalarComponents());
+	retval->SetExtent(source->GetExtent());
+	retval->SetOrigin(source->GetOrigin());
+	retval->SetSpacing(source->GetSpacing());
+
+	vtkDataArray* scalars = source->GetPointData()->GetScalars();
+	size_t size = size_t(scalars->GetNumberOfTuples()) * scalars->GetNumberOfComponents() * scalars->GetDataTypeSize();
+	memcpy(retval->GetScalarPointer(), source->GetScalarPointer(), size);
+	retval->Modified();
+	return retval;
+}
+
+void VideoFramePool::clear()
+{
+	QMutexLocker sentry(&mMutex);
+	mFrames.clear();
+}
+
+unsigned VideoFramePool::getSize() const
+{
+	QMutexLocker sentry(&mMutex);
+	return mFrames.size();
+}
+
+unsigned long VideoFramePool::getHitCount() const
+{
+	QMutexLocker sentry(&mMutex);
+	return mHits;
+}
+
+unsigned long VideoFramePool::getMissCount() const
+{
+	QMutexLocker sentry(&mMutex);
+	return mMisses;
+}
+
+QString VideoFramePool::getStatistics() const
+{
+	QMutexLocker sentry(&mMutex);
+	unsigned long total = mHits + mMisses;
+	double hitRate = total ? 100.0*mHits/total : 0;
+	return QString("frame pool: %1 hits, %2 misses (%3%), %4 frames")
+			.arg(mHits).arg(mMisses).arg(hitRate, 0, 'f', 1).arg(mFrames.size());
+}
+
+} // namespace cx
@@ -0,0 +1,83 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXVIDEOFRAMEPOOL_H
+#define CXVIDEOFRAMEPOOL_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <QMutex>
+#include <QString>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+#include "cxVector3D.h"
+
+namespace cx
+{
+
+/** \brief Pool of reusable video frames.
+ *
+ * Streams that produce one new vtkImageData per frame can draw frames
+ * from a pool instead of allocating, thus avoiding allocator churn
+ * and page faults at high frame rates.
+ *
+ * Frames are matched on dimensions, scalar type and number of components.
+ * A frame returns to the pool when it is no longer referenced by anyone
+ * but the pool, neither the vtkImageData nor its scalar array.
+ * No explicit release is needed, simply drop the smart pointer.
+ *
+ * If all frames are in use and the pool is full, new frames
+ * are allocated outside the pool.
+ *
+ * Create one pool per stream. Threadsafe.
+ *
+ * Only use the pool for frames that are released again, such as frames
+ * queued for saving. Frames held indefinitely, as in VideoRecorder,
+ * would keep the pool exhausted.
+ *
+ * \ingroup cx_resource_core_video
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT VideoFramePool
+{
+public:
+	explicit VideoFramePool(unsigned maxFrames = 32);
+
+	/** Return a frame with the given layout, origin 0 and spacing 1.
+	 *  Contents are undefined.
+	 */
+	vtkImageDataPtr get(Eigen::Array3i dim, int scalarType, int numComponents);
+	/** Return a frame with a copy of source. */
+	vtkImageDataPtr copy(vtkImageDataPtr source);
+	void clear();
+
+	unsigned getSize() const; ///< number of frames in the pool, used or free
+	unsigned getMaxSize() const { return mMaxFrames; }
+	unsigned long getHitCount() const; ///< number of frames reused from the pool
+	unsigned long getMissCount() const; ///< number of frames allocated
+	QString getStatistics() const;
+
+private:
+	bool isFree(vtkImageData* frame) const;
+	bool matches(vtkImageData* frame, Eigen::Array3i dim, int scalarType, int numComponents) const;
+	vtkImageDataPtr allocate(Eigen::Array3i dim, int scalarType, int numComponents);
+
+	mutable QMutex mMutex;
+	std::vector<vtkImageDataPtr> mFrames;
+	unsigned mMaxFrames;
+	unsigned long mHits;
+	unsigned long mMisses;
+};
+typedef boost::shared_ptr<VideoFramePool> VideoFramePoolPtr;
+
+} // namespace cx
+
+#endif // CXVIDEOFRAMEPOOL_H
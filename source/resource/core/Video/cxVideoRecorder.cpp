@@ -75,8 +75,8 @@ void VideoRecorder::newFrameSlot()
 //    diff = timestamp - mData.rbegin()->first;
 //  std::cout << "timestamp " << timestamp << ", " << diff << std::endl;
 
+	// the recording holds all frames: copy into own storage rather than a VideoFramePool.
 	vtkImageDataPtr frame = vtkImageDataPtr::New();
-//  std::cout << " RC after construct " << frame->GetReferenceCount() << std::endl;
 	frame->DeepCopy(mSource->getVtkImageData());
 //  std::cout << " RC after fill " << frame->GetReferenceCount() << std::endl;
 	mData[timestamp] = frame;
@@ -11,14 +11,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxAlgorithmHelpers.h"
 
 #include "cxImage.h"
-#include "cxTypeConversions.h"
-#include "itkImageFileReader.h"
-#include "vtkMetaImageWriter.h"
-#include "cxSettings.h"
-#include <QDir>
-#include "cxUtilHelpers.h"
-#include "cxDataLocations.h"
-#include "cxLogger.h"
 #include <itkGrayscaleFillholeImageFilter.h>
 
 namespace cx
@@ -27,8 +19,7 @@ namespace cx
 //---------------------------------------------------------------------------------------------------------------------
 itkImageType::ConstPointer AlgorithmHelper::getITKfromVTKImage(vtkImageDataPtr image)
 {
-  //HACK
-  return AlgorithmHelper::getITKfromVTKImageViaFile(image);
+	return AlgorithmHelper::getITKfromVTKImage<PixelType>(image);
 }
 //---------------------------------------------------------------------------------------------------------------------
 
@@ -41,85 +32,40 @@ itkImageType::ConstPointer AlgorithmHelper::getITKfromSSCImage(ImagePtr input)
 }
 //---------------------------------------------------------------------------------------------------------------------
 
-/**This is a workaround for _unpredictable_ crashes
- * experienced when using the itk::VTKImageToImageFilter.
- *
- */
-itkImageType::ConstPointer AlgorithmHelper::getITKfromVTKImageViaFile(vtkImageDataPtr input)
+vtkImageDataPtr AlgorithmHelper::getVTKFromITK(itkImageType::ConstPointer input)
 {
-  if(!input)
-  {
-    std::cout << "getITKfromSSCImage(): NO image!!!" << std::endl;
-    return itkImageType::ConstPointer();
-  }
-
-  double minVal = input->GetScalarRange()[0];
-  double maxVal = input->GetScalarRange()[1];
-
-  if(maxVal > SHRT_MAX || minVal < SHRT_MIN)
-  	reportWarning("Image values out of range. max: " + qstring_cast(maxVal)
-  			+ " min: " + qstring_cast(minVal) + " See bug #363 if this needs to be fixed");
-
-  QString tempFolder = DataLocations::getCachePath() + "/vtk2itk/";
-  QDir().mkpath(tempFolder);
-
-  // write to disk
-  vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
-
-  QString filename = tempFolder + "/"+qstring_cast(writer.GetPointer())+".mhd";
-
-
-  writer->SetInputData(input);
-  writer->SetFileName(cstring_cast(filename));
-  writer->SetCompression(false);
-  writer->Write();
-
-  // read from disk
-  typedef itk::ImageFileReader<itkImageType> ReaderType;
-  ReaderType::Pointer reader = ReaderType::New();
-#if ITK_VERSION_MAJOR==3
-  reader->SetFileName(cstring_cast(filename));
-#else
-  reader->SetFileName(string_cast(filename));
-#endif
-
-////  reader->SetFileName(cstring_cast(filename));
-//  reader->SetFileName(string_cast(filename));
-  reader->Update();
-  itkImageType::ConstPointer retval = reader->GetOutput();
-
-  QFile(filename).remove(); // cleanup
-  QFile(changeExtension(filename, "raw")).remove(); // cleanup
-
-  return retval;
+	return AlgorithmHelper::getVTKFromITK<PixelType>(input.GetPointer());
 }
-//---------------------------------------------------------------------------------------------------------------------
 
-vtkImageDataPtr AlgorithmHelper::getVTKFromITK(itkImageType::ConstPointer input)
+namespace
+{
+template<class TPixel>
+vtkImageDataPtr grayscaleFillhole(vtkImageDataPtr input)
 {
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(input);
-	itkToVtkFilter->Update();
+	typedef itk::Image<TPixel, Dimension> ImageType;
+	typename ImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromVTKImage<TPixel>(input);
+	if (!itkImage)
+		return vtkImageDataPtr();
 
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-	// TODO: possible memory problem here - check debug mem system of itk/vtk
+	// Not an InPlaceImageFilter: The input is only read, as the mask of the reconstruction.
+	typedef itk::GrayscaleFillholeImageFilter<ImageType, ImageType> FilterType;
+	typename FilterType::Pointer filter = FilterType::New();
 
-	return rawResult;
+	filter->SetInput(itkImage);
+	filter->Update();
+
+	return AlgorithmHelper::getVTKFromITK<TPixel>(filter->GetOutput());
 }
+} // namespace
 
 vtkImageDataPtr AlgorithmHelper::execute_itk_GrayscaleFillholeImageFilter(vtkImageDataPtr input)
 {
-  itkImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromVTKImage(input);
-
-  typedef itk::GrayscaleFillholeImageFilter<itkImageType, itkImageType> FilterType;
-  FilterType::Pointer filter = FilterType::New();
-
-  filter->SetInput(itkImage);
-  filter->Update();
+	if (!input)
+		return vtkImageDataPtr();
 
-  return AlgorithmHelper::getVTKFromITK(filter->GetOutput());
+	vtkImageDataPtr retval;
+	cxItkPixelTypeMacro(input->GetScalarType(), retval = grayscaleFillhole<CX_TT>(input));
+	return retval;
 }
 
 
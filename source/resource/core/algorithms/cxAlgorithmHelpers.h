@@ -17,9 +17,20 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "ItkVtkGlue/itkImageToVTKImageFilter.h"
 #include "ItkVtkGlue/itkVTKImageToImageFilter.h"
 #include <itkImage.h>
+#include <itkImportImageContainer.h>
+#include <itkNumericTraits.h>
+#include <algorithm>
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include <vtkDataArray.h>
+#include <vtkTypeTraits.h>
+#include <vtkCallbackCommand.h>
 
 #include "cxForwardDeclarations.h"
 #include "vtkForwardDeclarations.h"
+#include "cxLogger.h"
+#include "cxTypeConversions.h"
 
 namespace cx
 {
@@ -31,11 +42,75 @@ typedef itk::Image< PixelType, Dimension >  itkImageType;
 typedef itk::ImageToVTKImageFilter<itkImageType> itkToVtkFilterType;
 typedef itk::VTKImageToImageFilter<itkImageType> itkVTKImageToImageFilterType;
 
+/**
+ * Like vtkTemplateMacro, for the scalar types handled natively by the
+ * ITK filters: unsigned char, unsigned short, short and float.
+ * CX_TT is defined as the pixel type, other scalar types use PixelType.
+ *
+ * \ingroup cx_resource_core_algorithms
+ */
+#define cxItkPixelTypeMacro(scalarType, call) \
+	switch (scalarType) \
+	{ \
+	case VTK_UNSIGNED_CHAR: { typedef unsigned char CX_TT; call; } break; \
+	case VTK_UNSIGNED_SHORT: { typedef unsigned short CX_TT; call; } break; \
+	case VTK_FLOAT: { typedef float CX_TT; call; } break; \
+	default: { typedef cx::PixelType CX_TT; call; } break; \
+	}
+
+/**
+ * \brief Pixel container sharing the scalars of a vtkImageData.
+ * \ingroup cx_resource_core_algorithms
+ *
+ * The container holds a reference to the vtkDataArray, thus the buffer
+ * is valid as long as the itk::Image using it.
+ * The buffer belongs to the vtkImageData and is read-only for ITK.
+ *
+ * \date 2026-10-18
+ */
+template<class TElement>
+class VtkImportImageContainer : public itk::ImportImageContainer<itk::SizeValueType, TElement>
+{
+public:
+	typedef VtkImportImageContainer Self;
+	typedef itk::ImportImageContainer<itk::SizeValueType, TElement> Superclass;
+	typedef itk::SmartPointer<Self> Pointer;
+	typedef itk::SmartPointer<const Self> ConstPointer;
+
+	itkNewMacro(Self);
+	itkTypeMacro(VtkImportImageContainer, ImportImageContainer);
+
+	void setScalars(vtkDataArrayPtr scalars)
+	{
+		mScalars = scalars;
+		this->SetImportPointer(static_cast<TElement*>(scalars->GetVoidPointer(0)), scalars->GetNumberOfTuples(), false);
+	}
+
+protected:
+	VtkImportImageContainer() {}
+	virtual ~VtkImportImageContainer() {}
+
+private:
+	VtkImportImageContainer(const Self&); //purposely not implemented
+	void operator=(const Self&); //purposely not implemented
+
+	vtkDataArrayPtr mScalars;
+};
 
 /**
  * \brief Class with helper functions for algorithms.
  * \ingroup cx_resource_core_algorithms
  *
+ * Conversion between vtkImageData and itk::Image is done in memory.
+ * When the scalar type matches the pixel type, the images share
+ * the pixel buffer, and each keeps the other alive: Do not modify
+ * one while the other is in use.
+ *
+ * An itk::Image from getITKfromVTKImage() is read-only, as it
+ * usually shares the buffer of a patient image. Filters derived from
+ * itk::InPlaceImageFilter reuse the input buffer for output when the
+ * pixel types match, thus call InPlaceOff() on those fed with it.
+ *
  * \date Feb 16, 2011
  * \author Janne Beate Bakeng, SINTEF
  */
@@ -48,10 +123,152 @@ public:
   static vtkImageDataPtr getVTKFromITK(itkImageType::ConstPointer input);
   static vtkImageDataPtr execute_itk_GrayscaleFillholeImageFilter(vtkImageDataPtr input);
 
+	/** Wrap image in an itk::Image with pixel type TPixel.
+	 *  The buffer is shared if the scalar type is TPixel,
+	 *  otherwise the first component is cast to TPixel.
+	 *  The result is read-only, see the class description.
+	 */
+	template<class TPixel>
+	static typename itk::Image<TPixel, Dimension>::ConstPointer getITKfromVTKImage(vtkImageDataPtr image);
+	/** Wrap input in a vtkImageData sharing its buffer.
+	 *  The vtkImageData keeps input alive.
+	 */
+	template<class TPixel>
+	static vtkImageDataPtr getVTKFromITK(const itk::Image<TPixel, Dimension>* input);
+	/** Convert value to TPixel, clamped to the range of TPixel.
+	 */
+	template<class TPixel>
+	static TPixel convertToPixelValue(double value);
+
 private:
-  static itkImageType::ConstPointer getITKfromVTKImageViaFile(vtkImageDataPtr image);
+	template<class TIn, class TOut>
+	static void copyFirstComponent(const TIn* in, int components, TOut* out, vtkIdType numberOfPixels);
+	template<class TImage>
+	static void releaseITKImage(void* image);
 };
 
+template<class TPixel>
+typename itk::Image<TPixel, Dimension>::ConstPointer AlgorithmHelper::getITKfromVTKImage(vtkImageDataPtr input)
+{
+	typedef itk::Image<TPixel, Dimension> ImageType;
+
+	if (!input || !input->GetPointData()->GetScalars())
+	{
+		reportWarning("getITKfromVTKImage(): NO image!!!");
+		return typename ImageType::ConstPointer();
+	}
+
+	int* dim = input->GetDimensions();
+	int* extent = input->GetExtent();
+	double* spacing = input->GetSpacing();
+	double* origin = input->GetOrigin();
+
+	typename ImageType::RegionType region;
+	typename ImageType::SpacingType itkSpacing;
+	typename ImageType::PointType itkOrigin;
+	for (unsigned i=0; i<Dimension; ++i)
+	{
+		region.SetSize(i, dim[i]);
+		region.SetIndex(i, 0);
+		itkSpacing[i] = spacing[i];
+		itkOrigin[i] = origin[i] + extent[2*i]*spacing[i]; // itk index starts at zero
+	}
+
+	typename ImageType::Pointer retval = ImageType::New();
+	retval->SetRegions(region);
+	retval->SetSpacing(itkSpacing);
+	retval->SetOrigin(itkOrigin);
+
+	vtkDataArrayPtr scalars = input->GetPointData()->GetScalars();
+	vtkIdType numberOfPixels = input->GetNumberOfPoints();
+
+	if (scalars->GetDataType()==vtkTypeTraits<TPixel>::VTKTypeID() && scalars->GetNumberOfComponents()==1)
+	{
+		typename VtkImportImageContainer<TPixel>::Pointer container = VtkImportImageContainer<TPixel>::New();
+		container->setScalars(scalars);
+		retval->SetPixelContainer(container);
+		return retval.GetPointer();
+	}
+
+	double* range = scalars->GetRange(0);
+	if (range[1] > itk::NumericTraits<TPixel>::max() || range[0] < itk::NumericTraits<TPixel>::NonpositiveMin())
+		reportWarning("Image values out of range. max: " + qstring_cast(range[1])
+				+ " min: " + qstring_cast(range[0]) + " See bug #363 if this needs to be fixed");
+
+	retval->Allocate();
+	switch (scalars->GetDataType())
+	{
+		vtkTemplateMacro(copyFirstComponent(static_cast<VTK_TT*>(scalars->GetVoidPointer(0)),
+											scalars->GetNumberOfComponents(),
+											retval->GetBufferPointer(), numberOfPixels));
+	default:
+		reportWarning("getITKfromVTKImage(): Unsupported scalar type " + qstring_cast(scalars->GetDataTypeAsString()));
+		return typename ImageType::ConstPointer();
+	}
+	return retval.GetPointer();
+}
+
+template<class TPixel>
+vtkImageDataPtr AlgorithmHelper::getVTKFromITK(const itk::Image<TPixel, Dimension>* input)
+{
+	typedef itk::Image<TPixel, Dimension> ImageType;
+
+	if (!input)
+		return vtkImageDataPtr();
+
+	typename ImageType::RegionType region = input->GetBufferedRegion();
+	int extent[6];
+	double spacing[3];
+	double origin[3];
+	for (unsigned i=0; i<Dimension; ++i)
+	{
+		extent[2*i] = 0;
+		extent[2*i+1] = region.GetSize(i)-1;
+		spacing[i] = input->GetSpacing()[i];
+		origin[i] = input->GetOrigin()[i] + region.GetIndex(i)*spacing[i];
+	}
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetExtent(extent);
+	retval->SetSpacing(spacing);
+	retval->SetOrigin(origin);
+
+	vtkDataArrayPtr scalars;
+	scalars.TakeReference(vtkDataArray::CreateDataArray(vtkTypeTraits<TPixel>::VTKTypeID()));
+	scalars->SetNumberOfComponents(1);
+	scalars->SetVoidArray(const_cast<TPixel*>(input->GetBufferPointer()), region.GetNumberOfPixels(), 1);
+
+	// The array does not own the buffer: let it hold a reference to input instead,
+	// released when the observer is deleted together with the array.
+	vtkSmartPointer<vtkCallbackCommand> owner = vtkSmartPointer<vtkCallbackCommand>::New();
+	owner->SetClientData(new typename ImageType::ConstPointer(input));
+	owner->SetClientDataDeleteCallback(&AlgorithmHelper::releaseITKImage<ImageType>);
+	scalars->AddObserver(vtkCommand::DeleteEvent, owner);
+
+	retval->GetPointData()->SetScalars(scalars);
+	return retval;
+}
+
+template<class TPixel>
+TPixel AlgorithmHelper::convertToPixelValue(double value)
+{
+	value = std::max<double>(value, itk::NumericTraits<TPixel>::NonpositiveMin());
+	value = std::min<double>(value, itk::NumericTraits<TPixel>::max());
+	return static_cast<TPixel>(value);
+}
+
+template<class TIn, class TOut>
+void AlgorithmHelper::copyFirstComponent(const TIn* in, int components, TOut* out, vtkIdType numberOfPixels)
+{
+	for (vtkIdType i=0; i<numberOfPixels; ++i)
+		out[i] = static_cast<TOut>(in[i*components]);
+}
+
+template<class TImage>
+void AlgorithmHelper::releaseITKImage(void* image)
+{
+	delete static_cast<typename TImage::ConstPointer*>(image);
+}
 
 }
 
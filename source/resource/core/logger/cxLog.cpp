@@ -103,6 +103,7 @@ void Log::stopThread()
 	LogThreadPtr tempWorker = mWorker;
 	mWorker.reset();
 
+	QMetaObject::invokeMethod(tempWorker.get(), "aboutToStop", Qt::BlockingQueuedConnection);
 	mThread->quit();
 	mThread->wait(); // forever or until dead thread
 
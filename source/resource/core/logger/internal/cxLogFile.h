@@ -32,6 +32,7 @@ public:
 
 	void writeHeader();
 	void write(Message message);
+	QString formatMessage(Message msg); ///< message as written to file, without line ending
 	bool isWritable() const;
 	QString getFilename() const;
 
@@ -46,7 +47,6 @@ private:
 	Message readMessageFirstLine(QString line);
 	MESSAGE_LEVEL readMessageLevel(QString line);
 	QRegExp getRX_Timestamp() const;
-	QString formatMessage(Message msg);
 	bool appendToLogfile(QString filename, QString text);
 	QString readFileTail();
 //	QString removeEarlierSessionsAndSetStartTime(QString text);
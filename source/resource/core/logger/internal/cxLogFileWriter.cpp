@@ -0,0 +1,53 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxLogFileWriter.h"
+
+namespace cx
+{
+
+LogFileWriter::LogFileWriter(QString filename, int maxBufferSize) :
+	mFile(filename),
+	mMaxBufferSize(maxBufferSize)
+{
+}
+
+LogFileWriter::~LogFileWriter()
+{
+	this->flush();
+}
+
+void LogFileWriter::write(QString text)
+{
+	// QTextStream in LogFile used the locale codec, keep that.
+	mBuffer.append(text.toLocal8Bit());
+	if (mBuffer.size() >= mMaxBufferSize)
+		this->flush();
+}
+
+bool LogFileWriter::flush()
+{
+	if (mBuffer.isEmpty())
+		return true;
+
+	// open on first write, then keep open
+	if (!mFile.isOpen() && !mFile.open(QFile::WriteOnly | QFile::Append))
+	{
+		mBuffer.clear(); // discard: dont grow forever on an unwritable file
+		return false;
+	}
+
+	bool success = (mFile.write(mBuffer) == mBuffer.size());
+	mFile.flush();
+	mBuffer.clear();
+	return success;
+}
+
+} //namespace cx
@@ -0,0 +1,54 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXLOGFILEWRITER_H
+#define CXLOGFILEWRITER_H
+
+#include "cxResourceExport.h"
+
+#include <QFile>
+#include <QByteArray>
+#include <boost/shared_ptr.hpp>
+
+namespace cx
+{
+
+/**\brief Append text to a log file, buffered.
+ *
+ * The file is kept open, and text is collected in memory
+ * until flush() is called or the buffer exceeds maxBufferSize.
+ * The destructor flushes.
+ *
+ * Not threadsafe: Use from the log thread only.
+ *
+ * \addtogroup cx_resource_core_logger
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT LogFileWriter
+{
+public:
+	explicit LogFileWriter(QString filename, int maxBufferSize = 64*1024);
+	~LogFileWriter();
+
+	void write(QString text);
+	bool flush();
+	QString getFilename() const { return mFile.fileName(); }
+	int getBufferSize() const { return mBuffer.size(); }
+
+private:
+	QFile mFile;
+	QByteArray mBuffer;
+	int mMaxBufferSize;
+};
+typedef boost::shared_ptr<LogFileWriter> LogFileWriterPtr;
+
+} //namespace cx
+
+#endif // CXLOGFILEWRITER_H
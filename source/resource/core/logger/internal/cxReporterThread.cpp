@@ -37,6 +37,12 @@ namespace cx
 ReporterThread::ReporterThread(QObject *parent) :
 	LogThread(parent)
 {
+	// written messages are buffered until the timer fires, see sendToFile()
+	mFlushTimer = new QTimer(this);
+	mFlushTimer->setSingleShot(true);
+	mFlushTimer->setInterval(500);
+	connect(mFlushTimer, &QTimer::timeout, this, &ReporterThread::flushLogFiles);
+
 	qInstallMessageHandler(convertQtMessagesToCxMessages);
 	qRegisterMetaType<Message>("Message");
 
@@ -53,6 +59,7 @@ ReporterThread::ReporterThread(QObject *parent) :
 ReporterThread::~ReporterThread()
 {
 	qInstallMessageHandler(0);
+	mLogFileWriters.clear(); // flushes, in case aboutToStop() was not called
 	mCout.reset();
 	mCerr.reset();
 }
@@ -65,6 +72,7 @@ bool ReporterThread::initializeLogFile(LogFile file)
 
 	mInitializedFiles << filename;
 
+	this->getLogFileWriter(filename)->flush(); // header must follow earlier buffered text
 	file.writeHeader();
 
 	if (!file.isWritable())
@@ -78,6 +86,7 @@ bool ReporterThread::initializeLogFile(LogFile file)
 
 void ReporterThread::executeSetLoggingFolder(QString absoluteLoggingFolderPath)
 {
+	mLogFileWriters.clear(); // flushes and closes the files in the old folder
 	mLogPath = absoluteLoggingFolderPath;
 
 	QFileInfo(mLogPath+"/").absoluteDir().mkpath(".");
@@ -100,6 +109,12 @@ void ReporterThread::logMessage(Message msg)
 							  Q_ARG(Message, msg));
 }
 
+void ReporterThread::aboutToStop()
+{
+	// stop timer while in the owning thread
+	this->flushLogFiles();
+}
+
 void ReporterThread::onMessageEmitted(Message msg)
 {
 	//	this->sendToCout(message);
@@ -117,8 +132,31 @@ void ReporterThread::sendToFile(Message message)
 
 	this->initializeLogFile(channelLog);
 
-	channelLog.write(message);
-	allLog.write(message);
+	QString text = channelLog.formatMessage(message) + "\n";
+	this->getLogFileWriter(channelLog.getFilename())->write(text);
+	this->getLogFileWriter(allLog.getFilename())->write(text);
+
+	// errors might precede a crash: write at once.
+	if ((message.getMessageLevel()==mlERROR) || (message.getMessageLevel()==mlCERR))
+		this->flushLogFiles();
+	else if (!mFlushTimer->isActive())
+		mFlushTimer->start();
+}
+
+LogFileWriterPtr ReporterThread::getLogFileWriter(QString filename)
+{
+	LogFileWriterPtr& writer = mLogFileWriters[filename];
+	if (!writer)
+		writer.reset(new LogFileWriter(filename));
+	return writer;
+}
+
+void ReporterThread::flushLogFiles()
+{
+	mFlushTimer->stop();
+	std::map<QString, LogFileWriterPtr>::iterator iter;
+	for (iter = mLogFileWriters.begin(); iter != mLogFileWriters.end(); ++iter)
+		iter->second->flush();
 }
 
 void ReporterThread::sendToCout(Message message)
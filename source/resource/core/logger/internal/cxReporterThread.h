@@ -32,12 +32,14 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QList>
 #include <QThread>
 #include "cxLogThread.h"
+#include "cxLogFileWriter.h"
 
 class QString;
 class QDomNode;
 class QDomDocument;
 class QFile;
 class QTextStream;
+class QTimer;
 
 /**
  * \file
@@ -62,6 +64,7 @@ public:
 
 public slots:
 	virtual void logMessage(Message msg);
+	virtual void aboutToStop();
 
 signals:
 	void emittedMessage(Message message); ///< emitted for each new message, in addition to writing to file.
@@ -71,8 +74,10 @@ protected:
 
 private slots:
 	void onMessageEmitted(Message msg);
+	void flushLogFiles();
 private:
 	bool initializeLogFile(LogFile file);
+	LogFileWriterPtr getLogFileWriter(QString filename);
 
 	void sendToFile(Message message);
 	void sendToCout(Message message);
@@ -83,6 +88,8 @@ private:
 
 	QString mLogPath;
 	QStringList mInitializedFiles;
+	std::map<QString, LogFileWriterPtr> mLogFileWriters; ///< open log files, by filename
+	QTimer* mFlushTimer;
 
 };
 
@@ -175,6 +175,7 @@ signals:
 	void streamLoaded();
 	void patientChanged();
 	void videoAddedToTrackedStream();
+	void dataLoadProgress(int loaded, int total); ///< emitted for each data file read while loading a patient
 };
 
 
@@ -62,6 +62,7 @@ void PatientModelServiceProxy::onServiceAdded(PatientModelService* service)
 	connect(service, &PatientModelService::streamLoaded, this, &PatientModelService::streamLoaded);
 	connect(service, &PatientModelService::patientChanged, this, &PatientModelService::patientChanged);
 	connect(service, &PatientModelService::videoAddedToTrackedStream, this, &PatientModelService::videoAddedToTrackedStream);
+	connect(service, &PatientModelService::dataLoadProgress, this, &PatientModelService::dataLoadProgress);
 
 	if(mPatientModelService->isNull())
 		reportWarning("PatientModelServiceProxy::onServiceAdded mPatientModelService->isNull()");
@@ -84,6 +85,7 @@ void PatientModelServiceProxy::onServiceRemoved(PatientModelService *service)
 	disconnect(service, &PatientModelService::streamLoaded, this, &PatientModelService::streamLoaded);
 	disconnect(service, &PatientModelService::patientChanged, this, &PatientModelService::patientChanged);
 	disconnect(service, &PatientModelService::videoAddedToTrackedStream, this, &PatientModelService::videoAddedToTrackedStream);
+	disconnect(service, &PatientModelService::dataLoadProgress, this, &PatientModelService::dataLoadProgress);
 
 	mPatientModelService = PatientModelService::getNullObject();
 
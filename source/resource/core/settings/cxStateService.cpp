@@ -80,6 +80,9 @@ void StateService::fillDefaultSettings()
 	this->fillDefault("Ultrasound/acquisitionName", "US-Acq");
 	this->fillDefault("Ultrasound/8bitAcquisitionData", false);
 	this->fillDefault("Ultrasound/CompressAcquisition", true);
+	this->fillDefault("Ultrasound/SingleFileAcquisition", false);
+	this->fillDefault("Video/ImageQueueSize", 32);
+	this->fillDefault("Video/ImageQueuePolicy", "dropOldest");
 	this->fillDefault("View3D/sphereRadius", 1.0);
 	this->fillDefault("View3D/labelSize", 2.5);
 	this->fillDefault("Navigation/anyplaneViewOffset", 0.25);
@@ -0,0 +1,117 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <vtkImageData.h>
+#include "cxAlgorithmHelpers.h"
+
+namespace
+{
+vtkImageDataPtr createVolume(int scalarType)
+{
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetExtent(2, 11, 0, 7, 1, 6); // 10x8x6, not starting at zero
+	retval->SetSpacing(0.5, 1, 2);
+	retval->SetOrigin(10, 20, 30);
+	retval->AllocateScalars(scalarType, 1);
+	vtkDataArray* scalars = retval->GetPointData()->GetScalars();
+	for (vtkIdType i=0; i<scalars->GetNumberOfTuples(); ++i)
+		scalars->SetTuple1(i, i%100);
+	return retval;
+}
+
+template<class TImage>
+void checkGeometry(TImage* image)
+{
+	CHECK(image->GetBufferedRegion().GetSize(0) == 10);
+	CHECK(image->GetBufferedRegion().GetSize(1) == 8);
+	CHECK(image->GetBufferedRegion().GetSize(2) == 6);
+	CHECK(image->GetSpacing()[0] == Approx(0.5));
+	CHECK(image->GetSpacing()[2] == Approx(2));
+	CHECK(image->GetOrigin()[0] == Approx(10+2*0.5));
+	CHECK(image->GetOrigin()[1] == Approx(20));
+	CHECK(image->GetOrigin()[2] == Approx(30+1*2));
+}
+} // namespace
+
+TEST_CASE("AlgorithmHelper: VTK image is shared with ITK when the type matches", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createVolume(VTK_SHORT);
+	void* buffer = input->GetScalarPointer();
+
+	cx::itkImageType::ConstPointer itkImage = cx::AlgorithmHelper::getITKfromVTKImage(input);
+	REQUIRE(itkImage);
+	CHECK(itkImage->GetBufferPointer() == buffer);
+	checkGeometry(itkImage.GetPointer());
+
+	// The ITK image used to refer freed memory once the
+	// vtkImageData was gone: The crash the file round trip avoided.
+	input = NULL;
+	CHECK(itkImage->GetBufferPointer()[0] == 0);
+	CHECK(itkImage->GetBufferPointer()[99] == 99);
+	CHECK(itkImage->GetBufferPointer()[10*8*6-1] == (10*8*6-1)%100);
+}
+
+TEST_CASE("AlgorithmHelper: VTK image is converted to ITK when the type differs", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createVolume(VTK_UNSIGNED_CHAR);
+
+	cx::itkImageType::ConstPointer itkImage = cx::AlgorithmHelper::getITKfromVTKImage(input);
+	REQUIRE(itkImage);
+	CHECK(static_cast<void*>(const_cast<short*>(itkImage->GetBufferPointer())) != input->GetScalarPointer());
+	checkGeometry(itkImage.GetPointer());
+	CHECK(itkImage->GetBufferPointer()[42] == 42);
+
+	typedef itk::Image<float, cx::Dimension> FloatImageType;
+	FloatImageType::ConstPointer floatImage = cx::AlgorithmHelper::getITKfromVTKImage<float>(input);
+	REQUIRE(floatImage);
+	CHECK(floatImage->GetBufferPointer()[42] == Approx(42));
+}
+
+TEST_CASE("AlgorithmHelper: ITK image is shared with VTK and kept alive", "[unit][resource][core]")
+{
+	vtkImageDataPtr input = createVolume(VTK_FLOAT);
+	vtkImageDataPtr output;
+	{
+		itk::Image<float, cx::Dimension>::ConstPointer itkImage = cx::AlgorithmHelper::getITKfromVTKImage<float>(input);
+		REQUIRE(itkImage);
+		output = cx::AlgorithmHelper::getVTKFromITK<float>(itkImage.GetPointer());
+		REQUIRE(output);
+		CHECK(output->GetScalarPointer() == input->GetScalarPointer());
+	}
+	input = NULL;
+
+	CHECK(output->GetScalarType() == VTK_FLOAT);
+	int* dim = output->GetDimensions();
+	CHECK(dim[0] == 10);
+	CHECK(dim[1] == 8);
+	CHECK(dim[2] == 6);
+	CHECK(output->GetOrigin()[0] == Approx(11));
+	CHECK(output->GetOrigin()[2] == Approx(32));
+	CHECK(output->GetScalarComponentAsDouble(3, 0, 0, 0) == Approx(3));
+	CHECK(output->GetScalarComponentAsDouble(9, 7, 5, 0) == Approx((10*8*6-1)%100));
+}
+
+TEST_CASE("AlgorithmHelper: ITK filter runs on the scalar type of the input", "[unit][resource][core]")
+{
+	int types[] = { VTK_UNSIGNED_CHAR, VTK_UNSIGNED_SHORT, VTK_SHORT, VTK_FLOAT };
+	for (unsigned i=0; i<4; ++i)
+	{
+		INFO("Scalar type " << types[i]);
+		vtkImageDataPtr input = createVolume(types[i]);
+		vtkImageDataPtr output = cx::AlgorithmHelper::execute_itk_GrayscaleFillholeImageFilter(input);
+		REQUIRE(output);
+		CHECK(output->GetScalarType() == types[i]);
+		CHECK(output->GetNumberOfPoints() == input->GetNumberOfPoints());
+		CHECK(output->GetScalarRange()[1] <= input->GetScalarRange()[1]);
+	}
+}
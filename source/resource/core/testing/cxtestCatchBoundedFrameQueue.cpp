@@ -0,0 +1,131 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QtConcurrentRun>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include "cxBoundedFrameQueue.h"
+
+namespace cxtest
+{
+
+namespace
+{
+typedef boost::shared_ptr<int> IntPtr;
+typedef cx::BoundedFrameQueue<IntPtr> IntQueue;
+
+void pushFrames(IntQueue* queue, int count)
+{
+	for (int i = 0; i < count; ++i)
+		queue->push(IntPtr(new int(i)));
+}
+} // namespace
+
+TEST_CASE("BoundedFrameQueue: Capacity is rounded up to power of two", "[unit][resource][core]")
+{
+	CHECK(IntQueue(1).getCapacity() == 2);
+	CHECK(IntQueue(5).getCapacity() == 8);
+	CHECK(IntQueue(32).getCapacity() == 32);
+}
+
+TEST_CASE("BoundedFrameQueue: Drop oldest keeps the newest frames", "[unit][resource][core]")
+{
+	IntQueue queue(4, IntQueue::pDROP_OLDEST);
+	pushFrames(&queue, 10);
+
+	CHECK(queue.getEnqueuedCount() == 10);
+	CHECK(queue.getDroppedCount() == 6);
+	CHECK(queue.getDepth() == 4);
+
+	IntPtr value;
+	for (int i = 6; i < 10; ++i)
+	{
+		REQUIRE(queue.pop(&value));
+		CHECK(*value == i);
+	}
+	CHECK(!queue.pop(&value));
+	CHECK(queue.getDepth() == 0);
+}
+
+TEST_CASE("BoundedFrameQueue: Latest only keeps one frame", "[unit][resource][core]")
+{
+	IntQueue queue(4, IntQueue::pLATEST_ONLY);
+	pushFrames(&queue, 10);
+
+	CHECK(queue.getDroppedCount() == 9);
+	CHECK(queue.getDepth() == 1);
+	IntPtr value;
+	REQUIRE(queue.pop(&value));
+	CHECK(*value == 9);
+}
+
+TEST_CASE("BoundedFrameQueue: Block drops new frame after timeout", "[unit][resource][core]")
+{
+	IntQueue queue(2, IntQueue::pBLOCK);
+	queue.setBlockTimeout(10);
+
+	CHECK(queue.push(IntPtr(new int(0))));
+	CHECK(queue.push(IntPtr(new int(1))));
+	CHECK(!queue.push(IntPtr(new int(2))));
+	CHECK(queue.getDroppedCount() == 1);
+
+	IntPtr value;
+	REQUIRE(queue.pop(&value));
+	CHECK(*value == 0);
+	CHECK(queue.push(IntPtr(new int(3))));
+}
+
+TEST_CASE("BoundedFrameQueue: Frames pass between threads in order", "[unit][resource][core]")
+{
+	IntQueue::POLICY policy = IntQueue::pBLOCK;
+	SECTION("Block")
+	{
+		policy = IntQueue::pBLOCK;
+	}
+	SECTION("Drop oldest")
+	{
+		policy = IntQueue::pDROP_OLDEST;
+	}
+	SECTION("Latest only")
+	{
+		policy = IntQueue::pLATEST_ONLY;
+	}
+
+	IntQueue queue(8, policy);
+	queue.setBlockTimeout(10000);
+	int count = 20000;
+	QFuture<void> producer = QtConcurrent::run(boost::bind(&pushFrames, &queue, count));
+
+	quint64 received = 0;
+	int last = -1;
+	bool ordered = true;
+	IntPtr value;
+	while (!producer.isFinished() || queue.getDepth())
+	{
+		if (!queue.pop(&value))
+			continue;
+		ordered = ordered && (*value > last);
+		last = *value;
+		++received;
+	}
+	producer.waitForFinished();
+	while (queue.pop(&value))
+		++received;
+
+	CHECK(ordered);
+	CHECK(received + queue.getDroppedCount() == quint64(count));
+	if (policy == IntQueue::pBLOCK)
+		CHECK(received == quint64(count));
+}
+
+} // namespace cxtest
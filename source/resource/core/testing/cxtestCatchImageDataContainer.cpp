@@ -0,0 +1,123 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QDir>
+#include <vtkImageData.h>
+#include <vtkMetaImageWriter.h>
+#include "cxImageDataContainer.h"
+#include "cxVolumeHelpers.h"
+#include "cxDataLocations.h"
+#include "cxTypeConversions.h"
+#include "cxFileHelpers.h"
+
+typedef vtkSmartPointer<vtkMetaImageWriter> vtkMetaImageWriterPtr;
+
+namespace
+{
+QString getFramesPath()
+{
+	return cx::DataLocations::getTestDataPath() + "/temp/MappedImageDataContainer";
+}
+
+vtkImageDataPtr createFrame(unsigned index)
+{
+	vtkImageDataPtr retval = cx::generateVtkImageData(Eigen::Array3i(16, 8, 1), cx::Vector3D(0.3, 0.2, 1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	for (int i = 0; i < 16*8; ++i)
+		ptr[i] = i + index;
+	return retval;
+}
+
+void writeFrames(QString base, unsigned count, bool compress)
+{
+	vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
+	for (unsigned i = 0; i < count; ++i)
+	{
+		writer->SetInputData(createFrame(i));
+		writer->SetFileName(cstring_cast(QString("%1_%2.mhd").arg(base).arg(i)));
+		writer->SetCompression(compress);
+		writer->Write();
+	}
+}
+} // namespace
+
+TEST_CASE("MappedImageDataContainer: Maps uncompressed frames", "[unit][resource][core]")
+{
+	cx::removeNonemptyDirRecursively(getFramesPath());
+	QDir().mkpath(getFramesPath());
+	QString base = getFramesPath() + "/frames";
+	writeFrames(base, 3, false);
+
+	cx::MappedImageDataContainer container(base + ".mhd", cx::FileManagerServicePtr());
+	REQUIRE(container.size() == 3);
+
+	for (unsigned i = 0; i < container.size(); ++i)
+	{
+		CHECK(container.isMapped(i));
+		vtkImageDataPtr frame = container.get(i);
+		REQUIRE(frame);
+		CHECK(frame->GetDimensions()[0] == 16);
+		CHECK(frame->GetDimensions()[1] == 8);
+		CHECK(frame->GetScalarType() == VTK_UNSIGNED_CHAR);
+		CHECK(cx::similar(frame->GetSpacing()[0], 0.3));
+		unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+		CHECK(ptr[0] == i);
+		CHECK(ptr[16*8-1] == (unsigned char)(16*8-1+i));
+	}
+
+	cx::removeNonemptyDirRecursively(getFramesPath());
+}
+
+TEST_CASE("MappedImageDataContainer: Mapped frames are writable and outlive the container", "[unit][resource][core]")
+{
+	cx::removeNonemptyDirRecursively(getFramesPath());
+	QDir().mkpath(getFramesPath());
+	QString base = getFramesPath() + "/frames";
+	writeFrames(base, 2, false);
+
+	vtkImageDataPtr frame;
+	{
+		cx::MappedImageDataContainer container(base + ".mhd", cx::FileManagerServicePtr());
+		REQUIRE(container.isMapped(1));
+		frame = container.get(1);
+		REQUIRE(frame);
+
+		// copy-on-write: other frames and the file are unchanged
+		unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+		ptr[0] = 200;
+		vtkImageDataPtr other = container.get(1);
+		CHECK(static_cast<unsigned char*>(other->GetScalarPointer())[0] == 1);
+	}
+
+	unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+	CHECK(ptr[0] == 200);
+	CHECK(ptr[16*8-1] == (unsigned char)(16*8-1+1));
+
+	frame = vtkImageDataPtr();
+	cx::removeNonemptyDirRecursively(getFramesPath());
+}
+
+TEST_CASE("MappedImageDataContainer: Does not map compressed frames", "[unit][resource][core]")
+{
+	cx::removeNonemptyDirRecursively(getFramesPath());
+	QDir().mkpath(getFramesPath());
+	QString base = getFramesPath() + "/frames";
+	writeFrames(base, 2, true);
+
+	cx::MappedImageDataContainer container(base + ".mhd", cx::FileManagerServicePtr());
+	REQUIRE(container.size() == 2);
+	CHECK(!container.isMapped(0));
+	CHECK(!container.isMapped(1));
+
+	cx::removeNonemptyDirRecursively(getFramesPath());
+}
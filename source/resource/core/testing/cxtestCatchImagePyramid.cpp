@@ -0,0 +1,110 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <vtkImageData.h>
+#include "cxImage.h"
+#include "cxImagePyramid.h"
+#include "cxVolumeHelpers.h"
+
+namespace
+{
+vtkImageDataPtr createVolume()
+{
+	// 2x2x2 blocks of constant value: averaging keeps the values.
+	vtkImageDataPtr retval = cx::generateVtkImageData(Eigen::Array3i(64, 32, 16), cx::Vector3D(0.5, 0.5, 1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	for (int z = 0; z < 16; ++z)
+		for (int y = 0; y < 32; ++y)
+			for (int x = 0; x < 64; ++x)
+				ptr[x + 64*(y + 32*z)] = (x/2) + (y/2);
+	return retval;
+}
+} // namespace
+
+TEST_CASE("ImagePyramid: Finds level within voxel budget", "[unit][resource][core]")
+{
+	cx::ImagePyramidPtr pyramid = cx::ImagePyramid::create(createVolume());
+
+	// down to a single voxel: 64, 32, 16, 8, 4, 2 and 1 along x
+	REQUIRE(pyramid->getNumberOfLevels() == 7);
+	CHECK(pyramid->getNumberOfVoxels(0) == 64*32*16);
+	CHECK(pyramid->getNumberOfVoxels(1) == 32*16*8);
+	CHECK(pyramid->getNumberOfVoxels(3) == 8*4*2);
+	CHECK(pyramid->getNumberOfVoxels(6) == 1);
+
+	CHECK(pyramid->findLevel(0) == 0);
+	CHECK(pyramid->findLevel(64*32*16) == 0);
+	CHECK(pyramid->findLevel(64*32*16-1) == 1);
+	CHECK(pyramid->findLevel(1000) == 2);
+	CHECK(pyramid->findLevel(8*4*2) == 3);
+	CHECK(pyramid->findLevel(1) == 6);
+
+	for (long maxVoxels = 1; maxVoxels < 64*32*16; maxVoxels *= 3)
+		CHECK(pyramid->getNumberOfVoxels(pyramid->findLevel(maxVoxels)) <= maxVoxels);
+}
+
+TEST_CASE("ImagePyramid: Shows a volume before the levels are ready", "[unit][resource][core]")
+{
+	vtkImageDataPtr base = createVolume();
+	cx::ImagePyramidPtr pyramid = cx::ImagePyramid::create(base);
+
+	// either the base or a ready level, depending on the progress of the build.
+	vtkImageDataPtr volume = pyramid->getLevelFor(1000);
+	REQUIRE(volume);
+	CHECK((volume == base || volume->GetNumberOfPoints() <= 1000));
+
+	REQUIRE(pyramid->waitForLevel(pyramid->getNumberOfLevels()-1));
+	CHECK(pyramid->getLevelFor(1)->GetNumberOfPoints() == 1);
+}
+
+TEST_CASE("ImagePyramid: Builds downsampled levels", "[unit][resource][core]")
+{
+	vtkImageDataPtr base = createVolume();
+	cx::ImagePyramidPtr pyramid = cx::ImagePyramid::create(base);
+
+	CHECK(pyramid->isReady(0));
+	CHECK(pyramid->getLevel(0) == base);
+	CHECK(pyramid->getLevelFor(0) == base);
+
+	vtkImageDataPtr level1 = pyramid->waitForLevel(1);
+	REQUIRE(level1);
+	CHECK(pyramid->isReady(1));
+	int* dim = level1->GetDimensions();
+	CHECK(dim[0] == 32);
+	CHECK(dim[1] == 16);
+	CHECK(dim[2] == 8);
+	CHECK(level1->GetSpacing()[0] == Approx(1.0));
+	CHECK(level1->GetScalarRange()[1] == Approx(base->GetScalarRange()[1]));
+
+	for (int level = 1; level < pyramid->getNumberOfLevels(); ++level)
+		REQUIRE(pyramid->waitForLevel(level));
+	CHECK(pyramid->getLevelFor(1000) == pyramid->getLevel(2));
+}
+
+TEST_CASE("ImagePyramid: Image rebuilds pyramid when data change", "[unit][resource][core]")
+{
+	vtkImageDataPtr base = createVolume();
+	cx::ImagePtr image(new cx::Image("test", base));
+
+	cx::ImagePyramidPtr pyramid = image->getPyramid();
+	CHECK(image->getPyramid() == pyramid);
+	CHECK(pyramid->isValidFor(base));
+
+	vtkImageDataPtr resampled = image->resample(10000);
+	CHECK(resampled->GetNumberOfPoints() <= 10000);
+	CHECK(resampled == pyramid->getLevel(1));
+
+	base->Modified();
+	CHECK_FALSE(pyramid->isValidFor(base));
+	CHECK(image->getPyramid() != pyramid);
+}
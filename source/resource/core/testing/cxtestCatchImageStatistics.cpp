@@ -0,0 +1,138 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QtConcurrent>
+#include <vtkImageData.h>
+#include "cxImage.h"
+#include "cxImageStatistics.h"
+#include "cxVolumeHelpers.h"
+
+namespace
+{
+vtkImageDataPtr createShortImage()
+{
+	// 64*64*20 voxels: large enough to be split between threads
+	vtkImageDataPtr retval = cx::generateVtkImageDataSignedShort(Eigen::Array3i(64, 64, 20), cx::Vector3D(1, 1, 1), 0);
+	short* ptr = static_cast<short*>(retval->GetScalarPointer());
+	ptr[0] = -1000;
+	ptr[1] = -1000;
+	ptr[100] = 3000;
+	ptr[101] = 17;
+	return retval;
+}
+
+int getImageMax(const cx::ImagePtr& image)
+{
+	return image->getMax();
+}
+} // namespace
+
+TEST_CASE("ImageStatistics: Finds range and histogram of short image", "[unit][resource][core]")
+{
+	vtkImageDataPtr raw = createShortImage();
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create(raw);
+
+	CHECK(statistics->getMin() == Approx(-1000));
+	CHECK(statistics->getMax() == Approx(3000));
+	CHECK(statistics->getScalarMin() == Approx(-1000));
+	CHECK(statistics->getScalarMax() == Approx(3000));
+	CHECK(statistics->getHistogramMin() == -1000);
+	CHECK(statistics->getHistogramMax() == 3000);
+	CHECK(statistics->getNumberOfVoxels() == 64*64*20);
+
+	CHECK(statistics->getCount(-1000) == 2);
+	CHECK(statistics->getCount(17) == 1);
+	CHECK(statistics->getCount(3000) == 1);
+	CHECK(statistics->getCount(0) == 64*64*20-4);
+	CHECK(statistics->getCount(5000) == 0);
+	CHECK(statistics->getMaxCount(true) == 2);
+	CHECK(statistics->getMaxCount(false) == 64*64*20-4);
+}
+
+TEST_CASE("ImageStatistics: Uses average intensity for RGB image", "[unit][resource][core]")
+{
+	vtkImageDataPtr raw = cx::generateVtkImageData(Eigen::Array3i(10, 10, 1), cx::Vector3D(1, 1, 1), 0, 3);
+	unsigned char* ptr = static_cast<unsigned char*>(raw->GetScalarPointer());
+	ptr[3] = 100; // voxel 1
+	ptr[4] = 200;
+	ptr[5] = 0;
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create(raw);
+
+	CHECK(statistics->getMax() == Approx(100));
+	CHECK(statistics->getScalarMax() == Approx(100));
+	CHECK(statistics->getCount(100) == 1);
+}
+
+TEST_CASE("ImageStatistics: Finds range of double image", "[unit][resource][core]")
+{
+	vtkImageDataPtr raw = cx::generateVtkImageDataDouble(Eigen::Array3i(10, 10, 10), cx::Vector3D(1, 1, 1), 0.5);
+	double* ptr = static_cast<double*>(raw->GetScalarPointer());
+	ptr[10] = -2.5;
+	ptr[20] = 7.25;
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create(raw);
+
+	CHECK(statistics->getMin() == Approx(-2.5));
+	CHECK(statistics->getMax() == Approx(7.25));
+	CHECK(statistics->getHistogramMin() == -3);
+	CHECK(statistics->getHistogramMax() == 7);
+	CHECK(statistics->getCount(0) == 1000-2);
+	CHECK(statistics->getCount(-3) == 1);
+}
+
+TEST_CASE("ImageStatistics: Skips histogram for large intensity range", "[unit][resource][core]")
+{
+	vtkImageDataPtr raw = cx::generateVtkImageDataDouble(Eigen::Array3i(10, 10, 10), cx::Vector3D(1, 1, 1), 0.5);
+	double* ptr = static_cast<double*>(raw->GetScalarPointer());
+	ptr[10] = -1.0e7;
+	ptr[20] = 1.0e7;
+	cx::ImageStatisticsPtr statistics = cx::ImageStatistics::create(raw);
+
+	CHECK(statistics->getMin() == Approx(-1.0e7));
+	CHECK(statistics->getMax() == Approx(1.0e7));
+	CHECK(statistics->getMaxCount(false) == 0);
+}
+
+TEST_CASE("ImageStatistics: Image statistics are invalidated by new image data", "[unit][resource][core]")
+{
+	vtkImageDataPtr raw = createShortImage();
+	cx::ImagePtr image(new cx::Image("test", raw));
+
+	cx::ImageStatisticsPtr statistics = image->getStatistics();
+	CHECK(image->getStatistics() == statistics);
+	CHECK(image->getMax() == 3000);
+	CHECK(image->getMin() == -1000);
+
+	SECTION("Modified image data")
+	{
+		static_cast<short*>(raw->GetScalarPointer())[200] = 4000;
+		raw->Modified();
+		CHECK(image->getMax() == 4000);
+	}
+	SECTION("New image data")
+	{
+		image->setVtkImageData(cx::generateVtkImageDataSignedShort(Eigen::Array3i(4, 4, 4), cx::Vector3D(1, 1, 1), 5));
+		CHECK(image->getMin() == 5);
+		CHECK(image->getMax() == 5);
+	}
+	SECTION("Concurrent access")
+	{
+		image->setVtkImageData(createShortImage(), false);
+		QList<cx::ImagePtr> images;
+		for (int i=0; i<8; ++i)
+			images << image;
+		QList<int> max = QtConcurrent::blockingMapped(images, &getImageMax);
+		for (int i=0; i<max.size(); ++i)
+			CHECK(max[i] == 3000);
+		CHECK(image->getStatistics()->isValidFor(image->getBaseVtkImageData()));
+	}
+}
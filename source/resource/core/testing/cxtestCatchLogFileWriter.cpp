@@ -0,0 +1,70 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include "internal/cxLogFileWriter.h"
+#include "cxDataLocations.h"
+
+namespace
+{
+QString createTempFilename()
+{
+	QString filename = cx::DataLocations::getTestDataPath()+"/temp/LogFileWriter/test.txt";
+	QDir().mkpath(QFileInfo(filename).absolutePath());
+	QFile::remove(filename);
+	return filename;
+}
+
+QString readFile(QString filename)
+{
+	QFile file(filename);
+	file.open(QFile::ReadOnly);
+	return QString::fromLocal8Bit(file.readAll());
+}
+} // namespace
+
+TEST_CASE("LogFileWriter: Buffers until flushed", "[unit][resource][core]")
+{
+	QString filename = createTempFilename();
+	cx::LogFileWriter writer(filename);
+
+	writer.write("first\n");
+	writer.write("second\n");
+	CHECK(writer.getBufferSize() == 13);
+	CHECK(readFile(filename).isEmpty());
+
+	CHECK(writer.flush());
+	CHECK(writer.getBufferSize() == 0);
+	CHECK(readFile(filename) == "first\nsecond\n");
+
+	writer.write("third\n");
+	CHECK(writer.flush());
+	CHECK(readFile(filename) == "first\nsecond\nthird\n");
+}
+
+TEST_CASE("LogFileWriter: Flushes when buffer is full and on destruction", "[unit][resource][core]")
+{
+	QString filename = createTempFilename();
+	{
+		cx::LogFileWriter writer(filename, 10);
+		writer.write("0123456789");
+		CHECK(writer.getBufferSize() == 0);
+		CHECK(readFile(filename) == "0123456789");
+
+		writer.write("abc");
+		CHECK(readFile(filename) == "0123456789");
+	}
+	CHECK(readFile(filename) == "0123456789abc");
+}
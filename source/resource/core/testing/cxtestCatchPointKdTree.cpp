@@ -0,0 +1,90 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <cstdlib>
+#include "cxPointKdTree.h"
+
+namespace
+{
+std::vector<cx::Vector3D> createRandomPoints(int count)
+{
+	std::srand(42);
+	std::vector<cx::Vector3D> retval;
+	for (int i = 0; i < count; ++i)
+		retval.push_back(cx::Vector3D(std::rand()%1000, std::rand()%1000, std::rand()%100) / 10.0);
+	return retval;
+}
+
+int findClosestBruteForce(const std::vector<cx::Vector3D>& points, cx::Vector3D p)
+{
+	int retval = -1;
+	double best = 0;
+	for (unsigned i = 0; i < points.size(); ++i)
+	{
+		double d = (points[i] - p).squaredNorm();
+		if (retval < 0 || d < best)
+		{
+			retval = i;
+			best = d;
+		}
+	}
+	return retval;
+}
+} // namespace
+
+TEST_CASE("PointKdTree: Finds the same closest points as brute force", "[unit][resource][core]")
+{
+	std::vector<cx::Vector3D> points = createRandomPoints(2000);
+	cx::PointKdTree tree(points);
+	REQUIRE(tree.getNumberOfPoints() == 2000);
+
+	std::vector<cx::Vector3D> queries = createRandomPoints(200);
+	for (unsigned i = 0; i < queries.size(); ++i)
+	{
+		cx::Vector3D p = queries[i] + cx::Vector3D(0.05, -0.05, 0.05);
+		double distanceSquared = -1;
+		int found = tree.findClosestPoint(p, &distanceSquared);
+		int expected = findClosestBruteForce(points, p);
+		REQUIRE(found == expected);
+		CHECK(distanceSquared == Approx((points[expected] - p).squaredNorm()));
+	}
+}
+
+TEST_CASE("PointKdTree: Finds points within radius", "[unit][resource][core]")
+{
+	std::vector<cx::Vector3D> points = createRandomPoints(2000);
+	cx::PointKdTree tree(points);
+
+	cx::Vector3D center(50, 50, 5);
+	double radius = 7;
+	std::vector<int> expected;
+	for (unsigned i = 0; i < points.size(); ++i)
+		if ((points[i] - center).squaredNorm() <= radius*radius)
+			expected.push_back(i);
+
+	std::vector<int> found = tree.findPointsWithinRadius(center, radius);
+	CHECK(!expected.empty());
+	CHECK(found == expected);
+}
+
+TEST_CASE("PointKdTree: Handles empty and duplicate points", "[unit][resource][core]")
+{
+	cx::PointKdTree empty((std::vector<cx::Vector3D>()));
+	CHECK(empty.findClosestPoint(cx::Vector3D(1, 2, 3)) == -1);
+	CHECK(empty.findPointsWithinRadius(cx::Vector3D(1, 2, 3), 10).empty());
+
+	std::vector<cx::Vector3D> points(5, cx::Vector3D(1, 1, 1));
+	cx::PointKdTree tree(points);
+	CHECK(tree.findClosestPoint(cx::Vector3D(0, 0, 0)) == 0);
+	CHECK(tree.findPointsWithinRadius(cx::Vector3D(1, 1, 1), 0).size() == 5);
+}
@@ -0,0 +1,133 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <vector>
+#include <cmath>
+#include "cxPositionStorageFile.h"
+#include "cxPositionJournalWriter.h"
+#include "cxDataLocations.h"
+
+namespace
+{
+QString getJournalFilename()
+{
+	QString path = cx::DataLocations::getTestDataPath() + "/temp/PositionJournal";
+	QDir().mkpath(path);
+	QString filename = path + "/toolpositions.snwpos";
+	QFile::remove(filename);
+	return filename;
+}
+
+cx::Transform3D createTransform(double t)
+{
+	return cx::createTransformTranslate(cx::Vector3D(t, 2, 3));
+}
+
+std::vector<cx::PositionStorageEntry> readAll(cx::PositionStorageReader& reader)
+{
+	std::vector<cx::PositionStorageEntry> retval;
+	cx::Transform3D matrix = cx::Transform3D::Identity();
+	double timestamp;
+	QString toolUid;
+	while (!reader.atEnd())
+	{
+		if (!reader.read(&matrix, &timestamp, &toolUid))
+			break;
+		retval.push_back(cx::PositionStorageEntry(toolUid, timestamp, matrix));
+	}
+	return retval;
+}
+} // namespace
+
+TEST_CASE("PositionJournalWriter: Written positions are read back in order", "[unit][resource][core]")
+{
+	QString filename = getJournalFilename();
+	{
+		cx::PositionJournalWriter journal(filename, 10);
+		for (int i = 0; i < 10; ++i)
+			journal.append(i%2 ? "tool1" : "tool2", 1000+i, createTransform(i));
+		journal.flush();
+		CHECK(journal.getWrittenCount() == 10);
+
+		journal.append("tool1", 2000, createTransform(20));
+	} // destructor writes the rest
+
+	cx::PositionStorageReader reader(filename);
+	std::vector<cx::PositionStorageEntry> entries = readAll(reader);
+	REQUIRE(entries.size() == 11);
+	for (int i = 0; i < 10; ++i)
+	{
+		CHECK(entries[i].mToolUid == (i%2 ? "tool1" : "tool2"));
+		CHECK(entries[i].mTimestamp == Approx(1000+i));
+		CHECK(std::fabs(entries[i].mPosition.translation()[0] - i) < 0.001);
+	}
+	CHECK(entries[10].mTimestamp == Approx(2000));
+}
+
+TEST_CASE("PositionJournalWriter: Reader skips blocks outside the time window", "[unit][resource][core]")
+{
+	QString filename = getJournalFilename();
+	{
+		cx::PositionJournalWriter journal(filename, 10000);
+		for (int block = 0; block < 3; ++block)
+		{
+			for (int i = 0; i < 5; ++i)
+				journal.append("tool", 1000*block+i, createTransform(i));
+			journal.flush();
+		}
+		CHECK(journal.getBlockCount() == 3);
+	}
+
+	SECTION("Window inside one block")
+	{
+		cx::PositionStorageReader reader(filename);
+		reader.setTimeWindow(1001, 1002);
+		std::vector<cx::PositionStorageEntry> entries = readAll(reader);
+		REQUIRE(entries.size() == 5);
+		CHECK(entries.front().mTimestamp == Approx(1000));
+		CHECK(entries.back().mTimestamp == Approx(1004));
+		CHECK(entries.front().mToolUid == "tool");
+	}
+	SECTION("Window after the last block")
+	{
+		cx::PositionStorageReader reader(filename);
+		reader.setTimeWindow(5000, 6000);
+		CHECK(readAll(reader).empty());
+	}
+	SECTION("No window")
+	{
+		cx::PositionStorageReader reader(filename);
+		CHECK(readAll(reader).size() == 15);
+	}
+}
+
+TEST_CASE("PositionStorageWriter: Unblocked positions are read back", "[unit][resource][core]")
+{
+	QString filename = getJournalFilename();
+	{
+		cx::PositionStorageWriter writer(filename);
+		writer.write(createTransform(1), 100, QString("tool1"));
+		writer.write(createTransform(2), 101, QString("tool1"));
+		writer.write(createTransform(3), 102, QString("tool2"));
+	}
+
+	cx::PositionStorageReader reader(filename);
+	reader.setTimeWindow(5000, 6000); // does not apply outside blocks
+	std::vector<cx::PositionStorageEntry> entries = readAll(reader);
+	REQUIRE(entries.size() == 3);
+	CHECK(entries[0].mToolUid == "tool1");
+	CHECK(entries[1].mTimestamp == Approx(101));
+	CHECK(entries[2].mToolUid == "tool2");
+}
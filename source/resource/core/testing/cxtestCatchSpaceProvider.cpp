@@ -0,0 +1,71 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include "cxSpaceProviderImpl.h"
+#include "cxTrackingService.h"
+#include "cxRegistrationTransform.h"
+#include "cxtestPatientModelServiceMock.h"
+#include "cxDummyToolManager.h"
+#include "cxDummyTool.h"
+
+TEST_CASE("SpaceProviderImpl: Caches transforms until the registration changes", "[unit][resource][core]")
+{
+	cxtest::PatientModelServiceMockPtr patientModel(new cxtest::PatientModelServiceMock());
+	cx::SpaceProviderImpl spaceProvider(cx::TrackingService::getNullObject(), patientModel);
+
+	cx::CoordinateSystem pr = spaceProvider.getPr();
+	cx::CoordinateSystem r = spaceProvider.getR();
+
+	cx::Transform3D rMpr = cx::createTransformTranslate(cx::Vector3D(1, 2, 3));
+	patientModel->get_rMpr_History()->setRegistration(rMpr);
+
+	CHECK(cx::similar(spaceProvider.get_toMfrom(pr, r), rMpr));
+	CHECK(spaceProvider.getCacheMissCount() == 1);
+	CHECK(spaceProvider.getCacheHitCount() == 0);
+
+	CHECK(cx::similar(spaceProvider.get_toMfrom(pr, r), rMpr));
+	CHECK(cx::similar(spaceProvider.get_toMfrom(r, pr), rMpr.inv()));
+	CHECK(spaceProvider.getCacheMissCount() == 2);
+	CHECK(spaceProvider.getCacheHitCount() == 1);
+
+	cx::Transform3D changed = cx::createTransformTranslate(cx::Vector3D(4, 5, 6));
+	patientModel->get_rMpr_History()->setRegistration(changed);
+
+	CHECK(cx::similar(spaceProvider.get_toMfrom(pr, r), changed));
+	CHECK(spaceProvider.getCacheMissCount() == 3);
+}
+
+TEST_CASE("SpaceProviderImpl: Tool moves with equal timestamps invalidate the cache", "[unit][resource][core]")
+{
+	cxtest::PatientModelServiceMockPtr patientModel(new cxtest::PatientModelServiceMock());
+	cx::DummyToolManager::DummyToolManagerPtr trackingService = cx::DummyToolManager::create();
+	cx::DummyToolPtr dummyTool(new cx::DummyTool("tool"));
+	trackingService->addTool(dummyTool);
+	cx::SpaceProviderImpl spaceProvider(trackingService, patientModel);
+
+	cx::ToolPtr tool = dummyTool;
+	cx::CoordinateSystem t = cx::CoordinateSystem(cx::csTOOL, "tool");
+	cx::CoordinateSystem pr = spaceProvider.getPr();
+	double timestamp = 1000;
+
+	cx::Transform3D first = cx::createTransformTranslate(cx::Vector3D(1, 2, 3));
+	tool->set_prMt(first, timestamp);
+	CHECK(cx::similar(spaceProvider.get_toMfrom(t, pr), first));
+	CHECK(cx::similar(spaceProvider.get_toMfrom(t, pr), first));
+	CHECK(spaceProvider.getCacheHitCount() == 1);
+
+	// e.g. two manual tool moves within the same millisecond
+	cx::Transform3D second = cx::createTransformTranslate(cx::Vector3D(4, 5, 6));
+	tool->set_prMt(second, timestamp);
+	CHECK(cx::similar(spaceProvider.get_toMfrom(t, pr), second));
+}
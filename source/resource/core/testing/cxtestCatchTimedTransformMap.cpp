@@ -0,0 +1,127 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <map>
+#include <cstdlib>
+#include "cxTimedTransformMap.h"
+
+namespace cxtest
+{
+
+namespace
+{
+typedef std::map<double, cx::Transform3D> ReferenceMap;
+
+cx::Transform3D createTransform(double t)
+{
+	return cx::createTransformTranslate(cx::Vector3D(t, 2*t, 3));
+}
+
+void checkEqual(const cx::TimedTransformMap& map, const ReferenceMap& reference)
+{
+	REQUIRE(map.size() == reference.size());
+	bool equal = true;
+	cx::TimedTransformMap::const_iterator iter = map.begin();
+	for (ReferenceMap::const_iterator ref = reference.begin(); ref != reference.end(); ++ref, ++iter)
+	{
+		equal = equal && (iter->first == ref->first);
+		equal = equal && (iter->second.translation() == ref->second.translation());
+	}
+	CHECK(equal);
+	CHECK(iter == map.end());
+}
+} // namespace
+
+TEST_CASE("TimedTransformMap: Append in time order", "[unit][resource][core]")
+{
+	cx::TimedTransformMap map(4);
+	ReferenceMap reference;
+	for (int i = 0; i < 10; ++i)
+	{
+		map[i*10] = createTransform(i);
+		reference[i*10] = createTransform(i);
+	}
+
+	checkEqual(map, reference);
+	CHECK(map.getNumberOfChunks() == 3);
+	CHECK(map.begin()->first == 0);
+	CHECK(map.rbegin()->first == 90);
+	CHECK((++map.rbegin())->first == 80);
+}
+
+TEST_CASE("TimedTransformMap: Insert out of order behaves like std::map", "[unit][resource][core]")
+{
+	cx::TimedTransformMap map(4);
+	ReferenceMap reference;
+	srand(0);
+	for (int i = 0; i < 200; ++i)
+	{
+		double t = rand() % 100;
+		map[t] = createTransform(t);
+		reference[t] = createTransform(t);
+	}
+	checkEqual(map, reference);
+
+	for (double t = -1; t < 101; t += 0.5)
+	{
+		CHECK(map.count(t) == reference.count(t));
+		ReferenceMap::iterator refLower = reference.lower_bound(t);
+		cx::TimedTransformMap::iterator lower = map.lower_bound(t);
+		CHECK((lower == map.end()) == (refLower == reference.end()));
+		if (refLower != reference.end())
+			CHECK(lower->first == refLower->first);
+
+		ReferenceMap::iterator refUpper = reference.upper_bound(t);
+		cx::TimedTransformMap::iterator upper = map.upper_bound(t);
+		CHECK((upper == map.end()) == (refUpper == reference.end()));
+		if (refUpper != reference.end())
+			CHECK(upper->first == refUpper->first);
+	}
+}
+
+TEST_CASE("TimedTransformMap: Existing keys are not duplicated", "[unit][resource][core]")
+{
+	cx::TimedTransformMap map;
+	map[10] = createTransform(1);
+	map[20] = createTransform(2);
+	map[10] = createTransform(3);
+
+	CHECK(map.size() == 2);
+	CHECK(map.find(10)->second.translation() == createTransform(3).translation());
+	CHECK(!map.insert(std::make_pair(20.0, createTransform(4))).second);
+	CHECK(map.find(20)->second.translation() == createTransform(2).translation());
+	CHECK(map.find(15) == map.end());
+}
+
+TEST_CASE("TimedTransformMap: Copy a time range", "[unit][resource][core]")
+{
+	cx::TimedTransformMap map(4);
+	for (int i = 0; i < 20; ++i)
+		map[i] = createTransform(i);
+
+	cx::TimedTransformMap range(map.lower_bound(5), map.upper_bound(12));
+	CHECK(range.size() == 8);
+	CHECK(range.begin()->first == 5);
+	CHECK(range.rbegin()->first == 12);
+
+	cx::TimedTransformMap merged;
+	merged.insert(range.begin(), range.end());
+	merged.insert(map.lower_bound(10), map.end());
+	CHECK(merged.size() == 15);
+
+	cx::TimedTransformMap::iterator last = merged.lower_bound(100);
+	--last;
+	CHECK(last->first == 19);
+}
+
+} // namespace cxtest
@@ -0,0 +1,110 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <vtkImageData.h>
+#include <vtkPointData.h>
+#include "cxVideoFramePool.h"
+#include "cxVolumeHelpers.h"
+
+namespace cxtest
+{
+
+TEST_CASE("VideoFramePool: Released frames are reused", "[unit][resource][core]")
+{
+	cx::VideoFramePool pool(4);
+	Eigen::Array3i dim(32, 16, 1);
+
+	vtkImageDataPtr frame = pool.get(dim, VTK_UNSIGNED_CHAR, 3);
+	REQUIRE(frame);
+	CHECK(frame->GetDimensions()[0] == 32);
+	CHECK(frame->GetNumberOfScalarComponents() == 3);
+	void* buffer = frame->GetScalarPointer();
+
+	// frame in use: a new frame is allocated
+	vtkImageDataPtr second = pool.get(dim, VTK_UNSIGNED_CHAR, 3);
+	CHECK(second->GetScalarPointer() != buffer);
+	CHECK(pool.getMissCount() == 2);
+
+	frame = NULL;
+	vtkImageDataPtr third = pool.get(dim, VTK_UNSIGNED_CHAR, 3);
+	CHECK(third->GetScalarPointer() == buffer);
+	CHECK(pool.getHitCount() == 1);
+	CHECK(pool.getSize() == 2);
+}
+
+TEST_CASE("VideoFramePool: Frames with shared scalars are not reused", "[unit][resource][core]")
+{
+	cx::VideoFramePool pool(4);
+	Eigen::Array3i dim(32, 16, 1);
+
+	vtkImageDataPtr frame = pool.get(dim, VTK_UNSIGNED_CHAR, 1);
+	vtkImageDataPtr shallow = vtkImageDataPtr::New();
+	shallow->ShallowCopy(frame);
+	frame = NULL;
+
+	vtkImageDataPtr other = pool.get(dim, VTK_UNSIGNED_CHAR, 1);
+	CHECK(other->GetScalarPointer() != shallow->GetScalarPointer());
+	CHECK(pool.getHitCount() == 0);
+}
+
+TEST_CASE("VideoFramePool: Frames are matched on layout", "[unit][resource][core]")
+{
+	cx::VideoFramePool pool(1);
+	vtkImageDataPtr frame = pool.get(Eigen::Array3i(32, 16, 1), VTK_UNSIGNED_CHAR, 1);
+	frame = NULL;
+
+	SECTION("Other dimensions")
+	{
+		frame = pool.get(Eigen::Array3i(16, 16, 1), VTK_UNSIGNED_CHAR, 1);
+	}
+	SECTION("Other scalar type")
+	{
+		frame = pool.get(Eigen::Array3i(32, 16, 1), VTK_UNSIGNED_SHORT, 1);
+	}
+	SECTION("Other number of components")
+	{
+		frame = pool.get(Eigen::Array3i(32, 16, 1), VTK_UNSIGNED_CHAR, 4);
+	}
+	CHECK(pool.getHitCount() == 0);
+	CHECK(pool.getMissCount() == 2);
+	CHECK(pool.getSize() == 1); // the unused frame was replaced
+}
+
+TEST_CASE("VideoFramePool: Copy into pooled frame", "[unit][resource][core]")
+{
+	cx::VideoFramePool pool;
+	vtkImageDataPtr source = cx::generateVtkImageData(Eigen::Array3i(20, 10, 1), cx::Vector3D(0.5, 0.25, 1), 0);
+	source->SetOrigin(1, 2, 3);
+	unsigned char* src = static_cast<unsigned char*>(source->GetScalarPointer());
+	for (int i = 0; i < 20*10; ++i)
+		src[i] = i;
+
+	for (int repeat = 0; repeat < 3; ++repeat)
+	{
+		vtkImageDataPtr copy = pool.copy(source);
+		REQUIRE(copy);
+		CHECK(copy->GetScalarPointer() != source->GetScalarPointer());
+		CHECK(cx::similar(cx::Vector3D(copy->GetSpacing()), cx::Vector3D(0.5, 0.25, 1)));
+		CHECK(cx::similar(cx::Vector3D(copy->GetOrigin()), cx::Vector3D(1, 2, 3)));
+		unsigned char* dst = static_cast<unsigned char*>(copy->GetScalarPointer());
+		bool equal = true;
+		for (int i = 0; i < 20*10; ++i)
+			equal = equal && (dst[i] == src[i]);
+		CHECK(equal);
+	}
+	CHECK(pool.getMissCount() == 1);
+	CHECK(pool.getHitCount() == 2);
+	CHECK(!pool.copy(vtkImageDataPtr()));
+}
+
+} // namespace cxtest
@@ -16,6 +16,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxImageTF3D.h"
 #include "cxTransferFunctions3DPresets.h"
 #include "cxVolumeHelpers.h"
+#include "cxUnsignedDerivedImage.h"
 
 #include "cxProfile.h"
 #include "cxLogicManager.h"
@@ -263,6 +264,35 @@ TEST_CASE("Image: Initial window is kept after using UnsignedDerivedImage", "[un
 	cx::LogicManager::shutdown();
 }
 
+TEST_CASE("Image: UnsignedDerivedImage converts slices on demand", "[unit][resource][core]")
+{
+	Eigen::Array3i dim(8, 6, 5);
+	vtkImageDataPtr data = cx::generateVtkImageDataSignedShort(dim, cx::Vector3D(1, 1, 1), 0);
+	short* ptr = static_cast<short*>(data->GetScalarPointer());
+	for (int i = 0; i < dim.prod(); ++i)
+		ptr[i] = i - 100;
+	data->Modified();
+	cx::ImagePtr image(new cx::Image("signed", data));
+
+	cx::UnsignedDerivedImagePtr unsignedImage = boost::dynamic_pointer_cast<cx::UnsignedDerivedImage>(image->getUnsigned(image));
+	REQUIRE(unsignedImage);
+	CHECK(unsignedImage->getShift() == 100);
+	CHECK(unsignedImage->getUnsignedScalarType() == VTK_UNSIGNED_SHORT);
+
+	int sliceSize = dim[0]*dim[1];
+	std::vector<unsigned short> slab(2*sliceSize);
+	REQUIRE(unsignedImage->copyUnsignedSlices(2, 2, &slab[0]));
+	CHECK(slab[0] == 2*sliceSize);
+	CHECK(slab[2*sliceSize-1] == 4*sliceSize-1);
+	CHECK_FALSE(unsignedImage->copyUnsignedSlices(4, 2, &slab[0]));
+
+	vtkImageDataPtr converted = unsignedImage->getBaseVtkImageData();
+	REQUIRE(converted);
+	CHECK(converted->GetScalarType() == VTK_UNSIGNED_SHORT);
+	CHECK(converted->GetScalarRange()[0] == 0);
+	CHECK(converted->GetScalarRange()[1] == dim.prod()-1);
+}
+
 TEST_CASE("Image: Initial window from mdh file is kept after using addXml and parseXml", "[unit][resource][core]")
 {
 	cx::LogicManager::initialize();
@@ -28,11 +28,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxXmlOptionItem.h"
 #include "cxImageDataContainer.h"
 #include "cxVideoSource.h"
+#include "cxUSAcquisitionStreamFile.h"
+#include "cxVideoFramePool.h"
 
 namespace cx
 {
 
-VideoRecorderSaveThread::VideoRecorderSaveThread(QObject* parent, QString saveFolder, QString prefix, bool compressed, bool writeColor) :
+VideoRecorderSaveThread::VideoRecorderSaveThread(QObject* parent, QString saveFolder, QString prefix, bool compressed, bool writeColor, bool singleFile) :
 	QThread(parent),
 	mSaveFolder(saveFolder),
 	mPrefix(prefix),
@@ -42,9 +44,12 @@ VideoRecorderSaveThread::VideoRecorderSaveThread(QObject* parent, QString saveFo
 	mCancel(false),
 	mTimestampsFile(saveFolder+"/"+prefix+".fts"),
 	mCompressed(compressed),
-	mWriteColor(writeColor)
+	mWriteColor(writeColor),
+	mFramePool(new VideoFramePool())
 {
 	this->setObjectName("org.custusx.resource.videorecordersave"); // becomes the thread name
+	if (singleFile)
+		mStreamWriter.reset(new USAcquisitionStreamWriter(saveFolder+"/"+prefix+".cxus", compressed));
 }
 
 VideoRecorderSaveThread::~VideoRecorderSaveThread()
@@ -58,9 +63,12 @@ QString VideoRecorderSaveThread::addData(TimeInfo timestamp, vtkImageDataPtr ima
 
 	DataType data;
 	data.mTimestamp = timestamp;
-	data.mImage = vtkImageDataPtr::New();
-	data.mImage->DeepCopy(image);
-	data.mImageFilename = QString("%1/%2_%3.mhd").arg(mSaveFolder).arg(mPrefix).arg(mImageIndex++);
+	data.mImage = mFramePool->copy(image);
+	if (mStreamWriter)
+		data.mImageFilename = mStreamWriter->getFilename();
+	else
+		data.mImageFilename = QString("%1/%2_%3.mhd").arg(mSaveFolder).arg(mPrefix).arg(mImageIndex);
+	mImageIndex++;
 
 	{
 		QMutexLocker sentry(&mMutex);
@@ -70,6 +78,13 @@ QString VideoRecorderSaveThread::addData(TimeInfo timestamp, vtkImageDataPtr ima
 	return data.mImageFilename;
 }
 
+QString VideoRecorderSaveThread::getSingleFilename() const
+{
+	if (!mStreamWriter)
+		return "";
+	return mStreamWriter->getFilename();
+}
+
 void VideoRecorderSaveThread::stop()
 {
 	mStop = true;
@@ -83,6 +98,9 @@ void VideoRecorderSaveThread::cancel()
 
 bool VideoRecorderSaveThread::openTimestampsFile()
 {
+	if (mStreamWriter)
+		return mStreamWriter->open();
+
 	if(!mTimestampsFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
 	{
 	  reportError("Cannot open "+mTimestampsFile.fileName());
@@ -94,6 +112,8 @@ bool VideoRecorderSaveThread::openTimestampsFile()
 
 bool VideoRecorderSaveThread::closeTimestampsFile()
 {
+	if (mStreamWriter)
+		mStreamWriter->close();
 	mTimestampsFile.close();
 
 //	QFileInfo info(mTimestampsFile);
@@ -108,7 +128,8 @@ bool VideoRecorderSaveThread::closeTimestampsFile()
 
 void VideoRecorderSaveThread::write(VideoRecorderSaveThread::DataType data)
 {
-	this->writeTimeStampsFile(data.mTimestamp);
+	if (!mStreamWriter)
+		this->writeTimeStampsFile(data.mTimestamp);
 
 	// convert to 8 bit data if applicable.
 	if (!mWriteColor && data.mImage->GetNumberOfScalarComponents()>2)
@@ -120,6 +141,12 @@ void VideoRecorderSaveThread::write(VideoRecorderSaveThread::DataType data)
 //		  data.mImage->Update();
 	}
 
+	if (mStreamWriter)
+	{
+		mStreamWriter->writeFrame(data.mTimestamp, data.mImage);
+		return;
+	}
+
 	// write image
 	vtkMetaImageWriterPtr writer = vtkMetaImageWriterPtr::New();
 	writer->SetInputData(data.mImage);
@@ -175,7 +202,7 @@ void VideoRecorderSaveThread::run()
 //---------------------------------------------------------
 
 
-SavingVideoRecorder::SavingVideoRecorder(VideoSourcePtr source, QString saveFolder, QString prefix, bool compressed, bool writeColor, FileManagerServicePtr filemanagerservice) :
+SavingVideoRecorder::SavingVideoRecorder(VideoSourcePtr source, QString saveFolder, QString prefix, bool compressed, bool writeColor, FileManagerServicePtr filemanagerservice, bool singleFile) :
 //	mLastPurgedImageIndex(-1),
 	mSource(source)
 {
@@ -184,7 +211,7 @@ SavingVideoRecorder::SavingVideoRecorder(VideoSourcePtr source, QString saveFold
 
 	mPrefix = prefix;
 	mSaveFolder = saveFolder;
-	mSaveThread.reset(new VideoRecorderSaveThread(NULL, saveFolder, prefix, compressed, writeColor));
+	mSaveThread.reset(new VideoRecorderSaveThread(NULL, saveFolder, prefix, compressed, writeColor, singleFile));
 	mSaveThread->start();
 }
 
@@ -213,13 +240,27 @@ void SavingVideoRecorder::newFrameSlot()
 	TimeInfo timestamp = mSource->getAdvancedTimeInfo();
 	QString filename = mSaveThread->addData(timestamp, image);
 
-	mImages->append(filename);
+	if (mSaveThread->getSingleFilename().isEmpty())
+		mImages->append(filename);
 	mTimestamps.push_back(timestamp);
 }
 
-CachedImageDataContainerPtr SavingVideoRecorder::getImageData()
+ImageDataContainerPtr SavingVideoRecorder::getImageData()
 {
-	return mImages;
+	QString singleFile = mSaveThread->getSingleFilename();
+	if (singleFile.isEmpty())
+		return mImages;
+
+	// the file must be complete before reading
+	if (!mSingleFileImages)
+	{
+		this->completeSave();
+		USAcquisitionStreamReaderPtr reader(new USAcquisitionStreamReader(singleFile));
+		USAcquisitionStreamContainerPtr container(new USAcquisitionStreamContainer(reader));
+		container->setDeleteFileOnRelease(true);
+		mSingleFileImages = container;
+	}
+	return mSingleFileImages;
 }
 
 std::vector<TimeInfo> SavingVideoRecorder::getTimestamps()
@@ -242,7 +283,7 @@ void SavingVideoRecorder::cancel()
 void SavingVideoRecorder::deleteFolder(QString folder)
 {
 	QStringList filters;
-	filters << "*.fts" << "*.mhd" << "*.raw" << "*.zraw";
+	filters << "*.fts" << "*.mhd" << "*.raw" << "*.zraw" << "*.cxus";
 	for (int i=0; i<filters.size(); ++i) // prepend prefix, ensuring files from other savers are not deleted.
 		filters[i] = mPrefix + filters[i];
 
@@ -258,6 +299,7 @@ void SavingVideoRecorder::completeSave()
 {
 	mSaveThread->stop();
 	mSaveThread->wait(); // wait indefinitely for thread to finish
+	CX_LOG_CHANNEL_DEBUG("video") << "Saved " << mSource->getName() << ", " << mSaveThread->getFramePool()->getStatistics();
 }
 
 } // namespace cx
@@ -25,6 +25,9 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 typedef boost::shared_ptr<class CachedImageDataContainer> CachedImageDataContainerPtr;
+typedef boost::shared_ptr<class ImageDataContainer> ImageDataContainerPtr;
+typedef boost::shared_ptr<class USAcquisitionStreamWriter> USAcquisitionStreamWriterPtr;
+typedef boost::shared_ptr<class VideoFramePool> VideoFramePoolPtr;
 
 /** Class that saves vtkImageData continously to file.
   *
@@ -36,6 +39,9 @@ typedef boost::shared_ptr<class CachedImageDataContainer> CachedImageDataContain
   * A sequence of N files named \<prefix\>_i.mhd (0<i<N) and corresponding .raw
   * files are written.
   *
+  * If singleFile is set, all frames and timestamps are instead appended to
+  * the file \<prefix\>.cxus, see USAcquisitionStreamWriter.
+  *
   * If stop() is called, the thread will continue to write all remaining data,
   * then close files and return from run().
   *
@@ -52,12 +58,21 @@ public:
 	/**
 	  * Create the thread object, set folder to save to.
 	  */
-	VideoRecorderSaveThread(QObject* parent, QString saveFolder, QString prefix, bool compressed, bool writeColor);
+	VideoRecorderSaveThread(QObject* parent, QString saveFolder, QString prefix, bool compressed, bool writeColor, bool singleFile = false);
 	virtual ~VideoRecorderSaveThread();
 	/**
 	  * Add data to be saved.
+	  * Return the file the data will be written to.
 	  */
 	QString addData(TimeInfo timestamp, vtkImageDataPtr data);
+	/**
+	  * Return the single file written to, empty if writing one file per frame.
+	  */
+	QString getSingleFilename() const;
+	/**
+	  * Pool for the frames waiting to be written. Frames return to the pool when written.
+	  */
+	VideoFramePoolPtr getFramePool() const { return mFramePool; }
 	void stop();
 	void cancel();
 
@@ -78,6 +93,8 @@ protected:
 	QFile mTimestampsFile;
 	bool mCompressed;
 	bool mWriteColor;
+	USAcquisitionStreamWriterPtr mStreamWriter;
+	VideoFramePoolPtr mFramePool;
 	/**
 	  * Save the images to disk
 	  */
@@ -106,14 +123,17 @@ class cxResource_EXPORT SavingVideoRecorder : public QObject
 	Q_OBJECT
 
 public:
-	SavingVideoRecorder(VideoSourcePtr source, QString saveFolder, QString prefix, bool compressed, bool writeColor, FileManagerServicePtr filemanagerservice);
+	SavingVideoRecorder(VideoSourcePtr source, QString saveFolder, QString prefix, bool compressed, bool writeColor, FileManagerServicePtr filemanagerservice, bool singleFile = false);
 	virtual ~SavingVideoRecorder();
 
 	virtual void startRecord();
 	virtual void stopRecord();
 	void cancel();
 
-	CachedImageDataContainerPtr getImageData();
+	/** Return the recorded images. When recording to a single file,
+	  * this completes the save, as the file must be closed before reading.
+	  */
+	ImageDataContainerPtr getImageData();
 	std::vector<TimeInfo> getTimestamps();
 	QString getSaveFolder() { return mSaveFolder; }
 
@@ -131,6 +151,7 @@ private:
 	  */
 	void deleteFolder(QString folder);
 	CachedImageDataContainerPtr mImages;
+	ImageDataContainerPtr mSingleFileImages;
 	std::vector<TimeInfo> mTimestamps;
 	QString mSaveFolder;
 	QString mPrefix;
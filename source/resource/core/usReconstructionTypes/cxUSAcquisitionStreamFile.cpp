@@ -0,0 +1,651 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxUSAcquisitionStreamFile.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <limits>
+#include <vtkImageData.h>
+#include "cxLogger.h"
+#include "cxTypeConversions.h"
+
+namespace cx
+{
+
+namespace
+{
+const char MAGIC[8] = { 'C', 'X', 'U', 'S', 'A', 'C', 'Q', '1' };
+const quint32 VERSION = 1;
+const qint64 FILE_HEADER_SIZE = 12; // magic + version
+const qint64 CHUNK_HEADER_SIZE = 12; // type + size
+const qint64 FRAME_HEADER_SIZE = 105; // frame chunk payload excluding the pixel data
+const qint64 TAIL_CHUNK_SIZE = CHUNK_HEADER_SIZE + 8;
+const quint64 INDEX_COUNTS_SIZE = 8; // number of frames + number of chunks
+const quint64 INDEX_FRAME_ENTRY_SIZE = 32; // offset + 3 times
+const quint64 INDEX_CHUNK_ENTRY_SIZE = 12; // type + offset
+
+// chunk types, the tag reads as text in the file.
+const quint32 CHUNK_FRAME = 0x4d415246; // "FRAM"
+const quint32 CHUNK_FRAME_POSITIONS = 0x534f5046; // "FPOS"
+const quint32 CHUNK_TRACKING_POSITIONS = 0x534f5054; // "TPOS"
+const quint32 CHUNK_TEXT = 0x54584554; // "TEXT"
+const quint32 CHUNK_INDEX = 0x58444e49; // "INDX"
+const quint32 CHUNK_TAIL = 0x4c494154; // "TAIL"
+
+void setupStream(QDataStream& stream)
+{
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+}
+
+/** Size of one value of a vtk scalar type, 0 if the type is unknown.
+ */
+int getScalarTypeSize(int scalarType)
+{
+	switch (scalarType)
+	{
+	vtkTemplateMacro(return sizeof(VTK_TT));
+	default:
+		return 0;
+	}
+}
+
+qint64 getScalarDataSize(vtkImageDataPtr image)
+{
+	int* dims = image->GetDimensions();
+	return qint64(dims[0]) * dims[1] * dims[2] * image->GetNumberOfScalarComponents() * image->GetScalarSize();
+}
+
+QByteArray positionsToByteArray(const std::vector<TimedPosition>& positions)
+{
+	QByteArray retval;
+	QDataStream stream(&retval, QIODevice::WriteOnly);
+	setupStream(stream);
+	stream << quint32(positions.size());
+	for (unsigned i = 0; i < positions.size(); ++i)
+	{
+		stream << positions[i].mTime;
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 4; ++c)
+				stream << positions[i].mPos(r, c);
+	}
+	return retval;
+}
+} // namespace
+
+///--------------------------------------------------------
+///--------------------------------------------------------
+///--------------------------------------------------------
+
+USAcquisitionStreamWriter::USAcquisitionStreamWriter(QString filename, bool compress) :
+	mFile(filename),
+	mCompress(compress)
+{
+}
+
+USAcquisitionStreamWriter::~USAcquisitionStreamWriter()
+{
+	this->close();
+}
+
+bool USAcquisitionStreamWriter::open()
+{
+	QDir().mkpath(QFileInfo(mFile.fileName()).absolutePath());
+	if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		reportError("Cannot open " + mFile.fileName());
+		return false;
+	}
+
+	mFrames.clear();
+	mChunks.clear();
+	QDataStream stream(&mFile);
+	setupStream(stream);
+	stream.writeRawData(MAGIC, sizeof(MAGIC));
+	stream << VERSION;
+	return true;
+}
+
+bool USAcquisitionStreamWriter::isOpen() const
+{
+	return mFile.isOpen();
+}
+
+bool USAcquisitionStreamWriter::close()
+{
+	if (!this->isOpen())
+		return false;
+	bool success = this->writeIndex();
+	mFile.close();
+	return success;
+}
+
+QString USAcquisitionStreamWriter::getFilename() const
+{
+	return mFile.fileName();
+}
+
+unsigned USAcquisitionStreamWriter::getNumberOfFrames() const
+{
+	return mFrames.size();
+}
+
+bool USAcquisitionStreamWriter::writeChunkHeader(quint32 type, quint64 size)
+{
+	QDataStream stream(&mFile);
+	setupStream(stream);
+	stream << type << size;
+	return stream.status() == QDataStream::Ok;
+}
+
+bool USAcquisitionStreamWriter::writeData(const char* data, qint64 size)
+{
+	if (mFile.write(data, size) == size)
+		return true;
+	reportError(QString("Failed to write to %1: %2").arg(mFile.fileName()).arg(mFile.errorString()));
+	return false;
+}
+
+bool USAcquisitionStreamWriter::writeChunk(quint32 type, QByteArray payload)
+{
+	if (!this->isOpen())
+		return false;
+	quint64 offset = mFile.pos();
+	if (!this->writeChunkHeader(type, payload.size()) || !this->writeData(payload.constData(), payload.size()))
+		return false;
+	if ((type != CHUNK_INDEX) && (type != CHUNK_TAIL))
+		mChunks.push_back(std::make_pair(type, offset));
+	return true;
+}
+
+bool USAcquisitionStreamWriter::writeFrame(TimeInfo timestamp, vtkImageDataPtr image)
+{
+	if (!this->isOpen() || !image)
+		return false;
+
+	FrameEntry entry;
+	entry.mOffset = mFile.pos();
+	entry.mTime[0] = timestamp.getAcquisitionTime();
+	entry.mTime[1] = timestamp.getScannerAcquisitionTime();
+	entry.mTime[2] = timestamp.getSoftwareAcquisitionTime();
+
+	const char* raw = static_cast<const char*>(image->GetScalarPointer());
+	qint64 rawSize = getScalarDataSize(image);
+	QByteArray compressed;
+	if (mCompress)
+		compressed = qCompress(reinterpret_cast<const uchar*>(raw), rawSize);
+	quint64 dataSize = mCompress ? compressed.size() : rawSize;
+
+	QByteArray header;
+	QDataStream stream(&header, QIODevice::WriteOnly);
+	setupStream(stream);
+	stream << quint32(mFrames.size());
+	for (int i = 0; i < 3; ++i)
+		stream << entry.mTime[i];
+	for (int i = 0; i < 3; ++i)
+		stream << qint32(image->GetDimensions()[i]);
+	for (int i = 0; i < 3; ++i)
+		stream << image->GetSpacing()[i];
+	for (int i = 0; i < 3; ++i)
+		stream << image->GetOrigin()[i];
+	stream << qint32(image->GetScalarType());
+	stream << qint32(image->GetNumberOfScalarComponents());
+	stream << quint8(mCompress);
+	stream << dataSize;
+	CX_ASSERT(header.size() == FRAME_HEADER_SIZE);
+
+	// a failed frame is not indexed, thus the reader skips it if the rest of the file is ok.
+	if (!this->writeChunkHeader(CHUNK_FRAME, header.size() + dataSize)
+		|| !this->writeData(header.constData(), header.size())
+		|| !this->writeData(mCompress ? compressed.constData() : raw, dataSize))
+		return false;
+
+	mFrames.push_back(entry);
+	return true;
+}
+
+bool USAcquisitionStreamWriter::writeFramePositions(const std::vector<TimedPosition>& positions)
+{
+	return this->writeChunk(CHUNK_FRAME_POSITIONS, positionsToByteArray(positions));
+}
+
+bool USAcquisitionStreamWriter::writeTrackingPositions(const std::vector<TimedPosition>& positions)
+{
+	return this->writeChunk(CHUNK_TRACKING_POSITIONS, positionsToByteArray(positions));
+}
+
+bool USAcquisitionStreamWriter::writeText(QString name, QByteArray content)
+{
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	setupStream(stream);
+	stream << name << content;
+	return this->writeChunk(CHUNK_TEXT, payload);
+}
+
+/** Append the index of all chunks, followed by a fixed size tail chunk
+ *  pointing to the index.
+ */
+bool USAcquisitionStreamWriter::writeIndex()
+{
+	quint64 indexOffset = mFile.pos();
+
+	QByteArray payload;
+	QDataStream stream(&payload, QIODevice::WriteOnly);
+	setupStream(stream);
+	stream << quint32(mFrames.size());
+	for (unsigned i = 0; i < mFrames.size(); ++i)
+		stream << mFrames[i].mOffset << mFrames[i].mTime[0] << mFrames[i].mTime[1] << mFrames[i].mTime[2];
+	stream << quint32(mChunks.size());
+	for (unsigned i = 0; i < mChunks.size(); ++i)
+		stream << mChunks[i].first << mChunks[i].second;
+	if (!this->writeChunk(CHUNK_INDEX, payload))
+		return false;
+
+	QByteArray tail;
+	QDataStream tailStream(&tail, QIODevice::WriteOnly);
+	setupStream(tailStream);
+	tailStream << indexOffset;
+	return this->writeChunk(CHUNK_TAIL, tail);
+}
+
+///--------------------------------------------------------
+///--------------------------------------------------------
+///--------------------------------------------------------
+
+USAcquisitionStreamReader::USAcquisitionStreamReader(QString filename) :
+	mFile(filename),
+	mMutex(QMutex::Recursive),
+	mValid(false)
+{
+	if (!canRead(filename))
+	{
+		reportError("Not an US acquisition file: " + filename);
+		return;
+	}
+	if (!mFile.open(QIODevice::ReadOnly))
+	{
+		reportError("Cannot open " + filename);
+		return;
+	}
+
+	if (!this->readIndex())
+	{
+		reportWarning(QString("No index found in %1, scanning file").arg(filename));
+		mFrames.clear();
+		mFramePositions.clear();
+		mTrackingPositions.clear();
+		mText.clear();
+		this->scan();
+	}
+	mValid = true;
+}
+
+USAcquisitionStreamReader::~USAcquisitionStreamReader()
+{
+}
+
+bool USAcquisitionStreamReader::canRead(QString filename)
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QByteArray magic = file.read(sizeof(MAGIC));
+	return magic == QByteArray(MAGIC, sizeof(MAGIC));
+}
+
+bool USAcquisitionStreamReader::isValid() const
+{
+	return mValid;
+}
+
+QString USAcquisitionStreamReader::getFilename() const
+{
+	return mFile.fileName();
+}
+
+bool USAcquisitionStreamReader::readIndex()
+{
+	qint64 fileSize = mFile.size();
+	if (fileSize < FILE_HEADER_SIZE + TAIL_CHUNK_SIZE)
+		return false;
+
+	mFile.seek(fileSize - TAIL_CHUNK_SIZE);
+	QDataStream stream(&mFile);
+	setupStream(stream);
+	quint32 type;
+	quint64 size;
+	quint64 indexOffset;
+	stream >> type >> size >> indexOffset;
+	if ((type != CHUNK_TAIL) || (size != 8) || (indexOffset >= quint64(fileSize)))
+		return false;
+
+	mFile.seek(indexOffset);
+	stream >> type >> size;
+	if ((type != CHUNK_INDEX) || (indexOffset + CHUNK_HEADER_SIZE + size > quint64(fileSize)))
+		return false;
+
+	// validate the counts before allocating: each frame must fit both in the index and in the file.
+	quint32 numFrames;
+	stream >> numFrames;
+	if ((INDEX_COUNTS_SIZE + quint64(numFrames)*INDEX_FRAME_ENTRY_SIZE > size)
+		|| (quint64(numFrames)*(CHUNK_HEADER_SIZE + FRAME_HEADER_SIZE) > indexOffset))
+	{
+		reportError(QString("Index in %1 lists %2 frames, more than the file can hold").arg(mFile.fileName()).arg(numFrames));
+		return false;
+	}
+	mFrames.resize(numFrames);
+	for (unsigned i = 0; i < numFrames; ++i)
+	{
+		stream >> mFrames[i].mOffset >> mFrames[i].mTime[0] >> mFrames[i].mTime[1] >> mFrames[i].mTime[2];
+		if (mFrames[i].mOffset + CHUNK_HEADER_SIZE + FRAME_HEADER_SIZE > indexOffset)
+		{
+			reportError(QString("Index in %1 points to frame %2 outside the file").arg(mFile.fileName()).arg(i));
+			return false;
+		}
+	}
+	quint32 numChunks;
+	stream >> numChunks;
+	if (INDEX_COUNTS_SIZE + quint64(numFrames)*INDEX_FRAME_ENTRY_SIZE + quint64(numChunks)*INDEX_CHUNK_ENTRY_SIZE > size)
+	{
+		reportError(QString("Index in %1 lists %2 chunks, more than the index can hold").arg(mFile.fileName()).arg(numChunks));
+		return false;
+	}
+	std::vector<std::pair<quint32, quint64> > chunks(numChunks);
+	for (unsigned i = 0; i < numChunks; ++i)
+		stream >> chunks[i].first >> chunks[i].second;
+	if (stream.status() != QDataStream::Ok)
+		return false;
+
+	for (unsigned i = 0; i < chunks.size(); ++i)
+		if (!this->readChunk(chunks[i].first, chunks[i].second))
+			return false;
+	return true;
+}
+
+/** Read all chunks sequentially, used when the index is missing.
+ *  Stops at the first incomplete chunk.
+ */
+bool USAcquisitionStreamReader::scan()
+{
+	qint64 fileSize = mFile.size();
+	qint64 pos = FILE_HEADER_SIZE;
+	QDataStream stream(&mFile);
+	setupStream(stream);
+
+	while (pos + CHUNK_HEADER_SIZE <= fileSize)
+	{
+		mFile.seek(pos);
+		quint32 type;
+		quint64 size;
+		stream >> type >> size;
+		if (pos + CHUNK_HEADER_SIZE + qint64(size) > fileSize)
+			break;
+
+		if (type == CHUNK_FRAME)
+		{
+			FrameEntry entry;
+			if (!this->readFrameHeader(pos, &entry))
+				break;
+			mFrames.push_back(entry);
+		}
+		else if ((type != CHUNK_INDEX) && (type != CHUNK_TAIL))
+		{
+			this->readChunk(type, pos);
+		}
+		pos += CHUNK_HEADER_SIZE + size;
+	}
+	return true;
+}
+
+bool USAcquisitionStreamReader::readFrameHeader(quint64 offset, FrameEntry* entry)
+{
+	mFile.seek(offset + CHUNK_HEADER_SIZE);
+	QDataStream stream(&mFile);
+	setupStream(stream);
+	quint32 index;
+	stream >> index >> entry->mTime[0] >> entry->mTime[1] >> entry->mTime[2];
+	entry->mOffset = offset;
+	return stream.status() == QDataStream::Ok;
+}
+
+bool USAcquisitionStreamReader::readChunk(quint32 type, quint64 offset)
+{
+	mFile.seek(offset);
+	QDataStream stream(&mFile);
+	setupStream(stream);
+	quint32 foundType;
+	quint64 size;
+	stream >> foundType >> size;
+	if (foundType != type)
+		return false;
+	QByteArray payload = mFile.read(size);
+	if (payload.size() != qint64(size))
+		return false;
+
+	if (type == CHUNK_FRAME_POSITIONS)
+	{
+		mFramePositions = this->readPositions(payload);
+	}
+	else if (type == CHUNK_TRACKING_POSITIONS)
+	{
+		mTrackingPositions = this->readPositions(payload);
+	}
+	else if (type == CHUNK_TEXT)
+	{
+		QDataStream textStream(payload);
+		setupStream(textStream);
+		QString name;
+		QByteArray content;
+		textStream >> name >> content;
+		mText[name] = content;
+	}
+	// unknown chunks are ignored, allowing for additions to the format.
+	return true;
+}
+
+std::vector<TimedPosition> USAcquisitionStreamReader::readPositions(QByteArray payload) const
+{
+	QDataStream stream(payload);
+	setupStream(stream);
+	quint32 count;
+	stream >> count;
+
+	std::vector<TimedPosition> retval;
+	for (unsigned i = 0; (i < count) && (stream.status() == QDataStream::Ok); ++i)
+	{
+		TimedPosition current;
+		current.mPos = Transform3D::Identity();
+		stream >> current.mTime;
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 4; ++c)
+				stream >> current.mPos(r, c);
+		current.mTimeInfo.setAcquisitionTime(current.mTime);
+		retval.push_back(current);
+	}
+	return retval;
+}
+
+unsigned USAcquisitionStreamReader::getNumberOfFrames() const
+{
+	return mFrames.size();
+}
+
+vtkImageDataPtr USAcquisitionStreamReader::getFrame(unsigned index)
+{
+	if (index >= mFrames.size())
+		return vtkImageDataPtr();
+
+	QMutexLocker sentry(&mMutex);
+	mFile.seek(mFrames[index].mOffset);
+	QDataStream stream(&mFile);
+	setupStream(stream);
+
+	quint32 chunkType;
+	quint64 chunkSize;
+	stream >> chunkType >> chunkSize;
+	quint32 frameIndex;
+	double time[3];
+	qint32 dims[3];
+	double spacing[3];
+	double origin[3];
+	qint32 scalarType;
+	qint32 components;
+	quint8 compressed;
+	quint64 dataSize;
+	stream >> frameIndex;
+	for (int i = 0; i < 3; ++i)
+		stream >> time[i];
+	for (int i = 0; i < 3; ++i)
+		stream >> dims[i];
+	for (int i = 0; i < 3; ++i)
+		stream >> spacing[i];
+	for (int i = 0; i < 3; ++i)
+		stream >> origin[i];
+	stream >> scalarType >> components >> compressed >> dataSize;
+	if (stream.status() != QDataStream::Ok)
+	{
+		reportError(QString("Failed to read frame %1 from %2").arg(index).arg(mFile.fileName()));
+		return vtkImageDataPtr();
+	}
+
+	// validate the header before allocating: the data must fit in the chunk,
+	// and the chunk in the file.
+	bool valid = (chunkType == CHUNK_FRAME)
+			&& (chunkSize >= quint64(FRAME_HEADER_SIZE))
+			&& (dataSize <= chunkSize - FRAME_HEADER_SIZE)
+			&& (mFrames[index].mOffset + CHUNK_HEADER_SIZE + chunkSize <= quint64(mFile.size()))
+			&& (components >= 1) && (components <= 4);
+	// the size of the decoded frame, limited to what a QByteArray can hold.
+	qint64 expectedSize = valid ? getScalarTypeSize(scalarType) * components : 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if ((dims[i] <= 0) || (expectedSize > std::numeric_limits<int>::max() / dims[i]))
+			expectedSize = 0;
+		expectedSize *= dims[i];
+	}
+	if (!valid || (expectedSize == 0) || (!compressed && (qint64(dataSize) != expectedSize)))
+	{
+		reportError(QString("Corrupt frame header %1 in %2").arg(index).arg(mFile.fileName()));
+		return vtkImageDataPtr();
+	}
+
+	QByteArray data;
+	if (compressed)
+	{
+		// qUncompress allocates the size stored in the first 4 bytes, big endian.
+		data = mFile.read(dataSize);
+		quint32 uncompressedSize = 0;
+		for (int i = 0; (i < 4) && (i < data.size()); ++i)
+			uncompressedSize = (uncompressedSize << 8) | quint8(data[i]);
+		if ((data.size() < 4) || (uncompressedSize != quint64(expectedSize)))
+		{
+			reportError(QString("Corrupt frame %1 in %2").arg(index).arg(mFile.fileName()));
+			return vtkImageDataPtr();
+		}
+	}
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetSpacing(spacing);
+	retval->SetOrigin(origin);
+	retval->SetExtent(0, dims[0]-1, 0, dims[1]-1, 0, dims[2]-1);
+	retval->AllocateScalars(scalarType, components);
+	char* target = static_cast<char*>(retval->GetScalarPointer());
+
+	if (compressed)
+	{
+		data = qUncompress(data);
+		if (data.size() != expectedSize)
+		{
+			reportError(QString("Corrupt frame %1 in %2").arg(index).arg(mFile.fileName()));
+			return vtkImageDataPtr();
+		}
+		memcpy(target, data.constData(), expectedSize);
+	}
+	else
+	{
+		if (mFile.read(target, expectedSize) != expectedSize)
+		{
+			reportError(QString("Corrupt frame %1 in %2").arg(index).arg(mFile.fileName()));
+			return vtkImageDataPtr();
+		}
+	}
+
+	return retval;
+}
+
+std::vector<TimedPosition> USAcquisitionStreamReader::getFrameTimestamps() const
+{
+	std::vector<TimedPosition> retval(mFrames.size());
+	for (unsigned i = 0; i < mFrames.size(); ++i)
+	{
+		retval[i].mTime = mFrames[i].mTime[0];
+		retval[i].mTimeInfo.setAcquisitionTime(mFrames[i].mTime[0]);
+		retval[i].mTimeInfo.mOriginalAcquisitionTime.setMSecsSinceEpoch(mFrames[i].mTime[1]);
+		retval[i].mTimeInfo.mSoftwareAcquisitionTime.setMSecsSinceEpoch(mFrames[i].mTime[2]);
+		retval[i].mPos = Transform3D::Identity();
+	}
+	return retval;
+}
+
+std::vector<TimedPosition> USAcquisitionStreamReader::getFramePositions() const
+{
+	return mFramePositions;
+}
+
+std::vector<TimedPosition> USAcquisitionStreamReader::getTrackingPositions() const
+{
+	return mTrackingPositions;
+}
+
+QByteArray USAcquisitionStreamReader::getText(QString name) const
+{
+	std::map<QString, QByteArray>::const_iterator iter = mText.find(name);
+	if (iter == mText.end())
+		return QByteArray();
+	return iter->second;
+}
+
+///--------------------------------------------------------
+///--------------------------------------------------------
+///--------------------------------------------------------
+
+USAcquisitionStreamContainer::USAcquisitionStreamContainer(USAcquisitionStreamReaderPtr reader) :
+	mReader(reader),
+	mDeleteFileOnRelease(false)
+{
+}
+
+USAcquisitionStreamContainer::~USAcquisitionStreamContainer()
+{
+	if (mDeleteFileOnRelease && mReader)
+	{
+		QString filename = mReader->getFilename();
+		mReader.reset();
+		QDir().remove(filename);
+	}
+}
+
+vtkImageDataPtr USAcquisitionStreamContainer::get(unsigned index)
+{
+	CX_ASSERT(index < this->size());
+	return mReader->getFrame(index);
+}
+
+unsigned USAcquisitionStreamContainer::size() const
+{
+	return mReader->getNumberOfFrames();
+}
+
+} // namespace cx
@@ -0,0 +1,175 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXUSACQUISITIONSTREAMFILE_H_
+#define CXUSACQUISITIONSTREAMFILE_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <map>
+#include <QFile>
+#include <QMutex>
+#include <QByteArray>
+#include "vtkForwardDeclarations.h"
+#include "cxImageDataContainer.h"
+#include "cxUSReconstructInputData.h"
+
+namespace cx
+{
+
+/**
+ * \addtogroup cx_resource_usreconstructiontypes
+ * \{
+ */
+
+typedef boost::shared_ptr<class USAcquisitionStreamWriter> USAcquisitionStreamWriterPtr;
+typedef boost::shared_ptr<class USAcquisitionStreamReader> USAcquisitionStreamReaderPtr;
+
+/** Write an US acquisition to a single, append-only file.
+ *
+ * The file is a sequence of chunks, each starting with a type tag and a size.
+ * Frames are appended one by one as they arrive, the positions and text blocks
+ * are appended when known. close() appends an index of all chunks, enabling
+ * random access to the frames without scanning the file.
+ *
+ * A file where close() was never called (e.g. after a crash) is still readable,
+ * see USAcquisitionStreamReader.
+ *
+ * See \ref us_acq_file_format_cxus for a description of the format.
+ *
+ * Not thread-safe.
+ *
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT USAcquisitionStreamWriter
+{
+public:
+	/**
+	 * \param filename File to write, existing files are overwritten.
+	 * \param compress Compress the frame data using zlib.
+	 */
+	USAcquisitionStreamWriter(QString filename, bool compress);
+	~USAcquisitionStreamWriter();
+
+	bool open();
+	bool isOpen() const;
+	bool close(); ///< write the index and close, false if not open or on write error
+
+	// The write methods return false on write error, or if not open.
+	bool writeFrame(TimeInfo timestamp, vtkImageDataPtr image);
+	/** Write the rMu of each frame, in frame order. */
+	bool writeFramePositions(const std::vector<TimedPosition>& positions);
+	/** Write the tracking prMt with timestamps. */
+	bool writeTrackingPositions(const std::vector<TimedPosition>& positions);
+	/** Write a named block of text, e.g. the probe definition xml. */
+	bool writeText(QString name, QByteArray content);
+
+	unsigned getNumberOfFrames() const;
+	QString getFilename() const;
+
+private:
+	struct FrameEntry
+	{
+		quint64 mOffset;
+		double mTime[3]; ///< acquisition, scanner, software
+	};
+	bool writeChunkHeader(quint32 type, quint64 size);
+	bool writeData(const char* data, qint64 size);
+	bool writeChunk(quint32 type, QByteArray payload);
+	bool writeIndex();
+
+	QFile mFile;
+	bool mCompress;
+	std::vector<FrameEntry> mFrames;
+	std::vector<std::pair<quint32, quint64> > mChunks; ///< (type, offset) of non-frame chunks
+};
+
+/** Read an US acquisition from a file written by USAcquisitionStreamWriter.
+ *
+ * If the file contains an index, only the index, positions and text blocks are
+ * read during construction. Otherwise the chunks are scanned from the start,
+ * ignoring an incomplete chunk at the end.
+ *
+ * The frame data are read on demand using getFrame(). getFrame() is thread-safe.
+ *
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT USAcquisitionStreamReader
+{
+public:
+	explicit USAcquisitionStreamReader(QString filename);
+	~USAcquisitionStreamReader();
+
+	/** Return true if filename has the format read by this class. */
+	static bool canRead(QString filename);
+
+	bool isValid() const;
+	QString getFilename() const;
+
+	unsigned getNumberOfFrames() const;
+	vtkImageDataPtr getFrame(unsigned index);
+	std::vector<TimedPosition> getFrameTimestamps() const; ///< mPos is not set.
+	std::vector<TimedPosition> getFramePositions() const; ///< empty if not written
+	std::vector<TimedPosition> getTrackingPositions() const;
+	QByteArray getText(QString name) const;
+
+private:
+	struct FrameEntry
+	{
+		quint64 mOffset;
+		double mTime[3]; ///< acquisition, scanner, software
+	};
+	bool readIndex();
+	bool scan();
+	bool readChunk(quint32 type, quint64 offset);
+	bool readFrameHeader(quint64 offset, FrameEntry* entry);
+	std::vector<TimedPosition> readPositions(QByteArray payload) const;
+
+	QFile mFile;
+	QMutex mMutex; ///< protects mFile
+	bool mValid;
+	std::vector<FrameEntry> mFrames;
+	std::vector<TimedPosition> mFramePositions;
+	std::vector<TimedPosition> mTrackingPositions;
+	std::map<QString, QByteArray> mText;
+};
+
+/** Container for frames stored in a single acquisition file.
+ *
+ * Frames are read from file on each call to get(), and not kept in memory.
+ *
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT USAcquisitionStreamContainer : public ImageDataContainer
+{
+public:
+	explicit USAcquisitionStreamContainer(USAcquisitionStreamReaderPtr reader);
+	virtual ~USAcquisitionStreamContainer();
+	virtual vtkImageDataPtr get(unsigned index);
+	virtual unsigned size() const;
+	/**
+	* If set, the file will be deleted when object goes out of scope
+	*/
+	void setDeleteFileOnRelease(bool on) { mDeleteFileOnRelease = on; }
+private:
+	USAcquisitionStreamReaderPtr mReader;
+	bool mDeleteFileOnRelease;
+};
+typedef boost::shared_ptr<USAcquisitionStreamContainer> USAcquisitionStreamContainerPtr;
+
+/**
+ * \}
+ */
+
+} // namespace cx
+
+#endif // CXUSACQUISITIONSTREAMFILE_H_
@@ -12,6 +12,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxUSFrameData.h"
 
+#include <algorithm>
 #include <vtkImageData.h>
 #include <vtkImageLuminance.h>
 #include <vtkImageClip.h>
@@ -26,6 +27,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxLogger.h"
 #include "cxFileManagerService.h"
 #include "cxImage.h"
+#include "cxUSAcquisitionStreamFile.h"
 
 
 typedef vtkSmartPointer<vtkImageAppend> vtkImageAppendPtr;
@@ -99,6 +101,16 @@ vtkImageDataPtr ProcessedUSInputData::getMask()
 	return mMask;
 }
 
+USFramePlaneIndexPtr ProcessedUSInputData::getPlaneIndex() const
+{
+	return mPlaneIndex;
+}
+
+void ProcessedUSInputData::setPlaneIndex(USFramePlaneIndexPtr index)
+{
+	mPlaneIndex = index;
+}
+
 QString ProcessedUSInputData::getFilePath()
 {
 	return mPath;
@@ -126,9 +138,11 @@ USFrameDataPtr USFrameData::create(ImagePtr inputFrameData)
 }
 
 /** Create object from file.
+  * If the input is a single acquisition file (.cxus), read frames from it.
   * If file or file+.mhd exists, use this,
   * Otherwise assume input is split over several
   * files and try to load all mhdFile + i + ".mhd".
+  * Uncompressed frames are memory-mapped, not loaded.
   * forall i.
   */
 USFrameDataPtr USFrameData::create(QString inputFilename, FileManagerServicePtr fileManager)
@@ -136,6 +150,13 @@ USFrameDataPtr USFrameData::create(QString inputFilename, FileManagerServicePtr
 	QFileInfo info(inputFilename);
 
 	TimeKeeper timer;
+
+	if (USAcquisitionStreamReader::canRead(inputFilename))
+	{
+		USAcquisitionStreamReaderPtr reader(new USAcquisitionStreamReader(inputFilename));
+		return USFrameData::create(info.completeBaseName(), ImageDataContainerPtr(new USAcquisitionStreamContainer(reader)));
+	}
+
 	QString mhdSingleFile = info.absolutePath()+"/"+info.completeBaseName()+".mhd";
 
 	if (QFileInfo(mhdSingleFile).exists())
@@ -151,7 +172,7 @@ USFrameDataPtr USFrameData::create(QString inputFilename, FileManagerServicePtr
 	{
 		USFrameDataPtr retval(new USFrameData());
 		retval->mName = QFileInfo(inputFilename).completeBaseName();
-		retval->mImageContainer.reset(new cx::CachedImageDataContainer(inputFilename, -1, fileManager));
+		retval->mImageContainer.reset(new cx::MappedImageDataContainer(inputFilename, fileManager));
 		retval->resetRemovedFrames();
 		return retval;
 	}
@@ -291,6 +312,52 @@ vtkImageDataPtr USFrameData::to8bitGrayscaleAndEffectuateCropping(vtkImageDataPt
 	return copy;
 }
 
+/** Fast path for input that already is 8 bit grayscale:
+ * Return the input without copying if the crop does not remove anything,
+ * otherwise copy the cropped region in one pass.
+ * The input data are never modified.
+ * Return NULL for other input types.
+ */
+vtkImageDataPtr USFrameData::cropGrayscale8bit(vtkImageDataPtr input) const
+{
+	if ((input->GetNumberOfScalarComponents() != 1) || (input->GetScalarType() != VTK_UNSIGNED_CHAR))
+		return vtkImageDataPtr();
+
+	IntBoundingBox3D extent(input->GetExtent());
+	IntBoundingBox3D crop = extent;
+	if (mCropbox.range()[0]!=0)
+	{
+		for (int i=0; i<2; ++i)
+		{
+			crop[2*i] = std::max(extent[2*i], mCropbox[2*i]);
+			crop[2*i+1] = std::min(extent[2*i+1], mCropbox[2*i+1]);
+		}
+	}
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	if (crop == extent)
+	{
+		retval->ShallowCopy(input);
+		return retval;
+	}
+
+	retval->SetSpacing(input->GetSpacing());
+	retval->SetOrigin(input->GetOrigin());
+	retval->SetExtent(crop.begin());
+	retval->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+	int rowLength = crop[1]-crop[0]+1;
+	for (int z=crop[4]; z<=crop[5]; ++z)
+	{
+		for (int y=crop[2]; y<=crop[3]; ++y)
+		{
+			unsigned char* source = static_cast<unsigned char*>(input->GetScalarPointer(crop[0], y, z));
+			unsigned char* target = static_cast<unsigned char*>(retval->GetScalarPointer(crop[0], y, z));
+			std::copy(source, source+rowLength, target);
+		}
+	}
+	return retval;
+}
+
 vtkImageDataPtr USFrameData::convertTo8bit(vtkImageDataPtr input) const
 {
 	vtkImageDataPtr retval = input;
@@ -435,11 +502,14 @@ std::vector<std::vector<vtkImageDataPtr> > USFrameData::initializeFrames(std::ve
 		CX_ASSERT(mImageContainer->size() > mReducedToFull[i]);
 		vtkImageDataPtr current = mImageContainer->get(mReducedToFull[i]);
 
-		if (mCropbox.range()[0]!=0)
-			current = this->cropImageExtent(current, mCropbox);
-
 		// optimization: grayFrame is used in both calculations: compute once
-		vtkImageDataPtr grayFrame = this->to8bitGrayscaleAndEffectuateCropping(current);
+		vtkImageDataPtr grayFrame = this->cropGrayscale8bit(current);
+		if (!grayFrame)
+		{
+			if (mCropbox.range()[0]!=0)
+				current = this->cropImageExtent(current, mCropbox);
+			grayFrame = this->to8bitGrayscaleAndEffectuateCropping(current);
+		}
 
 		for (unsigned j=0; j<angio.size(); ++j)
 		{
@@ -23,6 +23,7 @@ namespace cx
 {
 typedef boost::shared_ptr<class ImageDataContainer> ImageDataContainerPtr;
 typedef boost::shared_ptr<class CachedImageDataContainer> CachedImageDataContainerPtr;
+typedef boost::shared_ptr<class USFramePlaneIndex> USFramePlaneIndexPtr;
 }
 
 namespace cx
@@ -51,6 +52,10 @@ public:
 	Vector3D getSpacing() const;
 	std::vector<TimedPosition> getFrames() const;
 	vtkImageDataPtr getMask();
+	/** Spatial index of the frames in output space. Can be zero.
+	  */
+	USFramePlaneIndexPtr getPlaneIndex() const;
+	void setPlaneIndex(USFramePlaneIndexPtr index);
 
 	QString getFilePath();
 	QString getUid();
@@ -60,6 +65,7 @@ private:
 	std::vector<vtkImageDataPtr> mProcessedImage;
 	std::vector<TimedPosition> mFrames;
 	vtkImageDataPtr mMask;///< Clipping mask for the input data
+	USFramePlaneIndexPtr mPlaneIndex;
 	QString mPath;
 	QString mUid;
 };
@@ -123,6 +129,7 @@ protected:
 
 	vtkImageDataPtr cropImageExtent(vtkImageDataPtr input, IntBoundingBox3D cropbox) const;
 	vtkImageDataPtr to8bitGrayscaleAndEffectuateCropping(vtkImageDataPtr input) const;
+	vtkImageDataPtr cropGrayscale8bit(vtkImageDataPtr input) const;
 
 	std::vector<int> mReducedToFull; ///< map from indexes in the reduced volume to the full (original) volume.
 	IntBoundingBox3D mCropbox;
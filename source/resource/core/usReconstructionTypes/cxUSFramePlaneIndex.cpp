@@ -0,0 +1,161 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "cxUSFramePlaneIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cx
+{
+
+namespace
+{
+/** Upper limit on the total number of cells. */
+const int MAX_CELLS = 1 << 18;
+
+bool boxesIntersect(const DoubleBoundingBox3D& a, const DoubleBoundingBox3D& b)
+{
+	for (int i = 0; i < 3; ++i)
+		if ((a[2*i+1] < b[2*i]) || (b[2*i+1] < a[2*i]))
+			return false;
+	return true;
+}
+} // namespace
+
+USFramePlaneIndex::USFramePlaneIndex(const std::vector<Vector3D>& frameRect, const std::vector<Transform3D>& dMu, double cellSize) :
+	mCellSize(cellSize),
+	mDim(0,0,0)
+{
+	if (dMu.empty() || frameRect.empty())
+		return;
+
+	// find bounds and plane equations for each frame
+	for (unsigned i = 0; i < dMu.size(); ++i)
+	{
+		std::vector<Vector3D> corners;
+		for (unsigned j = 0; j < frameRect.size(); ++j)
+			corners.push_back(dMu[i].coord(frameRect[j]));
+		mFrameBounds.push_back(DoubleBoundingBox3D::fromCloud(corners));
+
+		Vector3D n = dMu[i].vector(Vector3D(0,0,1)).normalized();
+		mNormals.push_back(n);
+		mOffsets.push_back(-n.dot(dMu[i].translation()));
+
+		mBounds = (i==0) ? mFrameBounds.back() : mBounds.unionWith(mFrameBounds.back());
+	}
+
+	Vector3D range = mBounds.range();
+	mCellSize = std::max(mCellSize, std::pow(range[0]*range[1]*range[2]/MAX_CELLS, 1.0/3.0));
+	if (mCellSize <= 0)
+		mCellSize = 1;
+	for (int i = 0; i < 3; ++i)
+		mDim[i] = std::max(1, static_cast<int>(std::ceil(range[i]/mCellSize)));
+
+	// Frames are visited in increasing order, thus each cell gets a sorted list.
+	// Consecutive frames are merged into runs, as neighbouring frames in a sweep
+	// usually pass through the same cells.
+	std::vector<std::vector<Run> > cells(mDim.prod());
+	for (unsigned frame = 0; frame < mFrameBounds.size(); ++frame)
+	{
+		Eigen::Array3i lo, hi;
+		if (!this->findCellRange(mFrameBounds[frame], &lo, &hi))
+			continue;
+		for (int z = lo[2]; z <= hi[2]; ++z)
+			for (int y = lo[1]; y <= hi[1]; ++y)
+				for (int x = lo[0]; x <= hi[0]; ++x)
+				{
+					if (!this->planeIntersects(frame, this->getCellBox(x, y, z)))
+						continue;
+					std::vector<Run>& runs = cells[this->getCellIndex(x, y, z)];
+					if (!runs.empty() && (runs.back().second == static_cast<int>(frame)))
+						runs.back().second++;
+					else
+						runs.push_back(Run(frame, frame+1));
+				}
+	}
+
+	mCellStart.assign(cells.size()+1, 0);
+	for (unsigned c = 0; c < cells.size(); ++c)
+	{
+		mCellStart[c+1] = mCellStart[c] + cells[c].size();
+		mCellRuns.insert(mCellRuns.end(), cells[c].begin(), cells[c].end());
+	}
+}
+
+int USFramePlaneIndex::getNumberOfFrames() const
+{
+	return mFrameBounds.size();
+}
+
+/** Separating axis test between the plane of frame and box.
+ */
+bool USFramePlaneIndex::planeIntersects(int frame, const DoubleBoundingBox3D& box) const
+{
+	const Vector3D& n = mNormals[frame];
+	Vector3D halfRange = box.range()/2;
+	double r = std::fabs(n[0])*halfRange[0] + std::fabs(n[1])*halfRange[1] + std::fabs(n[2])*halfRange[2];
+	double dist = n.dot(box.center()) + mOffsets[frame];
+	return std::fabs(dist) <= r;
+}
+
+bool USFramePlaneIndex::findCellRange(const DoubleBoundingBox3D& box, Eigen::Array3i* lo, Eigen::Array3i* hi) const
+{
+	if (!boxesIntersect(box, mBounds))
+		return false;
+	for (int i = 0; i < 3; ++i)
+	{
+		(*lo)[i] = static_cast<int>(std::floor((box[2*i] - mBounds[2*i])/mCellSize));
+		(*hi)[i] = static_cast<int>(std::floor((box[2*i+1] - mBounds[2*i])/mCellSize));
+		(*lo)[i] = std::min(std::max((*lo)[i], 0), mDim[i]-1);
+		(*hi)[i] = std::min(std::max((*hi)[i], 0), mDim[i]-1);
+	}
+	return true;
+}
+
+DoubleBoundingBox3D USFramePlaneIndex::getCellBox(int x, int y, int z) const
+{
+	Vector3D lo = mBounds.bottomLeft() + Vector3D(x, y, z)*mCellSize;
+	return DoubleBoundingBox3D(lo, lo + Vector3D::Ones()*mCellSize);
+}
+
+void USFramePlaneIndex::getFramesIntersecting(const DoubleBoundingBox3D& box, std::vector<int>* retval) const
+{
+	retval->clear();
+
+	Eigen::Array3i lo, hi;
+	if (mCellStart.empty() || !this->findCellRange(box, &lo, &hi))
+		return;
+
+	// gather the runs from all cells and merge the overlapping ones
+	std::vector<Run> runs;
+	for (int z = lo[2]; z <= hi[2]; ++z)
+		for (int y = lo[1]; y <= hi[1]; ++y)
+			for (int x = lo[0]; x <= hi[0]; ++x)
+			{
+				int cell = this->getCellIndex(x, y, z);
+				runs.insert(runs.end(), mCellRuns.begin() + mCellStart[cell], mCellRuns.begin() + mCellStart[cell+1]);
+			}
+	std::sort(runs.begin(), runs.end());
+
+	int next = 0; // first frame not yet examined
+	for (unsigned i = 0; i < runs.size(); ++i)
+	{
+		for (int frame = std::max(next, runs[i].first); frame < runs[i].second; ++frame)
+		{
+			if (boxesIntersect(box, mFrameBounds[frame]) && this->planeIntersects(frame, box))
+				retval->push_back(frame);
+		}
+		next = std::max(next, runs[i].second);
+	}
+}
+
+} // namespace cx
@@ -0,0 +1,93 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#ifndef CXUSFRAMEPLANEINDEX_H_
+#define CXUSFRAMEPLANEINDEX_H_
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <utility>
+#include <boost/shared_ptr.hpp>
+#include "cxBoundingBox3D.h"
+#include "cxTransform3D.h"
+
+namespace cx
+{
+
+/**
+ * \addtogroup cx_resource_usreconstructiontypes
+ * \{
+ */
+
+typedef boost::shared_ptr<class USFramePlaneIndex> USFramePlaneIndexPtr;
+
+/** Spatial lookup of the US frames passing close to a region of the output volume.
+ *
+ * The space covered by the frames is divided into a uniform grid of cells.
+ * Each cell holds the indices of all frames whose plane intersects the cell, stored as
+ * runs of consecutive indices. A query thus costs in proportion to the local frame
+ * density, not the total number of frames in the sweep.
+ *
+ * Only the part of each frame inside the given frame rectangle (typically the bounding
+ * box of the probe mask) is indexed. Queries may return frames that do not intersect
+ * the query box, but never miss a frame that does.
+ *
+ * Interface is thread-safe after construction.
+ *
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT USFramePlaneIndex
+{
+public:
+	/**
+	 * \param frameRect The 4 corners of the valid area of the frames, in frame space (mm).
+	 * \param dMu Transform from frame space to output space, one per frame.
+	 * \param cellSize Preferred side length of the grid cells (mm). Increased if the grid gets too large.
+	 */
+	USFramePlaneIndex(const std::vector<Vector3D>& frameRect, const std::vector<Transform3D>& dMu, double cellSize);
+
+	/** Set retval to the sorted indices of all frames that might intersect box.
+	 */
+	void getFramesIntersecting(const DoubleBoundingBox3D& box, std::vector<int>* retval) const;
+
+	int getNumberOfFrames() const;
+	double getCellSize() const { return mCellSize; }
+	Eigen::Array3i getGridDimensions() const { return mDim; }
+	DoubleBoundingBox3D getBounds() const { return mBounds; }
+
+private:
+	bool planeIntersects(int frame, const DoubleBoundingBox3D& box) const;
+	bool findCellRange(const DoubleBoundingBox3D& box, Eigen::Array3i* lo, Eigen::Array3i* hi) const;
+	DoubleBoundingBox3D getCellBox(int x, int y, int z) const;
+	int getCellIndex(int x, int y, int z) const { return x + y*mDim[0] + z*mDim[0]*mDim[1]; }
+
+	DoubleBoundingBox3D mBounds;
+	double mCellSize;
+	Eigen::Array3i mDim;
+
+	std::vector<DoubleBoundingBox3D> mFrameBounds;
+	std::vector<Vector3D> mNormals;
+	std::vector<double> mOffsets; ///< plane equation n*p+w=0, w for each frame
+
+	typedef std::pair<int,int> Run; ///< frames [first, second>
+	// compressed cell lists: frame runs in cell i are mCellRuns[mCellStart[i]..mCellStart[i+1]>
+	std::vector<int> mCellStart;
+	std::vector<Run> mCellRuns;
+};
+
+/**
+ * \}
+ */
+
+} // namespace cx
+
+#endif // CXUSFRAMEPLANEINDEX_H_
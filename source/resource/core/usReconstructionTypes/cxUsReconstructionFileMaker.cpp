@@ -30,6 +30,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxUSReconstructInputDataAlgoritms.h"
 #include "cxCustomMetaImage.h"
 #include "cxErrorObserver.h"
+#include "cxUSAcquisitionStreamFile.h"
 
 
 typedef vtkSmartPointer<vtkImageAppend> vtkImageAppendPtr;
@@ -37,8 +38,23 @@ typedef vtkSmartPointer<vtkImageAppend> vtkImageAppendPtr;
 namespace cx
 {
 
+namespace
+{
+QString metadataToString(const std::map<double, ToolPositionMetadata>& ts)
+{
+	QString retval;
+	QTextStream stream(&retval);
+	for (std::map<double, ToolPositionMetadata>::const_iterator i=ts.begin(); i!=ts.end(); ++i)
+	{
+		stream << i->second.toString() << endl;
+	}
+	return retval;
+}
+}
+
 UsReconstructionFileMaker::UsReconstructionFileMaker(QString sessionDescription) :
-    mSessionDescription(sessionDescription)
+    mSessionDescription(sessionDescription),
+    mWriteSingleFile(false)
 {
 }
 
@@ -210,11 +226,7 @@ bool UsReconstructionFileMaker::writeMetadata(QString filename, const std::map<d
 		return success;
 	}
 	QTextStream stream(&file);
-
-	for (std::map<double, ToolPositionMetadata>::const_iterator i=ts.begin(); i!=ts.end(); ++i)
-	{
-		stream << i->second.toString() << endl;
-	}
+	stream << metadataToString(ts);
 	file.close();
 	success = true;
 
@@ -356,6 +368,45 @@ void UsReconstructionFileMaker::writeUSImages(QString path, ImageDataContainerPt
 	}
 }
 
+/**
+ * Write all data required for reconstruction into one file, see USAcquisitionStreamWriter.
+ * The probe definition and tool metadata are stored as text blocks in the same format as
+ * the separate files.
+ */
+bool UsReconstructionFileMaker::writeSingleFile(QString path, QString session, ImageDataContainerPtr images, bool compression)
+{
+	CX_ASSERT(images->size()==mReconstructData.mFrames.size());
+	QString filename = path+"/"+session+".cxus";
+	USAcquisitionStreamWriter writer(filename, compression);
+	if (!writer.open())
+		return false;
+
+	bool success = true;
+	for (unsigned i=0; success && (i<images->size()); ++i)
+		success = writer.writeFrame(mReconstructData.mFrames[i].mTimeInfo, images->get(i));
+
+	success = success && writer.writeFramePositions(mReconstructData.mFrames);
+	success = success && writer.writeTrackingPositions(mReconstructData.mPositions);
+
+	XmlOptionFile probeFile;
+	mReconstructData.mProbeDefinition.mData.addXml(probeFile.getElement("configuration"));
+	probeFile.getElement("tool").toElement().setAttribute("toolID", mReconstructData.mProbeUid);
+	success = success && writer.writeText("probedata.xml", probeFile.getDocument().toByteArray(4));
+	success = success && writer.writeText("probe.toolmeta", metadataToString(mReconstructData.mTrackerRecordedMetadata).toUtf8());
+	success = success && writer.writeText("ref.toolmeta", metadataToString(mReconstructData.mReferenceRecordedMetadata).toUtf8());
+	success = writer.close() && success;
+	if (!success)
+		return false;
+
+	QFileInfo info(filename);
+	mReport << QString("%1, %2 bytes, %3 frames, %4 tracking positions.")
+			   .arg(info.fileName())
+			   .arg(info.size())
+			   .arg(writer.getNumberOfFrames())
+			   .arg(mReconstructData.mPositions.size());
+	return true;
+}
+
 void UsReconstructionFileMaker::writeMask(QString path, QString session, vtkImageDataPtr mask)
 {
 	QString filename = QString("%1/%2.mask.mhd").arg(path).arg(session);
@@ -401,6 +452,21 @@ QString UsReconstructionFileMaker::writeToNewFolder(QString path, bool compressi
 	mReport.clear();
 	mReport << "Made reconstruction folder: " + path;
 	QString session = mSessionDescription;
+	ImageDataContainerPtr imageData = mReconstructData.mUsRaw->getImageContainer();
+
+	if (mWriteSingleFile)
+	{
+		mReconstructData.mFilename = path+"/"+mSessionDescription+".cxus";
+		if (!imageData || !this->writeSingleFile(path, session, imageData, compression))
+			mReport << "failed to write single file, save failed.";
+
+		int time = std::max(1, timer.getElapsedms());
+		int frames = imageData ? imageData->size() : 0;
+		mReport << QString("Completed save to %1. Spent %2s, %3fps").arg(mSessionDescription).arg(time/1000).arg(frames*1000/time);
+		this->report();
+		mReport.clear();
+		return mReconstructData.mFilename;
+	}
 
 	this->writeTrackerMetadata(path, session, mReconstructData.mTrackerRecordedMetadata);
 	this->writeReferenceMetadata(path, session, mReconstructData.mReferenceRecordedMetadata);
@@ -412,7 +478,6 @@ QString UsReconstructionFileMaker::writeToNewFolder(QString path, bool compressi
 	this->writeMask(path, session, mReconstructData.getMask());
 	this->writeREADMEFile(path, session);
 
-	ImageDataContainerPtr imageData = mReconstructData.mUsRaw->getImageContainer();
 	if (imageData)
 		this->writeUSImages(path, imageData, compression, mReconstructData.mFrames);
 	else
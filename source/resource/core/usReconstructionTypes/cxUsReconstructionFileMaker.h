@@ -62,6 +62,11 @@ public:
 
 	QString getSessionName() const { return mSessionDescription; }
 
+	/** If set, writeToNewFolder() writes all frames, timestamps and positions
+	 *  into a single file \<session\>.cxus, instead of one file per frame.
+	 */
+	void setWriteSingleFile(bool on) { mWriteSingleFile = on; }
+
 
 	/**
 	 * If writeColor set to true, colors will be saved even if settings is set to 8 bit
@@ -94,6 +99,7 @@ private:
 	bool writeTrackerTimestamps(QString reconstructionFolder, QString session, std::vector<TimedPosition> ts);
 	void writeProbeConfiguration(QString reconstructionFolder, QString session, ProbeDefinition data, QString uid);
 	void writeUSImages(QString path, ImageDataContainerPtr images, bool compression, std::vector<TimedPosition> pos);
+	bool writeSingleFile(QString path, QString session, ImageDataContainerPtr images, bool compression);
 	void writeMask(QString path, QString session, vtkImageDataPtr mask);
 	void writeREADMEFile(QString reconstructionFolder, QString session);
 	bool writeTimestamps(QString filename, std::vector<TimedPosition> ts, QString type, TimeStampType timeStampType = Modified);
@@ -106,6 +112,7 @@ private:
 	USReconstructInputData mReconstructData;
 	QString mSessionDescription;
 	QStringList mReport;
+	bool mWriteSingleFile;
 };
 
 typedef boost::shared_ptr<UsReconstructionFileMaker> UsReconstructionFileMakerPtr;
@@ -14,6 +14,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QFileInfo>
 #include <QStringList>
 #include <QDataStream>
+#include <QDomDocument>
 #include "cxLogger.h"
 #include "cxTypeConversions.h"
 #include <vtkImageData.h>
@@ -22,6 +23,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxCreateProbeDefinitionFromConfiguration.h"
 #include "cxVolumeHelpers.h"
 #include "cxUSFrameData.h"
+#include "cxUSAcquisitionStreamFile.h"
 
 namespace cx
 {
@@ -49,35 +51,29 @@ USReconstructInputData UsReconstructionFileReader::readAllFiles(QString fileName
 
   retval.mFilename = fileName;
 
-  if (!QFileInfo(changeExtension(fileName, "fts")).exists())
+  if (isSingleFile(fileName))
   {
-    // There may not be any files here due to the automatic calling of the function
-    reportWarning("File not found: "+changeExtension(fileName, "fts")+", reconstruct load failed");
-    return retval;
+    if (!this->readSingleFile(fileName, &retval))
+      return USReconstructInputData();
   }
+  else
+  {
+    if (!QFileInfo(changeExtension(fileName, "fts")).exists())
+    {
+      // There may not be any files here due to the automatic calling of the function
+      reportWarning("File not found: "+changeExtension(fileName, "fts")+", reconstruct load failed");
+      return retval;
+    }
 
-  //Read US images
-  retval.mUsRaw = this->readUsDataFile(fileName);
+    //Read US images
+    retval.mUsRaw = this->readUsDataFile(fileName);
 
-  std::pair<QString, ProbeDefinition>  probeDefinitionFull = this->readProbeDefinitionBackwardsCompatible(changeExtension(fileName, "mhd"), calFilesPath);
-  ProbeDefinition  probeDefinition = probeDefinitionFull.second;
-  // override spacing with spacing from image file. This is because the raw spacing from probe calib might have been changed by changing the sound speed.
-    bool spacingOK = similar(probeDefinition.getSpacing()[0], retval.mUsRaw->getSpacing()[0], 0.001)
-                                && similar(probeDefinition.getSpacing()[1], retval.mUsRaw->getSpacing()[1], 0.001);
-  if (!spacingOK)
-  {
-      reportWarning(""
-    	  "Mismatch in spacing values from calibration and recorded image.\n"
-    	  "This might be valid if the sound speed was changed prior to recording.\n"
-                "Probe definition: "+ qstring_cast(probeDefinition.getSpacing()) + ", Acquired Image: " + qstring_cast(retval.mUsRaw->getSpacing())
-    	  );
-  }
-    probeDefinition.setSpacing(Vector3D(retval.mUsRaw->getSpacing()));
-  retval.mProbeDefinition.setData(probeDefinition);
-  retval.mProbeUid = probeDefinitionFull.first;
+    std::pair<QString, ProbeDefinition>  probeDefinitionFull = this->readProbeDefinitionBackwardsCompatible(changeExtension(fileName, "mhd"), calFilesPath);
+    this->setProbeDefinition(&retval, probeDefinitionFull);
 
-  retval.mFrames = this->readFrameTimestamps(fileName);
-  retval.mPositions = this->readPositions(fileName);
+    retval.mFrames = this->readFrameTimestamps(fileName);
+    retval.mPositions = this->readPositions(fileName);
+  }
 
 	if (!this->valid(retval))
 	{
@@ -94,6 +90,49 @@ USReconstructInputData UsReconstructionFileReader::readAllFiles(QString fileName
   return retval;
 }
 
+bool UsReconstructionFileReader::isSingleFile(QString fileName)
+{
+	return QFileInfo(fileName).suffix() == "cxus";
+}
+
+/** Read all data from a single acquisition file. The frames are read on demand.
+ */
+bool UsReconstructionFileReader::readSingleFile(QString fileName, USReconstructInputData* data)
+{
+	USAcquisitionStreamReaderPtr reader(new USAcquisitionStreamReader(fileName));
+	if (!reader->isValid() || !reader->getNumberOfFrames())
+	{
+		reportWarning("No frames found in "+fileName+", reconstruct load failed");
+		return false;
+	}
+
+	ImageDataContainerPtr images(new USAcquisitionStreamContainer(reader));
+	data->mUsRaw = USFrameData::create(QFileInfo(fileName).completeBaseName(), images);
+	this->setProbeDefinition(data, readProbeDefinitionFromXml(reader->getText("probedata.xml")));
+	data->mFrames = reader->getFrameTimestamps();
+	data->mPositions = reader->getTrackingPositions();
+	return true;
+}
+
+void UsReconstructionFileReader::setProbeDefinition(USReconstructInputData* data, std::pair<QString, ProbeDefinition> probeDefinitionFull)
+{
+  ProbeDefinition  probeDefinition = probeDefinitionFull.second;
+  // override spacing with spacing from image file. This is because the raw spacing from probe calib might have been changed by changing the sound speed.
+    bool spacingOK = similar(probeDefinition.getSpacing()[0], data->mUsRaw->getSpacing()[0], 0.001)
+                                && similar(probeDefinition.getSpacing()[1], data->mUsRaw->getSpacing()[1], 0.001);
+  if (!spacingOK)
+  {
+      reportWarning(""
+    	  "Mismatch in spacing values from calibration and recorded image.\n"
+    	  "This might be valid if the sound speed was changed prior to recording.\n"
+                "Probe definition: "+ qstring_cast(probeDefinition.getSpacing()) + ", Acquired Image: " + qstring_cast(data->mUsRaw->getSpacing())
+    	  );
+  }
+    probeDefinition.setSpacing(Vector3D(data->mUsRaw->getSpacing()));
+  data->mProbeDefinition.setData(probeDefinition);
+  data->mProbeUid = probeDefinitionFull.first;
+}
+
 bool UsReconstructionFileReader::valid(USReconstructInputData input)
 {
 	if (input.mUsRaw->getNumImages() != input.mFrames.size())
@@ -222,6 +261,23 @@ std::pair<QString, ProbeDefinition> UsReconstructionFileReader::readProbeDefinit
 	return retval;
 }
 
+std::pair<QString, ProbeDefinition> UsReconstructionFileReader::readProbeDefinitionFromXml(QByteArray xml)
+{
+	std::pair<QString, ProbeDefinition>  retval;
+	QDomDocument doc;
+	if (!doc.setContent(xml))
+	{
+		reportWarning("Failed to parse probe data.");
+		return retval;
+	}
+
+	QDomElement root = doc.documentElement();
+	retval.second.parseXml(root.firstChildElement("configuration"));
+	retval.first = root.firstChildElement("tool").attribute("toolID");
+
+	return retval;
+}
+
 USFrameDataPtr UsReconstructionFileReader::readUsDataFile(QString mhdFileName)
 {
 	return USFrameData::create(mhdFileName, mFileManagerService);
@@ -229,6 +285,9 @@ USFrameDataPtr UsReconstructionFileReader::readUsDataFile(QString mhdFileName)
 
 std::vector<TimedPosition> UsReconstructionFileReader::readFrameTimestamps(QString fileName)
 {
+  if (isSingleFile(fileName))
+    return USAcquisitionStreamReader(fileName).getFrameTimestamps();
+
   bool useOldFormat = !QFileInfo(changeExtension(fileName, "fts")).exists();
   std::vector<TimedPosition> retval;
 
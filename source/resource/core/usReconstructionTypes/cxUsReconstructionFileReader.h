@@ -116,6 +116,12 @@ ProbeCalibration = <not used>
  * numbers is whitespace-separated with newline between rows. Thus the number of
  * lines in this file is (# tracking positions) x 3.
  *
+ * \subsection us_acq_file_format_cxus \<filebase\>.cxus
+ *
+ * A single file containing all of the above, replacing the separate files.
+ * See USAcquisitionStreamWriter and the user documentation for the layout.
+ * When reading this format, the file name must have the .cxus suffix.
+ *
  * \subsection us_acq_file_format_mask \<filebase\>.mask.mhd
  *
  * This file contains the image mask. The binary image shows what parts
@@ -145,9 +151,19 @@ public:
 	  * named \<mhdfilename-base\>.probedata.xml
 	  */
 	static std::pair<QString, ProbeDefinition>  readProbeDefinitionFromFile(QString mhdFileName);
+	/**
+	  * Read probe data from the contents of a probedata.xml file.
+	  */
+	static std::pair<QString, ProbeDefinition>  readProbeDefinitionFromXml(QByteArray xml);
+	/**
+	  * Return true if fileName is an acquisition stored as a single file.
+	  */
+	static bool isSingleFile(QString fileName);
 
 private:
 	bool valid(USReconstructInputData input);
+	bool readSingleFile(QString fileName, USReconstructInputData* data);
+	void setProbeDefinition(USReconstructInputData* data, std::pair<QString, ProbeDefinition> probeDefinitionFull);
 	std::vector<TimedPosition> readPositions(QString fileName);
 	bool readMaskFile(QString mhdFileName, ImagePtr mask);
 	USFrameDataPtr readUsDataFile(QString mhdFileName);
@@ -79,3 +79,17 @@ TEST_CASE_METHOD(cxtest::USReconstructionFileFixture, "USReconstructionFile: Sav
 	this->assertCorrespondence(input, hasBeenRead);
 	cx::LogicManager::shutdown();
 }
+
+TEST_CASE_METHOD(cxtest::USReconstructionFileFixture, "USReconstructionFile: Save and load USReconstructInputData as single file", "[integration][resource][usReconstructionTypes]")
+{
+	cx::LogicManager::initialize();
+	cx::FileManagerServicePtr filemanager = cx::FileManagerServiceProxy::create(cx::logicManager()->getPluginContext());
+	ReconstructionData input = this->createSampleReconstructData();
+
+	QString filename = this->write(input, true);
+	cx::USReconstructInputData hasBeenRead = this->read(filename, filemanager);
+
+	CHECK(filename.endsWith(".cxus"));
+	this->assertCorrespondence(input, hasBeenRead);
+	cx::LogicManager::shutdown();
+}
@@ -0,0 +1,222 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <vtkImageData.h>
+#include "cxUSAcquisitionStreamFile.h"
+#include "cxVolumeHelpers.h"
+#include "cxDataLocations.h"
+#include "cxTypeConversions.h"
+#include "cxTransform3D.h"
+
+namespace cxtest
+{
+
+namespace
+{
+QString getStreamFilename()
+{
+	QString path = cx::DataLocations::getTestDataPath() + "/temp/USAcquisitionStreamFile";
+	QDir().mkpath(path);
+	return path + "/test.cxus";
+}
+
+vtkImageDataPtr createFrame(unsigned index)
+{
+	vtkImageDataPtr retval = cx::generateVtkImageData(Eigen::Array3i(20, 10, 1), cx::Vector3D(0.5, 0.25, 1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(retval->GetScalarPointer());
+	for (int i = 0; i < 20*10; ++i)
+		ptr[i] = (i + index) % 256;
+	return retval;
+}
+
+std::vector<cx::TimedPosition> createPositions(unsigned count)
+{
+	std::vector<cx::TimedPosition> retval;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		cx::TimedPosition pos;
+		pos.mTime = 1000 + 10*i;
+		pos.mPos = cx::createTransformTranslate(cx::Vector3D(i, 2*i, 3));
+		retval.push_back(pos);
+	}
+	return retval;
+}
+
+void writeStreamFile(QString filename, unsigned frameCount, bool compress)
+{
+	cx::USAcquisitionStreamWriter writer(filename, compress);
+	REQUIRE(writer.open());
+	for (unsigned i = 0; i < frameCount; ++i)
+		CHECK(writer.writeFrame(cx::TimeInfo(100 + 20*i), createFrame(i)));
+	CHECK(writer.writeFramePositions(createPositions(frameCount)));
+	CHECK(writer.writeTrackingPositions(createPositions(2*frameCount)));
+	CHECK(writer.writeText("probedata.xml", "<root/>"));
+	CHECK(writer.close());
+	CHECK(writer.getNumberOfFrames() == frameCount);
+}
+
+void checkFrame(vtkImageDataPtr frame, unsigned index)
+{
+	REQUIRE(frame);
+	CHECK(frame->GetDimensions()[0] == 20);
+	CHECK(frame->GetDimensions()[1] == 10);
+	CHECK(cx::similar(cx::Vector3D(frame->GetSpacing()), cx::Vector3D(0.5, 0.25, 1)));
+	CHECK(frame->GetScalarType() == VTK_UNSIGNED_CHAR);
+	unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+	bool equal = true;
+	for (int i = 0; i < 20*10; ++i)
+		equal = equal && (ptr[i] == (i + index) % 256);
+	CHECK(equal);
+}
+
+void testWriteAndReadBack(bool compress)
+{
+	QString filename = getStreamFilename();
+	unsigned frameCount = 5;
+	writeStreamFile(filename, frameCount, compress);
+
+	REQUIRE(cx::USAcquisitionStreamReader::canRead(filename));
+	cx::USAcquisitionStreamReaderPtr reader(new cx::USAcquisitionStreamReader(filename));
+	REQUIRE(reader->isValid());
+	REQUIRE(reader->getNumberOfFrames() == frameCount);
+
+	std::vector<cx::TimedPosition> timestamps = reader->getFrameTimestamps();
+	REQUIRE(timestamps.size() == frameCount);
+	for (unsigned i = 0; i < frameCount; ++i)
+		CHECK(timestamps[i].mTime == Approx(100 + 20*i));
+
+	// read out of order to exercise random access
+	for (int i = frameCount-1; i >= 0; --i)
+		checkFrame(reader->getFrame(i), i);
+	CHECK(!reader->getFrame(frameCount));
+
+	std::vector<cx::TimedPosition> expected = createPositions(2*frameCount);
+	std::vector<cx::TimedPosition> tracking = reader->getTrackingPositions();
+	REQUIRE(tracking.size() == expected.size());
+	for (unsigned i = 0; i < tracking.size(); ++i)
+	{
+		CHECK(tracking[i].mTime == Approx(expected[i].mTime));
+		CHECK(cx::similar(tracking[i].mPos, expected[i].mPos));
+	}
+	CHECK(reader->getFramePositions().size() == frameCount);
+	CHECK(reader->getText("probedata.xml") == QByteArray("<root/>"));
+
+	cx::USAcquisitionStreamContainer container(reader);
+	CHECK(container.size() == frameCount);
+	checkFrame(container.get(2), 2);
+
+	QFile::remove(filename);
+}
+} // namespace
+
+TEST_CASE("USAcquisitionStreamFile: Write and read back all data", "[unit][resource][usReconstructionTypes]")
+{
+	SECTION("Uncompressed")
+	{
+		testWriteAndReadBack(false);
+	}
+	SECTION("Compressed")
+	{
+		testWriteAndReadBack(true);
+	}
+}
+
+TEST_CASE("USAcquisitionStreamFile: Read truncated file without index", "[unit][resource][usReconstructionTypes]")
+{
+	QString filename = getStreamFilename();
+	writeStreamFile(filename, 3, false);
+
+	// file header + two complete uncompressed frame chunks + part of the third
+	qint64 frameChunkSize = 12 + 105 + 20*10;
+	QFile file(filename);
+	REQUIRE(file.resize(12 + 2*frameChunkSize + 50));
+
+	cx::USAcquisitionStreamReader reader(filename);
+	REQUIRE(reader.isValid());
+	REQUIRE(reader.getNumberOfFrames() == 2);
+	checkFrame(reader.getFrame(0), 0);
+	checkFrame(reader.getFrame(1), 1);
+	CHECK(reader.getTrackingPositions().empty());
+
+	QFile::remove(filename);
+}
+
+TEST_CASE("USAcquisitionStreamFile: Reject index with invalid frame count", "[unit][resource][usReconstructionTypes]")
+{
+	QString filename = getStreamFilename();
+	writeStreamFile(filename, 3, false);
+
+	// overwrite the frame count in the index, found through the tail chunk
+	QFile file(filename);
+	REQUIRE(file.open(QIODevice::ReadWrite));
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	REQUIRE(file.seek(file.size() - 8));
+	quint64 indexOffset;
+	stream >> indexOffset;
+	REQUIRE(file.seek(indexOffset + 12));
+	stream << quint32(1000000000);
+	file.close();
+
+	// the index is rejected before allocating, the frames are found by scanning
+	cx::USAcquisitionStreamReader reader(filename);
+	REQUIRE(reader.isValid());
+	REQUIRE(reader.getNumberOfFrames() == 3);
+	checkFrame(reader.getFrame(2), 2);
+
+	QFile::remove(filename);
+}
+
+TEST_CASE("USAcquisitionStreamFile: Reject frame with invalid header", "[unit][resource][usReconstructionTypes]")
+{
+	QString filename = getStreamFilename();
+	writeStreamFile(filename, 3, false);
+
+	// overwrite the dimensions of frame 1, following the chunk header, frame index and times.
+	qint64 frameChunkSize = 12 + 105 + 20*10;
+	QFile file(filename);
+	REQUIRE(file.open(QIODevice::ReadWrite));
+	QDataStream stream(&file);
+	stream.setByteOrder(QDataStream::LittleEndian);
+	REQUIRE(file.seek(12 + frameChunkSize + 12 + 4 + 3*8));
+	stream << qint32(100000) << qint32(100000) << qint32(100000);
+	file.close();
+
+	// rejected before allocating, the other frames are still readable
+	cx::USAcquisitionStreamReader reader(filename);
+	REQUIRE(reader.isValid());
+	REQUIRE(reader.getNumberOfFrames() == 3);
+	CHECK(!reader.getFrame(1));
+	checkFrame(reader.getFrame(2), 2);
+
+	QFile::remove(filename);
+}
+
+TEST_CASE("USAcquisitionStreamFile: Reject other file types", "[unit][resource][usReconstructionTypes]")
+{
+	QString filename = getStreamFilename();
+	QFile file(filename);
+	REQUIRE(file.open(QIODevice::WriteOnly));
+	file.write("0.0\n1.0\n");
+	file.close();
+
+	CHECK(!cx::USAcquisitionStreamReader::canRead(filename));
+	CHECK(!cx::USAcquisitionStreamReader::canRead(filename + ".missing"));
+
+	QFile::remove(filename);
+}
+
+} // namespace cxtest
@@ -0,0 +1,80 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+
+#include <vtkImageData.h>
+#include "cxUSFrameData.h"
+#include "cxVolumeHelpers.h"
+#include "cxBoundingBox3D.h"
+
+namespace cxtest
+{
+
+namespace
+{
+std::vector<vtkImageDataPtr> createGrayFrames(unsigned count)
+{
+	std::vector<vtkImageDataPtr> retval;
+	for (unsigned i = 0; i < count; ++i)
+	{
+		vtkImageDataPtr frame = cx::generateVtkImageData(Eigen::Array3i(20, 10, 1), cx::Vector3D(1, 1, 1), 0);
+		unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+		for (int y = 0; y < 10; ++y)
+			for (int x = 0; x < 20; ++x)
+				ptr[y*20+x] = 10*y + x + i;
+		retval.push_back(frame);
+	}
+	return retval;
+}
+} // namespace
+
+TEST_CASE("USFrameData: 8 bit grayscale frames are not copied when not cropped", "[usreconstruction][unit]")
+{
+	std::vector<vtkImageDataPtr> input = createGrayFrames(3);
+	cx::USFrameDataPtr data = cx::USFrameData::create("test", input);
+
+	std::vector<std::vector<vtkImageDataPtr> > output = data->initializeFrames(std::vector<bool>(1, false));
+	REQUIRE(output.size() == 1);
+	REQUIRE(output[0].size() == 3);
+	for (unsigned i = 0; i < input.size(); ++i)
+		CHECK(output[0][i]->GetScalarPointer() == input[i]->GetScalarPointer());
+}
+
+TEST_CASE("USFrameData: 8 bit grayscale frames are cropped", "[usreconstruction][unit]")
+{
+	std::vector<vtkImageDataPtr> input = createGrayFrames(3);
+	cx::USFrameDataPtr data = cx::USFrameData::create("test", input);
+	data->setCropBox(cx::IntBoundingBox3D(2, 11, 3, 7, 0, 0));
+
+	Eigen::Array3i dims = data->getDimensions();
+	CHECK(dims[0] == 10);
+	CHECK(dims[1] == 5);
+
+	std::vector<std::vector<vtkImageDataPtr> > output = data->initializeFrames(std::vector<bool>(1, false));
+	REQUIRE(output[0].size() == 3);
+	for (unsigned i = 0; i < output[0].size(); ++i)
+	{
+		vtkImageDataPtr frame = output[0][i];
+		CHECK(frame->GetDimensions()[0] == dims[0]);
+		CHECK(frame->GetDimensions()[1] == dims[1]);
+		CHECK(frame->GetScalarPointer() != input[i]->GetScalarPointer());
+
+		unsigned char* ptr = static_cast<unsigned char*>(frame->GetScalarPointer());
+		bool equal = true;
+		for (int y = 0; y < dims[1]; ++y)
+			for (int x = 0; x < dims[0]; ++x)
+				equal = equal && (ptr[y*dims[0]+x] == 10*(y+3) + (x+2) + i);
+		CHECK(equal);
+	}
+}
+
+} // namespace cxtest
@@ -0,0 +1,103 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <algorithm>
+#include <cmath>
+#include "cxUSFramePlaneIndex.h"
+
+namespace cxtest
+{
+
+namespace
+{
+std::vector<cx::Vector3D> createFrameRect(double width, double height)
+{
+	std::vector<cx::Vector3D> retval;
+	retval.push_back(cx::Vector3D(0, 0, 0));
+	retval.push_back(cx::Vector3D(width, 0, 0));
+	retval.push_back(cx::Vector3D(0, height, 0));
+	retval.push_back(cx::Vector3D(width, height, 0));
+	return retval;
+}
+
+/** A sweep along z, with the frames tilting back and forth around y.
+ */
+std::vector<cx::Transform3D> createSweep(int numFrames)
+{
+	std::vector<cx::Transform3D> retval;
+	for (int i = 0; i < numFrames; ++i)
+	{
+		double angle = 0.3*std::sin(i*0.1);
+		cx::Transform3D M = cx::createTransformTranslate(cx::Vector3D(0, 0, i*0.5)) * cx::createTransformRotateY(angle);
+		retval.push_back(M);
+	}
+	return retval;
+}
+
+bool frameHasPointInside(cx::Transform3D dMu, double width, double height, cx::DoubleBoundingBox3D box)
+{
+	for (double x = 0; x <= width; x += 0.5)
+		for (double y = 0; y <= height; y += 0.5)
+			if (box.contains(dMu.coord(cx::Vector3D(x, y, 0))))
+				return true;
+	return false;
+}
+} // namespace
+
+TEST_CASE("USFramePlaneIndex finds all frames passing through box", "[usreconstruction][unit]")
+{
+	double width = 40;
+	double height = 30;
+	std::vector<cx::Transform3D> sweep = createSweep(100);
+	cx::USFramePlaneIndex index(createFrameRect(width, height), sweep, 2.0);
+
+	CHECK(index.getNumberOfFrames() == 100);
+
+	std::vector<int> found;
+	for (double x = -5; x < 45; x += 7)
+		for (double z = -5; z < 60; z += 6)
+		{
+			cx::DoubleBoundingBox3D box(cx::Vector3D(x, 10, z), cx::Vector3D(x+3, 13, z+3));
+			index.getFramesIntersecting(box, &found);
+
+			CHECK(std::is_sorted(found.begin(), found.end()));
+			CHECK(std::adjacent_find(found.begin(), found.end()) == found.end());
+			for (unsigned i = 0; i < sweep.size(); ++i)
+			{
+				if (frameHasPointInside(sweep[i], width, height, box))
+					CHECK(std::binary_search(found.begin(), found.end(), int(i)));
+			}
+			// the index should give a small subset of the sweep
+			CHECK(found.size() < sweep.size()/2);
+		}
+}
+
+TEST_CASE("USFramePlaneIndex returns no frames outside sweep", "[usreconstruction][unit]")
+{
+	cx::USFramePlaneIndex index(createFrameRect(40, 30), createSweep(100), 2.0);
+
+	std::vector<int> found(1, 0);
+	index.getFramesIntersecting(cx::DoubleBoundingBox3D(cx::Vector3D(100, 100, 100), cx::Vector3D(110, 110, 110)), &found);
+	CHECK(found.empty());
+}
+
+TEST_CASE("USFramePlaneIndex handles empty input", "[usreconstruction][unit]")
+{
+	cx::USFramePlaneIndex index(createFrameRect(40, 30), std::vector<cx::Transform3D>(), 2.0);
+	CHECK(index.getNumberOfFrames() == 0);
+
+	std::vector<int> found;
+	index.getFramesIntersecting(cx::DoubleBoundingBox3D(cx::Vector3D(0, 0, 0), cx::Vector3D(10, 10, 10)), &found);
+	CHECK(found.empty());
+}
+
+} // namespace cxtest
@@ -54,13 +54,14 @@ void USReconstructionFileFixture::assertValidFolderForSession(QString path, QStr
 	CHECK(info.absoluteFilePath().contains(sessionName));
 }
 
-QString USReconstructionFileFixture::write(ReconstructionData input)
+QString USReconstructionFileFixture::write(ReconstructionData input, bool singleFile)
 {
 	QString path = cx::UsReconstructionFileMaker::createFolder(this->getDataPath(), input.sessionName);
 	cx::USReconstructInputData toBeWritten = this->createUSReconstructData(input);
 
 	cx::UsReconstructionFileMakerPtr fileMaker(new cx::UsReconstructionFileMaker(input.sessionName));
 	fileMaker->setReconstructData(toBeWritten);
+	fileMaker->setWriteSingleFile(singleFile);
 	bool compress = true;
 	fileMaker->writeToNewFolder(path, compress);
 	return fileMaker->getReconstructData().mFilename;
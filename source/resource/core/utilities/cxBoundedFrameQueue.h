@@ -0,0 +1,193 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXBOUNDEDFRAMEQUEUE_H
+#define CXBOUNDEDFRAMEQUEUE_H
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QThread>
+#include <boost/scoped_array.hpp>
+
+namespace cx
+{
+
+/** Bounded, lock-free queue for passing frames from one producer
+ * thread to one consumer thread.
+ *
+ * The policy decides what happens when a frame is pushed:
+ *  - pLATEST_ONLY : All queued frames are dropped, i.e. the consumer
+ *                   only sees the newest frame.
+ *  - pDROP_OLDEST : If the queue is full, the oldest frame is dropped.
+ *  - pBLOCK       : If the queue is full, wait until the consumer has
+ *                   made room, or drop the new frame after the block timeout.
+ *
+ * The implementation is a ring buffer where each cell has a sequence number
+ * (D. Vyukov's bounded queue). When dropping frames, the producer pops from
+ * the queue, thus pop() is safe to call from both threads.
+ *
+ * T must be default constructible and assignable, typically a shared pointer.
+ *
+ * \ingroup cx_resource_core_utilities
+ * \date 2026-10-18
+ */
+template<class T>
+class BoundedFrameQueue
+{
+public:
+	enum POLICY
+	{
+		pLATEST_ONLY,
+		pDROP_OLDEST,
+		pBLOCK
+	};
+
+	/**
+	 * \param capacity Max number of queued frames, rounded up to a power of two.
+	 */
+	explicit BoundedFrameQueue(unsigned capacity = 32, POLICY policy = pDROP_OLDEST) :
+		mPolicy(policy),
+		mBlockTimeout(100),
+		mEnqueuePos(0),
+		mDequeuePos(0),
+		mEnqueued(0),
+		mDropped(0)
+	{
+		unsigned size = 2;
+		while (size < capacity)
+			size *= 2;
+		mMask = size-1;
+		mCells.reset(new Cell[size]);
+		for (unsigned i=0; i<size; ++i)
+			mCells[i].mSequence.storeRelease(i);
+	}
+
+	/** Add a frame. Call from the producer thread only.
+	 *  Return false if the frame was dropped.
+	 */
+	bool push(const T& value)
+	{
+		POLICY policy = this->getPolicy();
+
+		if (policy == pLATEST_ONLY)
+			this->dropAll();
+
+		QElapsedTimer timer;
+		timer.start();
+		while (!this->tryPush(value))
+		{
+			if (policy == pBLOCK)
+			{
+				if (timer.elapsed() >= mBlockTimeout.loadAcquire())
+				{
+					mDropped.fetchAndAddOrdered(1);
+					return false;
+				}
+				QThread::usleep(100);
+			}
+			else if (this->getDepth() < this->getCapacity())
+			{
+				QThread::yieldCurrentThread(); // consumer is still reading the cell
+			}
+			else
+			{
+				T dropped;
+				if (this->pop(&dropped))
+					mDropped.fetchAndAddOrdered(1);
+			}
+		}
+
+		mEnqueued.fetchAndAddOrdered(1);
+		return true;
+	}
+
+	/** Remove the oldest frame and put it in value.
+	 *  Return false if the queue is empty.
+	 */
+	bool pop(T* value)
+	{
+		Cell* cell = NULL;
+		quint32 pos = mDequeuePos.loadAcquire();
+		while (true)
+		{
+			cell = &mCells[pos & mMask];
+			qint32 diff = qint32(cell->mSequence.loadAcquire() - (pos+1));
+			if (diff < 0)
+				return false; // empty
+			if ((diff == 0) && mDequeuePos.testAndSetOrdered(pos, pos+1))
+				break;
+			pos = mDequeuePos.loadAcquire();
+		}
+
+		*value = cell->mValue;
+		cell->mValue = T(); // release the reference
+		cell->mSequence.storeRelease(pos + mMask + 1);
+		return true;
+	}
+
+	void setPolicy(POLICY policy) { mPolicy.storeRelease(policy); }
+	POLICY getPolicy() const { return static_cast<POLICY>(mPolicy.loadAcquire()); }
+	void setBlockTimeout(int ms) { mBlockTimeout.storeRelease(ms); }
+	unsigned getCapacity() const { return mMask+1; }
+
+	/** Number of frames accepted by push() */
+	quint64 getEnqueuedCount() const { return mEnqueued.loadAcquire(); }
+	/** Number of frames dropped, either old frames removed or new frames rejected. */
+	quint64 getDroppedCount() const { return mDropped.loadAcquire(); }
+	/** Number of frames currently in the queue. Approximate if called during push/pop. */
+	unsigned getDepth() const
+	{
+		qint32 depth = qint32(mEnqueuePos.loadAcquire() - mDequeuePos.loadAcquire());
+		return depth > 0 ? depth : 0;
+	}
+
+private:
+	struct Cell
+	{
+		QAtomicInteger<quint32> mSequence;
+		T mValue;
+	};
+
+	bool tryPush(const T& value)
+	{
+		// single producer: no other thread changes mEnqueuePos
+		quint32 pos = mEnqueuePos.loadAcquire();
+		Cell* cell = &mCells[pos & mMask];
+		if (qint32(cell->mSequence.loadAcquire() - pos) != 0)
+			return false; // full, or the consumer is still reading the cell
+		mEnqueuePos.storeRelease(pos+1);
+		cell->mValue = value;
+		cell->mSequence.storeRelease(pos+1);
+		return true;
+	}
+
+	void dropAll()
+	{
+		T dropped;
+		while (this->pop(&dropped))
+			mDropped.fetchAndAddOrdered(1);
+	}
+
+	BoundedFrameQueue(const BoundedFrameQueue&);
+	BoundedFrameQueue& operator=(const BoundedFrameQueue&);
+
+	boost::scoped_array<Cell> mCells;
+	quint32 mMask;
+	QAtomicInt mPolicy;
+	QAtomicInt mBlockTimeout;
+	QAtomicInteger<quint32> mEnqueuePos;
+	QAtomicInteger<quint32> mDequeuePos;
+	QAtomicInteger<quint64> mEnqueued;
+	QAtomicInteger<quint64> mDropped;
+};
+
+} // namespace cx
+
+#endif // CXBOUNDEDFRAMEQUEUE_H
@@ -11,8 +11,16 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxImageDataContainer.h"
 #include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QFileInfo>
+#include <QStringList>
+#include <map>
 #include <vtkImageImport.h>
 #include <vtkImageData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkCallbackCommand.h>
 #include "cxFileManagerService.h"
 #include "cxLogger.h"
 #include "cxTypeConversions.h"
@@ -162,6 +170,231 @@ unsigned CachedImageDataContainer::size() const
 ///--------------------------------------------------------
 ///--------------------------------------------------------
 
+namespace
+{
+int metaElementTypeToVtk(QString type)
+{
+	if (type == "MET_UCHAR")
+		return VTK_UNSIGNED_CHAR;
+	if (type == "MET_CHAR")
+		return VTK_CHAR;
+	if (type == "MET_USHORT")
+		return VTK_UNSIGNED_SHORT;
+	if (type == "MET_SHORT")
+		return VTK_SHORT;
+	if (type == "MET_UINT")
+		return VTK_UNSIGNED_INT;
+	if (type == "MET_INT")
+		return VTK_INT;
+	if (type == "MET_FLOAT")
+		return VTK_FLOAT;
+	if (type == "MET_DOUBLE")
+		return VTK_DOUBLE;
+	return -1;
+}
+
+/** Read the keys of a metaheader file. Stop at ElementDataFile,
+ *  which always is the last key.
+ */
+std::map<QString, QString> readMetaHeaderKeys(QString filename)
+{
+	std::map<QString, QString> retval;
+	QFile file(filename);
+	if (!file.open(QIODevice::ReadOnly))
+		return retval;
+
+	QTextStream stream(&file);
+	while (!stream.atEnd())
+	{
+		QString line = stream.readLine();
+		int pos = line.indexOf("=");
+		if (pos < 0)
+			continue;
+		QString key = line.left(pos).trimmed();
+		retval[key] = line.mid(pos+1).trimmed();
+		if (key == "ElementDataFile")
+			break;
+	}
+	return retval;
+}
+
+template<class T>
+bool readValues(QString text, T* values, int minCount, int maxCount, T defaultValue)
+{
+	QStringList items = text.split(" ", QString::SkipEmptyParts);
+	if ((items.size() < minCount) || (items.size() > maxCount))
+		return false;
+	for (int i = 0; i < maxCount; ++i)
+		values[i] = (i < items.size()) ? T(items[i].toDouble()) : defaultValue;
+	return true;
+}
+} // namespace
+
+MappedImageDataContainer::Frame::Frame(QString filename) :
+	mFilename(filename),
+	mMapAttempted(false),
+	mDataSize(0),
+	mScalarType(-1),
+	mComponents(1)
+{
+}
+
+MappedImageDataContainer::MappedImageDataContainer(QString baseFilename, FileManagerServicePtr filemanagerservice) :
+	mFileManagerService(filemanagerservice)
+{
+	QFileInfo info(baseFilename);
+
+	for (int i=0; true; ++i)
+	{
+		QString file = info.absolutePath()+"/"+info.completeBaseName()+QString("_%1.mhd").arg(i);
+		if (!QFileInfo(file).exists())
+			break;
+		mFrames.push_back(Frame(file));
+	}
+}
+
+MappedImageDataContainer::MappedImageDataContainer(std::vector<QString> frames, FileManagerServicePtr filemanagerservice) :
+	mFileManagerService(filemanagerservice)
+{
+	for (unsigned i=0; i<frames.size(); ++i)
+		mFrames.push_back(Frame(frames[i]));
+}
+
+MappedImageDataContainer::~MappedImageDataContainer()
+{
+}
+
+/** Find the raw data file of the frame if the metaheader describes
+ *  uncompressed data in a separate file. Leave mDataFile empty otherwise.
+ */
+void MappedImageDataContainer::readFrameHeader(Frame* frame)
+{
+	frame->mMapAttempted = true;
+
+	std::map<QString, QString> keys = readMetaHeaderKeys(frame->mFilename);
+	if (keys["CompressedData"].compare("True", Qt::CaseInsensitive) == 0)
+		return;
+	if (!keys["HeaderSize"].isEmpty() && (keys["HeaderSize"] != "0"))
+		return;
+
+	frame->mScalarType = metaElementTypeToVtk(keys["ElementType"]);
+	if (frame->mScalarType < 0)
+		return;
+	int scalarSize = vtkDataArray::GetDataTypeSize(frame->mScalarType);
+	bool msb = (keys["BinaryDataByteOrderMSB"].compare("True", Qt::CaseInsensitive) == 0)
+			|| (keys["ElementByteOrderMSB"].compare("True", Qt::CaseInsensitive) == 0);
+	if (msb && (scalarSize > 1))
+		return;
+
+	if (!readValues<int>(keys["DimSize"], frame->mDim, 2, 3, 1))
+		return;
+	if (!readValues<double>(keys["ElementSpacing"], frame->mSpacing, 2, 3, 1))
+		return;
+	frame->mComponents = keys["ElementNumberOfChannels"].isEmpty() ? 1 : keys["ElementNumberOfChannels"].toInt();
+
+	QString dataFile = keys["ElementDataFile"];
+	if (dataFile.isEmpty() || (dataFile == "LOCAL") || dataFile.contains(" "))
+		return;
+	dataFile = QFileInfo(frame->mFilename).absoluteDir().absoluteFilePath(dataFile);
+
+	qint64 dataSize = qint64(frame->mDim[0]) * frame->mDim[1] * frame->mDim[2] * frame->mComponents * scalarSize;
+	if (QFileInfo(dataFile).size() < dataSize)
+		return;
+
+	frame->mDataFile = dataFile;
+	frame->mDataSize = dataSize;
+}
+
+namespace
+{
+void releaseMapping(void* clientData)
+{
+	delete static_cast<boost::shared_ptr<QFile>*>(clientData);
+}
+} // namespace
+
+/** Map the raw data copy-on-write into a new image.
+ *  The image scalars own the mapping: It is released when they are deleted.
+ */
+vtkImageDataPtr MappedImageDataContainer::mapFrame(const Frame& frame)
+{
+	boost::shared_ptr<QFile> file(new QFile(frame.mDataFile));
+	if (!file->open(QIODevice::ReadOnly))
+		return vtkImageDataPtr();
+	uchar* data = file->map(0, frame.mDataSize, QFileDevice::MapPrivateOption);
+	file->close(); // the mapping is valid until the QFile is deleted
+	if (!data)
+		return vtkImageDataPtr();
+
+	vtkImageDataPtr retval = vtkImageDataPtr::New();
+	retval->SetExtent(0, frame.mDim[0]-1, 0, frame.mDim[1]-1, 0, frame.mDim[2]-1);
+	retval->SetSpacing(frame.mSpacing);
+	retval->SetOrigin(0, 0, 0); // same as when loaded using the file manager
+
+	vtkDataArrayPtr scalars;
+	scalars.TakeReference(vtkDataArray::CreateDataArray(frame.mScalarType));
+	scalars->SetNumberOfComponents(frame.mComponents);
+	vtkIdType numberOfPixels = vtkIdType(frame.mDim[0]) * frame.mDim[1] * frame.mDim[2];
+	scalars->SetVoidArray(data, numberOfPixels*frame.mComponents, 1);
+
+	vtkSmartPointer<vtkCallbackCommand> owner = vtkSmartPointer<vtkCallbackCommand>::New();
+	owner->SetClientData(new boost::shared_ptr<QFile>(file));
+	owner->SetClientDataDeleteCallback(&releaseMapping);
+	scalars->AddObserver(vtkCommand::DeleteEvent, owner);
+
+	retval->GetPointData()->SetScalars(scalars);
+	return retval;
+}
+
+vtkImageDataPtr MappedImageDataContainer::get(unsigned index)
+{
+	CX_ASSERT(index < this->size());
+
+	QMutexLocker sentry(&mMutex);
+	Frame& frame = mFrames[index];
+	if (!frame.mMapAttempted)
+		this->readFrameHeader(&frame);
+	Frame current = frame;
+	sentry.unlock();
+
+	if (!current.mDataFile.isEmpty())
+	{
+		vtkImageDataPtr retval = this->mapFrame(current);
+		if (retval)
+			return retval;
+	}
+
+	if (!mFileManagerService)
+	{
+		reportError("Cannot map or load " + current.mFilename);
+		return vtkImageDataPtr();
+	}
+	return mFileManagerService->loadVtkImageData(current.mFilename);
+}
+
+bool MappedImageDataContainer::isMapped(unsigned index)
+{
+	QMutexLocker sentry(&mMutex);
+	Frame& frame = mFrames[index];
+	if (!frame.mMapAttempted)
+		this->readFrameHeader(&frame);
+	return !frame.mDataFile.isEmpty();
+}
+
+QString MappedImageDataContainer::getFilename(unsigned index) const
+{
+	return mFrames[index].mFilename;
+}
+
+unsigned MappedImageDataContainer::size() const
+{
+	return (unsigned)mFrames.size();
+}
+
+///--------------------------------------------------------
+///--------------------------------------------------------
+///--------------------------------------------------------
+
 SplitFramesContainer::SplitFramesContainer(vtkImageDataPtr image3D)
 {
 	mOptionalWholeBase = image3D;
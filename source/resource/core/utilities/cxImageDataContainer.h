@@ -16,6 +16,8 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "vtkForwardDeclarations.h"
 #include "cxForwardDeclarations.h"
 #include <vector>
+#include <QMutex>
+class QFile;
 
 namespace cx
 {
@@ -106,6 +108,62 @@ private:
 };
 typedef boost::shared_ptr<CachedImageDataContainer> CachedImageDataContainerPtr;
 
+/** Container class for zero-copy access to frames stored as
+  * uncompressed metaheader files.
+  *
+  * The raw data files are memory-mapped copy-on-write, and the returned
+  * vtkImageData refer directly to the mapped memory. Each returned frame
+  * owns its mapping, and keeps it until the frame is deleted, thus frames
+  * can outlive the container. Modifying a frame copies only the modified
+  * pages, and does not change the file or other frames. The mapped memory
+  * is managed by the OS file cache and can be paged out when memory is low.
+  *
+  * Frames that cannot be mapped, e.g. compressed data, are loaded using
+  * the file manager in the same way as CachedImageDataContainer.
+  *
+  * get() is thread-safe.
+  *
+  * \date 2026-10-18
+  */
+class cxResource_EXPORT MappedImageDataContainer : public ImageDataContainer
+{
+public:
+	/**
+	  * Use all files baseFilename_i.mhd, i=0,1,2...
+	  */
+	MappedImageDataContainer(QString baseFilename, FileManagerServicePtr filemanagerservice);
+	MappedImageDataContainer(std::vector<QString> frames, FileManagerServicePtr filemanagerservice);
+	virtual ~MappedImageDataContainer();
+	virtual vtkImageDataPtr get(unsigned index);
+	virtual unsigned size() const;
+	QString getFilename(unsigned index) const;
+	/**
+	  * Return true if the frame is available as mapped memory,
+	  * i.e. get(index) does not copy any data.
+	  */
+	bool isMapped(unsigned index);
+
+private:
+	struct Frame
+	{
+		Frame(QString filename);
+		QString mFilename;
+		bool mMapAttempted;
+		QString mDataFile; ///< raw data file, empty if the frame cannot be mapped
+		qint64 mDataSize;
+		int mDim[3];
+		double mSpacing[3];
+		int mScalarType;
+		int mComponents;
+	};
+	void readFrameHeader(Frame* frame);
+	vtkImageDataPtr mapFrame(const Frame& frame);
+	std::vector<Frame> mFrames;
+	FileManagerServicePtr mFileManagerService;
+	QMutex mMutex;
+};
+typedef boost::shared_ptr<MappedImageDataContainer> MappedImageDataContainerPtr;
+
 /** Container class for extracting 2D vtkImageData from a 3D base image.
  *
  * \date Dec 04 2012
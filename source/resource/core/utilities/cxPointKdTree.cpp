@@ -0,0 +1,139 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxPointKdTree.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace cx
+{
+
+namespace
+{
+struct AxisLess
+{
+	AxisLess(const std::vector<Vector3D>& points, int axis) : mPoints(points), mAxis(axis) {}
+	bool operator()(int a, int b) const
+	{
+		return mPoints[a][mAxis] < mPoints[b][mAxis];
+	}
+	const std::vector<Vector3D>& mPoints;
+	int mAxis;
+};
+} // namespace
+
+PointKdTree::PointKdTree(const std::vector<Vector3D>& points) :
+	mPoints(points)
+{
+	mIndices.resize(mPoints.size());
+	for (unsigned i = 0; i < mIndices.size(); ++i)
+		mIndices[i] = i;
+	mAxes.resize(mPoints.size(), 0);
+	this->build(0, int(mIndices.size()));
+}
+
+void PointKdTree::build(int begin, int end)
+{
+	if (end - begin <= 1)
+		return;
+
+	Vector3D lower = mPoints[mIndices[begin]];
+	Vector3D upper = lower;
+	for (int i = begin+1; i < end; ++i)
+	{
+		lower = lower.cwiseMin(mPoints[mIndices[i]]);
+		upper = upper.cwiseMax(mPoints[mIndices[i]]);
+	}
+	Vector3D extent = upper - lower;
+	int axis = 0;
+	if (extent[1] > extent[axis])
+		axis = 1;
+	if (extent[2] > extent[axis])
+		axis = 2;
+
+	int mid = (begin + end)/2;
+	std::nth_element(mIndices.begin()+begin, mIndices.begin()+mid, mIndices.begin()+end, AxisLess(mPoints, axis));
+	mAxes[mid] = axis;
+
+	this->build(begin, mid);
+	this->build(mid+1, end);
+}
+
+int PointKdTree::findClosestPoint(const Vector3D& p, double* distanceSquared) const
+{
+	int best = -1;
+	double bestDistanceSquared = std::numeric_limits<double>::max();
+	this->searchClosest(0, int(mIndices.size()), p, &best, &bestDistanceSquared);
+	if (distanceSquared)
+		*distanceSquared = bestDistanceSquared;
+	return best;
+}
+
+void PointKdTree::searchClosest(int begin, int end, const Vector3D& p, int* best, double* bestDistanceSquared) const
+{
+	if (begin >= end)
+		return;
+
+	int mid = (begin + end)/2;
+	int index = mIndices[mid];
+	const Vector3D& q = mPoints[index];
+	double distanceSquared = (q - p).squaredNorm();
+	if ((distanceSquared < *bestDistanceSquared) || ((distanceSquared == *bestDistanceSquared) && (index < *best)))
+	{
+		*best = index;
+		*bestDistanceSquared = distanceSquared;
+	}
+
+	// points equal to the median along the axis can be on both sides: prune with <=
+	int axis = mAxes[mid];
+	double diff = p[axis] - q[axis];
+	if (diff < 0)
+	{
+		this->searchClosest(begin, mid, p, best, bestDistanceSquared);
+		if (diff*diff <= *bestDistanceSquared)
+			this->searchClosest(mid+1, end, p, best, bestDistanceSquared);
+	}
+	else
+	{
+		this->searchClosest(mid+1, end, p, best, bestDistanceSquared);
+		if (diff*diff <= *bestDistanceSquared)
+			this->searchClosest(begin, mid, p, best, bestDistanceSquared);
+	}
+}
+
+std::vector<int> PointKdTree::findPointsWithinRadius(const Vector3D& p, double radius) const
+{
+	std::vector<int> retval;
+	this->searchRadius(0, int(mIndices.size()), p, radius*radius, &retval);
+	std::sort(retval.begin(), retval.end());
+	return retval;
+}
+
+void PointKdTree::searchRadius(int begin, int end, const Vector3D& p, double radiusSquared, std::vector<int>* result) const
+{
+	if (begin >= end)
+		return;
+
+	int mid = (begin + end)/2;
+	int index = mIndices[mid];
+	const Vector3D& q = mPoints[index];
+	if ((q - p).squaredNorm() <= radiusSquared)
+		result->push_back(index);
+
+	int axis = mAxes[mid];
+	double diff = p[axis] - q[axis];
+	if ((diff <= 0) || (diff*diff <= radiusSquared))
+		this->searchRadius(begin, mid, p, radiusSquared, result);
+	if ((diff >= 0) || (diff*diff <= radiusSquared))
+		this->searchRadius(mid+1, end, p, radiusSquared, result);
+}
+
+} // namespace cx
@@ -0,0 +1,62 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXPOINTKDTREE_H
+#define CXPOINTKDTREE_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include "cxVector3D.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class PointKdTree> PointKdTreePtr;
+
+/** \brief Static k-d tree for closest point queries in a point set.
+ *
+ * The tree is built once in the constructor, and stored implicitly as
+ * a permutation of the point indices: Each range is split at its median
+ * along the axis with the largest extent.
+ *
+ * Queries do not modify the tree, and can be run from several threads
+ * at once. Ties are resolved to the lowest point index, thus the result is
+ * independent of the tree layout.
+ *
+ * \ingroup cx_resource_core_utilities
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT PointKdTree
+{
+public:
+	explicit PointKdTree(const std::vector<Vector3D>& points);
+
+	/** Return the index of the point closest to p, -1 if the tree is empty. */
+	int findClosestPoint(const Vector3D& p, double* distanceSquared = NULL) const;
+	/** Return the indices of all points within radius of p, in increasing index order. */
+	std::vector<int> findPointsWithinRadius(const Vector3D& p, double radius) const;
+
+	int getNumberOfPoints() const { return int(mPoints.size()); }
+	const Vector3D& getPoint(int index) const { return mPoints[index]; }
+
+private:
+	void build(int begin, int end);
+	void searchClosest(int begin, int end, const Vector3D& p, int* best, double* bestDistanceSquared) const;
+	void searchRadius(int begin, int end, const Vector3D& p, double radiusSquared, std::vector<int>* result) const;
+
+	std::vector<Vector3D> mPoints;
+	std::vector<int> mIndices; ///< the tree: the median of [begin,end) is at (begin+end)/2
+	std::vector<char> mAxes; ///< split axis for each median
+};
+
+} // namespace cx
+
+#endif // CXPOINTKDTREE_H
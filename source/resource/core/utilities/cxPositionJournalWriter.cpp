@@ -0,0 +1,114 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxPositionJournalWriter.h"
+
+#include <QMutexLocker>
+
+namespace cx
+{
+
+PositionJournalWriter::PositionJournalWriter(QString filename, int flushInterval) :
+	mFilename(filename),
+	mFlushInterval(flushInterval),
+	mAppendedCount(0),
+	mWrittenCount(0),
+	mBlockCount(0),
+	mFlushRequested(false),
+	mStop(false)
+{
+	this->setObjectName("org.custusx.resource.positionjournal"); // becomes the thread name
+	this->start();
+}
+
+PositionJournalWriter::~PositionJournalWriter()
+{
+	this->stop();
+}
+
+void PositionJournalWriter::append(QString toolUid, double timestamp, const Transform3D& position)
+{
+	QMutexLocker sentry(&mMutex);
+	mPending.push_back(PositionStorageEntry(toolUid, timestamp, position));
+	++mAppendedCount;
+}
+
+void PositionJournalWriter::append(const std::vector<PositionStorageEntry>& entries)
+{
+	QMutexLocker sentry(&mMutex);
+	mPending.insert(mPending.end(), entries.begin(), entries.end());
+	mAppendedCount += entries.size();
+}
+
+void PositionJournalWriter::flush()
+{
+	QMutexLocker sentry(&mMutex);
+	quint64 target = mAppendedCount;
+	mFlushRequested = true;
+	mWakeup.wakeAll();
+	while ((mWrittenCount < target) && this->isRunning())
+		mWritten.wait(&mMutex, 100);
+}
+
+void PositionJournalWriter::stop()
+{
+	{
+		QMutexLocker sentry(&mMutex);
+		mStop = true;
+		mWakeup.wakeAll();
+	}
+	this->wait();
+}
+
+quint64 PositionJournalWriter::getWrittenCount() const
+{
+	QMutexLocker sentry(&mMutex);
+	return mWrittenCount;
+}
+
+quint64 PositionJournalWriter::getBlockCount() const
+{
+	QMutexLocker sentry(&mMutex);
+	return mBlockCount;
+}
+
+void PositionJournalWriter::writePending(PositionStorageWriter* writer)
+{
+	// called with mMutex locked: release it while writing.
+	std::vector<PositionStorageEntry> batch;
+	batch.swap(mPending);
+	mFlushRequested = false;
+
+	mMutex.unlock();
+	writer->writeBlock(batch);
+	writer->flush();
+	mMutex.lock();
+
+	mWrittenCount += batch.size();
+	if (!batch.empty())
+		++mBlockCount;
+	mWritten.wakeAll();
+}
+
+void PositionJournalWriter::run()
+{
+	PositionStorageWriter writer(mFilename);
+
+	QMutexLocker sentry(&mMutex);
+	while (!mStop)
+	{
+		if (!mFlushRequested)
+			mWakeup.wait(&mMutex, mFlushInterval);
+		this->writePending(&writer);
+	}
+	this->writePending(&writer);
+}
+
+} // namespace cx
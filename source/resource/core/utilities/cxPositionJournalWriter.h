@@ -0,0 +1,80 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXPOSITIONJOURNALWRITER_H
+#define CXPOSITIONJOURNALWRITER_H
+
+#include "cxResourceExport.h"
+
+#include <vector>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <boost/shared_ptr.hpp>
+#include "cxPositionStorageFile.h"
+
+namespace cx
+{
+
+/** \brief Append tool positions to a position file from a background thread.
+ *
+ * Positions added with append() are queued, and written by the thread
+ * in batches every flushInterval ms. Each batch is written as one block,
+ * see PositionStorageWriter::writeBlock(), thus readers can skip directly to
+ * the time window they need.
+ *
+ * The file is only appended to, never rewritten.
+ * Call flush() to ensure all queued positions are on disk, e.g. when saving.
+ * The destructor writes all queued positions before returning.
+ *
+ * \ingroup cx_resource_core_utilities
+ * \date 2026-10-18
+ */
+class cxResource_EXPORT PositionJournalWriter : public QThread
+{
+public:
+	explicit PositionJournalWriter(QString filename, int flushInterval = 1000);
+	virtual ~PositionJournalWriter();
+
+	/** Queue a position for writing. Threadsafe. */
+	void append(QString toolUid, double timestamp, const Transform3D& position);
+	void append(const std::vector<PositionStorageEntry>& entries);
+	/** Block until all queued positions are written to file. */
+	void flush();
+	/** Write all queued positions, then stop the thread. */
+	void stop();
+
+	QString getFilename() const { return mFilename; }
+	quint64 getWrittenCount() const;
+	quint64 getBlockCount() const;
+
+protected:
+	virtual void run();
+
+private:
+	void writePending(PositionStorageWriter* writer);
+
+	QString mFilename;
+	int mFlushInterval;
+	mutable QMutex mMutex; ///< protects the members below
+	QWaitCondition mWakeup;
+	QWaitCondition mWritten;
+	std::vector<PositionStorageEntry> mPending;
+	quint64 mAppendedCount;
+	quint64 mWrittenCount;
+	quint64 mBlockCount;
+	bool mFlushRequested;
+	bool mStop;
+};
+typedef boost::shared_ptr<PositionJournalWriter> PositionJournalWriterPtr;
+
+} // namespace cx
+
+#endif // CXPOSITIONJOURNALWRITER_H
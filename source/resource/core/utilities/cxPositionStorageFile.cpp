@@ -12,6 +12,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxPositionStorageFile.h"
 #include <QDateTime>
 #include <boost/cstdint.hpp>
+#include <limits>
 #include "cxFrame3D.h"
 #include "cxTime.h"
 
@@ -23,6 +24,8 @@ namespace cx
 PositionStorageReader::PositionStorageReader(QString filename) : positions(filename)
 {
   mError = false;
+  mWindowStart = -std::numeric_limits<double>::max();
+  mWindowStop = std::numeric_limits<double>::max();
   positions.open(QIODevice::ReadOnly);
   stream.setDevice(&positions);
   stream.setByteOrder(QDataStream::LittleEndian);
@@ -56,6 +59,31 @@ int PositionStorageReader::version()
   return mVersion;
 }
 
+void PositionStorageReader::setTimeWindow(double start, double stop)
+{
+	mWindowStart = start;
+	mWindowStop = stop;
+}
+
+void PositionStorageReader::readBlockHeader()
+{
+	quint8 size;
+	quint64 start;
+	quint64 stop;
+	quint32 count;
+	quint32 bytes;
+	stream >> size >> start >> stop >> count >> bytes;
+
+	// a block always starts with a tool change
+	mCurrentToolUid = "";
+
+	if ((double(stop) < mWindowStart) || (double(start) > mWindowStop))
+	{
+		if (stream.skipRawData(bytes) != int(bytes))
+			mError = true;
+	}
+}
+
 bool PositionStorageReader::read(Transform3D* matrix, double* timestamp, int* toolIndex)
 {
   if (atEnd())
@@ -92,15 +120,24 @@ bool PositionStorageReader::read(Transform3D* matrix, double* timestamp, QString
 
   stream >> type; // read type and make ready for a new read below
 
-  while (type==2) // change tool format
+  while (type==2 || type==4) // change tool or block format
   {
+	if (type==4)
+	{
+		this->readBlockHeader();
+		if (this->atEnd())
+			return false;
+		stream >> type;
+		continue;
+	}
+
 	  if (this->atEnd())
 		return false;
 	stream >> size;
     char* data = NULL;
     uint isize = 0;
     stream.readBytes(data, isize);
-	mCurrentToolUid = QString(QByteArray(data, size));
+	mCurrentToolUid = QString(QByteArray(data, isize));
     delete[] data;
 
     stream >> type; // read type and make ready for a new read below
@@ -194,7 +231,7 @@ PositionStorageWriter::PositionStorageWriter(QString filename) : positions(filen
 	if (positions.size() == 0)
 	{
 		stream.writeRawData("SNWPOS", 6);
-		stream << (quint8)2; // version 1 had only 32 bit timestamps
+		stream << (quint8)3; // version 1 had only 32 bit timestamps, version 2 had no blocks
 	}
 }
 
@@ -225,34 +262,72 @@ void PositionStorageWriter::write(Transform3D matrix, uint64_t timestamp, int to
 
 void PositionStorageWriter::write(Transform3D matrix, uint64_t timestamp, QString toolUid)
 {
-  if (toolUid!=mCurrentToolUid)
-  {
-    QByteArray name = toolUid.toLatin1();
+	if (toolUid!=mCurrentToolUid)
+		this->writeToolChange(toolUid);
+	this->writePosition(matrix, timestamp);
+}
 
-    stream << (quint8)2;  // Type - tool change
-    stream << (quint8)(name.size()+4); // Size of data following this point
-    stream.writeBytes(name.data(), name.size());
-    mCurrentToolUid = toolUid;
-  }
-  else
-  {
-    Frame3D frame = Frame3D::create(matrix);
-    boost::array<double, 6> rep = frame.getCompactAxisAngleRep();
-
-    stream << (quint8)3;  // Type -
-    stream << (quint8)(8+6*10); // Size of data following this point
-    stream << (quint64)timestamp; // Milliseconds since Epoch
-//    stream << (double)frame.mThetaXY;
-//    stream << (double)frame.mThetaZ;
-//    stream << (double)frame.mPhi;
-    stream << rep[0];
-    stream << rep[1];
-    stream << rep[2];
-    stream << rep[3];
-    stream << rep[4];
-    stream << rep[5];
-  }
+void PositionStorageWriter::writeToolChange(QString toolUid)
+{
+	QByteArray name = toolUid.toLatin1();
+
+	stream << (quint8)2;  // Type - tool change
+	stream << (quint8)(name.size()+4); // Size of data following this point
+	stream.writeBytes(name.data(), name.size());
+	mCurrentToolUid = toolUid;
+}
+
+void PositionStorageWriter::writePosition(Transform3D matrix, uint64_t timestamp)
+{
+	Frame3D frame = Frame3D::create(matrix);
+	boost::array<double, 6> rep = frame.getCompactAxisAngleRep();
+
+	stream << (quint8)3;  // Type -
+	stream << (quint8)(8+6*10); // Size of data following this point
+	stream << (quint64)timestamp; // Milliseconds since Epoch
+	for (unsigned i=0; i<rep.size(); ++i)
+		stream << rep[i];
+}
+
+void PositionStorageWriter::writeBlock(const std::vector<PositionStorageEntry>& entries)
+{
+	if (entries.empty())
+		return;
+
+	// compute header contents before writing
+	quint64 start = std::numeric_limits<quint64>::max();
+	quint64 stop = 0;
+	quint32 bytes = 0;
+	QString toolUid;
+	for (unsigned i=0; i<entries.size(); ++i)
+	{
+		quint64 timestamp = entries[i].mTimestamp;
+		start = std::min(start, timestamp);
+		stop = std::max(stop, timestamp);
+		if (i==0 || entries[i].mToolUid!=toolUid)
+		{
+			toolUid = entries[i].mToolUid;
+			bytes += 1+1+4+toolUid.toLatin1().size();
+		}
+		bytes += 1+1+8+6*8;
+	}
 
+	stream << (quint8)4; // Type - block
+	stream << (quint8)(8+8+4+4); // Size of data following this point
+	stream << start << stop << (quint32)entries.size() << bytes;
+
+	mCurrentToolUid = "";
+	for (unsigned i=0; i<entries.size(); ++i)
+	{
+		if (entries[i].mToolUid!=mCurrentToolUid)
+			this->writeToolChange(entries[i].mToolUid);
+		this->writePosition(entries[i].mPosition, entries[i].mTimestamp);
+	}
+}
+
+void PositionStorageWriter::flush()
+{
+	positions.flush();
 }
 
 
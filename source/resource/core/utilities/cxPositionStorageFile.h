@@ -18,11 +18,24 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QFile>
 #include <QDataStream>
 #include <boost/cstdint.hpp>
+#include <vector>
 
 #include "cxTransform3D.h"
 
 namespace cx {
 
+/** One tool position, as stored in the position file.
+ */
+struct cxResource_EXPORT PositionStorageEntry
+{
+	PositionStorageEntry() : mTimestamp(0), mPosition(Transform3D::Identity()) {}
+	PositionStorageEntry(QString toolUid, double timestamp, Transform3D position) :
+		mToolUid(toolUid), mTimestamp(timestamp), mPosition(position) {}
+	QString mToolUid;
+	double mTimestamp;
+	Transform3D mPosition;
+};
+
 /**\brief Reader class for the position file.
  * 
  * Each call to read() gives the next position entry from the file.
@@ -47,6 +60,11 @@ namespace cx {
    * Position. Requires change tool to have been called.
       <type=3><size><timestamp><position>
 
+   * Block header (version 3). Describes the entries following it:
+      <type=4><size><start timestamp><stop timestamp><count><bytes>
+     where bytes is the number of bytes in the block after the header.
+     The first entry in a block is always a change tool.
+
    The position field is <position> = <thetaXY><thetaZ><phi><x><y><z>
    Where the parameters are found from a matrix using the class CGFrame.
    \endverbatim
@@ -64,13 +82,20 @@ public:
 	bool atEnd() const;
 	static QString timestampToString(double timestamp);
 	int version();
+	/** Skip blocks with no positions inside [start, stop].
+	 *  Positions outside the blocks, or in blocks overlapping the window, are still read.
+	 */
+	void setTimeWindow(double start, double stop);
 private:
 	QString mCurrentToolUid; ///< the tool currently being written.
 	QFile positions;
 	QDataStream stream;
 	quint8 mVersion;
 	bool mError;
+	double mWindowStart;
+	double mWindowStop;
 	class Frame3D frameFromStream();
+	void readBlockHeader();
 };
 
 typedef boost::shared_ptr<PositionStorageReader> PositionStorageReaderPtr;
@@ -93,7 +118,13 @@ public:
 	~PositionStorageWriter();
 	void write(Transform3D matrix, uint64_t timestamp, int toolIndex);
 	void write(Transform3D matrix, uint64_t timestamp, QString toolUid);
+	/** Write entries as one block, see PositionStorageReader::setTimeWindow().
+	 */
+	void writeBlock(const std::vector<PositionStorageEntry>& entries);
+	void flush();
 private:
+	void writeToolChange(QString toolUid);
+	void writePosition(Transform3D matrix, uint64_t timestamp);
 	QString mCurrentToolUid; ///< the tool currently being written.
 	QFile positions;
 	QDataStream stream;
@@ -19,20 +19,117 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "cxSpaceListenerImpl.h"
 #include "cxTool.h"
 #include "cxActiveData.h"
+#include "cxRegistrationTransform.h"
 
 
 namespace cx
 {
 
+bool SpaceProviderImpl::SpacePair::operator<(const SpacePair& rhs) const
+{
+	if (mFrom.mId != rhs.mFrom.mId)
+		return mFrom.mId < rhs.mFrom.mId;
+	if (mTo.mId != rhs.mTo.mId)
+		return mTo.mId < rhs.mTo.mId;
+	if (mFrom.mRefObject != rhs.mFrom.mRefObject)
+		return mFrom.mRefObject < rhs.mFrom.mRefObject;
+	return mTo.mRefObject < rhs.mTo.mRefObject;
+}
+
+bool SpaceProviderImpl::SpaceStamp::operator==(const SpaceStamp& rhs) const
+{
+	return (mObject.lock() == rhs.mObject.lock())
+			&& (mVersion == rhs.mVersion)
+			&& (mOffset == rhs.mOffset)
+			&& (mSpacing == rhs.mSpacing);
+}
+
 SpaceProviderImpl::SpaceProviderImpl(TrackingServicePtr trackingService, PatientModelServicePtr dataManager) :
 	mTrackingService(trackingService),
-	mDataManager(dataManager)
+	mDataManager(dataManager),
+	mCacheHits(0),
+	mCacheMisses(0)
 {
 //	connect(mTrackingService.get(), SIGNAL(stateChanged()), this, SIGNAL(spaceAddedOrRemoved()));
 	connect(mTrackingService.get(), &TrackingService::stateChanged, this, &SpaceProvider::spaceAddedOrRemoved);
 	connect(mDataManager.get(), &PatientModelService::dataAddedOrRemoved, this, &SpaceProvider::spaceAddedOrRemoved);
 }
 
+quint64 SpaceProviderImpl::getCacheHitCount() const
+{
+	QMutexLocker sentry(&mCacheMutex);
+	return mCacheHits;
+}
+
+quint64 SpaceProviderImpl::getCacheMissCount() const
+{
+	QMutexLocker sentry(&mCacheMutex);
+	return mCacheMisses;
+}
+
+/** Fill stamp with what the transform of space depends on.
+ *  Return false if the transform cannot be cached.
+ */
+bool SpaceProviderImpl::createStamp(CoordinateSystem space, SpaceStamp* stamp)
+{
+	switch(space.mId)
+	{
+	case csREF:
+	case csPATIENTREF:
+		return true;
+	case csDATA:
+	case csDATA_VOXEL:
+	{
+		if (!mDataManager->isPatientValid())
+			return false;
+		DataPtr data = this->findData(space.mRefObject);
+		if (!data)
+			return false;
+		stamp->mObject = data;
+		stamp->mVersion = data->get_rMd_History()->getVersion();
+		ImagePtr image = boost::dynamic_pointer_cast<Image>(data);
+		if ((space.mId == csDATA_VOXEL) && image)
+			stamp->mSpacing = Vector3D(image->getBaseVtkImageData()->GetSpacing());
+		return true;
+	}
+	case csTOOL:
+	case csTOOL_OFFSET:
+	{
+		ToolPtr tool = this->findTool(space.mRefObject);
+		// the timestamp is not enough: several moves can share a timestamp.
+		if (!tool || (tool->getChangeCount() < 0))
+			return false;
+		stamp->mObject = tool;
+		stamp->mVersion = tool->getChangeCount();
+		stamp->mOffset = tool->getTooltipOffset();
+		return true;
+	}
+	default: // sensor calibration changes are not versioned
+		return false;
+	};
+}
+
+int SpaceProviderImpl::get_rMprVersion()
+{
+	return mDataManager->get_rMpr_History()->getVersion();
+}
+
+DataPtr SpaceProviderImpl::findData(QString uid)
+{
+	DataPtr data = mDataManager->getData(uid);
+	if (!data && uid=="active")
+		data = mDataManager->getActiveData()->getActive<Image>();
+	return data;
+}
+
+ToolPtr SpaceProviderImpl::findTool(QString uid)
+{
+	ToolPtr tool = mTrackingService->getTool(uid);
+	if (!tool && uid=="active")
+		tool = mTrackingService->getActiveTool();
+	return tool;
+}
+
 SpaceListenerPtr SpaceProviderImpl::createListener()
 {
 	return SpaceListenerPtr(new SpaceListenerImpl(mTrackingService, mDataManager));
@@ -127,6 +224,35 @@ Transform3D SpaceProviderImpl::getActiveToolTipTransform(CoordinateSystem to, bo
 }
 
 Transform3D SpaceProviderImpl::get_toMfrom(CoordinateSystem from, CoordinateSystem to)
+{
+	CacheEntry current;
+	if (!this->createStamp(from, &current.mFrom) || !this->createStamp(to, &current.mTo))
+		return this->calculate_toMfrom(from, to);
+	current.m_rMprVersion = this->get_rMprVersion();
+
+	SpacePair key(from, to);
+	{
+		QMutexLocker sentry(&mCacheMutex);
+		TransformCache::iterator iter = mTransformCache.find(key);
+		if ((iter != mTransformCache.end())
+				&& (iter->second.m_rMprVersion == current.m_rMprVersion)
+				&& (iter->second.mFrom == current.mFrom)
+				&& (iter->second.mTo == current.mTo))
+		{
+			++mCacheHits;
+			return iter->second.m_toMfrom;
+		}
+		++mCacheMisses;
+	}
+
+	current.m_toMfrom = this->calculate_toMfrom(from, to);
+
+	QMutexLocker sentry(&mCacheMutex);
+	mTransformCache[key] = current;
+	return current.m_toMfrom;
+}
+
+Transform3D SpaceProviderImpl::calculate_toMfrom(CoordinateSystem from, CoordinateSystem to)
 {
 	Transform3D to_M_from = get_rMfrom(to).inv() * get_rMfrom(from);
 	return to_M_from;
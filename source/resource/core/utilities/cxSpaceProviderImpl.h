@@ -15,12 +15,24 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxSpaceProvider.h"
 #include "cxForwardDeclarations.h"
+#include <map>
+#include <QMutex>
+#include <boost/weak_ptr.hpp>
+#include "cxVector3D.h"
 
 namespace cx
 {
 
 /** Provides information about all the coordinate systems in the application.
  *
+ * Transforms returned by get_toMfrom() are cached per (from, to) pair.
+ * Each entry stores what the transform was computed from: the tool and its
+ * timestamp and offset, the data and its rMd version, the image spacing,
+ * and the rMpr version. The entry is used only if these are unchanged,
+ * thus the cache does not depend on the order of signals.
+ * Sensor spaces and tools without timestamps are not cached.
+ *
+ * get_toMfrom() is threadsafe.
  *
  * \ingroup cx_resource_core_utilities
  * \date 2014-02-21
@@ -49,7 +61,41 @@ public:
 	virtual CoordinateSystem getR(); ///<data references coordinate system
 	virtual CoordinateSystem convertToSpecific(CoordinateSystem space);
 
+	quint64 getCacheHitCount() const;
+	quint64 getCacheMissCount() const;
+
 private:
+	struct SpacePair
+	{
+		SpacePair(CoordinateSystem from, CoordinateSystem to) : mFrom(from), mTo(to) {}
+		bool operator<(const SpacePair& rhs) const;
+		CoordinateSystem mFrom;
+		CoordinateSystem mTo;
+	};
+	/** What the transform of a space was computed from. */
+	struct SpaceStamp
+	{
+		SpaceStamp() : mVersion(0), mOffset(0), mSpacing(0,0,0) {}
+		bool operator==(const SpaceStamp& rhs) const;
+		boost::weak_ptr<void> mObject; ///< the tool or data
+		int mVersion; ///< rMd version of data, or change count of tool
+		double mOffset; ///< tool offset
+		Vector3D mSpacing; ///< image spacing, for voxel spaces
+	};
+	struct CacheEntry
+	{
+		Transform3D m_toMfrom;
+		int m_rMprVersion;
+		SpaceStamp mFrom;
+		SpaceStamp mTo;
+	};
+	typedef std::map<SpacePair, CacheEntry> TransformCache;
+
+	bool createStamp(CoordinateSystem space, SpaceStamp* stamp);
+	int get_rMprVersion();
+	DataPtr findData(QString uid);
+	ToolPtr findTool(QString uid);
+	Transform3D calculate_toMfrom(CoordinateSystem from, CoordinateSystem to);
 	Transform3D get_rMfrom(CoordinateSystem from); ///< ref_M_from
 
 	Transform3D get_rMr(); ///< ref_M_ref
@@ -64,6 +110,11 @@ private:
 
 	TrackingServicePtr mTrackingService;
 	PatientModelServicePtr mDataManager;
+
+	mutable QMutex mCacheMutex; ///< protects the cache and counters
+	TransformCache mTransformCache;
+	quint64 mCacheHits;
+	quint64 mCacheMisses;
 };
 
 } // namespace cx
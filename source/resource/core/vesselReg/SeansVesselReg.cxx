@@ -25,19 +25,62 @@
 #include "vtkImageData.h"
 #include "vtkGeneralTransform.h"
 #include "vtkMath.h"
-#include "vtkSortDataArray.h"
 #include "vtkMaskPoints.h"
 #include "vtkPointData.h"
 #include "vtkLandmarkTransform.h"
-#include "vtkFloatArray.h"
+#include "vtkIdList.h"
 #include "cxMesh.h"
 #include "cxLogger.h"
+#include "cxPointKdTree.h"
+#include <algorithm>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <boost/bind.hpp>
 
 namespace cx
 {
 
+namespace
+{
+/** A range of source points, searched by one thread. */
+struct ClosestPointSlab
+{
+	ClosestPointSlab(int begin_, int end_) : begin(begin_), end(end_) {}
+	int begin;
+	int end;
+};
+
+void findClosestPointsInSlab(const PointKdTree* tree, const std::vector<Vector3D>* source,
+							 std::vector<Vector3D>* closest, std::vector<double>* residuals, const ClosestPointSlab& slab)
+{
+	for (int i = slab.begin; i < slab.end; ++i)
+	{
+		double distanceSquared = 0;
+		int index = tree->findClosestPoint((*source)[i], &distanceSquared);
+		(*closest)[i] = tree->getPoint(index);
+		(*residuals)[i] = distanceSquared;
+	}
+}
+
+/** Order point ids by residual, ties by id. */
+struct ResidualLess
+{
+	explicit ResidualLess(const std::vector<double>& residuals) : mResiduals(residuals) {}
+	bool operator()(int a, int b) const
+	{
+		if (mResiduals[a] != mResiduals[b])
+			return mResiduals[a] < mResiduals[b];
+		return a < b;
+	}
+	const std::vector<double>& mResiduals;
+};
+} // namespace
+
 SeansVesselReg::SeansVesselReg()// : mInvertedTransform(false)
 {
+	mClosestPointTime = 0;
+	mClosestPointSearches = 0;
 	mt_auto_lts = true;
 	mt_ltsRatio = 80;
 	mt_distanceDeltaStopThreshold = 0.001;
@@ -91,6 +134,8 @@ bool SeansVesselReg::execute()
 		std::cout << "single Point Threshold:" << mt_singlePointThreshold << endl;
 	}
 	QTime start = QTime::currentTime();
+	mClosestPointTime = 0;
+	mClosestPointSearches = 0;
 
 	ContextPtr context = mLastRun;
 
@@ -113,6 +158,11 @@ bool SeansVesselReg::execute()
 		this->performOneRegistration(context, false);
 	}
 
+	report(QString("Vessel registration: %1 closest point searches used %2 of %3 ms.")
+		   .arg(mClosestPointSearches)
+		   .arg(mClosestPointTime, 0, 'f', 0)
+		   .arg(start.msecsTo(QTime::currentTime())));
+
 	printOutResults(m_logPath + "/Vessel_Based_Registration_", context->mConcatenation);
 
 	if (mt_verbose)
@@ -193,6 +243,10 @@ void SeansVesselReg::linearRefine(ContextPtr context)
 	QDateTime t0 = QDateTime::currentDateTime();
 	for (int iteration = 1; iteration < mt_maximumNumberOfIterations && (t0.msecsTo(QDateTime::currentDateTime()) < mt_maximumDurationSeconds*1000); ++iteration)
 	{
+		QElapsedTimer iterationTimer;
+		iterationTimer.start();
+		double closestPointTime = mClosestPointTime;
+
 		this->performOneRegistration(context, true);
 		double difference = context->mMetric - previousMetric;
 
@@ -200,7 +254,11 @@ void SeansVesselReg::linearRefine(ContextPtr context)
 		{
 //			std::cout << myNumberOfIterations << " ";
 //			std::cout.flush();
-			std::cout << QString("iteration\t%1\trms:\t%2").arg(iteration).arg(context->mMetric) << std::endl;
+			std::cout << QString("iteration\t%1\trms:\t%2\ttime:\t%3ms\tclosest points:\t%4ms")
+						 .arg(iteration)
+						 .arg(context->mMetric)
+						 .arg(iterationTimer.elapsed())
+						 .arg(mClosestPointTime - closestPointTime, 0, 'f', 1) << std::endl;
 		}
 
 		// Check for convergence
@@ -223,6 +281,7 @@ SeansVesselReg::ContextPtr SeansVesselReg::splitContext(ContextPtr context)
 
 	// constant data: shallow copy
 	retval->mTargetPointLocator = context->mTargetPointLocator;
+	retval->mTargetKdTree = context->mTargetKdTree;
 	retval->mTargetPoints = context->mTargetPoints;
 
 	// will be modified: deep copy
@@ -287,10 +346,14 @@ SeansVesselReg::ContextPtr SeansVesselReg::createContext(DataPtr source, DataPtr
 
 	// Create locator for target points
 	context->mTargetPoints = targetPolyData;
-	context->mTargetPointLocator = vtkCellLocatorPtr::New();
-	context->mTargetPointLocator->SetDataSet(targetPolyData);
-	context->mTargetPointLocator->SetNumberOfCellsPerBucket(1);
-	context->mTargetPointLocator->BuildLocator();
+	context->mTargetKdTree = this->createKdTree(targetPolyData);
+	if (!context->mTargetKdTree)
+	{
+		context->mTargetPointLocator = vtkCellLocatorPtr::New();
+		context->mTargetPointLocator->SetDataSet(targetPolyData);
+		context->mTargetPointLocator->SetNumberOfCellsPerBucket(1);
+		context->mTargetPointLocator->BuildLocator();
+	}
 
 	//Since we are going to play with the data, we have to make a copy
 	context->mSourcePoints = vtkPointsPtr::New();
@@ -301,11 +364,81 @@ SeansVesselReg::ContextPtr SeansVesselReg::createContext(DataPtr source, DataPtr
 	return context;
 }
 
+/** Create a k-d tree of the vertices in target, or NULL if target
+ *  contains other cells: Then the closest point might be inside a cell.
+ */
+PointKdTreePtr SeansVesselReg::createKdTree(vtkPolyDataPtr target)
+{
+	if (target->GetNumberOfLines() || target->GetNumberOfPolys() || target->GetNumberOfStrips())
+		return PointKdTreePtr();
+
+	// only points used by a vertex, as in vtkCellLocator. Without cells, use all points.
+	std::vector<bool> used(target->GetNumberOfPoints(), target->GetNumberOfVerts()==0);
+	vtkCellArray* verts = target->GetVerts();
+	vtkIdListPtr ids = vtkIdListPtr::New();
+	verts->InitTraversal();
+	while (verts->GetNextCell(ids))
+		for (vtkIdType i = 0; i < ids->GetNumberOfIds(); ++i)
+			used[ids->GetId(i)] = true;
+
+	std::vector<Vector3D> points;
+	for (vtkIdType i = 0; i < target->GetNumberOfPoints(); ++i)
+		if (used[i])
+			points.push_back(Vector3D(target->GetPoint(i)));
+	if (points.empty())
+		return PointKdTreePtr();
+
+	return PointKdTreePtr(new PointKdTree(points));
+}
+
+/** Find the closest target point and squared distance for all source points.
+ */
+void SeansVesselReg::findClosestPoints(ContextPtr context, std::vector<Vector3D>* closest, std::vector<double>* residuals)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	int numPoints = context->mSourcePoints->GetNumberOfPoints();
+	closest->resize(numPoints);
+	residuals->resize(numPoints);
+
+	if (context->mTargetKdTree)
+	{
+		std::vector<Vector3D> source(numPoints);
+		for (int i = 0; i < numPoints; ++i)
+			context->mSourcePoints->GetPoint(i, source[i].data());
+
+		// the tree is read only: search from several threads
+		int count = std::max(1, std::min(numPoints/1024, QThread::idealThreadCount()));
+		std::vector<ClosestPointSlab> slabs;
+		for (int i = 0; i < count; ++i)
+			slabs.push_back(ClosestPointSlab(i*numPoints/count, (i+1)*numPoints/count));
+		QtConcurrent::blockingMap(slabs, boost::bind(&findClosestPointsInSlab, context->mTargetKdTree.get(), &source, closest, residuals, _1));
+	}
+	else
+	{
+		// vtkCellLocator is not threadsafe
+		for (int i = 0; i < numPoints; ++i)
+		{
+			vtkIdType cell_id;
+			int sub_id;
+			double distanceSquared = 0;
+			context->mTargetPointLocator->FindClosestPoint(context->mSourcePoints->GetPoint(i), (*closest)[i].data(), cell_id, sub_id, distanceSquared);
+			(*residuals)[i] = distanceSquared;
+		}
+	}
+
+	mClosestPointTime += timer.nsecsElapsed() / 1.0E6;
+	++mClosestPointSearches;
+}
+
 /**\brief Compute distances between the two datasets.
  *
  * The results will be added into the context: sorted source and target points,
  * and the metric.
  *
+ * Only the best mLtsRatio % of the points are used, they are selected
+ * with a partial sort and are not ordered internally.
  */
 void SeansVesselReg::computeDistances(ContextPtr context)
 {
@@ -323,30 +456,15 @@ void SeansVesselReg::computeDistances(ContextPtr context)
 	int nb_points = ((int) (numPoints * context->mLtsRatio) / 100);
 //	std::cout << QString("onestep %1/%2").arg(nb_points).arg(numPoints) << std::endl;
 
-	// - closestPoint is used so that the internal state of LandmarkTransform remains
-	//   correct whenever the iteration process is stopped (hence its source
-	//   and landmark points might be used in a vtkThinPlateSplineTransform).
-	vtkPointsPtr closestPoint = vtkPointsPtr::New();
-	closestPoint->SetNumberOfPoints(numPoints);
-
-	// Fill points with the closest points to each vertex in input
-	vtkFloatArrayPtr residuals = vtkFloatArrayPtr::New();
-	residuals->SetNumberOfValues(numPoints);
+	//Find closest points to all source points
+	std::vector<Vector3D> closest;
+	std::vector<double> residuals;
+	this->findClosestPoints(context, &closest, &residuals);
 
-	vtkIdListPtr IdList = vtkIdListPtr::New();
-	IdList->SetNumberOfIds(numPoints);
 	double total_distance = 0;
-	double distanceSquared = 0;
-	//Find closest points to all source points
 	for (int i = 0; i < numPoints; ++i)
 	{
-		//Check the distance to neighbouring points (neighbours should be matched to nearby points)
-		vtkIdType cell_id;
-		int sub_id;
-		double outPoint[3];
-		context->mTargetPointLocator->FindClosestPoint(context->mSourcePoints->GetPoint(i), outPoint, cell_id, sub_id, distanceSquared);
-		closestPoint->SetPoint(i, outPoint);
-		if ((boost::math::isnan)(distanceSquared))
+		if ((boost::math::isnan)(residuals[i]))
 		{
 			std::cout << "nan found during findClosestPoint!" << std::endl;
 			{
@@ -354,18 +472,27 @@ void SeansVesselReg::computeDistances(ContextPtr context)
 				return;
 			}
 		}
-		residuals->InsertValue(i, distanceSquared);
-		IdList->InsertId(i, i);
-		total_distance += sqrt(distanceSquared);
+		total_distance += sqrt(residuals[i]);
 	}
 
 	// quality of the current iteration
 	context->mMetric = total_distance / numPoints;
 
-	vtkSortDataArrayPtr sort = vtkSortDataArrayPtr::New();
-	sort->Sort(residuals, IdList);
-	context->mSortedSourcePoints = this->createSortedPoints(IdList, context->mSourcePoints, nb_points);
-	context->mSortedTargetPoints = this->createSortedPoints(IdList, closestPoint, nb_points);
+	// - closestPoint is used so that the internal state of LandmarkTransform remains
+	//   correct whenever the iteration process is stopped (hence its source
+	//   and landmark points might be used in a vtkThinPlateSplineTransform).
+	vtkPointsPtr closestPoint = vtkPointsPtr::New();
+	closestPoint->SetNumberOfPoints(numPoints);
+	for (int i = 0; i < numPoints; ++i)
+		closestPoint->SetPoint(i, closest[i].data());
+
+	std::vector<int> ids(numPoints);
+	for (int i = 0; i < numPoints; ++i)
+		ids[i] = i;
+	std::nth_element(ids.begin(), ids.begin()+nb_points, ids.end(), ResidualLess(residuals));
+
+	context->mSortedSourcePoints = this->createSortedPoints(ids, context->mSourcePoints, nb_points);
+	context->mSortedTargetPoints = this->createSortedPoints(ids, closestPoint, nb_points);
 }
 
 /**\brief Register the source points to the target point in a single ste.
@@ -414,7 +541,7 @@ void SeansVesselReg::performOneRegistration(ContextPtr context, bool linear)
  * based on the numPoint first of unsortedPoints.
  *
  */
-vtkPointsPtr SeansVesselReg::createSortedPoints(vtkIdListPtr sortedIDList, vtkPointsPtr unsortedPoints, int numPoints)
+vtkPointsPtr SeansVesselReg::createSortedPoints(const std::vector<int>& sortedIDList, vtkPointsPtr unsortedPoints, int numPoints)
 {
 	vtkPointsPtr retval = vtkPointsPtr::New();
 	retval->SetNumberOfPoints(numPoints);
@@ -423,7 +550,7 @@ vtkPointsPtr SeansVesselReg::createSortedPoints(vtkIdListPtr sortedIDList, vtkPo
 
 	for (int i = 0; i < numPoints; ++i)
 	{
-		vtkIdType index = sortedIDList->GetId(i);
+		vtkIdType index = sortedIDList[i];
 		unsortedPoints->GetPoint(index, temp_point); // source points to use in tps
 		retval->SetPoint(i, temp_point);
 	}
@@ -7,9 +7,12 @@
 #include "vtkForwardDeclarations.h"
 #include "cxTransform3D.h"
 #include "vtkSmartPointer.h"
+#include <vector>
 
 namespace cx
 {
+typedef boost::shared_ptr<class PointKdTree> PointKdTreePtr;
+
 /** Vessel - vessel registration algorithm.
  *
  * Input is two centerline representations of vessel trees.
@@ -17,6 +20,8 @@ namespace cx
  *
  * Basic usage: Run execute(), then get result with getLinearTransform()
  *
+ * If the target only contains vertices, the closest points are found in a
+ * k-d tree using several threads, otherwise with a vtkCellLocator.
  *
  * \ingroup cx_resource_core_utilities
  * \date Feb 4, 2011
@@ -35,7 +40,8 @@ public:
 	 */
 	struct cxResource_EXPORT Context
 	{
-		vtkCellLocatorPtr mTargetPointLocator; ///< input: target data wrapped in a locator
+		vtkCellLocatorPtr mTargetPointLocator; ///< input: target data wrapped in a locator, used if mTargetKdTree is not set
+		PointKdTreePtr mTargetKdTree; ///< input: target vertices, if the target only contains vertices
 		vtkPolyDataPtr mTargetPoints; ///< input: target data
 		vtkPointsPtr mSourcePoints; ///< input: current source data, modified according to last iteration
 
@@ -113,6 +119,11 @@ public:
 		double p_BoundingBox[6]);
 private:
 	Transform3D getLinearTransform(vtkGeneralTransformPtr concatenation);
+	void findClosestPoints(ContextPtr context, std::vector<Vector3D>* closest, std::vector<double>* residuals);
+	static PointKdTreePtr createKdTree(vtkPolyDataPtr target);
+
+	double mClosestPointTime; ///< ms spent in findClosestPoints() since the last reset
+	int mClosestPointSearches;
 
 protected:
 	bool runAlgorithm(ContextPtr context, vtkGeneralTransformPtr myConcatenation, int largeSteps, double fraction);
@@ -121,7 +132,7 @@ protected:
 	vtkAbstractTransformPtr nonLinearRegistration(vtkPointsPtr sortedSourcePoints, vtkPointsPtr sortedTargetPoints);
 	vtkPolyDataPtr convertToPolyData(DataPtr data, QString id);
 	vtkPointsPtr transformPoints(vtkPointsPtr input, vtkAbstractTransformPtr transform);
-	vtkPointsPtr createSortedPoints(vtkIdListPtr sortedIDList, vtkPointsPtr unsortedPoints, int numPoints);
+	vtkPointsPtr createSortedPoints(const std::vector<int>& sortedIDList, vtkPointsPtr unsortedPoints, int numPoints);
 	vtkPolyDataPtr crop(vtkPolyDataPtr input, vtkPolyDataPtr fixed, double margin);
 	ContextPtr linearRefineAllLTS(ContextPtr context);
 	void linearRefine(ContextPtr context);
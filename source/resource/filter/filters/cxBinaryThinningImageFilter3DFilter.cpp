@@ -143,17 +143,8 @@ bool BinaryThinningImageFilter3DFilter::execute()
 	centerlineFilterType::Pointer centerlineFilter = centerlineFilterType::New();
 	centerlineFilter->SetInput(itkImage);
 	centerlineFilter->Update();
-	itkImage = centerlineFilter->GetOutput();
 
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(itkImage);
-	itkToVtkFilter->Update();
-
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-
-	mRawResult =  rawResult;
+	mRawResult = AlgorithmHelper::getVTKFromITK(centerlineFilter->GetOutput());
 	return true;
 }
 
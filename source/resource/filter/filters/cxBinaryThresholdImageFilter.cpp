@@ -13,7 +13,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxAlgorithmHelpers.h"
 #include <itkBinaryThresholdImageFilter.h>
-#include <vtkImageCast.h>
 #include "cxUtilHelpers.h"
 #include "cxRegistrationTransform.h"
 #include "cxStringProperty.h"
@@ -33,6 +32,32 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
+namespace
+{
+template<class TPixel>
+vtkImageDataPtr binaryThreshold(vtkImageDataPtr input, double lower, double upper)
+{
+	typedef itk::Image<TPixel, Dimension> ImageType;
+	typedef itk::Image<unsigned char, Dimension> MaskType;
+	typename ImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromVTKImage<TPixel>(input);
+	if (!itkImage)
+		return vtkImageDataPtr();
+
+	//Binary Thresholding
+	typedef itk::BinaryThresholdImageFilter<ImageType, MaskType> thresholdFilterType;
+	typename thresholdFilterType::Pointer thresholdFilter = thresholdFilterType::New();
+	thresholdFilter->InPlaceOff(); // itkImage shares the buffer of input
+	thresholdFilter->SetInput(itkImage);
+	thresholdFilter->SetOutsideValue(0);
+	thresholdFilter->SetInsideValue(1);
+	thresholdFilter->SetLowerThreshold(AlgorithmHelper::convertToPixelValue<TPixel>(lower));
+	thresholdFilter->SetUpperThreshold(AlgorithmHelper::convertToPixelValue<TPixel>(upper));
+	thresholdFilter->Update();
+
+	return AlgorithmHelper::getVTKFromITK<unsigned char>(thresholdFilter->GetOutput());
+}
+} // namespace
+
 BinaryThresholdImageFilter::BinaryThresholdImageFilter(VisServicesPtr services) :
 	FilterImpl(services)
 {
@@ -167,34 +192,12 @@ bool BinaryThresholdImageFilter::execute()
 	DoublePairPropertyPtr thresholds = this->getThresholdOption(mCopiedOptions);
 	BoolPropertyPtr generateSurface = this->getGenerateSurfaceOption(mCopiedOptions);
 
-	itkImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromSSCImage(input);
-
-	//Binary Thresholding
-	typedef itk::BinaryThresholdImageFilter<itkImageType, itkImageType> thresholdFilterType;
-	thresholdFilterType::Pointer thresholdFilter = thresholdFilterType::New();
-	thresholdFilter->SetInput(itkImage);
-	thresholdFilter->SetOutsideValue(0);
-	thresholdFilter->SetInsideValue(1);
-	thresholdFilter->SetLowerThreshold(thresholds->getValue()[0]);
-	thresholdFilter->SetUpperThreshold(thresholds->getValue()[1]);
-	thresholdFilter->Update();
-	itkImage = thresholdFilter->GetOutput();
-
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(itkImage);
-	itkToVtkFilter->Update();
-
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-
-	vtkImageCastPtr imageCast = vtkImageCastPtr::New();
-	imageCast->SetInputData(rawResult);
-	imageCast->SetOutputScalarTypeToUnsignedChar();
-	imageCast->Update();
-	rawResult = imageCast->GetOutput();
-
-	// TODO: possible memory problem here - check debug mem system of itk/vtk
+	vtkImageDataPtr image = input->getBaseVtkImageData();
+	Eigen::Vector2d range = thresholds->getValue();
+	vtkImageDataPtr rawResult;
+	cxItkPixelTypeMacro(image->GetScalarType(), rawResult = binaryThreshold<CX_TT>(image, range[0], range[1]));
+	if (!rawResult)
+		return false;
 
 	mRawResult =  rawResult;
 
@@ -139,18 +139,7 @@ vtkImageDataPtr ConnectedThresholdImageFilter::calculate()
 		reportError(qstring_cast(excep.GetDescription()));
 	}
 
-	itkImage = thresholdFilter->GetOutput();
-
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(itkImage);
-	itkToVtkFilter->Update();
-
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-	// TODO: possible memory problem here - check debug mem system of itk/vtk
-
-	return rawResult;
+	return AlgorithmHelper::getVTKFromITK(thresholdFilter->GetOutput());
 }
 
 }
@@ -20,7 +20,6 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <itkBinaryDilateImageFilter.h>
 #include <itkBinaryBallStructuringElement.h>
 #include "cxAlgorithmHelpers.h"
-#include <vtkImageCast.h>
 #include "cxUtilHelpers.h"
 #include "cxContourFilter.h"
 #include "cxMesh.h"
@@ -32,6 +31,37 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 namespace cx {
 
+namespace
+{
+/** Dilate the voxels with value 1, keeping the pixel type of input
+ *  so that no labels are wrapped by a cast.
+ */
+template<class TPixel>
+vtkImageDataPtr dilate(vtkImageDataPtr input, itk::Size<3> radiusInVoxels)
+{
+	typedef itk::Image<TPixel, Dimension> ImageType;
+	typename ImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromVTKImage<TPixel>(input);
+	if (!itkImage)
+		return vtkImageDataPtr();
+
+	// Create structuring element
+	typedef itk::BinaryBallStructuringElement<TPixel,3> StructuringElementType;
+	StructuringElementType structuringElement;
+	structuringElement.SetRadius(radiusInVoxels);
+	structuringElement.CreateStructuringElement();
+
+	// Dilation
+	typedef itk::BinaryDilateImageFilter<ImageType, ImageType, StructuringElementType> dilateFilterType;
+	typename dilateFilterType::Pointer dilationFilter = dilateFilterType::New();
+	dilationFilter->SetInput(itkImage);
+	dilationFilter->SetKernel(structuringElement);
+	dilationFilter->SetDilateValue(1);
+	dilationFilter->Update();
+
+	return AlgorithmHelper::getVTKFromITK<TPixel>(dilationFilter->GetOutput());
+}
+} // namespace
+
 DilationFilter::DilationFilter(VisServicesPtr services) :
 	FilterImpl(services)
 {
@@ -132,40 +162,13 @@ bool DilationFilter::execute() {
 	radiusInVoxels[1] = radius/spacing(1);
 	radiusInVoxels[2] = radius/spacing(2);
 
-	itkImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromSSCImage(input);
-
-	// Create structuring element
-	typedef itk::BinaryBallStructuringElement<unsigned char,3> StructuringElementType;
-    StructuringElementType structuringElement;
-    structuringElement.SetRadius(radiusInVoxels);
-    structuringElement.CreateStructuringElement();
-
-	// Dilation
-	typedef itk::BinaryDilateImageFilter<itkImageType, itkImageType, StructuringElementType> dilateFilterType;
-	dilateFilterType::Pointer dilationFilter = dilateFilterType::New();
-	dilationFilter->SetInput(itkImage);
-	dilationFilter->SetKernel(structuringElement);
-	dilationFilter->SetDilateValue(1);
-	dilationFilter->Update();
-	itkImage = dilationFilter->GetOutput();
-
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(itkImage);
-	itkToVtkFilter->Update();
-
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-
-	vtkImageCastPtr imageCast = vtkImageCastPtr::New();
-	imageCast->SetInputData(rawResult);
-	imageCast->SetOutputScalarTypeToUnsignedChar();
-	imageCast->Update();
-	rawResult = imageCast->GetOutput();
-
-	// TODO: possible memory problem here - check debug mem system of itk/vtk
+	vtkImageDataPtr image = input->getBaseVtkImageData();
+	vtkImageDataPtr rawResult;
+	cxItkPixelTypeMacro(image->GetScalarType(), rawResult = dilate<CX_TT>(image, radiusInVoxels));
+	if (!rawResult)
+		return false;
 
-	mRawResult =  rawResult;
+	mRawResult = rawResult;
 
 	BoolPropertyPtr generateSurface = this->getGenerateSurfaceOption(mCopiedOptions);
 	if (generateSurface->getValue())
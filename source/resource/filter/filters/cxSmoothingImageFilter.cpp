@@ -30,6 +30,27 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 namespace cx
 {
 
+namespace
+{
+template<class TPixel>
+vtkImageDataPtr smooth(vtkImageDataPtr input, double sigma)
+{
+	typedef itk::Image<TPixel, Dimension> ImageType;
+	typename ImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromVTKImage<TPixel>(input);
+	if (!itkImage)
+		return vtkImageDataPtr();
+
+	typedef itk::SmoothingRecursiveGaussianImageFilter<ImageType, ImageType> smoothingFilterType;
+	typename smoothingFilterType::Pointer smoohingFilter = smoothingFilterType::New();
+	smoohingFilter->InPlaceOff(); // itkImage shares the buffer of input
+	smoohingFilter->SetSigma(sigma);
+	smoohingFilter->SetInput(itkImage);
+	smoohingFilter->Update();
+
+	return AlgorithmHelper::getVTKFromITK<TPixel>(smoohingFilter->GetOutput());
+}
+} // namespace
+
 SmoothingImageFilter::SmoothingImageFilter(VisServicesPtr services) :
 	FilterImpl(services)
 {
@@ -96,23 +117,11 @@ bool SmoothingImageFilter::execute()
 
 	DoublePropertyPtr sigma = this->getSigma(mCopiedOptions);
 
-	itkImageType::ConstPointer itkImage = AlgorithmHelper::getITKfromSSCImage(input);
-
-	typedef itk::SmoothingRecursiveGaussianImageFilter<itkImageType, itkImageType> smoothingFilterType;
-	smoothingFilterType::Pointer smoohingFilter = smoothingFilterType::New();
-	smoohingFilter->SetSigma(sigma->getValue());
-	smoohingFilter->SetInput(itkImage);
-	smoohingFilter->Update();
-	itkImage = smoohingFilter->GetOutput();
-
-	//Convert ITK to VTK
-	itkToVtkFilterType::Pointer itkToVtkFilter = itkToVtkFilterType::New();
-	itkToVtkFilter->SetInput(itkImage);
-	itkToVtkFilter->Update();
-
-	vtkImageDataPtr rawResult = vtkImageDataPtr::New();
-	rawResult->DeepCopy(itkToVtkFilter->GetOutput());
-	// TODO: possible memory problem here - check debug mem system of itk/vtk
+	vtkImageDataPtr image = input->getBaseVtkImageData();
+	vtkImageDataPtr rawResult;
+	cxItkPixelTypeMacro(image->GetScalarType(), rawResult = smooth<CX_TT>(image, sigma->getValue()));
+	if (!rawResult)
+		return false;
 
 	mRawResult =  rawResult;
 	return true;
@@ -0,0 +1,110 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+                 
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+                 
+CustusX is released under a BSD 3-Clause license.
+                 
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <vector>
+#include <vtkImageData.h>
+#include "cxBinaryThresholdImageFilter.h"
+#include "cxSmoothingImageFilter.h"
+#include "cxSelectDataStringProperty.h"
+#include "cxDoubleProperty.h"
+#include "cxBoolProperty.h"
+#include "cxImage.h"
+#include "cxVolumeHelpers.h"
+#include "cxAlgorithmHelpers.h"
+#include "cxtestVisServices.h"
+#include "cxtestPatientModelServiceMock.h"
+
+namespace
+{
+/** Unsigned char image, thus the ITK filters get the shared buffer.
+ */
+cx::ImagePtr createUnsignedCharImage()
+{
+	vtkImageDataPtr raw = cx::generateVtkImageData(Eigen::Array3i(10,8,6), cx::Vector3D(1,1,1), 0);
+	unsigned char* ptr = static_cast<unsigned char*>(raw->GetScalarPointer());
+	for (vtkIdType i=0; i<raw->GetNumberOfPoints(); ++i)
+		ptr[i] = i%100;
+	return cx::ImagePtr(new cx::Image("input_uchar", raw));
+}
+
+std::vector<unsigned char> getVoxels(cx::ImagePtr image)
+{
+	vtkImageDataPtr raw = image->getBaseVtkImageData();
+	unsigned char* ptr = static_cast<unsigned char*>(raw->GetScalarPointer());
+	return std::vector<unsigned char>(ptr, ptr+raw->GetNumberOfPoints());
+}
+
+cx::PropertyPtr getOption(cx::FilterPtr filter, QString uid)
+{
+	std::vector<cx::PropertyPtr> options = filter->getOptions();
+	for (unsigned i=0; i<options.size(); ++i)
+		if (options[i]->getUid() == uid)
+			return options[i];
+	return cx::PropertyPtr();
+}
+
+void executeOn(cx::FilterPtr filter, cx::ImagePtr input)
+{
+	std::vector<cx::SelectDataStringPropertyBasePtr> inputTypes = filter->getInputTypes();
+	REQUIRE(inputTypes.size() == 1);
+	REQUIRE(inputTypes[0]->setValue(input->getUid()));
+	REQUIRE(filter->preProcess());
+	REQUIRE(filter->execute());
+}
+} // namespace
+
+TEST_CASE("BinaryThresholdImageFilter: unsigned char input is unchanged by execute", "[unit]")
+{
+	cxtest::TestVisServicesPtr services = cxtest::TestVisServices::create();
+	cx::ImagePtr input = createUnsignedCharImage();
+	boost::dynamic_pointer_cast<cxtest::PatientModelServiceMock>(services->patient())->insertData(input);
+	std::vector<unsigned char> before = getVoxels(input);
+
+	cx::FilterPtr filter(new cx::BinaryThresholdImageFilter(services));
+	filter->getOutputTypes();
+	cx::BoolPropertyPtr generateSurface = boost::dynamic_pointer_cast<cx::BoolProperty>(getOption(filter, "Generate Surface"));
+	REQUIRE(generateSurface);
+	generateSurface->setValue(false);
+
+	executeOn(filter, input);
+
+	CHECK(getVoxels(input) == before);
+}
+
+TEST_CASE("SmoothingImageFilter: unsigned char input is unchanged by execute", "[unit]")
+{
+	cxtest::TestVisServicesPtr services = cxtest::TestVisServices::create();
+	cx::ImagePtr input = createUnsignedCharImage();
+	boost::dynamic_pointer_cast<cxtest::PatientModelServiceMock>(services->patient())->insertData(input);
+	std::vector<unsigned char> before = getVoxels(input);
+
+	cx::FilterPtr filter(new cx::SmoothingImageFilter(services));
+	filter->getOutputTypes();
+	cx::DoublePropertyPtr sigma = boost::dynamic_pointer_cast<cx::DoubleProperty>(getOption(filter, "Smoothing sigma"));
+	REQUIRE(sigma);
+	sigma->setValue(2.0);
+
+	executeOn(filter, input);
+
+	CHECK(getVoxels(input) == before);
+}
+
+TEST_CASE("AlgorithmHelper: unsigned char input is unchanged by grayscale fillhole", "[unit]")
+{
+	cx::ImagePtr input = createUnsignedCharImage();
+	std::vector<unsigned char> before = getVoxels(input);
+
+	vtkImageDataPtr output = cx::AlgorithmHelper::execute_itk_GrayscaleFillholeImageFilter(input->getBaseVtkImageData());
+	REQUIRE(output);
+
+	CHECK(getVoxels(input) == before);
+}
@@ -134,6 +134,7 @@ ImageStreamerOpenCV::ImageStreamerOpenCV()
 {
 	mGrabbing = false;
 	mAvailableImage = false;
+	mFramePool.reset(new VideoFramePool());
 	setSendInterval(40);
 
 #ifdef CX_USE_OpenCV
@@ -409,12 +410,8 @@ ImagePtr ImageStreamerOpenCV::getImageMessage()
 
 vtkImageDataPtr ImageStreamerOpenCV::convertTovtkImageData(cv::Mat& frame)
 {
-	vtkImageDataPtr retval = vtkImageDataPtr::New();
-
 	Eigen::Array3i dim(frame.cols, frame.rows, 1);
 //	Eigen::Array3f spacing(1,1);
-	retval->SetDimensions(dim.data());
-	retval->SetSpacing(1,1,1);
 
 	int dataType = -1;
 
@@ -442,7 +439,7 @@ vtkImageDataPtr ImageStreamerOpenCV::convertTovtkImageData(cv::Mat& frame)
 		return vtkImageDataPtr();
 	}
 
-	retval->AllocateScalars(dataType, frame.channels());
+	vtkImageDataPtr retval = mFramePool->get(dim, dataType, frame.channels());
 
 	//------------------------------------------------------------
 	// Create a new IMAGE type message
@@ -24,6 +24,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <QStringList>
 #include "cxSender.h"
 #include "cxStreamer.h"
+#include "cxVideoFramePool.h"
 
 class QDomElement;
 
@@ -102,6 +103,7 @@ private:
 	QSize mRescaleSize;
 
 	VideoCapturePtr mVideoCapture; // OpenCV video grabber
+	VideoFramePoolPtr mFramePool;
 	QDateTime mLastGrabTime;
 	bool mAvailableImage;
 	bool mGrabbing;
@@ -165,6 +165,7 @@ ImageTestData ImageTestData::initializePrimaryData(vtkImageDataPtr source, QStri
 	retval.mRawUid = QString("%1 [%2]").arg(QFileInfo(filename).completeBaseName()).arg(colorFormat);
 	retval.mDataSource.reset(new SplitFramesContainer(retval.mImageData));
 	retval.mCurrentFrame = 0;
+	retval.mFramePool.reset(new VideoFramePool());
 	return retval;
 }
 
@@ -195,6 +196,7 @@ ImageTestData ImageTestData::initializeSecondaryData(vtkImageDataPtr source, QSt
 	retval.mRawUid = QString("uchar %1[%2]").arg(QFileInfo(filename).completeBaseName()).arg(colorFormat);
 	retval.mDataSource.reset(new SplitFramesContainer(retval.mImageData));
 	retval.mCurrentFrame = 0;
+	retval.mFramePool.reset(new VideoFramePool());
 	return retval;
 }
 
@@ -204,8 +206,7 @@ PackagePtr ImageTestData::createPackage(ImageTestData* data)
 
 	int frame = (data->mCurrentFrame++) % data->mDataSource->size();
 	QString uid = data->mRawUid;
-	vtkImageDataPtr copy = vtkImageDataPtr::New();
-	copy->DeepCopy(data->mDataSource->get(frame));
+	vtkImageDataPtr copy = data->mFramePool->copy(data->mDataSource->get(frame));
 	ImagePtr image(new Image(uid, copy));
 	image->setAcquisitionTime(QDateTime::currentDateTime());
 	package->mImage = image;
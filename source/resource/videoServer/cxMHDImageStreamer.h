@@ -17,6 +17,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include "boost/shared_ptr.hpp"
 #include "cxStreamer.h"
 #include "cxForwardDeclarations.h"
+#include "cxVideoFramePool.h"
 
 class QTimer;
 class QDomElement;
@@ -50,6 +51,7 @@ public:
 	boost::shared_ptr<class SplitFramesContainer> mDataSource;
 	int mCurrentFrame;
 	QString mRawUid;
+	VideoFramePoolPtr mFramePool;
 };
 typedef boost::shared_ptr<class ImageTestData> ImageTestDataPtr;
 
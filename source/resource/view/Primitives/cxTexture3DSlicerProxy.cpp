@@ -20,10 +20,12 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkImageData.h>
 #include <vtkLookupTable.h>
 #include <vtkOpenGLRenderWindow.h>
+#include <vtkDataArray.h>
 
 #include <vtkOpenGLPolyDataMapper.h>
 
 #include "cxImage.h"
+#include "cxUnsignedDerivedImage.h"
 #include "cxView.h"
 #include "cxImageLUT2D.h"
 #include "cxSliceProxy.h"
@@ -407,6 +409,29 @@ std::vector<ImagePtr> Texture3DSlicerProxyImpl::convertToUnsigned(std::vector<Im
 	return images;
 }
 
+/**
+ * The image data describing the geometry of image. For unsigned views,
+ * this is the base data: The unsigned voxels are only created on upload.
+ */
+vtkImageDataPtr Texture3DSlicerProxyImpl::getGeometry(ImagePtr image) const
+{
+	UnsignedDerivedImagePtr unsignedView = boost::dynamic_pointer_cast<UnsignedDerivedImage>(image);
+	if (unsignedView && unsignedView->getBase())
+		return unsignedView->getBase()->getBaseVtkImageData();
+	return image->getBaseVtkImageData();
+}
+
+/**
+ * The max value of the scalar type uploaded to the texture.
+ */
+double Texture3DSlicerProxyImpl::getScalarTypeMax(ImagePtr image) const
+{
+	UnsignedDerivedImagePtr unsignedView = boost::dynamic_pointer_cast<UnsignedDerivedImage>(image);
+	if (unsignedView)
+		return vtkDataArray::GetDataTypeMax(unsignedView->getUnsignedScalarType());
+	return image->getBaseVtkImageData()->GetScalarTypeMax();
+}
+
 
 void Texture3DSlicerProxyImpl::setSliceProxy(SliceProxyPtr slicer)
 {
@@ -504,7 +529,7 @@ void Texture3DSlicerProxyImpl::updateAndUploadCoordinates()
 	{
 
 		ImagePtr image = mImages[i];
-		vtkImageDataPtr volume = image->getBaseVtkImageData();
+		vtkImageDataPtr volume = this->getGeometry(image);
 
 		// create a bb describing the volume in physical (raw data) space
 		Vector3D origin(volume->GetOrigin());
@@ -594,7 +619,6 @@ void Texture3DSlicerProxyImpl::updateAndUploadColorAttribute()
 		ImagePtr image = mImages[i];
 		QString imageUid = image->getUid();
 
-		vtkImageDataPtr inputImage = image->getBaseVtkImageData() ;
 		vtkLookupTablePtr lut = image->getLookupTable2D()->getOutputLookupTable();
 
 		//TODO this is a HACK
@@ -605,7 +629,7 @@ void Texture3DSlicerProxyImpl::updateAndUploadColorAttribute()
 		//lut->GetTable()->Modified();
 
 		//Generate window, level, llr, alpha
-		int scalarTypeMax = (int)inputImage->GetScalarTypeMax();
+		int scalarTypeMax = (int)this->getScalarTypeMax(image);
 		double imin = lut->GetRange()[0];
 		double imax = lut->GetRange()[1];
 		float window = (float) (imax-imin) / scalarTypeMax;
@@ -136,6 +136,8 @@ private:
 	QString getTCoordName(int index);
 	void setColorAttributes(int i);
 	std::vector<ImagePtr> convertToUnsigned(std::vector<ImagePtr> images_raw);
+	vtkImageDataPtr getGeometry(ImagePtr image) const;
+	double getScalarTypeMax(ImagePtr image) const;
 
 	bool isNewInputImages(std::vector<ImagePtr> images_raw);
 
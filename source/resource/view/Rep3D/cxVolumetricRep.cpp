@@ -29,6 +29,7 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 
 #include "cxView.h"
 #include "cxImage.h"
+#include "cxImagePyramid.h"
 #include "cxImageTF3D.h"
 #include "cxSlicePlaneClipper.h"
 #include "cxTypeConversions.h"
@@ -108,6 +109,7 @@ void VolumetricRep::setImage(ImagePtr image)
 		disconnect(mImage.get(), &Image::vtkImageDataChanged, this, &VolumetricRep::vtkImageDataChangedSlot);
 		disconnect(mImage.get(), &Image::transformChanged, this, &VolumetricRep::transformChangedSlot);
 		mMonitor.reset();
+		this->setPyramid(ImagePyramidPtr());
 		mMapper->SetInputData( (vtkImageData*)NULL );
 	}
 
@@ -153,8 +155,25 @@ void VolumetricRep::updateVtkImageDataSlot()
 	if (!mImage)
 		return;
 
-	vtkImageDataPtr volume = mImage->resample(this->mMaxVoxels);
+	// Use the pyramid level fitting mMaxVoxels. If not built yet, show a coarser
+	// level or the full volume, and update when the level is ready.
+	this->setPyramid(mImage->getPyramid());
+	vtkImageDataPtr volume = mPyramid->getLevelFor(this->mMaxVoxels);
+	if (volume == mMapper->GetInput())
+		return;
 	mMapper->SetInputData(volume);
+	mVolume->SetVisibility(volume ? 1 : 0);
+}
+
+void VolumetricRep::setPyramid(ImagePyramidPtr pyramid)
+{
+	if (pyramid == mPyramid)
+		return;
+	if (mPyramid)
+		disconnect(mPyramid.get(), &ImagePyramid::levelReady, this, &VolumetricRep::updateVtkImageDataSlot);
+	mPyramid = pyramid;
+	if (mPyramid)
+		connect(mPyramid.get(), &ImagePyramid::levelReady, this, &VolumetricRep::updateVtkImageDataSlot);
 }
 
 void VolumetricRep::setMaxVolumeSize(long maxVoxels)
@@ -25,6 +25,7 @@ namespace cx
 {
 	typedef boost::shared_ptr<class VolumeProperty> VolumePropertyPtr;
 	typedef boost::shared_ptr<class ImageMapperMonitor> ImageMapperMonitorPtr;
+	typedef boost::shared_ptr<class ImagePyramid> ImagePyramidPtr;
 }
 
 namespace cx
@@ -86,6 +87,7 @@ protected:
 	VolumetricRep();
 	virtual void addRepActorsToViewRenderer(ViewPtr view);
 	virtual void removeRepActorsFromViewRenderer(ViewPtr view);
+	void setPyramid(ImagePyramidPtr pyramid);
 
 	cx::VolumePropertyPtr mVolumeProperty;
 	vtkVolumeMapperPtr mMapper;
@@ -93,6 +95,7 @@ protected:
 	long mMaxVoxels; ///< always resample volume below this size.
 
 	ImagePtr mImage;
+	ImagePyramidPtr mPyramid; ///< source of downsampled volumes
 	cx::ImageMapperMonitorPtr mMonitor; ///< helper object for visualizing clipping/cropping
 
 protected slots:
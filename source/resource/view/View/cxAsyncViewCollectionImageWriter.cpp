@@ -0,0 +1,172 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#include "cxAsyncViewCollectionImageWriter.h"
+
+#include <algorithm>
+#include <QtConcurrent>
+#include <QTimer>
+#include "vtkImageData.h"
+#include "vtkRenderer.h"
+#include "cxView.h"
+#include "cxViewCollectionWidget.h"
+#include "cxViewCollectionImageWriter.h"
+#include "cxVolumeHelpers.h"
+
+namespace cx
+{
+
+AsyncViewCollectionImageWriter::AsyncViewCollectionImageWriter(ViewCollectionWidget* widget) :
+	mWidget(widget),
+	mHasQueued(false)
+{
+	// collect the last render if no new render arrives to push it through
+	mFlushTimer = new QTimer(this);
+	mFlushTimer->setSingleShot(true);
+	mFlushTimer->setInterval(50);
+	connect(mFlushTimer, SIGNAL(timeout()), this, SLOT(onFlush()));
+
+	connect(&mWatcher, SIGNAL(finished()), this, SLOT(onAssembled()));
+}
+
+AsyncViewCollectionImageWriter::~AsyncViewCollectionImageWriter()
+{
+	mWatcher.waitForFinished();
+}
+
+vtkImageDataPtr AsyncViewCollectionImageWriter::getImage() const
+{
+	return mImage;
+}
+
+QDateTime AsyncViewCollectionImageWriter::getImageTime() const
+{
+	return mImageTime;
+}
+
+void AsyncViewCollectionImageWriter::requestGrab()
+{
+	if (!mWidget)
+		return;
+
+	Frame previous;
+	previous.size = mPendingSize;
+	previous.time = mPendingTime;
+
+	ViewCollectionImageWriter geometry(mWidget);
+	std::vector<ViewPtr> views = mWidget->getViews();
+	std::map<QString, PixelBufferReadbackPtr> readbacks;
+	for (unsigned i=0; i<views.size(); ++i)
+	{
+		QString uid = views[i]->getUid();
+		PixelBufferReadbackPtr readback = mReadbacks[uid];
+		if (!readback)
+			readback.reset(new PixelBufferReadback(views[i]->getRenderWindow()));
+		readbacks[uid] = readback;
+
+		vtkRendererPtr renderer = views[i]->getRenderer();
+		Eigen::Array2i origin(renderer->GetOrigin());
+		Eigen::Array2i size(renderer->GetSize());
+		QRect region(origin[0], origin[1], size[0], size[1]);
+
+		PixelBufferReadback::Pixels pixels;
+		if (readback->read(region, geometry.getVtkPositionOfView(views[i]), &pixels))
+			previous.pieces.push_back(pixels);
+	}
+	mReadbacks = readbacks; // drop views no longer in the layout
+
+	mPendingSize = QSize(mWidget->width(), mWidget->height());
+	mPendingTime = QDateTime::currentDateTime();
+	mFlushTimer->start();
+
+	if (!previous.pieces.empty())
+		this->assembleLater(previous);
+}
+
+void AsyncViewCollectionImageWriter::onFlush()
+{
+	Frame frame;
+	frame.size = mPendingSize;
+	frame.time = mPendingTime;
+
+	for (std::map<QString, PixelBufferReadbackPtr>::iterator iter=mReadbacks.begin(); iter!=mReadbacks.end(); ++iter)
+	{
+		PixelBufferReadback::Pixels pixels;
+		if (iter->second->flush(&pixels))
+			frame.pieces.push_back(pixels);
+	}
+
+	if (!frame.pieces.empty())
+		this->assembleLater(frame);
+}
+
+void AsyncViewCollectionImageWriter::assembleLater(Frame frame)
+{
+	// keep only the latest frame while the worker is busy
+	if (mWatcher.isRunning())
+	{
+		mQueued = frame;
+		mHasQueued = true;
+		return;
+	}
+
+	mAssemblingTime = frame.time;
+	mWatcher.setFuture(QtConcurrent::run(&AsyncViewCollectionImageWriter::assemble, frame));
+}
+
+void AsyncViewCollectionImageWriter::onAssembled()
+{
+	mImage = mWatcher.result();
+	mImageTime = mAssemblingTime;
+
+	if (mHasQueued)
+	{
+		mHasQueued = false;
+		this->assembleLater(mQueued);
+	}
+
+	emit imageReady();
+}
+
+/** Convert the BGRA pieces to RGB and draw them into a common image,
+ *  as ViewCollectionImageWriter::grab() does.
+ */
+vtkImageDataPtr AsyncViewCollectionImageWriter::assemble(Frame frame)
+{
+	Eigen::Array3i target_size(frame.size.width(), frame.size.height(), 1);
+	vtkImageDataPtr target = generateVtkImageData(target_size, Vector3D(1,1,1), 150, 3);
+
+	for (unsigned i=0; i<frame.pieces.size(); ++i)
+	{
+		const PixelBufferReadback::Pixels& piece = frame.pieces[i];
+		QPoint pos = piece.target;
+		int width = std::min(piece.size.width(), target_size[0]-pos.x());
+		if (pos.x()<0 || width<=0)
+			continue;
+
+		for (int y=0; y<piece.size.height(); ++y)
+		{
+			if (pos.y()+y<0 || pos.y()+y>=target_size[1])
+				continue;
+			const unsigned char* src = reinterpret_cast<const unsigned char*>(piece.data.constData()) + y*piece.size.width()*4;
+			unsigned char* dst = reinterpret_cast<unsigned char*>(target->GetScalarPointer(pos.x(), pos.y()+y, 0));
+			for (int x=0; x<width; ++x)
+			{
+				dst[3*x+0] = src[4*x+2];
+				dst[3*x+1] = src[4*x+1];
+				dst[3*x+2] = src[4*x+0];
+			}
+		}
+	}
+
+	return target;
+}
+
+} // namespace cx
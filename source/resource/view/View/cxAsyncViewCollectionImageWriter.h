@@ -0,0 +1,90 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXASYNCVIEWCOLLECTIONIMAGEWRITER_H
+#define CXASYNCVIEWCOLLECTIONIMAGEWRITER_H
+
+#include "cxResourceVisualizationExport.h"
+
+#include <map>
+#include <vector>
+#include <QObject>
+#include <QPointer>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include "cxPixelBufferReadback.h"
+#include "cxForwardDeclarations.h"
+
+class QTimer;
+
+namespace cx
+{
+class ViewCollectionWidget;
+
+/** Grab the rendered contents of a ViewCollectionWidget without
+ *  stalling the render loop.
+ *
+ *  Call requestGrab() after each render. Each view is read back through
+ *  a PixelBufferReadback, thus the pixels of a render are collected at
+ *  the next request, or shortly after if no new render arrives.
+ *  Converting the pixels to RGB and assembling the views into one image
+ *  is done on a worker thread, then imageReady() is emitted.
+ *
+ *  The image has the same format as ViewCollectionImageWriter::grab().
+ *
+ * \ingroup cx_resource_view
+ * \date 2026-10-18
+ */
+class cxResourceVisualization_EXPORT AsyncViewCollectionImageWriter : public QObject
+{
+	Q_OBJECT
+public:
+	explicit AsyncViewCollectionImageWriter(ViewCollectionWidget* widget);
+	virtual ~AsyncViewCollectionImageWriter();
+
+	void requestGrab(); ///< call after render
+	vtkImageDataPtr getImage() const; ///< the last assembled image
+	QDateTime getImageTime() const; ///< time of the render the image was grabbed from
+
+signals:
+	void imageReady();
+
+private slots:
+	void onFlush();
+	void onAssembled();
+
+private:
+	struct Frame
+	{
+		std::vector<PixelBufferReadback::Pixels> pieces;
+		QSize size;
+		QDateTime time;
+	};
+	void assembleLater(Frame frame);
+	static vtkImageDataPtr assemble(Frame frame);
+
+	QPointer<ViewCollectionWidget> mWidget;
+	std::map<QString, PixelBufferReadbackPtr> mReadbacks; ///< one for each view uid
+	QSize mPendingSize; ///< layout size at the pending readback
+	QDateTime mPendingTime;
+	QTimer* mFlushTimer;
+
+	QFutureWatcher<vtkImageDataPtr> mWatcher;
+	QDateTime mAssemblingTime;
+	Frame mQueued; ///< latest frame waiting for the worker
+	bool mHasQueued;
+
+	vtkImageDataPtr mImage;
+	QDateTime mImageTime;
+};
+
+} // namespace cx
+
+#endif // CXASYNCVIEWCOLLECTIONIMAGEWRITER_H
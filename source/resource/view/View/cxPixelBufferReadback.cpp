@@ -0,0 +1,103 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+//needed on windows to where <windows.h> is included
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <GL/glew.h>
+
+#include "cxPixelBufferReadback.h"
+
+#include <vtkOpenGLRenderWindow.h>
+#include <vtkPixelBufferObject.h>
+#include "cxGLHelpers.h"
+#include "cxLogger.h"
+
+namespace cx
+{
+
+PixelBufferReadback::PixelBufferReadback(vtkRenderWindowPtr renderWindow) :
+	mRenderWindow(renderWindow),
+	mCurrent(0)
+{
+	for (int i=0; i<2; ++i)
+	{
+		mBuffers[i] = vtkPixelBufferObjectPtr::New();
+		mBuffers[i]->SetContext(mRenderWindow);
+	}
+}
+
+bool PixelBufferReadback::read(QRect region, QPoint target, Pixels* previous)
+{
+	vtkOpenGLRenderWindow* renderWindow = vtkOpenGLRenderWindow::SafeDownCast(mRenderWindow);
+	if (!renderWindow || region.isEmpty())
+		return false;
+	renderWindow->MakeCurrent();
+
+	// start transfer into the current buffer. BGRA is the fast path on most drivers.
+	unsigned int numBytes = region.width()*region.height()*4;
+	vtkPixelBufferObject* buffer = mBuffers[mCurrent];
+	if (buffer->GetSize() != numBytes)
+		buffer->Allocate(VTK_UNSIGNED_CHAR, numBytes, 1, vtkPixelBufferObject::PACKED_BUFFER);
+
+	buffer->Bind(vtkPixelBufferObject::PACKED_BUFFER);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadBuffer(renderWindow->GetBackBuffer());
+	glReadPixels(region.x(), region.y(), region.width(), region.height(), GL_BGRA, GL_UNSIGNED_BYTE, 0);
+	buffer->UnBind();
+	report_gl_error();
+
+	mRequests[mCurrent].region = region;
+	mRequests[mCurrent].target = target;
+	mRequests[mCurrent].pending = true;
+
+	// the other buffer was filled by the previous call: collect it and use it for the next read.
+	mCurrent = 1-mCurrent;
+	return this->map(mCurrent, previous);
+}
+
+bool PixelBufferReadback::flush(Pixels* previous)
+{
+	if (!mRequests[1-mCurrent].pending)
+		return false;
+	mRenderWindow->MakeCurrent();
+	return this->map(1-mCurrent, previous);
+}
+
+bool PixelBufferReadback::map(int index, Pixels* pixels)
+{
+	Request& request = mRequests[index];
+	if (!request.pending)
+		return false;
+	request.pending = false;
+
+	void* data = mBuffers[index]->MapPackedBuffer();
+	if (!data)
+	{
+		CX_LOG_WARNING() << "PixelBufferReadback: Failed to map pixel buffer";
+		return false;
+	}
+
+	pixels->data = QByteArray(static_cast<const char*>(data), request.region.width()*request.region.height()*4);
+	pixels->size = request.region.size();
+	pixels->target = request.target;
+	mBuffers[index]->UnmapPackedBuffer();
+	report_gl_error();
+	return true;
+}
+
+} // namespace cx
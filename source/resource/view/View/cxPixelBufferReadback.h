@@ -0,0 +1,75 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+#ifndef CXPIXELBUFFERREADBACK_H
+#define CXPIXELBUFFERREADBACK_H
+
+#include "cxResourceVisualizationExport.h"
+
+#include <QByteArray>
+#include <QRect>
+#include <boost/shared_ptr.hpp>
+#include "vtkForwardDeclarations.h"
+
+namespace cx
+{
+typedef boost::shared_ptr<class PixelBufferReadback> PixelBufferReadbackPtr;
+
+/** Read back a region of a render window without waiting for the GPU.
+ *
+ * Two pixel buffer objects are used in turn: read() starts the transfer
+ * of the region into one of them, then maps the other one, filled by
+ * the previous call. The GPU thus has one frame to complete each transfer.
+ * flush() maps the last transfer without starting a new one.
+ *
+ * Must be called with a valid context, i.e. after the first render.
+ *
+ * \ingroup cx_resource_view
+ * \date 2026-10-18
+ */
+class cxResourceVisualization_EXPORT PixelBufferReadback
+{
+public:
+	struct Pixels
+	{
+		QByteArray data; ///< BGRA, 4 bytes per pixel, bottom row first
+		QSize size;
+		QPoint target; ///< user-defined position, passed on from read()
+	};
+
+	explicit PixelBufferReadback(vtkRenderWindowPtr renderWindow);
+
+	/** Start reading region, given in pixels from the lower left corner of the window.
+	 *  Return true and fill previous if a previous read was pending.
+	 */
+	bool read(QRect region, QPoint target, Pixels* previous);
+	/** Return true and fill previous if a read was pending.
+	 */
+	bool flush(Pixels* previous);
+
+private:
+	struct Request
+	{
+		Request() : pending(false) {}
+		QRect region;
+		QPoint target;
+		bool pending;
+	};
+	bool map(int index, Pixels* pixels);
+
+	vtkRenderWindowPtr mRenderWindow;
+	vtkPixelBufferObjectPtr mBuffers[2];
+	Request mRequests[2];
+	int mCurrent;
+};
+
+} // namespace cx
+
+#endif // CXPIXELBUFFERREADBACK_H
@@ -30,6 +30,8 @@ class ViewCollectionWidget;
 /** Write the previously rendered contents of the input ViewCollectionWidget
  *  to a vtkImageData.
  *
+ *  The readback is synchronous. Use AsyncViewCollectionImageWriter
+ *  for grabbing every rendered frame.
  */
 class cxResourceVisualization_EXPORT ViewCollectionImageWriter
 {
@@ -37,15 +39,15 @@ public:
 	explicit ViewCollectionImageWriter(ViewCollectionWidget* widget);
     vtkImageDataPtr grab();
     static QImage vtkImageData2QImage(vtkImageDataPtr input);
+    /**
+     * Get view position in vtk coords, lower left corner*/
+    QPoint getVtkPositionOfView(ViewPtr view);
 private:
 	vtkImageDataPtr view2vtkImageData(ViewPtr view);
 	/**
 	 * Draw image inside target. pos is given in vtk coordinates inside target.
 	 * image is assumed to fit inside target at the indicated position. */
     void drawImageAtPos(vtkImageDataPtr target, vtkImageDataPtr image, QPoint pos);
-    /**
-     * Get view position in vtk coords, lower left corner*/
-    QPoint getVtkPositionOfView(ViewPtr view);
     QPoint qt2vtk(QPoint qpos);
 
 	ViewCollectionWidget* mWidget;
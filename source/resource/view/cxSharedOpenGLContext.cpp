@@ -26,10 +26,13 @@ See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt
 #include <vtkPixelBufferObject.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkTextureUnitManager.h>
+#include <vtkDataArray.h>
+#include <algorithm>
 
 #include "cxGLHelpers.h"
 #include "cxLogger.h"
 #include "cxImage.h"
+#include "cxUnsignedDerivedImage.h"
 #include "cxUtilHelpers.h"
 #include "cxSettings.h"
 
@@ -164,7 +167,13 @@ bool SharedOpenGLContext::uploadImage(ImagePtr image)
 		return success;
 	}
 
-	unsigned long new_modified_time = image->getBaseVtkImageData()->GetMTime();
+	// an unsigned view is converted while uploading, from the data of its base
+	UnsignedDerivedImagePtr unsignedView = boost::dynamic_pointer_cast<UnsignedDerivedImage>(image);
+	if (unsignedView && !unsignedView->getBase())
+		return success;
+	vtkImageDataPtr source = unsignedView ? unsignedView->getBase()->getBaseVtkImageData() : image->getBaseVtkImageData();
+
+	unsigned long new_modified_time = source->GetMTime();
 	std::map<QString, std::pair<vtkTextureObjectPtr, unsigned long> >::iterator it = m3DTextureObjects.find(image->getUid());
 	bool uploaded_but_modified = (it != m3DTextureObjects.end() && (it->second.second != new_modified_time) );
 	bool not_uploaded = it == m3DTextureObjects.end();
@@ -173,9 +182,9 @@ bool SharedOpenGLContext::uploadImage(ImagePtr image)
 	if( uploaded_but_modified || not_uploaded)
 	{
 		//upload new data to gpu
-		vtkImageDataPtr vtkImageData = image->getBaseVtkImageData();
+		vtkImageDataPtr vtkImageData = source;
 		int* dims = vtkImageData->GetDimensions();
-		int dataType = vtkImageData->GetScalarType();
+		int dataType = unsignedView ? unsignedView->getUnsignedScalarType() : vtkImageData->GetScalarType();
 		int numComps = vtkImageData->GetNumberOfScalarComponents();
 		int coordinate[3] = {dims[0]/2, dims[1]/2, dims[2]/2};
 		void* data = vtkImageData->GetScalarPointer();
@@ -196,7 +205,10 @@ bool SharedOpenGLContext::uploadImage(ImagePtr image)
 			//CX_LOG_DEBUG() << "create new texture_object";
 		}
 
-		success = this->create3DTextureObject(texture_object, dims[0], dims[1], dims[2], dataType, numComps, data, mContext);
+		if (unsignedView)
+			success = this->create3DTextureObjectFromUnsignedView(texture_object, unsignedView, dims[0], dims[1], dims[2], dataType, numComps, mContext);
+		else
+			success = this->create3DTextureObject(texture_object, dims[0], dims[1], dims[2], dataType, numComps, data, mContext);
 		m3DTextureObjects[image->getUid()] = std::make_pair(texture_object, vtkImageData->GetMTime());
 	}
 	else if(uploade_and_not_modified)
@@ -440,6 +452,39 @@ bool SharedOpenGLContext::create3DTextureObject(vtkTextureObjectPtr texture_obje
 	return true;
 }
 
+/**
+ * Allocate the texture, then convert and upload the image a slab of slices at a time:
+ * Only one slab of unsigned data exists in memory.
+ */
+bool SharedOpenGLContext::create3DTextureObjectFromUnsignedView(vtkTextureObjectPtr texture_object, UnsignedDerivedImagePtr image, unsigned int width, unsigned int height, unsigned int depth, int dataType, int numComps, vtkOpenGLRenderWindowPtr opengl_renderwindow) const
+{
+	if (!this->create3DTextureObject(texture_object, width, height, depth, dataType, numComps, NULL, opengl_renderwindow))
+		return false;
+
+	const int maxSlabSize = 16*1024*1024; // bytes
+	int sliceSize = width * height * numComps * vtkDataArray::GetDataTypeSize(dataType);
+	int slicesPerSlab = std::max(1, maxSlabSize / std::max(1, sliceSize));
+	std::vector<char> buffer(size_t(sliceSize) * std::min<int>(slicesPerSlab, depth));
+
+	texture_object->Activate();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	bool success = true;
+	for (int first = 0; first < int(depth) && success; first += slicesPerSlab)
+	{
+		int count = std::min<int>(slicesPerSlab, depth - first);
+		success = image->copyUnsignedSlices(first, count, &buffer[0]);
+		if (success)
+			glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, first, width, height, count,
+							texture_object->GetFormat(dataType, numComps, false), texture_object->GetDataType(dataType), &buffer[0]);
+	}
+	texture_object->Deactivate();
+	report_gl_error();
+
+	if (!success)
+		CX_LOG_ERROR() << "Error converting image " << image->getUid() << " to unsigned";
+	return success;
+}
+
 bool SharedOpenGLContext::useLinearInterpolation() const
 {
 	return settings()->value("View2D/useLinearInterpolationIn2DRendering").toBool();
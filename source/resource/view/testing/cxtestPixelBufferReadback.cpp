@@ -0,0 +1,64 @@
+/*=========================================================================
+This file is part of CustusX, an Image Guided Therapy Application.
+
+Copyright (c) SINTEF Department of Medical Technology.
+All rights reserved.
+
+CustusX is released under a BSD 3-Clause license.
+
+See Lisence.txt (https://github.com/SINTEFMedtek/CustusX/blob/master/License.txt) for details.
+=========================================================================*/
+
+#include "catch.hpp"
+#include <vtkRenderWindow.h>
+#include <vtkRenderer.h>
+#include "cxPixelBufferReadback.h"
+
+namespace cxtest
+{
+
+namespace
+{
+unsigned char byteAt(const cx::PixelBufferReadback::Pixels& pixels, int x, int y, int component)
+{
+	return static_cast<unsigned char>(pixels.data[(y*pixels.size.width()+x)*4+component]);
+}
+} // namespace
+
+TEST_CASE("PixelBufferReadback: Read back the previous frame", "[opengl][resource][visualization][integration]")
+{
+	vtkRenderWindowPtr renderWindow = vtkRenderWindowPtr::New();
+	renderWindow->SetOffScreenRendering(1);
+	renderWindow->SetSize(64, 48);
+	vtkRendererPtr renderer = vtkRendererPtr::New();
+	renderWindow->AddRenderer(renderer);
+
+	cx::PixelBufferReadback readback(renderWindow);
+	cx::PixelBufferReadback::Pixels pixels;
+	QRect region(8, 4, 32, 16);
+	QPoint target(3, 5);
+
+	renderer->SetBackground(1, 0, 0);
+	renderWindow->Render();
+	CHECK(!readback.read(region, target, &pixels)); // nothing to collect yet
+
+	renderer->SetBackground(0, 0, 1);
+	renderWindow->Render();
+	REQUIRE(readback.read(region, target, &pixels));
+	REQUIRE(pixels.size == region.size());
+	REQUIRE(pixels.data.size() == region.width()*region.height()*4);
+	CHECK(pixels.target == target);
+	// BGRA of the red frame
+	CHECK(byteAt(pixels, 0, 0, 0) == 0);
+	CHECK(byteAt(pixels, 0, 0, 2) == 255);
+	CHECK(byteAt(pixels, 31, 15, 2) == 255);
+
+	REQUIRE(readback.flush(&pixels));
+	// BGRA of the blue frame
+	CHECK(byteAt(pixels, 0, 0, 0) == 255);
+	CHECK(byteAt(pixels, 0, 0, 2) == 0);
+
+	CHECK(!readback.flush(&pixels)); // nothing pending
+}
+
+} // namespace cxtest